@@ -75,12 +75,14 @@ target_link_libraries(utils
 
 add_library(stats
   fboss/agent/AggregatePortStats.cpp
+  fboss/agent/PortCounterSlab.cpp
   fboss/agent/PortStats.cpp
   fboss/agent/SwitchStats.cpp
   fboss/agent/oss/AggregatePortStats.cpp
 )
 
 target_link_libraries(stats
+  agent_config_cpp2
   fboss_types
   state
   Folly::folly
@@ -98,12 +100,14 @@ add_library(core
   fboss/agent/ApplyThriftConfig.cpp
   fboss/agent/ArpCache.cpp
   fboss/agent/ArpHandler.cpp
+  fboss/agent/CpuPacketScheduler.cpp
   fboss/agent/DHCPv4Handler.cpp
   fboss/agent/DHCPv6Handler.cpp
   fboss/agent/HwSwitch.cpp
   fboss/agent/IPHeaderV4.cpp
   fboss/agent/IPv4Handler.cpp
   fboss/agent/IPv6Handler.cpp
+  fboss/agent/IcmpErrorRateLimiter.cpp
   fboss/agent/L2Entry.cpp
   fboss/agent/LacpController.cpp
   fboss/agent/LacpMachines.cpp
@@ -120,8 +124,10 @@ add_library(core
   fboss/agent/MirrorManager.cpp
   fboss/agent/MirrorManagerImpl.cpp
   fboss/agent/NdpCache.cpp
+  fboss/agent/NetlinkBatch.cpp
   fboss/agent/NeighborUpdater.cpp
   fboss/agent/NeighborUpdaterImpl.cpp
+  fboss/agent/ParsedPacketMeta.cpp
   fboss/agent/PortUpdateHandler.cpp
   fboss/agent/ResolvedNexthopMonitor.cpp
   fboss/agent/ResolvedNexthopProbe.cpp
@@ -130,6 +136,7 @@ add_library(core
   fboss/agent/RouteUpdateLogger.cpp
   fboss/agent/RouteUpdateLoggingPrefixTracker.cpp
   fboss/agent/StandaloneRibConversions.cpp
+  fboss/agent/StateUpdateRecorder.cpp
   fboss/agent/StaticL2ForNeighborObserver.cpp
   fboss/agent/StaticL2ForNeighborUpdater.cpp
   fboss/agent/StaticL2ForNeighborSwSwitchUpdater.cpp
@@ -137,6 +144,7 @@ add_library(core
   fboss/agent/ThreadHeartbeat.cpp
   fboss/agent/TunIntf.cpp
   fboss/agent/TunManager.cpp
+  fboss/agent/TxPacketBufferPool.cpp
   fboss/agent/ndp/IPv6RouteAdvertiser.cpp
   fboss/agent/oss/RouteUpdateLogger.cpp
   fboss/agent/oss/SwSwitch.cpp
@@ -230,6 +238,7 @@ target_link_libraries(platform_base
 
 add_library(hw_switch
   fboss/agent/HwSwitch.cpp
+  fboss/agent/TxPacketBufferPool.cpp
 )
 
 target_link_libraries(hw_switch
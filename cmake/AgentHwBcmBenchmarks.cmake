@@ -269,6 +269,23 @@ target_link_libraries(bcm_init_and_exit_100Gx100G
   -Wl,--no-whole-archive
 )
 
+add_executable(bcm_warm_boot_cache_speed
+  fboss/agent/hw/bcm/benchmarks/BcmWarmBootCacheBenchmark.cpp
+)
+
+target_link_libraries(bcm_warm_boot_cache_speed
+  -Wl,--whole-archive
+  bcm
+  config
+  bcm_switch_ensemble
+  config_factory
+  -Wl,--no-whole-archive
+  hw_benchmark_main
+  ${OPENNSA}
+  Folly::folly
+  Folly::follybenchmark
+)
+
 install(TARGETS bcm_ecmp_shrink_speed)
 install(TARGETS bcm_ecmp_shrink_with_competing_route_updates_speed)
 install(TARGETS bcm_fsw_scale_route_add_speed)
@@ -288,3 +305,4 @@ install(TARGETS bcm_init_and_exit_100Gx10G)
 install(TARGETS bcm_init_and_exit_100Gx25G)
 install(TARGETS bcm_init_and_exit_100Gx50G)
 install(TARGETS bcm_init_and_exit_100Gx100G)
+install(TARGETS bcm_warm_boot_cache_speed)
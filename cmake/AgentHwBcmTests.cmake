@@ -21,6 +21,7 @@ add_executable(bcm_test
   fboss/agent/hw/bcm/tests/BcmAclUnitTests.cpp
   fboss/agent/hw/bcm/tests/BcmAddDelEcmpTests.cpp
   fboss/agent/hw/bcm/tests/BcmBstStatsMgrTest.cpp
+  fboss/agent/hw/bcm/tests/BcmSflowExporterTest.cpp
   fboss/agent/hw/bcm/tests/BcmControlPlaneTests.cpp
   fboss/agent/hw/bcm/tests/BcmCosQueueManagerTest.cpp
   fboss/agent/hw/bcm/tests/BcmCosQueueManagerCounterTests.cpp
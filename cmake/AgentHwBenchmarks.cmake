@@ -239,3 +239,65 @@ target_link_libraries(hw_init_and_exit_100Gx100G
   config_factory
   hw_init_and_exit_benchmark_helper
 )
+
+# MockPlatform and SimSwitch are only built into fboss_agent
+if (NOT SAI_ONLY)
+  add_executable(state_update_replay_benchmark
+    fboss/agent/hw/test/StateUpdateReplayBenchmark.cpp
+    fboss/agent/hw/test/FakeSaiPlatformUtils.cpp
+    fboss/agent/hw/sim/SimPlatform.cpp
+    fboss/agent/hw/sim/SimPlatformMapping.cpp
+    fboss/agent/hw/sim/SimPlatformPort.cpp
+  )
+
+  target_include_directories(state_update_replay_benchmark
+    PUBLIC
+      ${LIBGMOCK_INCLUDE_DIR}
+  )
+
+  target_link_libraries(state_update_replay_benchmark
+    fboss_agent
+    sai_platform
+    fake_sai
+    ${LIBGMOCK_LIBRARIES}
+    Folly::folly
+  )
+
+  set_target_properties(state_update_replay_benchmark PROPERTIES COMPILE_FLAGS
+    "-DSAI_VER_MAJOR=${SAI_VER_MAJOR} \
+    -DSAI_VER_MINOR=${SAI_VER_MINOR}  \
+    -DSAI_VER_RELEASE=${SAI_VER_RELEASE}"
+  )
+
+  add_executable(sw_switch_update_benchmark
+    fboss/agent/hw/test/SwSwitchUpdateBenchmark.cpp
+    fboss/agent/hw/test/FakeSaiPlatformUtils.cpp
+    fboss/agent/hw/sim/SimPlatform.cpp
+    fboss/agent/hw/sim/SimPlatformMapping.cpp
+    fboss/agent/hw/sim/SimPlatformPort.cpp
+    fboss/agent/test/TestUtils.cpp
+  )
+
+  target_include_directories(sw_switch_update_benchmark
+    PUBLIC
+      ${LIBGMOCK_INCLUDE_DIR}
+  )
+
+  target_link_libraries(sw_switch_update_benchmark
+    fboss_agent
+    sai_platform
+    fake_sai
+    trunk_utils
+    ${LIBGMOCK_LIBRARIES}
+    Folly::folly
+  )
+
+  set_target_properties(sw_switch_update_benchmark PROPERTIES COMPILE_FLAGS
+    "-DSAI_VER_MAJOR=${SAI_VER_MAJOR} \
+    -DSAI_VER_MINOR=${SAI_VER_MINOR}  \
+    -DSAI_VER_RELEASE=${SAI_VER_RELEASE}"
+  )
+
+  install(TARGETS state_update_replay_benchmark)
+  install(TARGETS sw_switch_update_benchmark)
+endif()
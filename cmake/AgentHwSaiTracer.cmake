@@ -20,6 +20,9 @@ add_library(sai_tracer
   fboss/agent/hw/sai/tracer/QueueApiTracer.cpp
   fboss/agent/hw/sai/tracer/RouteApiTracer.cpp
   fboss/agent/hw/sai/tracer/RouterInterfaceApiTracer.cpp
+  fboss/agent/hw/sai/tracer/SaiBinaryTracer.cpp
+  fboss/agent/hw/sai/tracer/SaiTraceRecord.cpp
+  fboss/agent/hw/sai/tracer/SaiTraceRing.cpp
   fboss/agent/hw/sai/tracer/SaiTracer.cpp
   fboss/agent/hw/sai/tracer/SamplePacketApiTracer.cpp
   fboss/agent/hw/sai/tracer/SchedulerApiTracer.cpp
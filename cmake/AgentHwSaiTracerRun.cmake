@@ -3,6 +3,9 @@
 # In general, libraries and binaries in fboss/foo/bar are built by
 # cmake/FooBar.cmake
 
+find_path(SAI_META_INCLUDE_DIR NAMES saimetadatautils.h PATH_SUFFIXES meta)
+message(STATUS "Found SAI_META_INCLUDE_DIR: ${SAI_META_INCLUDE_DIR}")
+
 function(BUILD_SAI_REPLAYER SAI_IMPL_NAME SAI_IMPL_ARG)
 
   message(STATUS "Building Sai Replayer SAI_IMPL_NAME: ${SAI_IMPL_NAME} SAI_IMPL_ARG: ${SAI_IMPL_ARG}")
@@ -27,6 +30,30 @@ function(BUILD_SAI_REPLAYER SAI_IMPL_NAME SAI_IMPL_ARG)
       -DSAI_VER_RELEASE=${SAI_VER_RELEASE}"
     )
 
+  add_executable(sai_trace_replayer-${SAI_IMPL_NAME}-${SAI_VER_SUFFIX}
+    fboss/agent/hw/sai/tracer/run/SaiTraceReplayer.cpp
+  )
+
+  target_link_libraries(sai_trace_replayer-${SAI_IMPL_NAME}-${SAI_VER_SUFFIX}
+    sai_tracer
+    ${SAI_IMPL_ARG}
+    Folly::folly
+  )
+
+  # Only the SAI metadata headers are needed, the replayer checks at runtime
+  # whether the SAI implementation provides the metadata functions
+  target_include_directories(
+    sai_trace_replayer-${SAI_IMPL_NAME}-${SAI_VER_SUFFIX}
+    PRIVATE ${SAI_META_INCLUDE_DIR}
+  )
+
+  set_target_properties(sai_trace_replayer-${SAI_IMPL_NAME}-${SAI_VER_SUFFIX}
+      PROPERTIES COMPILE_FLAGS
+      "-DSAI_VER_MAJOR=${SAI_VER_MAJOR} \
+      -DSAI_VER_MINOR=${SAI_VER_MINOR}  \
+      -DSAI_VER_RELEASE=${SAI_VER_RELEASE}"
+    )
+
 endfunction()
 
 BUILD_SAI_REPLAYER("fake" fake_sai)
@@ -39,5 +66,6 @@ if(SAI_IMPL)
   BUILD_SAI_REPLAYER("sai_impl" ${SAI_IMPL})
   install(
     TARGETS
-    sai_replayer-sai_impl-${SAI_VER_SUFFIX})
+    sai_replayer-sai_impl-${SAI_VER_SUFFIX}
+    sai_trace_replayer-sai_impl-${SAI_VER_SUFFIX})
 endif()
@@ -32,6 +32,7 @@ add_library(state
   fboss/agent/state/NdpTable.cpp
   fboss/agent/state/NeighborResponseTable.cpp
   fboss/agent/state/NodeBase.cpp
+  fboss/agent/state/ParallelSerialization.cpp
   fboss/agent/state/Port.cpp
   fboss/agent/state/PortMap.cpp
   fboss/agent/state/PortQueue.cpp
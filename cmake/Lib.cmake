@@ -6,6 +6,10 @@
 add_library(radix_tree
   fboss/lib/RadixTree.h
   fboss/lib/RadixTree-inl.h
+  fboss/lib/PersistentRadixTree.h
+  fboss/lib/PersistentRadixTree-inl.h
+  fboss/lib/CompactRadixTree.h
+  fboss/lib/CompactRadixTree-inl.h
 )
 
 target_link_libraries(radix_tree
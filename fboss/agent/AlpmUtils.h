@@ -8,6 +8,8 @@
  *
  */
 
+#pragma once
+
 #include <memory>
 
 namespace facebook::fboss {
@@ -25,4 +27,25 @@ uint64_t numMinAlpmRoutes();
 uint64_t numMinAlpmV4Routes();
 uint64_t numMinAlpmV6Routes();
 
+/*
+ * Order in which routes of a single update should be programmed on ALPM
+ * enabled ASICs. The default route anchors every ALPM bucket and always goes
+ * first. Other routes go most specific first, and routes of the same length
+ * in address order, so prefixes sharing a bucket are programmed back to back
+ * rather than splitting and reshuffling buckets as they arrive.
+ * Deletes should be done in the reverse order.
+ */
+template <typename PrefixT>
+bool alpmAddOrderLess(const PrefixT& lhs, const PrefixT& rhs) {
+  auto lhsDefault = lhs.mask == 0;
+  auto rhsDefault = rhs.mask == 0;
+  if (lhsDefault != rhsDefault) {
+    return lhsDefault;
+  }
+  if (lhs.mask != rhs.mask) {
+    return lhs.mask > rhs.mask;
+  }
+  return lhs.network < rhs.network;
+}
+
 } // namespace facebook::fboss
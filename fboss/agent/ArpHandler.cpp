@@ -16,6 +16,7 @@
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/ParsedPacketMeta.h"
 #include "fboss/agent/PortStats.h"
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
@@ -56,34 +57,31 @@ ArpHandler::ArpHandler(SwSwitch* sw) : sw_(sw) {}
 
 void ArpHandler::handlePacket(
     unique_ptr<RxPacket> pkt,
-    MacAddress /*dst*/,
-    MacAddress /*src*/,
-    Cursor cursor) {
-  auto stats = sw_->stats();
-  CHECK(stats);
-  PortID port = pkt->getSrcPort();
-  CHECK(stats->port(port));
+    const ParsedPacketMeta& meta) {
+  auto portStats = meta.portStats;
+  CHECK(portStats);
+  auto cursor = meta.l3Cursor(pkt.get());
 
-  stats->port(port)->arpPkt();
+  portStats->arpPkt();
   // Read htype, ptype, hlen, and plen
   auto htype = cursor.readBE<uint16_t>();
   if (htype != ARP_HTYPE_ETHERNET) {
-    stats->port(port)->arpUnsupported();
+    portStats->arpUnsupported();
     return;
   }
   auto ptype = cursor.readBE<uint16_t>();
   if (ptype != ARP_PTYPE_IPV4) {
-    stats->port(port)->arpUnsupported();
+    portStats->arpUnsupported();
     return;
   }
   auto hlen = cursor.readBE<uint8_t>();
   if (hlen != ARP_HLEN_ETHERNET) {
-    stats->port(port)->arpUnsupported();
+    portStats->arpUnsupported();
     return;
   }
   auto plen = cursor.readBE<uint8_t>();
   if (plen != ARP_PLEN_IPV4) {
-    stats->port(port)->arpUnsupported();
+    portStats->arpUnsupported();
     return;
   }
 
@@ -93,7 +91,7 @@ void ArpHandler::handlePacket(
   if (!vlan) {
     // Hmm, we don't actually have this VLAN configured.
     // Perhaps the state has changed since we received the packet.
-    stats->port(port)->pktDropped();
+    portStats->pktDropped();
     return;
   }
 
@@ -105,7 +103,7 @@ void ArpHandler::handlePacket(
   auto targetIP = PktUtil::readIPv4(&cursor);
 
   if (readOp != ARP_OP_REQUEST && readOp != ARP_OP_REPLY) {
-    stats->port(port)->arpBadOp();
+    portStats->arpBadOp();
     return;
   }
 
@@ -118,7 +116,7 @@ void ArpHandler::handlePacket(
     // The target IP does not refer to us.
     XLOG(DBG5) << "ignoring ARP message for " << targetIP.str() << " on vlan "
                << pkt->getSrcVlan();
-    stats->port(port)->arpNotMine();
+    portStats->arpNotMine();
 
     updater->receivedArpNotMine(
         vlan->getID(),
@@ -130,10 +128,10 @@ void ArpHandler::handlePacket(
   }
 
   if (op == ARP_OP_REQUEST) {
-    stats->port(port)->arpRequestRx();
+    portStats->arpRequestRx();
   } else {
     CHECK(op == ARP_OP_REPLY);
-    stats->port(port)->arpReplyRx();
+    portStats->arpReplyRx();
   }
 
   if (op == ARP_OP_REQUEST && !AggregatePort::isIngressValid(state, pkt)) {
@@ -27,6 +27,7 @@ class Cursor;
 
 namespace facebook::fboss {
 
+struct ParsedPacketMeta;
 class RxPacket;
 class SwSwitch;
 class SwitchState;
@@ -45,9 +46,7 @@ class ArpHandler {
 
   void handlePacket(
       std::unique_ptr<RxPacket> pkt,
-      folly::MacAddress dst,
-      folly::MacAddress src,
-      folly::io::Cursor cursor);
+      const ParsedPacketMeta& meta);
 
   /*
    * These two static methods are for sending out ARP requests.
@@ -8,7 +8,10 @@
  *
  */
 
+#include <algorithm>
+#include <array>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <fstream>
 #include <iostream>
@@ -17,6 +20,8 @@
 #include "fboss/agent/SysError.h"
 
 #include <folly/FileUtil.h>
+#include <folly/ScopeGuard.h>
+#include <folly/logging/xlog.h>
 #include <gflags/gflags.h>
 
 DEFINE_bool(
@@ -24,33 +29,81 @@ DEFINE_bool(
     false,
     "Flag to indicate whether to disable async logging and directly write into the file");
 
-enum BufferToWrite { BUFFER0, BUFFER1 };
+DEFINE_int32(
+    async_logger_staging_buffer_size,
+    1 << 20,
+    "Size in bytes of the per thread staging buffer of async logger. Records "
+    "that do not fit are dropped instead of blocking the logging thread");
 
 static std::string exitFilePath;
 static uint32_t offset = 0;
-static BufferToWrite currentBuffer = BUFFER0;
-static std::array<char, facebook::fboss::AsyncLogger::kBufferSize> buffer0;
-static std::array<char, facebook::fboss::AsyncLogger::kBufferSize> buffer1;
+static std::array<char, facebook::fboss::AsyncLogger::kBufferSize> buffer;
 
 namespace {
 
-void terminateHandler() {
+constexpr size_t kRecordAlignment = 8;
+
+size_t alignedSize(size_t size) {
+  return (size + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+} // namespace
+
+namespace facebook::fboss {
+
+std::shared_ptr<AsyncLogger::StagingBuffers>&
+AsyncLogger::terminateStagingBuffers() {
+  // Leaked so that it is still around when terminate handler runs
+  static auto* stagingBuffers = new std::shared_ptr<StagingBuffers>();
+  return *stagingBuffers;
+}
+
+void AsyncLogger::terminateHandler() {
+  // Use standard library instead of folly because in unclean exit, folly
+  // library could be inaccessible so there's a higher chance of writing into
+  // file using standard library.
+  std::ofstream logfile;
+  logfile.open(exitFilePath, std::ofstream::app);
   if (offset > 0) {
-    // Use standard library instead of folly because in unclean exit, folly
-    // library could be inaccessible so there's a higher chance of writing into
-    // file using standard library.
-    std::ofstream logfile;
-    logfile.open(exitFilePath, std::ofstream::app);
-
-    if (currentBuffer == BUFFER0) {
-      logfile.write(buffer0.data(), offset);
-    } else {
-      logfile.write(buffer1.data(), offset);
-    }
+    logfile.write(buffer.data(), offset);
     std::cerr << "Async logger exit with " << offset
               << " bytes written to file " << std::endl;
   }
 
+  // Records not yet merged into the buffer are all newer than it. Write the
+  // ones that are fully staged, in sequence order. A record the flush thread
+  // is merging right now may end up in the file twice.
+  if (auto stagingBuffers = terminateStagingBuffers()) {
+    // Do not wait on a lock the terminating thread may hold
+    if (auto lockedBuffers = stagingBuffers->tryWLock()) {
+      std::vector<std::pair<uint64_t, std::string>> records;
+      for (const auto& staging : *lockedBuffers) {
+        auto head = staging->head.load(std::memory_order_acquire);
+        auto tail = staging->tail.load(std::memory_order_acquire);
+        while (head != tail) {
+          RecordHeader header;
+          staging->copyOut(head, &header, sizeof(header));
+          std::string record(header.size, '\0');
+          staging->copyOut(head + sizeof(header), record.data(), header.size);
+          records.emplace_back(header.seq, std::move(record));
+          head += sizeof(header) + alignedSize(header.size);
+        }
+      }
+      std::sort(records.begin(), records.end());
+      for (const auto& record : records) {
+        logfile.write(record.second.data(), record.second.size());
+      }
+      if (!records.empty()) {
+        std::cerr << "Async logger exit with " << records.size()
+                  << " staged records written to file " << std::endl;
+      }
+    } else {
+      std::cerr << "Async logger exit without writing staged records"
+                << std::endl;
+    }
+  }
+  logfile.close();
+
   std::exception_ptr eptr = std::current_exception();
   if (eptr) {
     try {
@@ -63,21 +116,45 @@ void terminateHandler() {
   abort();
 }
 
-} // namespace
+AsyncLogger::StagingBuffer::StagingBuffer(size_t size)
+    : capacity(alignedSize(size)), data(new char[capacity]) {}
+
+void AsyncLogger::StagingBuffer::copyIn(
+    uint64_t pos,
+    const void* src,
+    size_t len) {
+  auto start = pos % capacity;
+  auto first = std::min(len, capacity - start);
+  memcpy(data.get() + start, src, first);
+  memcpy(data.get(), static_cast<const char*>(src) + first, len - first);
+}
 
-namespace facebook::fboss {
-AsyncLogger::AsyncLogger(std::string filePath, uint32_t logTimeout)
-    : bufferSize_(AsyncLogger::kBufferSize) {
+void AsyncLogger::StagingBuffer::copyOut(uint64_t pos, void* dst, size_t len)
+    const {
+  auto start = pos % capacity;
+  auto first = std::min(len, capacity - start);
+  memcpy(dst, data.get() + start, first);
+  memcpy(static_cast<char*>(dst) + first, data.get(), len - first);
+}
+
+AsyncLogger::AsyncLogger(
+    std::string filePath,
+    uint32_t logTimeout,
+    size_t stagingBufferSize)
+    : stagingBufferSize_(
+          stagingBufferSize ? stagingBufferSize
+                            : FLAGS_async_logger_staging_buffer_size),
+      stagingBuffers_(std::make_shared<StagingBuffers>()) {
   openLogFile(filePath);
 
   if (!FLAGS_disable_async_logger) {
-    logBuffer_ = buffer0.data();
-    flushBuffer_ = buffer1.data();
+    logBuffer_ = buffer.data();
 
     exitFilePath = filePath;
 
     logTimeout_ = std::chrono::milliseconds(logTimeout);
 
+    terminateStagingBuffers() = stagingBuffers_;
     std::set_terminate(terminateHandler);
   }
 }
@@ -87,50 +164,53 @@ AsyncLogger::~AsyncLogger() {
 }
 
 void AsyncLogger::worker_thread() {
-  while (enableLogging_) {
-    std::unique_lock<std::mutex> lock(latch_);
-
-    // Wait for either 1. Timeout 2. Force flush or full flush
-    cv_.wait_for(lock, logTimeout_, [this] {
-      return this->forceFlush_ || this->fullFlush_;
-    });
-
-    // Swap log buffer and flush buffer
-    char* writeBuffer = logBuffer_;
-    uint32_t currSize = offset;
-    offset = 0;
-    currentBuffer = ((currentBuffer == BUFFER0) ? BUFFER1 : BUFFER0);
-    logBuffer_ = flushBuffer_;
-
-    if (fullFlush_) {
-      fullFlush_ = false;
-    }
-
-    lock.unlock();
-    cv_.notify_one();
-
-    // Write content in swap buffer to file
-    if (currSize > 0) {
-      auto bytesWritten = logFile_.withWLock([&](auto& lockedFile) {
-        return folly::writeFull(lockedFile.fd(), writeBuffer, currSize);
+  bool running = true;
+  while (running) {
+    uint64_t flushRequest;
+    bool writeOut;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+
+      // Wait for either 1. Timeout 2. Force flush 3. Staging buffers filling
+      // up 4. Stop
+      bool woken = cv_.wait_for(lock, logTimeout_, [this] {
+        return wakeRequested_ || flushRequests_ != flushesDone_ ||
+            !enableLogging_;
       });
+      flushRequest = flushRequests_;
+      running = enableLogging_;
+      // A wake up from producers only merges staged records, the write
+      // buffer goes out once it is full. Everything else writes it out.
+      writeOut = !woken || flushRequest != flushesDone_ || !running;
+      wakeRequested_ = false;
+    }
 
-      if (bytesWritten < 0) {
-        throw SysError(
-            errno, "error writing ", currSize, " bytes to log file.");
+    if (!running) {
+      // Producers past the enableLogging_ check may still be staging
+      while (appendsInFlight_.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
       }
-
-      flushCount_++;
+    }
+    drainStagingBuffers(nextSeq_.load(std::memory_order_acquire));
+    if (writeOut) {
+      writeBuffer();
     }
 
-    memset(writeBuffer, 0, bufferSize_);
-    flushBuffer_ = writeBuffer;
+    auto dropped = droppedRecords_.load(std::memory_order_relaxed);
+    if (dropped != droppedRecordsLogged_) {
+      XLOG(WARN) << "Async logger dropped " << dropped - droppedRecordsLogged_
+                 << " records, staging buffer of " << stagingBufferSize_
+                 << " bytes full";
+      droppedRecordsLogged_ = dropped;
+    }
 
     // Notify force flush that write completes
-    if (forceFlush_) {
-      forceFlush_ = false;
-      promise_.set_value(0);
-      promise_ = std::promise<int>();
+    if (flushRequest != flushesDone_) {
+      {
+        std::lock_guard<std::mutex> lock(latch_);
+        flushesDone_ = flushRequest;
+      }
+      flushDoneCv_.notify_all();
     }
   }
 }
@@ -144,67 +224,196 @@ void AsyncLogger::startFlushThread() {
 
 void AsyncLogger::stopFlushThread() {
   if (!FLAGS_disable_async_logger && enableLogging_) {
-    enableLogging_ = false;
+    {
+      std::lock_guard<std::mutex> lock(latch_);
+      enableLogging_ = false;
+    }
+    cv_.notify_one();
     flushThread_->join();
     delete flushThread_;
+    flushThread_ = nullptr;
   }
 }
 
 void AsyncLogger::forceFlush() {
-  if (!FLAGS_disable_async_logger) {
-    future_ = promise_.get_future();
-
-    forceFlush_ = true;
+  if (!FLAGS_disable_async_logger && enableLogging_) {
+    std::unique_lock<std::mutex> lock(latch_);
+    auto request = ++flushRequests_;
     cv_.notify_one();
 
     // Wait for flush to complete
-    future_.get();
+    flushDoneCv_.wait(
+        lock, [this, request] { return flushesDone_ >= request; });
   }
 }
 
 void AsyncLogger::appendLog(const char* logRecord, size_t logSize) {
-  if (!enableLogging_) {
+  if (!enableLogging_ || logSize == 0) {
+    return;
+  }
+
+  auto recordSize = sizeof(RecordHeader) + alignedSize(logSize);
+  if (FLAGS_disable_async_logger) {
+    writeDirect(logRecord, logSize);
+    return;
+  }
+  if (recordSize > alignedSize(stagingBufferSize_)) {
+    // Could never be staged. Write out what is staged first to keep the
+    // order of this thread's records.
+    forceFlush();
+    writeDirect(logRecord, logSize);
     return;
   }
 
-  if (FLAGS_disable_async_logger && logSize > 0) {
-    auto bytesWritten = logFile_.withWLock([&](auto& lockedFile) {
-      return folly::writeFull(lockedFile.fd(), logRecord, logSize);
-    });
+  // Pairs with stopFlushThread(): either we see logging disabled here, or
+  // the final drain waits for this record to be staged
+  appendsInFlight_.fetch_add(1, std::memory_order_seq_cst);
+  SCOPE_EXIT {
+    appendsInFlight_.fetch_sub(1, std::memory_order_release);
+  };
+  if (!enableLogging_.load(std::memory_order_seq_cst)) {
+    return;
+  }
 
-    if (bytesWritten < 0) {
-      throw SysError(errno, "error writing ", logSize, " bytes to log file.");
-    }
+  auto staging = getStagingBuffer();
+  auto tail = staging->tail.load(std::memory_order_relaxed);
+  auto head = staging->head.load(std::memory_order_acquire);
+  if (tail - head + recordSize > staging->capacity) {
+    // Never block the caller on the flush thread, drop and account instead
+    droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+    wakeFlushThread();
     return;
   }
 
-  // Acquire the lock and check if there's enough space in the buffer
-  latch_.lock();
+  // The sequence number is only taken once the record is sure to be staged,
+  // so the flush thread never waits on a sequence number that is not coming.
+  RecordHeader header{
+      nextSeq_.fetch_add(1, std::memory_order_acq_rel), logSize};
+  staging->copyIn(tail, &header, sizeof(header));
+  staging->copyIn(tail + sizeof(header), logRecord, logSize);
+  staging->tail.store(tail + recordSize, std::memory_order_release);
+
+  if (tail + recordSize - head > kBufferSize / 2) {
+    wakeFlushThread();
+  }
+}
+
+void AsyncLogger::writeDirect(const char* logRecord, size_t logSize) {
+  auto bytesWritten = logFile_.withWLock([&](auto& lockedFile) {
+    return folly::writeFull(lockedFile.fd(), logRecord, logSize);
+  });
+
+  if (bytesWritten < 0) {
+    throw SysError(errno, "error writing ", logSize, " bytes to log file.");
+  }
+}
+
+AsyncLogger::StagingBuffer* AsyncLogger::getStagingBuffer() {
+  auto& staging = *localStagingBuffer_;
+  if (!staging) {
+    staging = std::make_shared<StagingBuffer>(stagingBufferSize_);
+    stagingBuffers_->wlock()->push_back(staging);
+  }
+  return staging.get();
+}
 
-  if (logSize + offset >= bufferSize_) {
-    // Release the lock and notify worker thread to flush logs
-    fullFlush_ = true;
-    latch_.unlock();
+void AsyncLogger::wakeFlushThread() {
+  // Only the first producer after each wake up pays for the lock
+  if (!wakeRequested_.exchange(true, std::memory_order_acq_rel)) {
+    { std::lock_guard<std::mutex> lock(latch_); }
     cv_.notify_one();
+  }
+}
 
-    // Wait for worker to finish
-    std::unique_lock<std::mutex> lock(latch_);
-    cv_.wait(lock, [logSize] {
-      return logSize + offset < AsyncLogger::kBufferSize;
-    });
+void AsyncLogger::drainStagingBuffers(uint64_t upTo) {
+  // Every record below upTo was staged by a thread that registered its
+  // staging buffer before taking the sequence number, so it is in this copy.
+  auto stagingBuffers = stagingBuffers_->copy();
+
+  while (nextSeqToWrite_ < upTo) {
+    bool progress = false;
+    for (auto& staging : stagingBuffers) {
+      auto head = staging->head.load(std::memory_order_relaxed);
+      auto tail = staging->tail.load(std::memory_order_acquire);
+      // Records of one thread are in sequence order, consume them for as
+      // long as they are the next ones to write
+      while (head != tail && nextSeqToWrite_ < upTo) {
+        RecordHeader header;
+        staging->copyOut(head, &header, sizeof(header));
+        if (header.seq != nextSeqToWrite_) {
+          break;
+        }
+        appendToWriteBuffer(*staging, head);
+        head += sizeof(header) + alignedSize(header.size);
+        staging->head.store(head, std::memory_order_release);
+        ++nextSeqToWrite_;
+        progress = true;
+      }
+    }
+    if (!progress) {
+      // A producer took the next sequence number but has not published the
+      // record yet, it is just a copy away
+      std::this_thread::yield();
+    }
+  }
 
-    // Write to buffer
-    memcpy(logBuffer_ + offset, logRecord, logSize);
-    offset += logSize;
+  // Forget staging buffers of threads that have exited once they are drained
+  stagingBuffers.clear();
+  stagingBuffers_->withWLock([](auto& buffers) {
+    buffers.erase(
+        std::remove_if(
+            buffers.begin(),
+            buffers.end(),
+            [](const auto& staging) {
+              return staging.use_count() == 1 &&
+                  staging->head.load(std::memory_order_relaxed) ==
+                  staging->tail.load(std::memory_order_acquire);
+            }),
+        buffers.end());
+  });
+}
 
-    lock.unlock();
-  } else {
-    // Directly write to buffer
-    memcpy(logBuffer_ + offset, logRecord, logSize);
-    offset += logSize;
+void AsyncLogger::appendToWriteBuffer(
+    const StagingBuffer& staging,
+    uint64_t pos) {
+  RecordHeader header;
+  staging.copyOut(pos, &header, sizeof(header));
+  pos += sizeof(header);
 
-    latch_.unlock();
+  // Keep records whole in a write if they fit
+  if (offset + header.size > kBufferSize) {
+    writeBuffer();
   }
+
+  auto remaining = header.size;
+  while (remaining > 0) {
+    auto len = std::min<uint64_t>(remaining, kBufferSize - offset);
+    staging.copyOut(pos, logBuffer_ + offset, len);
+    offset += len;
+    pos += len;
+    remaining -= len;
+    if (offset == kBufferSize) {
+      writeBuffer();
+    }
+  }
+}
+
+void AsyncLogger::writeBuffer() {
+  if (offset == 0) {
+    return;
+  }
+
+  auto currSize = offset;
+  auto bytesWritten = logFile_.withWLock([&](auto& lockedFile) {
+    return folly::writeFull(lockedFile.fd(), logBuffer_, currSize);
+  });
+
+  if (bytesWritten < 0) {
+    throw SysError(errno, "error writing ", currSize, " bytes to log file.");
+  }
+
+  offset = 0;
+  flushCount_++;
 }
 
 void AsyncLogger::openLogFile(std::string& file_path) {
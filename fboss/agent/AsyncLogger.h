@@ -10,19 +10,44 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
-#include <future>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include <folly/File.h>
 #include <folly/Synchronized.h>
+#include <folly/ThreadLocal.h>
 
 namespace facebook::fboss {
 
+/*
+ * AsyncLogger buffers log records in memory and writes them to a file from a
+ * background flush thread.
+ *
+ * appendLog() is lock free and never blocks on file I/O. Each producer thread
+ * appends into its own staging buffer, a single producer / single consumer
+ * ring. Records are stamped with a global sequence number, and the flush
+ * thread merges the staging buffers back in sequence order into the write
+ * buffer, so the file has the records in the order appendLog() was called
+ * across all threads. If a staging buffer is full the record is dropped and
+ * accounted in droppedRecords() rather than blocking the producer. Records
+ * larger than a whole staging buffer are written to the file directly, after
+ * flushing what is already staged.
+ */
 class AsyncLogger {
  public:
-  explicit AsyncLogger(std::string filePath, uint32_t logTimeout);
+  /*
+   * stagingBufferSize is the per producer thread staging buffer size in
+   * bytes, 0 uses --async_logger_staging_buffer_size.
+   */
+  explicit AsyncLogger(
+      std::string filePath,
+      uint32_t logTimeout,
+      size_t stagingBufferSize = 0);
 
   ~AsyncLogger();
 
@@ -30,9 +55,11 @@ class AsyncLogger {
    * To handle unclean exit, we use terminate handler to write out the logs that
    * are still in the buffer. However, terminate handler is invoked after the
    * program exits, meaning variables could be already destructed when we enter
-   * terminate handler. Therefore, we use static variables for the async buffer
-   * and related data structures. They are not garbage collected until terminate
-   * handler is finished.
+   * terminate handler. Therefore, we use a static variable for the write
+   * buffer the flush thread drains staging buffers into. It is not garbage
+   * collected until terminate handler is finished. Records still in the
+   * staging buffers are reached through a registry that is never destroyed,
+   * and written after the buffer in sequence order.
    * However, the downside of this approach is that the buffer size needs to be
    * hardcoded (instead of declaring a google flag and pass in as command line
    * argument). The buffer size should be known at compile time.
@@ -49,27 +76,85 @@ class AsyncLogger {
 
   void appendLog(const char* logRecord, size_t logSize);
 
+  uint64_t droppedRecords() const {
+    return droppedRecords_.load(std::memory_order_relaxed);
+  }
+
   // Expose these variables for testing purpose
-  uint32_t flushCount_{0};
+  std::atomic<uint32_t> flushCount_{0};
 
  private:
-  void worker_thread();
-  void openLogFile(std::string& file_path);
+  /*
+   * Single producer / single consumer byte ring. Each record is a
+   * RecordHeader followed by the record bytes, padded to 8 bytes.
+   */
+  struct StagingBuffer {
+    explicit StagingBuffer(size_t size);
 
-  bool forceFlush_{false};
-  bool fullFlush_{false};
-  bool enableLogging_{false};
+    void copyIn(uint64_t pos, const void* src, size_t len);
+    void copyOut(uint64_t pos, void* dst, size_t len) const;
 
-  uint32_t bufferSize_;
+    const size_t capacity;
+    std::unique_ptr<char[]> data;
+    // Written by the producer thread only
+    alignas(64) std::atomic<uint64_t> tail{0};
+    // Written by the flush thread only
+    alignas(64) std::atomic<uint64_t> head{0};
+  };
+
+  struct RecordHeader {
+    uint64_t seq;
+    uint64_t size;
+  };
+
+  using StagingBuffers =
+      folly::Synchronized<std::vector<std::shared_ptr<StagingBuffer>>>;
+
+  static void terminateHandler();
+  // Staging buffers of the logger that installed the terminate handler
+  static std::shared_ptr<StagingBuffers>& terminateStagingBuffers();
+
+  void worker_thread();
+  void openLogFile(std::string& file_path);
+  void writeDirect(const char* logRecord, size_t logSize);
+
+  StagingBuffer* getStagingBuffer();
+  void wakeFlushThread();
+  // Merge staged records up to (excluding) sequence number upTo
+  void drainStagingBuffers(uint64_t upTo);
+  void appendToWriteBuffer(const StagingBuffer& staging, uint64_t pos);
+  void writeBuffer();
+
+  std::atomic<bool> enableLogging_{false};
+  // appendLog() calls past the enableLogging_ check. The final drain in
+  // stopFlushThread() waits for them so that no staged record is left behind.
+  std::atomic<uint32_t> appendsInFlight_{0};
+
+  size_t stagingBufferSize_;
+  std::atomic<uint64_t> nextSeq_{0};
+  std::atomic<uint64_t> droppedRecords_{0};
+  // Flush thread only
+  uint64_t nextSeqToWrite_{0};
+  uint64_t droppedRecordsLogged_{0};
+
+  std::shared_ptr<StagingBuffers> stagingBuffers_;
+  folly::ThreadLocal<std::shared_ptr<StagingBuffer>> localStagingBuffer_;
 
   char* logBuffer_;
-  char* flushBuffer_;
 
-  std::promise<int> promise_;
-  std::future<int> future_;
+  /*
+   * Control path between producers, forceFlush() and the flush thread.
+   * Producers only take latch_ to wake the flush thread, once their staging
+   * buffer holds more than half a write buffer worth of records.
+   */
   std::mutex latch_;
-  std::thread* flushThread_;
   std::condition_variable cv_;
+  std::atomic<bool> wakeRequested_{false};
+  uint64_t flushRequests_{0};
+  uint64_t flushesDone_{0};
+  std::condition_variable flushDoneCv_;
+
+  std::thread* flushThread_{nullptr};
   std::chrono::microseconds logTimeout_;
 
   folly::Synchronized<folly::File> logFile_;
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/CpuPacketScheduler.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/ParsedPacketMeta.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/InterfaceMap.h"
+
+#include <folly/logging/xlog.h>
+#include <thrift/lib/cpp/util/EnumUtils.h>
+
+#include <algorithm>
+
+namespace {
+constexpr uint16_t kBgpPort = 179;
+} // namespace
+
+namespace facebook::fboss {
+
+namespace {
+/*
+ * Whether the IPv4Handler or IPv6Handler hands the packet to the host rather
+ * than routing it
+ */
+bool isForUs(const ParsedPacketMeta& meta, const InterfaceMap& interfaces) {
+  if (meta.dstIp.isMulticast()) {
+    return interfaces.getInterfaceInVlanIf(meta.vlan) != nullptr;
+  }
+  if (meta.dstIp.isV6() && meta.dstIp.isLinkLocal()) {
+    auto intf = interfaces.getInterfaceInVlanIf(meta.vlan);
+    return intf && intf->hasAddress(meta.dstIp);
+  }
+  // TODO: assume vrf 0 now, as the handlers do
+  return interfaces.getInterfaceIf(RouterID(0), meta.dstIp) != nullptr;
+}
+} // namespace
+
+cfg::CpuPacketClass CpuPacketScheduler::classify(
+    const ParsedPacketMeta& meta,
+    const InterfaceMap& interfaces) {
+  switch (static_cast<ETHERTYPE>(meta.etherType)) {
+    case ETHERTYPE::ETHERTYPE_SLOW_PROTOCOLS:
+    case ETHERTYPE::ETHERTYPE_LLDP:
+    case ETHERTYPE::ETHERRTPE_EAPOL:
+      return cfg::CpuPacketClass::HIGH;
+    case ETHERTYPE::ETHERTYPE_ARP:
+      return cfg::CpuPacketClass::NEIGHBOR;
+    case ETHERTYPE::ETHERTYPE_IPV4:
+    case ETHERTYPE::ETHERTYPE_IPV6:
+      break;
+    default:
+      return cfg::CpuPacketClass::DEFAULT;
+  }
+
+  // BGP sessions are usually single hop, so check them before the TTL
+  if (meta.ipProto == static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP) &&
+      (meta.srcL4Port == kBgpPort || meta.dstL4Port == kBgpPort)) {
+    return cfg::CpuPacketClass::HIGH;
+  }
+  if (meta.ipProto == static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP)) {
+    auto icmpType = static_cast<ICMPv6Type>(meta.icmpType);
+    if (icmpType >= ICMPv6Type::ICMPV6_TYPE_NDP_ROUTER_SOLICITATION &&
+        icmpType <= ICMPv6Type::ICMPV6_TYPE_NDP_REDIRECT_MESSAGE) {
+      return cfg::CpuPacketClass::NEIGHBOR;
+    }
+  }
+  // The interface lookup is only paid for packets with a low TTL
+  if (meta.ttl <= 1 && !isForUs(meta, interfaces)) {
+    return cfg::CpuPacketClass::TTL_EXPIRED;
+  }
+  return cfg::CpuPacketClass::DEFAULT;
+}
+
+void CpuPacketScheduler::setConfig(
+    const cfg::CpuPacketSchedulerConfig& config) {
+  for (const auto& [packetClass, rateLimit] : *config.rateLimits_ref()) {
+    if (static_cast<size_t>(packetClass) >= kNumPacketClasses ||
+        *rateLimit.packetsPerSec_ref() <= 0 ||
+        *rateLimit.burstSize_ref() < 0) {
+      throw FbossError(
+          "Invalid CPU packet rate limit for class ",
+          apache::thrift::util::enumNameSafe(packetClass),
+          ": ",
+          *rateLimit.packetsPerSec_ref(),
+          " pps, burst ",
+          *rateLimit.burstSize_ref());
+    }
+  }
+
+  bool enabled = false;
+  for (size_t i = 0; i < kNumPacketClasses; ++i) {
+    auto packetClass = static_cast<cfg::CpuPacketClass>(i);
+    auto& rateLimit = rateLimits_[i];
+    auto it = config.rateLimits_ref()->find(packetClass);
+    if (it == config.rateLimits_ref()->end()) {
+      rateLimit.limited = false;
+      continue;
+    }
+    auto packetsPerSec = *it->second.packetsPerSec_ref();
+    auto burstSize = *it->second.burstSize_ref();
+    rateLimit.packetsPerSec = packetsPerSec;
+    // A bucket must hold at least one packet for any to get through
+    rateLimit.burstSize = std::max(burstSize, 1);
+    rateLimit.limited = true;
+    enabled = true;
+    XLOG(DBG2) << "CPU packet class "
+               << apache::thrift::util::enumNameSafe(packetClass)
+               << " limited to " << packetsPerSec << " pps per port, burst "
+               << burstSize;
+  }
+  enabled_ = enabled;
+}
+
+bool CpuPacketScheduler::admit(cfg::CpuPacketClass packetClass, PortID port) {
+  auto index = static_cast<size_t>(packetClass);
+  DCHECK_LT(index, kNumPacketClasses);
+  const auto& rateLimit = rateLimits_[index];
+  if (!rateLimit.limited.load(std::memory_order_relaxed)) {
+    return true;
+  }
+
+  uint64_t key = (static_cast<uint64_t>(port) << 8) | index;
+  auto it = buckets_.find(key);
+  if (it == buckets_.cend()) {
+    // New buckets start full, as after a quiet period
+    it = buckets_
+             .try_emplace(key, std::make_unique<folly::DynamicTokenBucket>())
+             .first;
+  }
+  return it->second->consume(
+      1,
+      rateLimit.packetsPerSec.load(std::memory_order_relaxed),
+      rateLimit.burstSize.load(std::memory_order_relaxed));
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/TokenBucket.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "fboss/agent/gen-cpp2/agent_config_types.h"
+#include "fboss/agent/types.h"
+
+namespace facebook::fboss {
+
+class InterfaceMap;
+struct ParsedPacketMeta;
+
+/*
+ * Software rate limiter for packets trapped to the CPU, applied by
+ * SwSwitch::handlePacket before any handler runs. Hardware CoPP bounds the
+ * total rate of trapped packets, this keeps a flood of one kind of packet
+ * (e.g. TTL expired) from starving the others (e.g. BGP keepalives) of
+ * handler time.
+ *
+ * Packets are classified into cfg::CpuPacketClass, and each class has a
+ * token bucket per ingress port. Over the limit packets are dropped. All
+ * methods are thread safe, admit() is called from the packet RX threads.
+ */
+class CpuPacketScheduler {
+ public:
+  static constexpr size_t kNumPacketClasses = 4;
+
+  /*
+   * Class of a trapped packet. Packets addressed to one of our interfaces
+   * are handled by the host whatever their TTL, only the ones we would
+   * have to route are TTL_EXPIRED.
+   */
+  static cfg::CpuPacketClass classify(
+      const ParsedPacketMeta& meta,
+      const InterfaceMap& interfaces);
+
+  /*
+   * Apply new rate limits. Buckets keep their tokens across updates.
+   */
+  void setConfig(const cfg::CpuPacketSchedulerConfig& config);
+
+  // Whether any class is rate limited
+  bool enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /*
+   * Whether a packet of packetClass from port may be handled now.
+   */
+  bool admit(cfg::CpuPacketClass packetClass, PortID port);
+
+ private:
+  struct RateLimit {
+    std::atomic<bool> limited{false};
+    std::atomic<double> packetsPerSec{0};
+    std::atomic<double> burstSize{0};
+  };
+
+  std::atomic<bool> enabled_{false};
+  std::array<RateLimit, kNumPacketClasses> rateLimits_;
+  // Keyed by port and packet class
+  folly::ConcurrentHashMap<
+      uint64_t,
+      std::unique_ptr<folly::DynamicTokenBucket>>
+      buckets_;
+};
+
+} // namespace facebook::fboss
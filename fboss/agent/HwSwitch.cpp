@@ -8,6 +8,8 @@
  *
  */
 #include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/TxPacket.h"
+#include "fboss/agent/TxPacketBufferPool.h"
 #include "fboss/agent/hw/HwSwitchStats.h"
 #include "fboss/agent/hw/switch_asics/HwAsic.h"
 #include "fboss/agent/normalization/Normalizer.h"
@@ -22,6 +24,23 @@
 
 namespace facebook::fboss {
 
+HwSwitch::HwSwitch(uint32_t featuresDesired)
+    : featuresDesired_(featuresDesired) {
+  if (FLAGS_tx_buffer_pool_size) {
+    txBufferPool_ =
+        std::make_shared<TxPacketBufferPool>(FLAGS_tx_buffer_pool_size);
+  }
+}
+
+bool HwSwitch::sendPacketsSwitchedAsync(
+    std::vector<std::unique_ptr<TxPacket>> pkts) noexcept {
+  bool allSent = true;
+  for (auto& pkt : pkts) {
+    allSent &= sendPacketSwitchedAsync(std::move(pkt));
+  }
+  return allSent;
+}
+
 std::string HwSwitch::getDebugDump() const {
   folly::test::TemporaryDirectory tmpDir;
   auto fname = tmpDir.path().string() + "hw_debug_dump";
@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace folly {
 struct dynamic;
@@ -32,6 +33,7 @@ class SwitchStats;
 class StateDelta;
 class RxPacket;
 class TxPacket;
+class TxPacketBufferPool;
 class L2Entry;
 class HwSwitchStats;
 enum class L2EntryUpdateType : uint8_t;
@@ -109,11 +111,10 @@ class HwSwitch {
     TAM_EVENT_NOTIFY_DESIRED = 0x04,
   };
 
-  HwSwitch(
+  explicit HwSwitch(
       uint32_t featuresDesired =
           (FeaturesDesired::PACKET_RX_DESIRED |
-           FeaturesDesired::LINKSCAN_DESIRED))
-      : featuresDesired_(featuresDesired) {}
+           FeaturesDesired::LINKSCAN_DESIRED));
   virtual ~HwSwitch() {}
 
   virtual Platform* getPlatform() const = 0;
@@ -178,6 +179,16 @@ class HwSwitch {
   virtual bool sendPacketSwitchedAsync(
       std::unique_ptr<TxPacket> pkt) noexcept = 0;
 
+  /*
+   * Send a burst of packets, each of them switched as done by
+   * sendPacketSwitchedAsync(). Implementations may override this to do the
+   * per send setup once for the whole burst.
+   *
+   * @return If all the packets are successfully sent to HW.
+   */
+  virtual bool sendPacketsSwitchedAsync(
+      std::vector<std::unique_ptr<TxPacket>> pkts) noexcept;
+
   /*
    * Send a packet, send it out the specified port, use
    * VLAN and destination MAC from packet
@@ -315,6 +326,14 @@ class HwSwitch {
 
   HwSwitchStats* getSwitchStats() const;
 
+  /*
+   * Buffers for allocatePacket() to reuse, null if --tx_buffer_pool_size
+   * is 0.
+   */
+  const std::shared_ptr<TxPacketBufferPool>& getTxBufferPool() const {
+    return txBufferPool_;
+  }
+
  private:
   virtual void switchRunStateChangedImpl(SwitchRunState newState) = 0;
 
@@ -322,6 +341,7 @@ class HwSwitch {
 
   uint32_t featuresDesired_;
   SwitchRunState runState_{SwitchRunState::UNINITIALIZED};
+  std::shared_ptr<TxPacketBufferPool> txBufferPool_;
 
   // Forbidden copy constructor and assignment operator
   HwSwitch(HwSwitch const&) = delete;
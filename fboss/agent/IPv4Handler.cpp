@@ -20,6 +20,7 @@
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/IPHeaderV4.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/ParsedPacketMeta.h"
 #include "fboss/agent/Platform.h"
 #include "fboss/agent/PortStats.h"
 #include "fboss/agent/RxPacket.h"
@@ -57,17 +58,12 @@ std::unique_ptr<TxPacket> createICMPv4Pkt(
     folly::MacAddress dstMac,
     folly::MacAddress srcMac,
     VlanID vlan,
-    folly::IPAddressV4& dstIP,
-    folly::IPAddressV4& srcIP,
+    IPv4Hdr ipv4,
     ICMPv4Type icmpType,
     ICMPv4Code icmpCode,
     uint32_t bodyLength,
     BodyFn serializeBody) {
-  IPv4Hdr ipv4(
-      srcIP,
-      dstIP,
-      static_cast<uint8_t>(IP_PROTO::IP_PROTO_ICMP),
-      ICMPHdr::SIZE + bodyLength);
+  ipv4.length = ipv4.size() + ICMPHdr::SIZE + bodyLength;
   ipv4.computeChecksum();
 
   ICMPHdr icmp4(
@@ -81,7 +77,11 @@ std::unique_ptr<TxPacket> createICMPv4Pkt(
   return pkt;
 }
 
-IPv4Handler::IPv4Handler(SwSwitch* sw) : sw_(sw) {}
+IPv4Handler::IPv4Handler(SwSwitch* sw)
+    : sw_(sw),
+      icmpErrorLimiter_(
+          FLAGS_icmp_error_rate_limit,
+          FLAGS_icmp_error_burst_size) {}
 
 void IPv4Handler::sendICMPTimeExceeded(
     VlanID srcVlan,
@@ -89,6 +89,12 @@ void IPv4Handler::sendICMPTimeExceeded(
     MacAddress src,
     IPv4Hdr& v4Hdr,
     Cursor cursor) {
+  if (!icmpErrorLimiter_.admit(
+          v4Hdr.srcAddr,
+          static_cast<uint8_t>(ICMPv4Type::ICMPV4_TYPE_TIME_EXCEEDED))) {
+    sw_->stats()->icmpErrorSuppressed();
+    return;
+  }
   auto state = sw_->getState();
 
   // payload serialization function
@@ -101,35 +107,41 @@ void IPv4Handler::sendICMPTimeExceeded(
     sendCursor->push(cursor.data(), ICMPHdr::ICMPV4_SENDER_BYTES);
   };
 
-  IPAddressV4 srcIp = getSwitchVlanIP(state, srcVlan);
+  auto ipv4 = icmpErrorTemplates_.get(state->getInterfaces(), srcVlan, [&]() {
+    return IPv4Hdr(
+        getSwitchVlanIP(state, srcVlan),
+        IPAddressV4(),
+        static_cast<uint8_t>(IP_PROTO::IP_PROTO_ICMP),
+        0);
+  });
+  ipv4.dstAddr = v4Hdr.srcAddr;
   auto icmpPkt = createICMPv4Pkt(
       sw_,
       dst,
       src,
       srcVlan,
-      v4Hdr.srcAddr,
-      srcIp,
+      ipv4,
       ICMPv4Type::ICMPV4_TYPE_TIME_EXCEEDED,
       ICMPv4Code::ICMPV4_CODE_TIME_EXCEEDED_TTL_EXCEEDED,
       bodyLength,
       serializeBody);
   XLOG(DBG4) << "sending ICMP Time Exceeded with srcMac " << src
              << " dstMac: " << dst << " vlan: " << srcVlan
-             << " dstIp: " << v4Hdr.srcAddr.str() << " srcIp: " << srcIp.str()
+             << " dstIp: " << v4Hdr.srcAddr.str()
+             << " srcIp: " << ipv4.srcAddr.str()
              << " bodyLength: " << bodyLength;
   sw_->sendPacketSwitchedAsync(std::move(icmpPkt));
 }
 
 void IPv4Handler::handlePacket(
     unique_ptr<RxPacket> pkt,
-    MacAddress dst,
-    MacAddress src,
-    Cursor cursor) {
-  SwitchStats* stats = sw_->stats();
-  PortID port = pkt->getSrcPort();
+    const ParsedPacketMeta& meta) {
+  auto portStats = meta.portStats;
+  PortID port = meta.port;
+  auto cursor = meta.l3Cursor(pkt.get());
 
-  const uint32_t l3Len = pkt->getLength() - (cursor - Cursor(pkt->buf()));
-  stats->port(port)->ipv4Rx();
+  const uint32_t l3Len = pkt->getLength() - meta.l3Offset;
+  portStats->ipv4Rx();
   IPv4Hdr v4Hdr(cursor);
   XLOG(DBG4) << "Rx IPv4 packet (" << l3Len << " bytes) " << v4Hdr.srcAddr.str()
              << " --> " << v4Hdr.dstAddr.str() << " proto: 0x" << std::hex
@@ -144,21 +156,27 @@ void IPv4Handler::handlePacket(
   auto state = sw_->getState();
   // Need to check if the packet is for self or not. We store our IP
   // in the ARP response table. Use that for now.
-  auto vlan = state->getVlans()->getVlanIf(pkt->getSrcVlan());
+  auto vlan = state->getVlans()->getVlanIf(meta.vlan);
   if (!vlan) {
-    stats->port(port)->pktDropped();
+    portStats->pktDropped();
     return;
   }
 
   if (v4Hdr.protocol == static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)) {
     Cursor udpCursor(cursor);
     UDPHeader udpHdr;
-    udpHdr.parse(&udpCursor, sw_->portStats(port));
+    udpHdr.parse(&udpCursor, portStats);
     XLOG(DBG4) << "UDP packet, Source port :" << udpHdr.srcPort
                << " destination port: " << udpHdr.dstPort;
     if (DHCPv4Handler::isDHCPv4Packet(udpHdr)) {
       DHCPv4Handler::handlePacket(
-          sw_, std::move(pkt), src, dst, v4Hdr, udpHdr, udpCursor);
+          sw_,
+          std::move(pkt),
+          meta.srcMac,
+          meta.dstMac,
+          v4Hdr,
+          udpHdr,
+          udpCursor);
       return;
     }
   }
@@ -170,7 +188,7 @@ void IPv4Handler::handlePacket(
   auto interfaceMap = state->getInterfaces();
   if (v4Hdr.dstAddr.isMulticast()) {
     // Forward multicast packet directly to corresponding host interface
-    intf = interfaceMap->getInterfaceInVlanIf(pkt->getSrcVlan());
+    intf = interfaceMap->getInterfaceInVlanIf(meta.vlan);
   } else if (v4Hdr.dstAddr.isLinkLocal()) {
     // XXX: Ideally we should scope the limit to Link only. However we are
     // using v4 link locals in a special way on Galaxy/6pack which needs because
@@ -178,7 +196,7 @@ void IPv4Handler::handlePacket(
     //
     // Forward link-local packet directly to corresponding host interface
     // provided desAddr is assigned to that interface.
-    // intf = interfaceMap->getInterfaceInVlanIf(pkt->getSrcVlan());
+    // intf = interfaceMap->getInterfaceInVlanIf(meta.vlan);
     // if (not intf->hasAddress(v4Hdr.dstAddr)) {
     //   intf = nullptr;
     // }
@@ -192,15 +210,15 @@ void IPv4Handler::handlePacket(
     // TODO: Also check to see if this is the broadcast address for one of the
     // interfaces on this VLAN.  We should probably build up a more efficient
     // data structure to look up this information.
-    stats->port(port)->ipv4Mine();
+    portStats->ipv4Mine();
     // Anything not handled by the controller, we will forward it to the host,
     // i.e. ping, ssh, bgp...
     // FixME: will do another diff to set length in RxPacket, so that it
     // can be reused here.
     if (sw_->sendPacketToHost(intf->getID(), std::move(pkt))) {
-      stats->port(port)->pktToHost(l3Len);
+      portStats->pktToHost(l3Len);
     } else {
-      stats->port(port)->pktDropped();
+      portStats->pktDropped();
     }
     return;
   }
@@ -208,11 +226,11 @@ void IPv4Handler::handlePacket(
   // if packet is not for us, check the ttl exceed
   if (v4Hdr.ttl <= 1) {
     XLOG(DBG4) << "Rx IPv4 Packet with TTL expired";
-    stats->port(port)->pktDropped();
-    stats->port(port)->ipv4TtlExceeded();
+    portStats->pktDropped();
+    portStats->ipv4TtlExceeded();
     // Look up cpu mac from platform
     MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
-    sendICMPTimeExceeded(pkt->getSrcVlan(), cpuMac, cpuMac, v4Hdr, cursor);
+    sendICMPTimeExceeded(meta.vlan, cpuMac, cpuMac, v4Hdr, cursor);
     return;
   }
 
@@ -221,7 +239,7 @@ void IPv4Handler::handlePacket(
   // interfaces on this VLAN. We should probably build up a more efficient
   // data structure to look up this information.
   if (v4Hdr.dstAddr.isLinkLocalBroadcast()) {
-    stats->port(port)->pktDropped();
+    portStats->pktDropped();
     return;
   }
 
@@ -229,15 +247,15 @@ void IPv4Handler::handlePacket(
   // resolving the address
   // We will need to manage the rate somehow. Either from HW
   // or a SW control here
-  stats->port(port)->ipv4Nexthop();
-  if (!resolveMac(state, port, v4Hdr.dstAddr, pkt->getSrcVlan())) {
-    stats->port(port)->ipv4NoArp();
+  portStats->ipv4Nexthop();
+  if (!resolveMac(state, port, v4Hdr.dstAddr, meta.vlan)) {
+    portStats->ipv4NoArp();
     XLOG(DBG4) << "Cannot find the interface to send out ARP request for "
                << v4Hdr.dstAddr.str();
   }
   // TODO: ideally, we need to store this packet until the ARP is done and
   // then send this pkt out. For now, just drop it.
-  stats->port(port)->pktDropped();
+  portStats->pktDropped();
 }
 
 // Return true if we successfully sent an ARP request, false otherwise
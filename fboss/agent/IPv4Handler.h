@@ -15,6 +15,8 @@
 
 #include <folly/IPAddressV4.h>
 #include <folly/MacAddress.h>
+#include "fboss/agent/IcmpErrorRateLimiter.h"
+#include "fboss/agent/IcmpErrorTemplateCache.h"
 #include "fboss/agent/packet/IPv4Hdr.h"
 
 namespace folly {
@@ -25,6 +27,7 @@ class Cursor;
 
 namespace facebook::fboss {
 
+struct ParsedPacketMeta;
 class RxPacket;
 class SwitchState;
 class SwSwitch;
@@ -38,9 +41,7 @@ class IPv4Handler {
 
   void handlePacket(
       std::unique_ptr<RxPacket> pkt,
-      folly::MacAddress dst,
-      folly::MacAddress src,
-      folly::io::Cursor cursor);
+      const ParsedPacketMeta& meta);
 
   /*
    * TODO(aeckert): t17949183 unify packet handling pipeline and then
@@ -65,6 +66,8 @@ class IPv4Handler {
   IPv4Handler& operator=(IPv4Handler const&) = delete;
 
   SwSwitch* sw_{nullptr};
+  IcmpErrorRateLimiter icmpErrorLimiter_;
+  IcmpErrorTemplateCache<IPv4Hdr> icmpErrorTemplates_;
 };
 
 } // namespace facebook::fboss
@@ -15,6 +15,7 @@
 #include "fboss/agent/DHCPv6Handler.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/ParsedPacketMeta.h"
 #include "fboss/agent/Platform.h"
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
@@ -49,23 +50,32 @@ using std::unique_ptr;
 
 namespace facebook::fboss {
 
+namespace {
+
+IPv6Hdr makeICMPv6Hdr(
+    const folly::IPAddressV6& srcIP,
+    const folly::IPAddressV6& dstIP) {
+  IPv6Hdr ipv6(srcIP, dstIP);
+  ipv6.trafficClass = 0xe0; // CS7 precedence (network control)
+  ipv6.nextHeader = static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP);
+  ipv6.hopLimit = 255;
+  return ipv6;
+}
+
+} // namespace
+
 template <typename BodyFn>
 std::unique_ptr<TxPacket> createICMPv6Pkt(
     SwSwitch* sw,
     folly::MacAddress dstMac,
     folly::MacAddress srcMac,
     VlanID vlan,
-    const folly::IPAddressV6& dstIP,
-    const folly::IPAddressV6& srcIP,
+    IPv6Hdr ipv6,
     ICMPv6Type icmp6Type,
     ICMPv6Code icmp6Code,
     uint32_t bodyLength,
     BodyFn serializeBody) {
-  IPv6Hdr ipv6(srcIP, dstIP);
-  ipv6.trafficClass = 0xe0; // CS7 precedence (network control)
   ipv6.payloadLength = ICMPHdr::SIZE + bodyLength;
-  ipv6.nextHeader = static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP);
-  ipv6.hopLimit = 255;
 
   ICMPHdr icmp6(
       static_cast<uint8_t>(icmp6Type), static_cast<uint8_t>(icmp6Code), 0);
@@ -78,6 +88,30 @@ std::unique_ptr<TxPacket> createICMPv6Pkt(
   return pkt;
 }
 
+template <typename BodyFn>
+std::unique_ptr<TxPacket> createICMPv6Pkt(
+    SwSwitch* sw,
+    folly::MacAddress dstMac,
+    folly::MacAddress srcMac,
+    VlanID vlan,
+    const folly::IPAddressV6& dstIP,
+    const folly::IPAddressV6& srcIP,
+    ICMPv6Type icmp6Type,
+    ICMPv6Code icmp6Code,
+    uint32_t bodyLength,
+    BodyFn serializeBody) {
+  return createICMPv6Pkt(
+      sw,
+      dstMac,
+      srcMac,
+      vlan,
+      makeICMPv6Hdr(srcIP, dstIP),
+      icmp6Type,
+      icmp6Code,
+      bodyLength,
+      serializeBody);
+}
+
 struct IPv6Handler::ICMPHeaders {
   folly::MacAddress dst;
   folly::MacAddress src;
@@ -86,7 +120,11 @@ struct IPv6Handler::ICMPHeaders {
 };
 
 IPv6Handler::IPv6Handler(SwSwitch* sw)
-    : AutoRegisterStateObserver(sw, "IPv6Handler"), sw_(sw) {}
+    : AutoRegisterStateObserver(sw, "IPv6Handler"),
+      sw_(sw),
+      icmpErrorLimiter_(
+          FLAGS_icmp_error_rate_limit,
+          FLAGS_icmp_error_burst_size) {}
 
 void IPv6Handler::stateUpdated(const StateDelta& delta) {
   for (const auto& entry : delta.getIntfsDelta()) {
@@ -128,15 +166,17 @@ void IPv6Handler::intfDeleted(const Interface* intf) {
 
 void IPv6Handler::handlePacket(
     unique_ptr<RxPacket> pkt,
-    MacAddress dst,
-    MacAddress src,
-    Cursor cursor) {
-  const uint32_t l3Len = pkt->getLength() - (cursor - Cursor(pkt->buf()));
+    const ParsedPacketMeta& meta) {
+  const auto& dst = meta.dstMac;
+  const auto& src = meta.srcMac;
+  auto portStats = meta.portStats;
+  auto cursor = meta.l3Cursor(pkt.get());
+  const uint32_t l3Len = pkt->getLength() - meta.l3Offset;
   IPv6Hdr ipv6(cursor); // note: advances our cursor object
   XLOG(DBG4) << "IPv6 (" << l3Len
              << " bytes)"
                 " port: "
-             << pkt->getSrcPort() << " vlan: " << pkt->getSrcVlan()
+             << pkt->getSrcPort() << " vlan: " << meta.vlan
              << " src: " << ipv6.srcAddr.str() << " (" << src << ")"
              << " dst: " << ipv6.dstAddr.str() << " (" << dst << ")"
              << " nextHeader: " << static_cast<int>(ipv6.nextHeader);
@@ -147,14 +187,13 @@ void IPv6Handler::handlePacket(
 
   // retrieve the current switch state
   auto state = sw_->getState();
-  PortID port = pkt->getSrcPort();
 
   // NOTE: DHCPv6 solicit packet from client has hoplimit set to 1,
   // we need to handle it before send the ICMPv6 TTL exceeded
   if (ipv6.nextHeader == static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)) {
     Cursor udpCursor(cursor);
     UDPHeader udpHdr;
-    udpHdr.parse(&udpCursor, sw_->portStats(port));
+    udpHdr.parse(&udpCursor, portStats);
     XLOG(DBG4) << "DHCP UDP packet, source port :" << udpHdr.srcPort
                << " destination port: " << udpHdr.dstPort;
     if (DHCPv6Handler::isForDHCPv6RelayOrServer(udpHdr)) {
@@ -176,11 +215,11 @@ void IPv6Handler::handlePacket(
     // Forward multicast packet directly to corresponding host interface
     // and let Linux handle it. In software we consume ICMPv6 Multicast
     // packets for function of NDP protocol, rest all are forwarded to host.
-    intf = interfaceMap->getInterfaceInVlanIf(pkt->getSrcVlan());
+    intf = interfaceMap->getInterfaceInVlanIf(meta.vlan);
   } else if (ipv6.dstAddr.isLinkLocal()) {
     // Forward link-local packet directly to corresponding host interface
     // provided desAddr is assigned to that interface.
-    intf = interfaceMap->getInterfaceInVlanIf(pkt->getSrcVlan());
+    intf = interfaceMap->getInterfaceInVlanIf(meta.vlan);
     if (intf && !(intf->hasAddress(ipv6.dstAddr))) {
       intf = nullptr;
     }
@@ -195,11 +234,11 @@ void IPv6Handler::handlePacket(
   auto minHopLimit = intf ? 0 : 1;
   if (ipv6.hopLimit <= minHopLimit) {
     XLOG(DBG4) << "Rx IPv6 Packet with hop limit exceeded";
-    sw_->portStats(port)->pktDropped();
-    sw_->portStats(port)->ipv6HopExceeded();
+    portStats->pktDropped();
+    portStats->ipv6HopExceeded();
     // Look up cpu mac from platform
     MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
-    sendICMPv6TimeExceeded(pkt->getSrcVlan(), cpuMac, cpuMac, ipv6, cursor);
+    sendICMPv6TimeExceeded(meta.vlan, cpuMac, cpuMac, ipv6, cursor);
     return;
   }
 
@@ -207,12 +246,11 @@ void IPv6Handler::handlePacket(
     // packets destined for us
     // Anything not handled by the controller, we will forward it to the host,
     // i.e. ping, ssh, bgp...
-    PortID portID = pkt->getSrcPort();
     if (ipv6.payloadLength > intf->getMtu()) {
       // Generate PTB as interface to dst intf has MTU smaller than payload
       sendICMPv6PacketTooBig(
-          portID, pkt->getSrcVlan(), src, dst, ipv6, intf->getMtu(), cursor);
-      sw_->portStats(portID)->pktDropped();
+          meta.port, meta.vlan, src, dst, ipv6, intf->getMtu(), cursor);
+      portStats->pktDropped();
       return;
     }
     if (ipv6.nextHeader == static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP)) {
@@ -224,9 +262,9 @@ void IPv6Handler::handlePacket(
     }
 
     if (sw_->sendPacketToHost(intf->getID(), std::move(pkt))) {
-      sw_->portStats(portID)->pktToHost(l3Len);
+      portStats->pktToHost(l3Len);
     } else {
-      sw_->portStats(portID)->pktDropped();
+      portStats->pktDropped();
     }
     return;
   }
@@ -543,6 +581,12 @@ void IPv6Handler::sendICMPv6TimeExceeded(
     MacAddress src,
     IPv6Hdr& v6Hdr,
     folly::io::Cursor cursor) {
+  if (!icmpErrorLimiter_.admit(
+          v6Hdr.srcAddr,
+          static_cast<uint8_t>(ICMPv6Type::ICMPV6_TYPE_TIME_EXCEEDED))) {
+    sw_->stats()->icmpErrorSuppressed();
+    return;
+  }
   auto state = sw_->getState();
 
   /*
@@ -565,21 +609,22 @@ void IPv6Handler::sendICMPv6TimeExceeded(
     sendCursor->push(cursor, remainingLength);
   };
 
-  IPAddressV6 srcIp = getSwitchVlanIPv6(state, srcVlan);
+  auto ipv6 = getICMPv6ErrorTemplate(state, srcVlan);
+  ipv6.dstAddr = v6Hdr.srcAddr;
   auto icmpPkt = createICMPv6Pkt(
       sw_,
       dst,
       src,
       srcVlan,
-      v6Hdr.srcAddr,
-      srcIp,
+      ipv6,
       ICMPv6Type::ICMPV6_TYPE_TIME_EXCEEDED,
       ICMPv6Code::ICMPV6_CODE_TIME_EXCEEDED_HOPLIMIT_EXCEEDED,
       icmpPayloadLength,
       serializeBody);
   XLOG(DBG4) << "sending ICMPv6 Time Exceeded with srcMac  " << src
              << " dstMac: " << dst << " vlan: " << srcVlan
-             << " dstIp: " << v6Hdr.srcAddr.str() << " srcIP: " << srcIp.str()
+             << " dstIp: " << v6Hdr.srcAddr.str()
+             << " srcIP: " << ipv6.srcAddr.str()
              << " bodyLength: " << icmpPayloadLength;
   sw_->sendPacketSwitchedAsync(std::move(icmpPkt));
 }
@@ -592,6 +637,12 @@ void IPv6Handler::sendICMPv6PacketTooBig(
     IPv6Hdr& v6Hdr,
     int expectedMtu,
     folly::io::Cursor cursor) {
+  if (!icmpErrorLimiter_.admit(
+          v6Hdr.srcAddr,
+          static_cast<uint8_t>(ICMPv6Type::ICMPV6_TYPE_PACKET_TOO_BIG))) {
+    sw_->stats()->icmpErrorSuppressed();
+    return;
+  }
   auto state = sw_->getState();
 
   // payload serialization function
@@ -611,14 +662,14 @@ void IPv6Handler::sendICMPv6PacketTooBig(
     sendCursor->push(cursor, remainingLength);
   };
 
-  IPAddressV6 srcIp = getSwitchVlanIPv6(state, srcVlan);
+  auto ipv6 = getICMPv6ErrorTemplate(state, srcVlan);
+  ipv6.dstAddr = v6Hdr.srcAddr;
   auto icmpPkt = createICMPv6Pkt(
       sw_,
       dst,
       src,
       srcVlan,
-      v6Hdr.srcAddr,
-      srcIp,
+      ipv6,
       ICMPv6Type::ICMPV6_TYPE_PACKET_TOO_BIG,
       ICMPv6Code::ICMPV6_CODE_PACKET_TOO_BIG,
       bodyLength,
@@ -626,12 +677,21 @@ void IPv6Handler::sendICMPv6PacketTooBig(
 
   XLOG(DBG4) << "sending ICMPv6 Packet Too Big with srcMac  " << src
              << " dstMac: " << dst << " vlan: " << srcVlan
-             << " dstIp: " << v6Hdr.srcAddr.str() << " srcIP: " << srcIp.str()
+             << " dstIp: " << v6Hdr.srcAddr.str()
+             << " srcIP: " << ipv6.srcAddr.str()
              << " bodyLength: " << bodyLength;
   sw_->sendPacketSwitchedAsync(std::move(icmpPkt));
   sw_->portStats(srcPort)->pktTooBig();
 }
 
+IPv6Hdr IPv6Handler::getICMPv6ErrorTemplate(
+    const std::shared_ptr<SwitchState>& state,
+    VlanID vlan) {
+  return icmpErrorTemplates_.get(state->getInterfaces(), vlan, [&]() {
+    return makeICMPv6Hdr(getSwitchVlanIPv6(state, vlan), IPAddressV6());
+  });
+}
+
 bool IPv6Handler::checkNdpPacket(const ICMPHeaders& hdr, const RxPacket* pkt)
     const {
   // Validation common for all NDP packets
@@ -9,9 +9,12 @@
  */
 #pragma once
 
+#include "fboss/agent/IcmpErrorRateLimiter.h"
+#include "fboss/agent/IcmpErrorTemplateCache.h"
 #include "fboss/agent/StateObserver.h"
 #include "fboss/agent/ndp/IPv6RouteAdvertiser.h"
 #include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
 #include "fboss/agent/packet/NDP.h"
 #include "fboss/agent/types.h"
 
@@ -27,8 +30,8 @@ class Cursor;
 
 namespace facebook::fboss {
 
-class IPv6Hdr;
 class Interface;
+struct ParsedPacketMeta;
 class RxPacket;
 class StateDelta;
 class SwitchState;
@@ -45,9 +48,7 @@ class IPv6Handler : public AutoRegisterStateObserver {
 
   void handlePacket(
       std::unique_ptr<RxPacket> pkt,
-      folly::MacAddress dst,
-      folly::MacAddress src,
-      folly::io::Cursor cursor);
+      const ParsedPacketMeta& meta);
 
   void floodNeighborAdvertisements();
   void sendNeighborSolicitation(
@@ -116,6 +117,11 @@ class IPv6Handler : public AutoRegisterStateObserver {
       IPv6Hdr& v6Hdr,
       int expectedMtu,
       folly::io::Cursor cursor);
+
+  // Header template for ICMPv6 errors sent out of vlan
+  IPv6Hdr getICMPv6ErrorTemplate(
+      const std::shared_ptr<SwitchState>& state,
+      VlanID vlan);
   /**
    * Function to handle ICMPv6
    *
@@ -183,6 +189,8 @@ class IPv6Handler : public AutoRegisterStateObserver {
 
   SwSwitch* sw_{nullptr};
   RAMap routeAdvertisers_;
+  IcmpErrorRateLimiter icmpErrorLimiter_;
+  IcmpErrorTemplateCache<IPv6Hdr> icmpErrorTemplates_;
 };
 
 } // namespace facebook::fboss
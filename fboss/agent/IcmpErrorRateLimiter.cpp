@@ -0,0 +1,47 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/IcmpErrorRateLimiter.h"
+
+#include <folly/hash/Hash.h>
+
+#include <algorithm>
+
+DEFINE_uint32(
+    icmp_error_rate_limit,
+    0,
+    "Maximum rate of ICMP errors (TTL exceeded, packet too big) sent to any "
+    "one destination, per ICMP type, in packets per second. 0 disables the "
+    "limit");
+DEFINE_uint32(
+    icmp_error_burst_size,
+    10,
+    "Number of ICMP errors that may be sent to one destination in a burst "
+    "when --icmp_error_rate_limit is set");
+
+namespace facebook::fboss {
+
+IcmpErrorRateLimiter::IcmpErrorRateLimiter(
+    uint32_t errorsPerSec,
+    uint32_t burstSize)
+    : errorsPerSec_(errorsPerSec),
+      // A bucket must hold at least one token for any error to be sent
+      burstSize_(std::max<uint32_t>(burstSize, 1)) {}
+
+bool IcmpErrorRateLimiter::admit(
+    const folly::IPAddress& dst,
+    uint8_t icmpType) {
+  if (errorsPerSec_ == 0) {
+    return true;
+  }
+  auto index = folly::hash::hash_combine(dst.hash(), icmpType) % kNumBuckets;
+  return buckets_[index].consume(1, errorsPerSec_, burstSize_);
+}
+
+} // namespace facebook::fboss
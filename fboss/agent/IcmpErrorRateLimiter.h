@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/IPAddress.h>
+#include <folly/TokenBucket.h>
+#include <gflags/gflags.h>
+
+#include <array>
+
+DECLARE_uint32(icmp_error_rate_limit);
+DECLARE_uint32(icmp_error_burst_size);
+
+namespace facebook::fboss {
+
+/*
+ * Limits the rate of ICMP errors (TTL exceeded, packet too big) sent to
+ * each destination, so that traceroute sweeps and routing loops do not have
+ * the agent spend its time generating errors. Each (destination, ICMP type)
+ * pair gets a token bucket.
+ *
+ * Pairs are hashed into a fixed number of buckets, which bounds memory
+ * however many sources send us expiring packets. Pairs that hash to the same
+ * bucket share its tokens. All methods are thread safe.
+ */
+class IcmpErrorRateLimiter {
+ public:
+  static constexpr size_t kNumBuckets = 1024;
+
+  // An errorsPerSec of 0 disables the limit
+  IcmpErrorRateLimiter(uint32_t errorsPerSec, uint32_t burstSize);
+
+  /*
+   * Whether an ICMP error of icmpType may be sent to dst now.
+   */
+  bool admit(const folly::IPAddress& dst, uint8_t icmpType);
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  IcmpErrorRateLimiter(IcmpErrorRateLimiter const&) = delete;
+  IcmpErrorRateLimiter& operator=(IcmpErrorRateLimiter const&) = delete;
+
+  const double errorsPerSec_;
+  const double burstSize_;
+  std::array<folly::DynamicTokenBucket, kNumBuckets> buckets_;
+};
+
+} // namespace facebook::fboss
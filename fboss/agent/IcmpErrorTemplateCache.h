@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <boost/container/flat_map.hpp>
+#include <folly/Synchronized.h>
+
+#include <memory>
+
+#include "fboss/agent/types.h"
+
+namespace facebook::fboss {
+
+class InterfaceMap;
+
+/*
+ * IP header templates for the ICMP errors sent out of each VLAN. Finding
+ * the switch IP of a VLAN walks the interface map, which adds up when a
+ * traceroute sweep or routing loop has us send an error per packet. With a
+ * template only the destination, lengths and checksums need patching.
+ *
+ * Templates are built from one InterfaceMap and dropped as soon as the
+ * caller passes a different one. All methods are thread safe.
+ */
+template <typename IPHdrT>
+class IcmpErrorTemplateCache {
+ public:
+  /*
+   * Template for errors sent out of vlan. On a miss buildTemplate() is
+   * called, and its result cached.
+   */
+  template <typename BuildFn>
+  IPHdrT get(
+      const std::shared_ptr<InterfaceMap>& interfaces,
+      VlanID vlan,
+      BuildFn buildTemplate) {
+    {
+      auto templates = templates_.rlock();
+      if (templates->interfaces == interfaces) {
+        auto it = templates->headers.find(vlan);
+        if (it != templates->headers.end()) {
+          return it->second;
+        }
+      }
+    }
+
+    IPHdrT ipHdr = buildTemplate();
+    auto templates = templates_.wlock();
+    if (templates->interfaces != interfaces) {
+      templates->interfaces = interfaces;
+      templates->headers.clear();
+    }
+    templates->headers.emplace(vlan, ipHdr);
+    return ipHdr;
+  }
+
+ private:
+  struct Templates {
+    std::shared_ptr<InterfaceMap> interfaces;
+    boost::container::flat_map<VlanID, IPHdrT> headers;
+  };
+
+  folly::Synchronized<Templates> templates_;
+};
+
+} // namespace facebook::fboss
@@ -16,6 +16,7 @@
 #include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
 #include <unistd.h>
+#include "fboss/agent/ParsedPacketMeta.h"
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
@@ -85,15 +86,14 @@ void LldpManager::stop() {
 
 void LldpManager::handlePacket(
     std::unique_ptr<RxPacket> pkt,
-    folly::MacAddress /*dst*/,
-    folly::MacAddress src,
-    folly::io::Cursor cursor) {
+    const ParsedPacketMeta& meta) {
   LinkNeighbor neighbor;
+  auto cursor = meta.l3Cursor(pkt.get());
 
   sw_->stats()->LldpRecvdPkt();
 
   bool ret = neighbor.parseLldpPdu(
-      pkt->getSrcPort(), pkt->getSrcVlan(), src, ETHERTYPE_LLDP, &cursor);
+      meta.port, meta.vlan, meta.srcMac, ETHERTYPE_LLDP, &cursor);
 
   if (!ret) {
     // LinkNeighbor will have already logged a message about the error.
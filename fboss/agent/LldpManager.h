@@ -26,6 +26,7 @@ class Cursor;
 
 namespace facebook::fboss {
 
+struct ParsedPacketMeta;
 class RxPacket;
 class TxPacket;
 
@@ -77,9 +78,7 @@ class LldpManager : private folly::AsyncTimeout {
 
   void handlePacket(
       std::unique_ptr<RxPacket> pkt,
-      folly::MacAddress dst,
-      folly::MacAddress src,
-      folly::io::Cursor cursor);
+      const ParsedPacketMeta& meta);
 
   // Create an LLDP packet
   static std::unique_ptr<TxPacket> createLldpPkt(
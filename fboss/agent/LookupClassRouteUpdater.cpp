@@ -15,6 +15,9 @@
 #include "fboss/agent/state/Port.h"
 #include "fboss/agent/state/SwitchState.h"
 
+#include <fb303/ThreadCachedServiceData.h>
+#include <folly/logging/xlog.h>
+
 /*
  * TODO(skhare)
  *
@@ -33,8 +36,15 @@ DEFINE_bool(
     true,
     "Enable route entry (ip-per-task/VIP) portion of Queue-per-host fix");
 
+using facebook::fb303::AVG;
+
 namespace facebook::fboss {
 
+namespace {
+const std::string kRoutesTouchedPerUpdate =
+    "lookup_class_route_updater.routes_touched";
+} // namespace
+
 // Helper methods
 
 void LookupClassRouteUpdater::reAddAllRoutes(const StateDelta& stateDelta) {
@@ -132,16 +142,13 @@ bool LookupClassRouteUpdater::belongsToSubnetInCache(
     VlanID vlanID,
     const folly::IPAddress& ipToSearch) {
   auto it = vlan2SubnetsCache_.find(vlanID);
-  if (it != vlan2SubnetsCache_.end()) {
-    auto subnetsCache = it->second;
-    for (const auto& [ipAddress, mask] : subnetsCache) {
-      if (ipToSearch.inSubnet(ipAddress, mask)) {
-        return true;
-      }
-    }
+  if (it == vlan2SubnetsCache_.end()) {
+    return false;
   }
 
-  return false;
+  const auto& subnetsCache = it->second;
+  return subnetsCache.longestMatch(ipToSearch, ipToSearch.bitCount()) !=
+      subnetsCache.end();
 }
 
 void LookupClassRouteUpdater::updateSubnetsCache(
@@ -162,7 +169,7 @@ void LookupClassRouteUpdater::updateSubnetsCache(
         newState->getInterfaces()->getInterfaceIf(vlan->getInterfaceID());
     if (interface) {
       for (auto address : interface->getAddresses()) {
-        subnetsCache.insert(address);
+        subnetsCache.insert(address.first, address.second, true);
 
         if (reAddAllRoutesEnabled) {
           /*
@@ -223,7 +230,7 @@ void LookupClassRouteUpdater::processPortRemovedForVlan(
   auto& subnetsCache = vlan2SubnetsCache_[vlanID];
   for (auto address : interface->getAddresses()) {
     removeNextHopsForSubnet(stateDelta, address, vlan);
-    subnetsCache.erase(address);
+    subnetsCache.erase(address.first, address.second);
   }
 }
 
@@ -816,8 +823,26 @@ void LookupClassRouteUpdater::updateClassIDForRouteHelper(
 
 void LookupClassRouteUpdater::updateClassIDsForRoutes(
     const std::vector<RouteAndClassID>& routesAndClassIDs) {
+  // Applied by flushClassIDUpdatesForRoutes once the update evb is done with
+  // the deltas already queued
+  for (const auto& [ridAndCidr, classID] : routesAndClassIDs) {
+    pendingRouteClassIDs_.insert_or_assign(ridAndCidr, classID);
+  }
+}
+
+void LookupClassRouteUpdater::flushClassIDUpdatesForRoutes() {
+  if (pendingRouteClassIDs_.empty()) {
+    return;
+  }
+
+  XLOG(DBG2) << "Updating classID for " << pendingRouteClassIDs_.size()
+             << " routes";
+  tcData().addStatValue(
+      kRoutesTouchedPerUpdate, pendingRouteClassIDs_.size(), AVG);
+
   auto updateClassIDsForRoutesFn =
-      [this, routesAndClassIDs](const std::shared_ptr<SwitchState>& state)
+      [this, routesAndClassIDs = std::move(pendingRouteClassIDs_)](
+          const std::shared_ptr<SwitchState>& state)
       -> std::shared_ptr<SwitchState> {
     auto newState{state};
 
@@ -840,6 +865,8 @@ void LookupClassRouteUpdater::updateClassIDsForRoutes(
     return newState;
   };
 
+  pendingRouteClassIDs_.clear();
+
   sw_->updateState(
       "Update classIDs for routes", std::move(updateClassIDsForRoutesFn));
 }
@@ -912,15 +939,23 @@ void LookupClassRouteUpdater::stateUpdated(const StateDelta& stateDelta) {
    * thus have non-empty vlan2SubnetsCache_ (populated by processPortUpdates).
    * Skip the processing on other setups.
    */
-  if (vlan2SubnetsCache_.empty()) {
-    return;
-  }
+  if (!vlan2SubnetsCache_.empty()) {
+    processNeighborUpdates<folly::IPAddressV6>(stateDelta);
+    processNeighborUpdates<folly::IPAddressV4>(stateDelta);
 
-  processNeighborUpdates<folly::IPAddressV6>(stateDelta);
-  processNeighborUpdates<folly::IPAddressV4>(stateDelta);
+    processRouteUpdates<folly::IPAddressV6>(stateDelta);
+    processRouteUpdates<folly::IPAddressV4>(stateDelta);
+  }
 
-  processRouteUpdates<folly::IPAddressV6>(stateDelta);
-  processRouteUpdates<folly::IPAddressV4>(stateDelta);
+  // One state update for all the classID changes caused by the deltas
+  // processed before the update evb gets to the flush
+  if (!pendingRouteClassIDs_.empty() && !classIDFlushScheduled_) {
+    classIDFlushScheduled_ = true;
+    sw_->getUpdateEvb()->runInEventBaseThread([this]() {
+      classIDFlushScheduled_ = false;
+      flushClassIDUpdatesForRoutes();
+    });
+  }
 }
 
 } // namespace facebook::fboss
@@ -11,6 +11,7 @@
 
 #include "fboss/agent/StateObserver.h"
 #include "fboss/agent/state/StateDelta.h"
+#include "fboss/lib/RadixTree.h"
 
 #include <folly/container/F14Map.h>
 #include <folly/container/F14Set.h>
@@ -154,6 +155,7 @@ class LookupClassRouteUpdater : public AutoRegisterStateObserver {
       std::optional<cfg::AclLookupClass> classID);
   void updateClassIDsForRoutes(
       const std::vector<RouteAndClassID>& routesAndClassIDs);
+  void flushClassIDUpdatesForRoutes();
 
   template <typename AddrT>
   void clearClassIDsForRoutes() const;
@@ -172,12 +174,14 @@ class LookupClassRouteUpdater : public AutoRegisterStateObserver {
    * Thus, we discover and maintain a list of subnets for ports that have
    * non-emptry lookupClasses list.
    *
-   * Today, the list of subnets we need to cache is very small. Thus,
-   * std::set is good enough. In future, if we need to cache a large
-   * number of subnets, we could use a Radix tree.
+   * Every neighbor and nexthop is checked against this cache, so subnets of
+   * a vlan are kept in a Radix tree and membership is a single longest
+   * prefix match rather than a scan of all the subnets. Tree values are
+   * unused.
    */
-  boost::container::flat_map<VlanID, folly::F14FastSet<folly::CIDRNetwork>>
-      vlan2SubnetsCache_;
+  boost::container::
+      flat_map<VlanID, network::RadixTree<folly::IPAddress, bool>>
+          vlan2SubnetsCache_;
 
   /*
    * Route inherits classID of one of its reachable next hops.
@@ -256,6 +260,18 @@ class LookupClassRouteUpdater : public AutoRegisterStateObserver {
    */
   std::set<RidAndCidr> allPrefixesWithClassID_;
 
+  /*
+   * A burst of neighbor changes would otherwise schedule one state update
+   * per neighbor. ClassID updates are accumulated here and flushed as a
+   * single state update from a function queued on the update evb, so the
+   * flush covers every delta processed before the evb gets to it. A later
+   * update for the same prefix overrides earlier ones, same as if the
+   * updates were applied in order. Only accessed from the update thread.
+   */
+  std::map<RidAndCidr, std::optional<cfg::AclLookupClass>>
+      pendingRouteClassIDs_;
+  bool classIDFlushScheduled_{false};
+
   SwSwitch* sw_;
 
   bool inited_{false};
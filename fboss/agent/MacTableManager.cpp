@@ -12,8 +12,23 @@
 #include "fboss/agent/L2Entry.h"
 #include "fboss/agent/MacTableUtils.h"
 #include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/state/SwitchState.h"
 
+#include <folly/io/async/EventBase.h>
+#include <gflags/gflags.h>
+
+DEFINE_bool(
+    l2_learning_batching,
+    false,
+    "Aggregate L2 learn and age events and apply them in batches instead of "
+    "one state update per event");
+DEFINE_int32(
+    l2_learning_batch_window_ms,
+    10,
+    "Time L2 learn and age events are aggregated for before being applied, "
+    "when l2_learning_batching is set");
+
 namespace facebook::fboss {
 
 MacTableManager::MacTableManager(SwSwitch* sw) : sw_(sw) {}
@@ -21,14 +36,86 @@ MacTableManager::MacTableManager(SwSwitch* sw) : sw_(sw) {}
 void MacTableManager::handleL2LearningUpdate(
     L2Entry l2Entry,
     L2EntryUpdateType l2EntryUpdateType) {
-  auto updateMacTableFn =
-      [l2Entry, l2EntryUpdateType](const std::shared_ptr<SwitchState>& state) {
-        return MacTableUtils::updateMacTable(state, l2Entry, l2EntryUpdateType);
-      };
-
-  sw_->updateState(
-      folly::to<std::string>("Programming : ", l2Entry.str()),
-      std::move(updateMacTableFn));
+  sw_->stats()->l2LearningEvent();
+  if (!FLAGS_l2_learning_batching) {
+    auto updateMacTableFn = [this, l2Entry, l2EntryUpdateType](
+                                const std::shared_ptr<SwitchState>& state) {
+      sw_->stats()->l2LearningUpdate(1);
+      return MacTableUtils::updateMacTable(state, l2Entry, l2EntryUpdateType);
+    };
+
+    sw_->updateState(
+        folly::to<std::string>("Programming : ", l2Entry.str()),
+        std::move(updateMacTableFn));
+    return;
+  }
+
+  bool schedule = false;
+  pendingEvents_.withWLock([&](auto& pending) {
+    auto& events = pending.events[{l2Entry.getVlanID(), l2Entry.getMac()}];
+    ++pending.numEvents;
+    // Only the last of consecutive events of the same type matters. Repeated
+    // learns on the same port are no-ops, and a MAC moving through several
+    // ports ends up on the last one. The only difference with applying every
+    // move is that a MAC moving back to its port in the same window keeps
+    // its classID.
+    if (!events.empty() && events.back().type == l2EntryUpdateType) {
+      events.back().entry = std::move(l2Entry);
+    } else {
+      events.push_back(L2Event{std::move(l2Entry), l2EntryUpdateType});
+    }
+    schedule = !pending.scheduled;
+    pending.scheduled = true;
+  });
+  if (schedule) {
+    scheduleUpdate();
+  }
+}
+
+void MacTableManager::scheduleUpdate() {
+  auto updateFn = [this](const std::shared_ptr<SwitchState>& state) {
+    return applyPendingEvents(state);
+  };
+  if (FLAGS_l2_learning_batch_window_ms <= 0) {
+    sw_->updateState("Programming L2 learning batch", std::move(updateFn));
+    return;
+  }
+  // The events are collected by the update function when it runs, so events
+  // received until then are part of the batch as well
+  auto evb = sw_->getUpdateEvb();
+  evb->runInEventBaseThread([this, evb, updateFn = std::move(updateFn)]() {
+    evb->runAfterDelay(
+        [this, updateFn]() {
+          sw_->updateState("Programming L2 learning batch", updateFn);
+        },
+        FLAGS_l2_learning_batch_window_ms);
+  });
+}
+
+std::shared_ptr<SwitchState> MacTableManager::applyPendingEvents(
+    const std::shared_ptr<SwitchState>& state) {
+  std::map<L2EventKey, std::vector<L2Event>> events;
+  size_t numEvents = 0;
+  pendingEvents_.withWLock([&](auto& pending) {
+    events.swap(pending.events);
+    numEvents = std::exchange(pending.numEvents, 0);
+    pending.scheduled = false;
+  });
+  if (events.empty()) {
+    return std::shared_ptr<SwitchState>();
+  }
+
+  // Only the first modification clones the state and the MacTables, later
+  // ones modify the unpublished copies in place
+  std::shared_ptr<SwitchState> newState{state};
+  for (const auto& macEvents : events) {
+    for (const auto& event : macEvents.second) {
+      newState =
+          MacTableUtils::updateMacTable(newState, event.entry, event.type);
+    }
+  }
+  sw_->stats()->l2LearningUpdate(numEvents);
+  return newState;
 }
 
 } // namespace facebook::fboss
@@ -11,6 +11,12 @@
 
 #include "fboss/agent/L2Entry.h"
 
+#include <folly/Synchronized.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
 namespace facebook::fboss {
 
 class SwSwitch;
@@ -19,6 +25,14 @@ class MacTableManager {
  public:
   explicit MacTableManager(SwSwitch* sw);
 
+  /*
+   * Apply a learn or age event from the HwSwitch to the MacTable.
+   * This function can be called from any thread.
+   *
+   * With FLAGS_l2_learning_batching, events are aggregated per (vlan, mac)
+   * and every event received within FLAGS_l2_learning_batch_window_ms is
+   * applied by a single state update.
+   */
   void handleL2LearningUpdate(
       L2Entry l2Entry,
       L2EntryUpdateType l2EntryUpdateType);
@@ -28,7 +42,26 @@ class MacTableManager {
   MacTableManager(MacTableManager const&) = delete;
   MacTableManager& operator=(MacTableManager const&) = delete;
 
+  struct L2Event {
+    L2Entry entry;
+    L2EntryUpdateType type;
+  };
+  using L2EventKey = std::pair<VlanID, folly::MacAddress>;
+
+  struct PendingEvents {
+    // Events of every (vlan, mac), in the order they were received
+    std::map<L2EventKey, std::vector<L2Event>> events;
+    size_t numEvents{0};
+    // Whether a state update is scheduled to apply events
+    bool scheduled{false};
+  };
+
+  void scheduleUpdate();
+  std::shared_ptr<SwitchState> applyPendingEvents(
+      const std::shared_ptr<SwitchState>& state);
+
   SwSwitch* sw_{nullptr};
+  folly::Synchronized<PendingEvents> pendingEvents_;
 };
 
 } // namespace facebook::fboss
@@ -2,6 +2,7 @@
 #include "fboss/agent/MirrorManager.h"
 
 #include <boost/container/flat_set.hpp>
+#include <folly/hash/Hash.h>
 #include <tuple>
 #include "fboss/agent/state/DeltaFunctions.h"
 #include "fboss/agent/state/Interface.h"
@@ -19,30 +20,142 @@ using std::optional;
 namespace facebook::fboss {
 
 void MirrorManager::stateUpdated(const StateDelta& delta) {
+  const auto& state = delta.newState();
+  if (state->getMirrors()->size() == 0) {
+    mirrorDependencies_.clear();
+    neighborToMirrors_.clear();
+    return;
+  }
   if (!hasMirrorChanges(delta)) {
     return;
   }
 
-  auto updateMirrorsFn = [this](const std::shared_ptr<SwitchState>& state) {
-    return resolveMirrors(state);
+  auto affected = affectedMirrors(delta);
+  bool mirrorsChanged = false;
+  for (const auto& name : affected) {
+    auto mirror = state->getMirrors()->getMirrorIf(name);
+    if (!mirror || !mirror->getDestinationIp()) {
+      /* SPAN mirror does not require resolving */
+      continue;
+    }
+    MirrorDependencies deps;
+    if (resolveMirror(state, mirror, &deps)) {
+      mirrorsChanged = true;
+    }
+    updateDependencies(name, std::move(deps));
+  }
+  if (!mirrorsChanged) {
+    return;
+  }
+
+  // Mirrors are resolved again against the state the update is applied on,
+  // which may be newer than the one they were just resolved against
+  auto updateMirrorsFn = [this, affected = std::move(affected)](
+                             const std::shared_ptr<SwitchState>& newState) {
+    return resolveMirrors(newState, affected);
   };
-  sw_->updateState("Updating mirrors", updateMirrorsFn);
+  sw_->updateState("Updating mirrors", std::move(updateMirrorsFn));
+}
+
+std::unordered_set<std::string> MirrorManager::affectedMirrors(
+    const StateDelta& delta) {
+  std::unordered_set<std::string> affected;
+  DeltaFunctions::forEachChanged(
+      delta.getMirrorsDelta(),
+      [&](const std::shared_ptr<Mirror>& /*oldMirror*/,
+          const std::shared_ptr<Mirror>& newMirror) {
+        affected.insert(newMirror->getID());
+      },
+      [&](const std::shared_ptr<Mirror>& addedMirror) {
+        affected.insert(addedMirror->getID());
+      },
+      [&](const std::shared_ptr<Mirror>& removedMirror) {
+        removeDependencies(removedMirror->getID());
+      });
+
+  auto neighborChanged = [&](const IPAddress& ip) {
+    auto itr = neighborToMirrors_.find(ip);
+    if (itr != neighborToMirrors_.end()) {
+      affected.insert(itr->second.begin(), itr->second.end());
+    }
+  };
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    for (const auto& arpDelta : vlanDelta.getArpDelta()) {
+      auto entry = arpDelta.getNew() ? arpDelta.getNew() : arpDelta.getOld();
+      neighborChanged(IPAddress(entry->getIP()));
+    }
+    for (const auto& ndpDelta : vlanDelta.getNdpDelta()) {
+      auto entry = ndpDelta.getNew() ? ndpDelta.getNew() : ndpDelta.getOld();
+      neighborChanged(IPAddress(entry->getIP()));
+    }
+  }
+
+  std::unordered_set<folly::CIDRNetwork, folly::hasher<folly::CIDRNetwork>>
+      changedPrefixes;
+  auto routeChanged = [&](const auto& routeDelta) {
+    const auto& route =
+        routeDelta.getNew() ? routeDelta.getNew() : routeDelta.getOld();
+    changedPrefixes.emplace(
+        IPAddress(route->prefix().network), route->prefix().mask);
+  };
+  for (const auto& rtDelta : delta.getRouteTablesDelta()) {
+    for (const auto& routeDelta : rtDelta.getRoutesV4Delta()) {
+      routeChanged(routeDelta);
+    }
+    for (const auto& routeDelta : rtDelta.getRoutesV6Delta()) {
+      routeChanged(routeDelta);
+    }
+  }
+
+  for (const auto& mirror : *delta.newState()->getMirrors()) {
+    if (!mirror->getDestinationIp() || affected.count(mirror->getID())) {
+      continue;
+    }
+    auto deps = mirrorDependencies_.find(mirror->getID());
+    if (deps == mirrorDependencies_.end()) {
+      affected.insert(mirror->getID());
+      continue;
+    }
+    if (changedPrefixes.empty()) {
+      continue;
+    }
+    // A changed route matters if it is the resolving route, or a more
+    // specific route covering the destination
+    const auto& destinationIp = mirror->getDestinationIp().value();
+    int minMask = deps->second.route ? deps->second.route->second : 0;
+    for (int mask = destinationIp.bitCount(); mask >= minMask; --mask) {
+      if (changedPrefixes.count(
+              folly::CIDRNetwork(destinationIp.mask(mask), mask))) {
+        affected.insert(mirror->getID());
+        break;
+      }
+    }
+  }
+  return affected;
+}
+
+std::shared_ptr<Mirror> MirrorManager::resolveMirror(
+    const std::shared_ptr<SwitchState>& state,
+    const std::shared_ptr<Mirror>& mirror,
+    MirrorDependencies* deps) {
+  ++numMirrorsResolved_;
+  return mirror->getDestinationIp()->isV4()
+      ? v4Manager_->updateMirror(mirror, state, deps)
+      : v6Manager_->updateMirror(mirror, state, deps);
 }
 
 std::shared_ptr<SwitchState> MirrorManager::resolveMirrors(
-    const std::shared_ptr<SwitchState>& state) {
+    const std::shared_ptr<SwitchState>& state,
+    const std::unordered_set<std::string>& mirrorNames) {
   auto mirrors = state->getMirrors()->clone();
   bool mirrorsUpdated = false;
 
-  for (const auto& mirror : *state->getMirrors()) {
-    if (!mirror->getDestinationIp()) {
-      /* SPAN mirror does not require resolving */
+  for (const auto& name : mirrorNames) {
+    auto mirror = state->getMirrors()->getMirrorIf(name);
+    if (!mirror || !mirror->getDestinationIp()) {
       continue;
     }
-    const auto destinationIp = mirror->getDestinationIp().value();
-    std::shared_ptr<Mirror> updatedMirror = destinationIp.isV4()
-        ? v4Manager_->updateMirror(mirror)
-        : v6Manager_->updateMirror(mirror);
+    std::shared_ptr<Mirror> updatedMirror = resolveMirror(state, mirror);
     if (updatedMirror) {
       XLOG(INFO) << "Mirror: " << updatedMirror->getID() << " updated.";
       mirrors->updateNode(updatedMirror);
@@ -57,6 +170,34 @@ std::shared_ptr<SwitchState> MirrorManager::resolveMirrors(
   return updatedState;
 }
 
+void MirrorManager::updateDependencies(
+    const std::string& mirror,
+    MirrorDependencies deps) {
+  removeDependencies(mirror);
+  for (const auto& neighbor : deps.neighbors) {
+    neighborToMirrors_[neighbor].insert(mirror);
+  }
+  mirrorDependencies_.emplace(mirror, std::move(deps));
+}
+
+void MirrorManager::removeDependencies(const std::string& mirror) {
+  auto itr = mirrorDependencies_.find(mirror);
+  if (itr == mirrorDependencies_.end()) {
+    return;
+  }
+  for (const auto& neighbor : itr->second.neighbors) {
+    auto nitr = neighborToMirrors_.find(neighbor);
+    if (nitr == neighborToMirrors_.end()) {
+      continue;
+    }
+    nitr->second.erase(mirror);
+    if (nitr->second.empty()) {
+      neighborToMirrors_.erase(nitr);
+    }
+  }
+  mirrorDependencies_.erase(itr);
+}
+
 bool MirrorManager::hasMirrorChanges(const StateDelta& delta) {
   return (sw_->getState()->getMirrors()->size() > 0) &&
       (!isEmpty(delta.getMirrorsDelta()) ||
@@ -7,6 +7,12 @@
 #include "fboss/agent/state/RouteNextHop.h"
 #include "fboss/agent/state/StateDelta.h"
 
+#include <folly/IPAddress.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace facebook::fboss {
 
 class MirrorManager : public AutoRegisterStateObserver {
@@ -20,6 +26,14 @@ class MirrorManager : public AutoRegisterStateObserver {
 
   void stateUpdated(const StateDelta& delta) override;
 
+  /*
+   * Number of mirror resolutions done so far, to measure update work.
+   * Must be called from the update thread.
+   */
+  uint64_t getNumMirrorsResolved() const {
+    return numMirrorsResolved_;
+  }
+
  private:
   SwSwitch* sw_;
   std::unique_ptr<MirrorManagerV4> v4Manager_;
@@ -27,8 +41,32 @@ class MirrorManager : public AutoRegisterStateObserver {
 
   bool hasMirrorChanges(const StateDelta& delta);
 
+  /*
+   * Mirrors whose configuration, resolving route or nexthop neighbors
+   * changed in delta, and so need to be re-resolved.
+   */
+  std::unordered_set<std::string> affectedMirrors(const StateDelta& delta);
+
+  std::shared_ptr<Mirror> resolveMirror(
+      const std::shared_ptr<SwitchState>& state,
+      const std::shared_ptr<Mirror>& mirror,
+      MirrorDependencies* deps = nullptr);
+
   std::shared_ptr<SwitchState> resolveMirrors(
-      const std::shared_ptr<SwitchState>& state);
+      const std::shared_ptr<SwitchState>& state,
+      const std::unordered_set<std::string>& mirrorNames);
+
+  void updateDependencies(const std::string& mirror, MirrorDependencies deps);
+  void removeDependencies(const std::string& mirror);
+
+  /*
+   * Index of what each mirror resolution depended on, as of the last state
+   * seen by stateUpdated. Only accessed from the update thread.
+   */
+  std::unordered_map<std::string, MirrorDependencies> mirrorDependencies_;
+  std::unordered_map<folly::IPAddress, std::unordered_set<std::string>>
+      neighborToMirrors_;
+  uint64_t numMirrorsResolved_{0};
 };
 
 } // namespace facebook::fboss
@@ -22,11 +22,12 @@ namespace facebook::fboss {
 
 template <typename AddrT>
 std::shared_ptr<Mirror> MirrorManagerImpl<AddrT>::updateMirror(
-    const std::shared_ptr<Mirror>& mirror) {
+    const std::shared_ptr<Mirror>& mirror,
+    const std::shared_ptr<SwitchState>& state,
+    MirrorDependencies* deps) {
   const AddrT destinationIp =
       getIPAddress<AddrT>(mirror->getDestinationIp().value());
-  const auto state = sw_->getState();
-  const auto nexthops = resolveMirrorNextHops(state, destinationIp);
+  const auto nexthops = resolveMirrorNextHops(state, destinationIp, deps);
 
   auto newMirror = std::make_shared<Mirror>(
       mirror->getID(),
@@ -38,8 +39,8 @@ std::shared_ptr<Mirror> MirrorManagerImpl<AddrT>::updateMirror(
       mirror->getTruncate());
 
   for (const auto& nexthop : nexthops) {
-    const auto entry =
-        resolveMirrorNextHopNeighbor(state, mirror, destinationIp, nexthop);
+    const auto entry = resolveMirrorNextHopNeighbor(
+        state, mirror, destinationIp, nexthop, deps);
 
     if (!entry) {
       continue;
@@ -69,9 +70,14 @@ std::shared_ptr<Mirror> MirrorManagerImpl<AddrT>::updateMirror(
 template <typename AddrT>
 RouteNextHopEntry::NextHopSet MirrorManagerImpl<AddrT>::resolveMirrorNextHops(
     const std::shared_ptr<SwitchState>& state,
-    const AddrT& destinationIp) {
+    const AddrT& destinationIp,
+    MirrorDependencies* deps) {
   const auto route =
       sw_->longestMatch<AddrT>(state, destinationIp, RouterID(0));
+  if (route && deps) {
+    deps->route = folly::CIDRNetwork(
+        folly::IPAddress(route->prefix().network), route->prefix().mask);
+  }
   if (!route || !route->isResolved()) {
     return RouteNextHopEntry::NextHopSet();
   }
@@ -84,7 +90,8 @@ MirrorManagerImpl<AddrT>::resolveMirrorNextHopNeighbor(
     const std::shared_ptr<SwitchState>& state,
     const std::shared_ptr<Mirror>& mirror,
     const AddrT& destinationIp,
-    const NextHop& nexthop) const {
+    const NextHop& nexthop,
+    MirrorDependencies* deps) const {
   std::shared_ptr<NeighborEntryT> neighbor;
   if (!nexthop.isResolved()) {
     return std::shared_ptr<NeighborEntryT>(nullptr);
@@ -96,14 +103,14 @@ MirrorManagerImpl<AddrT>::resolveMirrorNextHopNeighbor(
       state->getInterfaces()->getInterfaceIf(mirrorEgressInterface);
   auto vlan = state->getVlans()->getVlanIf(interface->getVlanID());
 
-  if (interface->hasAddress(mirrorNextHopIp)) {
-    /* if mirror destination is directly connected */
-    neighbor = vlan->template getNeighborEntryTable<AddrT>()->getEntryIf(
-        destinationIp);
-  } else {
-    neighbor = vlan->template getNeighborEntryTable<AddrT>()->getEntryIf(
-        mirrorNextHopIp);
+  /* if mirror destination is directly connected */
+  auto neighborIp =
+      interface->hasAddress(mirrorNextHopIp) ? destinationIp : mirrorNextHopIp;
+  if (deps) {
+    deps->neighbors.emplace_back(neighborIp);
   }
+  neighbor =
+      vlan->template getNeighborEntryTable<AddrT>()->getEntryIf(neighborIp);
 
   if (!neighbor || neighbor->zeroPort() ||
       !neighbor->getPort().isPhysicalPort() ||
@@ -2,9 +2,13 @@
 
 #pragma once
 
+#include <folly/IPAddress.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 
+#include <optional>
+#include <vector>
+
 #include "fboss/agent/state/ArpEntry.h"
 #include "fboss/agent/state/Mirror.h"
 #include "fboss/agent/state/NdpEntry.h"
@@ -16,6 +20,16 @@ class Mirror;
 class MirrorTunnel;
 class SwSwitch;
 
+/*
+ * What resolving a mirror looked at: the route its destination resolved
+ * through, if any, and the neighbors looked up for that route's nexthops.
+ * The mirror needs re-resolving only when one of these changes.
+ */
+struct MirrorDependencies {
+  std::optional<folly::CIDRNetwork> route;
+  std::vector<folly::IPAddress> neighbors;
+};
+
 template <typename AddrT>
 class MirrorManagerImpl {
  public:
@@ -28,18 +42,28 @@ class MirrorManagerImpl {
   explicit MirrorManagerImpl(SwSwitch* sw) : sw_(sw) {}
   ~MirrorManagerImpl() {}
 
-  std::shared_ptr<Mirror> updateMirror(const std::shared_ptr<Mirror>& mirror);
+  /*
+   * Resolve mirror against state, returns nullptr if the resolved mirror is
+   * the same as the given one. If deps is set, it is filled with what the
+   * resolution depended on.
+   */
+  std::shared_ptr<Mirror> updateMirror(
+      const std::shared_ptr<Mirror>& mirror,
+      const std::shared_ptr<SwitchState>& state,
+      MirrorDependencies* deps = nullptr);
 
  private:
   NextHopSet resolveMirrorNextHops(
       const std::shared_ptr<SwitchState>& state,
-      const AddrT& destinationIp);
+      const AddrT& destinationIp,
+      MirrorDependencies* deps);
 
   std::shared_ptr<NeighborEntryT> resolveMirrorNextHopNeighbor(
       const std::shared_ptr<SwitchState>& state,
       const std::shared_ptr<Mirror>& mirror,
       const AddrT& destinationIp,
-      const NextHop& nexthop) const;
+      const NextHop& nexthop,
+      MirrorDependencies* deps) const;
 
   MirrorTunnel resolveMirrorTunnel(
       const std::shared_ptr<SwitchState>& state,
@@ -68,6 +68,11 @@ class NeighborCache {
     impl_->portDown(port);
   }
 
+  void flushBatch() {
+    std::lock_guard<std::mutex> g(cacheLock_);
+    impl_->flushBatch();
+  }
+
   template <typename NeighborEntryThrift>
   std::list<NeighborEntryThrift> getCacheData() {
     std::lock_guard<std::mutex> g(cacheLock_);
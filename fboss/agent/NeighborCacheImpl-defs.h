@@ -15,9 +15,11 @@
 #include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
 #include <list>
+#include <utility>
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/IPv6Handler.h"
 #include "fboss/agent/NeighborCacheImpl.h"
+#include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/state/ArpTable.h"
 #include "fboss/agent/state/NdpTable.h"
 #include "fboss/agent/state/NeighborEntry.h"
@@ -58,6 +60,105 @@ bool checkVlanAndIntf(
   return true;
 }
 
+/*
+ * Add a resolved entry to the SwitchState, or update the existing entry.
+ * Returns whether the state was modified.
+ */
+template <typename NTable>
+bool programEntry(
+    std::shared_ptr<SwitchState>* state,
+    const typename NeighborCacheEntry<NTable>::EntryFields& fields,
+    VlanID vlanID) {
+  if (!checkVlanAndIntf<NTable>(*state, fields, vlanID)) {
+    // Either the vlan or intf is no longer valid.
+    return false;
+  }
+
+  auto vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  auto node = table->getNodeIf(fields.ip);
+
+  if (!node) {
+    table = table->modify(&vlan, state);
+    table->addEntry(fields);
+    XLOG(DBG2) << "Adding entry for " << fields.ip << " --> " << fields.mac
+               << " on interface " << fields.interfaceID << " for vlan "
+               << vlanID;
+  } else {
+    if (node->getMac() == fields.mac && node->getPort() == fields.port &&
+        node->getIntfID() == fields.interfaceID &&
+        node->getState() == fields.state && !node->isPending()) {
+      // This entry was already updated while we were waiting on the lock.
+      return false;
+    }
+    table = table->modify(&vlan, state);
+    table->updateEntry(fields);
+    XLOG(DBG2) << "Converting pending entry for " << fields.ip << " --> "
+               << fields.mac << " on interface " << fields.interfaceID
+               << " for vlan " << vlanID;
+  }
+  return true;
+}
+
+/*
+ * Add a pending entry to the SwitchState. An existing entry is only replaced
+ * if force is set. Returns whether the state was modified.
+ */
+template <typename NTable>
+bool programPendingEntry(
+    std::shared_ptr<SwitchState>* state,
+    const typename NeighborCacheEntry<NTable>::EntryFields& fields,
+    VlanID vlanID,
+    bool force) {
+  if (!checkVlanAndIntf<NTable>(*state, fields, vlanID)) {
+    // Either the vlan or intf is no longer valid.
+    return false;
+  }
+
+  auto vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  auto node = table->getNodeIf(fields.ip);
+  if (node && !force) {
+    // don't replace an existing entry with a pending one unless
+    // explicitly allowed
+    return false;
+  }
+
+  table = table->modify(&vlan, state);
+  if (node) {
+    table->removeEntry(fields.ip);
+  }
+  table->addPendingEntry(fields.ip, fields.interfaceID);
+
+  XLOG(DBG4) << "Adding pending entry for " << fields.ip << " on interface "
+             << fields.interfaceID << " for vlan " << vlanID;
+  return true;
+}
+
+/*
+ * Remove an entry from the SwitchState. Returns whether the state was
+ * modified.
+ */
+template <typename NTable>
+bool removeEntry(
+    std::shared_ptr<SwitchState>* state,
+    typename NTable::Entry::AddressType ip,
+    VlanID vlanID) {
+  auto* vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  if (!vlan) {
+    return false;
+  }
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  const auto& entry = table->getNodeIf(ip);
+  if (!entry) {
+    return false;
+  }
+
+  table = table->modify(&vlan, state);
+  table->removeNode(ip);
+  return true;
+}
+
 } // namespace ncachehelpers
 
 template <typename NTable>
@@ -65,37 +166,17 @@ void NeighborCacheImpl<NTable>::programEntry(Entry* entry) {
   CHECK(!entry->isPending());
 
   auto fields = entry->getFields();
+  if (batchingEnabled()) {
+    queueBatchEntry(BatchOp::RESOLVED, fields, false);
+    return;
+  }
+
   auto vlanID = vlanID_;
   auto updateFn = [fields, vlanID](const std::shared_ptr<SwitchState>& state)
       -> std::shared_ptr<SwitchState> {
-    if (!ncachehelpers::checkVlanAndIntf<NTable>(state, fields, vlanID)) {
-      // Either the vlan or intf is no longer valid.
-      return nullptr;
-    }
-
-    auto vlan = state->getVlans()->getVlanIf(vlanID).get();
     std::shared_ptr<SwitchState> newState{state};
-    auto* table = vlan->template getNeighborTable<NTable>().get();
-    auto node = table->getNodeIf(fields.ip);
-
-    if (!node) {
-      table = table->modify(&vlan, &newState);
-      table->addEntry(fields);
-      XLOG(DBG2) << "Adding entry for " << fields.ip << " --> " << fields.mac
-                 << " on interface " << fields.interfaceID << " for vlan "
-                 << vlanID;
-    } else {
-      if (node->getMac() == fields.mac && node->getPort() == fields.port &&
-          node->getIntfID() == fields.interfaceID &&
-          node->getState() == fields.state && !node->isPending()) {
-        // This entry was already updated while we were waiting on the lock.
-        return nullptr;
-      }
-      table = table->modify(&vlan, &newState);
-      table->updateEntry(fields);
-      XLOG(DBG2) << "Converting pending entry for " << fields.ip << " --> "
-                 << fields.mac << " on interface " << fields.interfaceID
-                 << " for vlan " << vlanID;
+    if (!ncachehelpers::programEntry<NTable>(&newState, fields, vlanID)) {
+      return nullptr;
     }
     return newState;
   };
@@ -109,33 +190,20 @@ void NeighborCacheImpl<NTable>::programPendingEntry(Entry* entry, bool force) {
   CHECK(entry->isPending());
 
   auto fields = entry->getFields();
+  if (batchingEnabled()) {
+    queueBatchEntry(BatchOp::PENDING, fields, force);
+    return;
+  }
+
   auto vlanID = vlanID_;
   auto updateFn =
       [fields, vlanID, force](const std::shared_ptr<SwitchState>& state)
       -> std::shared_ptr<SwitchState> {
-    if (!ncachehelpers::checkVlanAndIntf<NTable>(state, fields, vlanID)) {
-      // Either the vlan or intf is no longer valid.
-      return nullptr;
-    }
-
-    auto vlan = state->getVlans()->getVlanIf(vlanID).get();
     std::shared_ptr<SwitchState> newState{state};
-    auto* table = vlan->template getNeighborTable<NTable>().get();
-    auto node = table->getNodeIf(fields.ip);
-    table = table->modify(&vlan, &newState);
-
-    if (node) {
-      if (!force) {
-        // don't replace an existing entry with a pending one unless
-        // explicitly allowed
-        return nullptr;
-      }
-      table->removeEntry(fields.ip);
+    if (!ncachehelpers::programPendingEntry<NTable>(
+            &newState, fields, vlanID, force)) {
+      return nullptr;
     }
-    table->addPendingEntry(fields.ip, fields.interfaceID);
-
-    XLOG(DBG4) << "Adding pending entry for " << fields.ip << " on interface "
-               << fields.interfaceID << " for vlan " << vlanID;
     return newState;
   };
 
@@ -144,6 +212,89 @@ void NeighborCacheImpl<NTable>::programPendingEntry(Entry* entry, bool force) {
       std::move(updateFn));
 }
 
+template <typename NTable>
+void NeighborCacheImpl<NTable>::queueBatchEntry(
+    BatchOp op,
+    const EntryFields& fields,
+    bool force) {
+  // A pending entry must be seen by the HwSwitch even if the neighbor
+  // resolves right after, so it cannot be folded with a later update of the
+  // same address. Such an update goes to the next batch instead.
+  if (op != BatchOp::PENDING && batchPendingIps_.count(fields.ip)) {
+    flushBatch();
+  }
+
+  batch_.push_back(BatchEntry{op, fields, force});
+  if (op == BatchOp::PENDING) {
+    batchPendingIps_.insert(fields.ip);
+  }
+
+  if (batch_.size() >= static_cast<size_t>(FLAGS_neighbor_batch_max_entries)) {
+    flushBatch();
+    return;
+  }
+  if (!batchTimeout_) {
+    // The timeout goes through the cache to take the cache lock
+    batchTimeout_ = folly::AsyncTimeout::make(
+        *evb_, [cache = cache_]() noexcept { cache->flushBatch(); });
+  }
+  if (!batchTimeout_->isScheduled()) {
+    batchTimeout_->scheduleTimeout(FLAGS_neighbor_batch_window_ms);
+  }
+}
+
+template <typename NTable>
+void NeighborCacheImpl<NTable>::flushBatch() {
+  if (batchTimeout_) {
+    batchTimeout_->cancelTimeout();
+  }
+  if (batch_.empty()) {
+    return;
+  }
+
+  auto batch = std::make_shared<const std::vector<BatchEntry>>(
+      std::exchange(batch_, {}));
+  bool hasPending = !batchPendingIps_.empty();
+  batchPendingIps_.clear();
+  if constexpr (std::is_same_v<NTable, ArpTable>) {
+    sw_->stats()->arpBatchSize(batch->size());
+  } else {
+    sw_->stats()->ndpBatchSize(batch->size());
+  }
+
+  auto vlanID = vlanID_;
+  auto updateFn = [batch, vlanID](const std::shared_ptr<SwitchState>& state)
+      -> std::shared_ptr<SwitchState> {
+    std::shared_ptr<SwitchState> newState{state};
+    bool changed = false;
+    for (const auto& entry : *batch) {
+      switch (entry.op) {
+        case BatchOp::PENDING:
+          changed |= ncachehelpers::programPendingEntry<NTable>(
+              &newState, entry.fields, vlanID, entry.force);
+          break;
+        case BatchOp::RESOLVED:
+          changed |= ncachehelpers::programEntry<NTable>(
+              &newState, entry.fields, vlanID);
+          break;
+        case BatchOp::REMOVED:
+          changed |= ncachehelpers::removeEntry<NTable>(
+              &newState, entry.fields.ip, vlanID);
+          break;
+      }
+    }
+    return changed ? newState : nullptr;
+  };
+
+  if (hasPending) {
+    // Pending entries must reach the HwSwitch, as in the unbatched case
+    sw_->updateStateNoCoalescing(
+        "program pending neighbor batch", std::move(updateFn));
+  } else {
+    sw_->updateState("program neighbor batch", std::move(updateFn));
+  }
+}
+
 template <typename NTable>
 NeighborCacheImpl<NTable>::~NeighborCacheImpl() {}
 
@@ -202,6 +353,9 @@ void NeighborCacheImpl<NTable>::updateEntryClassID(
   if (entry) {
     entry->updateClassID(classID);
 
+    // The entry may still be queued for programming
+    flushBatch();
+
     auto updateClassIDFn =
         [this, ip, classID](const std::shared_ptr<SwitchState>& state) {
           auto vlan = state->getVlans()->getVlanIf(vlanID_).get();
@@ -315,16 +469,7 @@ template <typename NTable>
 bool NeighborCacheImpl<NTable>::flushEntryFromSwitchState(
     std::shared_ptr<SwitchState>* state,
     AddressType ip) {
-  auto* vlan = (*state)->getVlans()->getVlan(vlanID_).get();
-  auto* table = vlan->template getNeighborTable<NTable>().get();
-  const auto& entry = table->getNodeIf(ip);
-  if (!entry) {
-    return false;
-  }
-
-  table = table->modify(&vlan, state);
-  table->removeNode(ip);
-  return true;
+  return ncachehelpers::removeEntry<NTable>(state, ip, vlanID_);
 }
 
 template <typename NTable>
@@ -344,6 +489,17 @@ void NeighborCacheImpl<NTable>::flushEntry(AddressType ip, bool* flushed) {
     return;
   }
 
+  if (!flushed && batchingEnabled()) {
+    // Only the address of the fields is used to remove the entry
+    queueBatchEntry(
+        BatchOp::REMOVED,
+        EntryFields(ip, intfID_, NeighborState::PENDING),
+        false);
+    return;
+  }
+  // Entries queued before this one must be applied first
+  flushBatch();
+
   // flush from SwitchState
   auto updateFn = [this, ip, flushed](const std::shared_ptr<SwitchState>& state)
       -> std::shared_ptr<SwitchState> {
@@ -18,9 +18,16 @@
 
 #include <folly/IPAddress.h>
 #include <folly/Random.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <gflags/gflags.h>
 #include <list>
 #include <optional>
 #include <string>
+#include <unordered_set>
+#include <vector>
+
+DECLARE_int32(neighbor_batch_window_ms);
+DECLARE_int32(neighbor_batch_max_entries);
 
 namespace facebook::fboss {
 
@@ -66,6 +73,12 @@ class NeighborCacheImpl {
         intfID_(intfID),
         evb_(sw->getNeighborCacheEvb()) {}
 
+  /*
+   * Apply the queued neighbor updates now. Only does anything if batching
+   * is enabled with FLAGS_neighbor_batch_window_ms.
+   */
+  void flushBatch();
+
   // Methods useful for subclasses
   void setPendingEntry(AddressType ip, bool force = false);
 
@@ -131,6 +144,26 @@ class NeighborCacheImpl {
 
   void processEntry(AddressType ip);
 
+  /*
+   * With FLAGS_neighbor_batch_window_ms set, pending, resolved and removed
+   * entries are queued and applied to the SwitchState together, once the
+   * window expires or FLAGS_neighbor_batch_max_entries are queued.
+   */
+  enum class BatchOp {
+    PENDING,
+    RESOLVED,
+    REMOVED,
+  };
+  struct BatchEntry {
+    BatchOp op;
+    EntryFields fields;
+    bool force;
+  };
+  bool batchingEnabled() const {
+    return FLAGS_neighbor_batch_window_ms > 0;
+  }
+  void queueBatchEntry(BatchOp op, const EntryFields& fields, bool force);
+
   // Pass in a non-null flushed if you care whether an entry
   // was actually flushed from the switch state
   void flushEntry(AddressType ip, bool* flushed = nullptr);
@@ -161,6 +194,13 @@ class NeighborCacheImpl {
 
   // Map of all entries
   std::unordered_map<AddressType, std::shared_ptr<Entry>> entries_;
+
+  // Neighbor updates not applied yet, in the order they were made
+  std::vector<BatchEntry> batch_;
+  // Addresses with a pending entry in batch_
+  std::unordered_set<AddressType> batchPendingIps_;
+  // Flushes batch_ once the batching window expires
+  std::unique_ptr<folly::AsyncTimeout> batchTimeout_;
 };
 
 } // namespace facebook::fboss
@@ -38,6 +38,18 @@ using folly::IPAddressV6;
 using folly::MacAddress;
 using std::shared_ptr;
 
+DEFINE_int32(
+    neighbor_batch_window_ms,
+    0,
+    "Time neighbor caches collect pending, resolved and removed entries "
+    "for before applying them as a single state update. 0 applies every "
+    "entry with its own state update");
+DEFINE_int32(
+    neighbor_batch_max_entries,
+    1024,
+    "Apply the entries collected by a neighbor cache right away once this "
+    "many are queued");
+
 namespace facebook::fboss {
 
 using facebook::fboss::DeltaFunctions::forEachChanged;
@@ -56,7 +68,9 @@ NeighborUpdater::~NeighborUpdater() {
 }
 
 void NeighborUpdater::waitForPendingUpdates() {
-  folly::via(sw_->getNeighborCacheEvb(), [impl = this->impl_]() {}).get();
+  folly::via(sw_->getNeighborCacheEvb(), [impl = this->impl_]() {
+    impl->flushBatches();
+  }).get();
 }
 
 auto NeighborUpdater::createCaches(const SwitchState* state, const Vlan* vlan)
@@ -53,6 +53,10 @@ class NeighborUpdater : public AutoRegisterStateObserver {
   explicit NeighborUpdater(SwSwitch* sw);
   ~NeighborUpdater() override;
 
+  /*
+   * Wait for the neighbor updates scheduled so far to be processed, and
+   * for the entries queued by batching to be handed to SwSwitch.
+   */
   void waitForPendingUpdates();
 
   void stateUpdated(const StateDelta& delta) override;
@@ -149,6 +149,13 @@ void NeighborUpdaterImpl::portDown(PortDescriptor port) {
   }
 }
 
+void NeighborUpdaterImpl::flushBatches() {
+  for (auto vlanCaches : caches_) {
+    vlanCaches.second->arpCache->flushBatch();
+    vlanCaches.second->ndpCache->flushBatch();
+  }
+}
+
 bool NeighborUpdaterImpl::flushEntryImpl(VlanID vlan, IPAddress ip) {
   if (ip.isV4()) {
     auto cache = getArpCacheInternal(vlan);
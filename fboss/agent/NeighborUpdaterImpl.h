@@ -89,6 +89,9 @@ class NeighborUpdaterImpl {
 
   bool flushEntryImpl(VlanID vlan, folly::IPAddress ip);
 
+  // Apply the neighbor updates queued by every cache
+  void flushBatches();
+
   // Forbidden copy constructor and assignment operator
   NeighborUpdaterImpl(NeighborUpdaterImpl const&) = delete;
   NeighborUpdaterImpl& operator=(NeighborUpdaterImpl const&) = delete;
@@ -0,0 +1,217 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/NetlinkBatch.h"
+
+extern "C" {
+#include <netlink/netlink.h>
+}
+
+#include <folly/ExceptionString.h>
+#include <folly/ScopeGuard.h>
+#include <folly/logging/xlog.h>
+#include "fboss/agent/NlError.h"
+
+#include <chrono>
+#include <unordered_map>
+#include <utility>
+
+namespace facebook::fboss {
+
+NetlinkBatch::NetlinkBatch(nl_sock* sock, size_t maxChunkBytes)
+    : sock_(sock), maxChunkBytes_(maxChunkBytes) {
+  CHECK(sock_) << "NULL netlink socket";
+}
+
+NetlinkBatch::~NetlinkBatch() {
+  clear();
+}
+
+void NetlinkBatch::add(nl_msg* msg, std::string description, bool ignoreError) {
+  CHECK(msg) << "NULL netlink message for " << description;
+  Request request;
+  request.msg = msg;
+  request.description = std::move(description);
+  request.ignoreError = ignoreError;
+  requests_.push_back(std::move(request));
+}
+
+void NetlinkBatch::setUndo(nl_msg* undo, std::string description) {
+  CHECK(undo) << "NULL netlink message for " << description;
+  CHECK(!requests_.empty()) << "No request to undo with " << description;
+  auto& request = requests_.back();
+  if (request.undo) {
+    nlmsg_free(request.undo);
+  }
+  request.undo = undo;
+  request.undoDescription = std::move(description);
+}
+
+void NetlinkBatch::clear() {
+  for (auto& request : requests_) {
+    nlmsg_free(request.msg);
+    if (request.undo) {
+      nlmsg_free(request.undo);
+    }
+  }
+  requests_.clear();
+}
+
+void NetlinkBatch::flush() {
+  if (requests_.empty()) {
+    return;
+  }
+  SCOPE_EXIT {
+    clear();
+  };
+
+  const auto startTs = std::chrono::steady_clock::now();
+  auto numChunks = sendAll();
+  auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTs);
+  XLOG(DBG2) << "Applied " << requests_.size() << " netlink requests in "
+             << numChunks << " messages in " << elapsedMs.count() << "ms";
+
+  int firstError = 0;
+  std::string firstFailure;
+  for (const auto& request : requests_) {
+    if (request.error == 0) {
+      XLOG(INFO) << "Completed request to " << request.description;
+    } else if (request.ignoreError) {
+      XLOG(WARNING) << "Failed to " << request.description << ": "
+                    << nl_geterror(request.error);
+    } else {
+      XLOG(ERR) << "Failed to " << request.description << ": "
+                << nl_geterror(request.error);
+      if (firstError == 0) {
+        firstError = request.error;
+        firstFailure = request.description;
+      }
+    }
+  }
+
+  undoFailed();
+  if (firstError != 0) {
+    throw NlError(firstError, "Failed to ", firstFailure);
+  }
+}
+
+size_t NetlinkBatch::sendAll() {
+  size_t numChunks = 0;
+  size_t begin = 0;
+  while (begin < requests_.size()) {
+    size_t chunkBytes = 0;
+    auto end = begin;
+    for (; end < requests_.size(); ++end) {
+      auto len = NLMSG_ALIGN(nlmsg_hdr(requests_[end].msg)->nlmsg_len);
+      // A request larger than the chunk size is sent on its own
+      if (end > begin && chunkBytes + len > maxChunkBytes_) {
+        break;
+      }
+      chunkBytes += len;
+    }
+    sendChunk(begin, end);
+    ++numChunks;
+    begin = end;
+  }
+  return numChunks;
+}
+
+void NetlinkBatch::undoFailed() {
+  std::vector<Request> undos;
+  for (auto& request : requests_) {
+    if (request.error != 0 && request.undo) {
+      Request undo;
+      undo.msg = std::exchange(request.undo, nullptr);
+      undo.description = std::move(request.undoDescription);
+      undo.ignoreError = true;
+      undos.push_back(std::move(undo));
+    }
+  }
+  if (undos.empty()) {
+    return;
+  }
+
+  // The failed requests were logged already, only the undos are left
+  clear();
+  requests_ = std::move(undos);
+  try {
+    sendAll();
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "Failed to send " << requests_.size()
+              << " netlink undo requests: " << folly::exceptionStr(ex);
+    return;
+  }
+  for (const auto& request : requests_) {
+    if (request.error == 0) {
+      XLOG(INFO) << "Completed request to " << request.description;
+    } else {
+      XLOG(ERR) << "Failed to " << request.description << ": "
+                << nl_geterror(request.error);
+    }
+  }
+}
+
+void NetlinkBatch::sendChunk(size_t begin, size_t end) {
+  buf_.clear();
+  // Sequence number of each request in the chunk to its index in requests_
+  std::unordered_map<uint32_t, size_t> pending;
+  for (auto i = begin; i < end; ++i) {
+    auto msg = requests_[i].msg;
+    // Fills in the sequence number and port id of the socket
+    nl_complete_msg(sock_, msg);
+    auto hdr = nlmsg_hdr(msg);
+    hdr->nlmsg_flags |= NLM_F_ACK;
+    auto data = reinterpret_cast<const uint8_t*>(hdr);
+    buf_.insert(buf_.end(), data, data + hdr->nlmsg_len);
+    buf_.resize(NLMSG_ALIGN(buf_.size()));
+    pending.emplace(hdr->nlmsg_seq, i);
+  }
+
+  auto error = nl_sendto(sock_, buf_.data(), buf_.size());
+  nlCheckError(error, "Failed to send ", end - begin, " netlink requests");
+
+  // The kernel answers every request with an NLMSG_ERROR message, whose
+  // error is 0 on success
+  while (!pending.empty()) {
+    sockaddr_nl peer;
+    unsigned char* data = nullptr;
+    auto len = nl_recv(sock_, &peer, &data, nullptr);
+    SCOPE_EXIT {
+      free(data);
+    };
+    nlCheckError(len, "Failed to receive ACKs of netlink requests");
+    if (len == 0) {
+      throw FbossError(
+          "Netlink socket closed with ",
+          pending.size(),
+          " netlink requests not acknowledged");
+    }
+
+    auto hdr = reinterpret_cast<nlmsghdr*>(data);
+    for (; nlmsg_ok(hdr, len); hdr = nlmsg_next(hdr, &len)) {
+      if (hdr->nlmsg_type != NLMSG_ERROR) {
+        continue;
+      }
+      auto iter = pending.find(hdr->nlmsg_seq);
+      if (iter == pending.end()) {
+        XLOG(DBG3) << "Ignoring netlink ACK for unknown sequence "
+                   << hdr->nlmsg_seq;
+        continue;
+      }
+      auto ack = static_cast<nlmsgerr*>(nlmsg_data(hdr));
+      if (ack->error < 0) {
+        requests_[iter->second].error = -nl_syserr2nlerr(-ack->error);
+      }
+      pending.erase(iter);
+    }
+  }
+}
+
+} // namespace facebook::fboss
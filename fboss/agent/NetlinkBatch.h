@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <netlink/msg.h>
+#include <netlink/socket.h>
+}
+
+namespace facebook::fboss {
+
+/*
+ * A transaction of rtnetlink requests (RTM_NEW*, RTM_DEL*) that are sent
+ * together instead of one round trip per request.
+ *
+ * Requests are packed into as few sendmsg calls as the chunk size allows.
+ * Every request asks for an ACK, and the ACKs of a chunk are only collected
+ * once the whole chunk has been sent, so the kernel processes the chunk
+ * back to back. Requests are applied by the kernel in the order they were
+ * added.
+ */
+class NetlinkBatch {
+ public:
+  static constexpr size_t kDefaultMaxChunkBytes = 32 * 1024;
+
+  explicit NetlinkBatch(
+      nl_sock* sock,
+      size_t maxChunkBytes = kDefaultMaxChunkBytes);
+  ~NetlinkBatch();
+
+  /*
+   * Queue a request built by one of the libnl rtnl_*_build_*_request
+   * functions. The batch takes ownership of msg.
+   *
+   * description is used to log the outcome, e.g. "add address 10.0.0.1/24".
+   * If ignoreError is set, a failure of this request is only logged.
+   */
+  void add(nl_msg* msg, std::string description, bool ignoreError = false);
+
+  /*
+   * Attach an undo request to the request added last. If that request
+   * fails, undo is sent once the batch was processed, to revert earlier
+   * requests of the batch it depends on. Failures of undo requests are only
+   * logged. The batch takes ownership of undo.
+   */
+  void setUndo(nl_msg* undo, std::string description);
+
+  /*
+   * Send all queued requests and wait for their ACKs. All requests are
+   * attempted even if some of them fail. If a request not marked with
+   * ignoreError failed, an NlError for the first such failure is thrown
+   * after the whole batch and the undo requests of failed requests were
+   * processed.
+   */
+  void flush();
+
+  /*
+   * Drop all queued requests without sending them.
+   */
+  void clear();
+
+  size_t size() const {
+    return requests_.size();
+  }
+  bool empty() const {
+    return requests_.empty();
+  }
+
+ private:
+  // no copy or assign
+  NetlinkBatch(const NetlinkBatch&) = delete;
+  NetlinkBatch& operator=(const NetlinkBatch&) = delete;
+
+  struct Request {
+    nl_msg* msg{nullptr};
+    std::string description;
+    bool ignoreError{false};
+    int error{0};
+    nl_msg* undo{nullptr};
+    std::string undoDescription;
+  };
+
+  /*
+   * Send all requests in as few chunks as possible. Returns the number of
+   * chunks sent.
+   */
+  size_t sendAll();
+
+  /*
+   * Send requests [begin, end) in one sendmsg and collect their ACKs.
+   */
+  void sendChunk(size_t begin, size_t end);
+
+  /*
+   * Send the undo requests of all failed requests.
+   */
+  void undoFailed();
+
+  nl_sock* sock_{nullptr};
+  size_t maxChunkBytes_{0};
+  std::vector<Request> requests_;
+  // Reused across chunks
+  std::vector<uint8_t> buf_;
+};
+
+} // namespace facebook::fboss
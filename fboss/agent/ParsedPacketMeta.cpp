@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/ParsedPacketMeta.h"
+
+#include "fboss/agent/RxPacket.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/packet/IPv4Hdr.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/packet/PktUtil.h"
+
+using folly::io::Cursor;
+
+namespace facebook::fboss {
+
+Cursor ParsedPacketMeta::l3Cursor(const RxPacket* pkt) const {
+  Cursor cursor(pkt->buf());
+  cursor += l3Offset;
+  return cursor;
+}
+
+ParsedPacketMeta ParsedPacketMeta::parse(
+    const RxPacket* pkt,
+    PortStats* portStats) {
+  ParsedPacketMeta meta;
+  meta.port = pkt->getSrcPort();
+  meta.vlan = pkt->getSrcVlan();
+  meta.portStats = portStats;
+
+  Cursor start(pkt->buf());
+  Cursor cursor(start);
+  meta.dstMac = PktUtil::readMac(&cursor);
+  meta.srcMac = PktUtil::readMac(&cursor);
+  meta.etherType = cursor.readBE<uint16_t>();
+  if (meta.etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN)) {
+    meta.vlanTag = cursor.readBE<uint16_t>() & 0xfff;
+    meta.etherType = cursor.readBE<uint16_t>();
+  }
+  meta.l3Offset = cursor - start;
+
+  if (meta.etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV4) &&
+      cursor.canAdvance(IPv4Hdr::minSize())) {
+    // Version and IHL, then the TTL and protocol at offset 8 and the
+    // destination at offset 16
+    size_t headerLen = (cursor.read<uint8_t>() & 0xf) * 4;
+    cursor += 7;
+    meta.ttl = cursor.read<uint8_t>();
+    meta.ipProto = cursor.read<uint8_t>();
+    cursor += 6;
+    meta.dstIp = PktUtil::readIPv4(&cursor);
+    if (headerLen >= IPv4Hdr::minSize()) {
+      meta.l4Offset = meta.l3Offset + headerLen;
+    }
+  } else if (
+      meta.etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV6) &&
+      cursor.canAdvance(IPv6Hdr::SIZE)) {
+    // Next header and hop limit at offset 6, destination at offset 24
+    cursor += 6;
+    meta.ipProto = cursor.read<uint8_t>();
+    meta.ttl = cursor.read<uint8_t>();
+    cursor += 16;
+    meta.dstIp = PktUtil::readIPv6(&cursor);
+    meta.l4Offset = meta.l3Offset + IPv6Hdr::SIZE;
+  }
+
+  if (meta.hasL4()) {
+    Cursor l4Cursor(start);
+    if (!l4Cursor.canAdvance(meta.l4Offset)) {
+      meta.l4Offset = 0;
+      return meta;
+    }
+    l4Cursor += meta.l4Offset;
+    if ((meta.ipProto == static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP) ||
+         meta.ipProto == static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)) &&
+        l4Cursor.canAdvance(2 * sizeof(uint16_t))) {
+      meta.srcL4Port = l4Cursor.readBE<uint16_t>();
+      meta.dstL4Port = l4Cursor.readBE<uint16_t>();
+    } else if (
+        (meta.ipProto == static_cast<uint8_t>(IP_PROTO::IP_PROTO_ICMP) ||
+         meta.ipProto == static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP)) &&
+        l4Cursor.canAdvance(sizeof(uint8_t))) {
+      meta.icmpType = l4Cursor.read<uint8_t>();
+    }
+  }
+  return meta;
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/IPAddress.h>
+#include <folly/MacAddress.h>
+#include <folly/io/Cursor.h>
+
+#include <optional>
+
+#include "fboss/agent/types.h"
+
+namespace facebook::fboss {
+
+class PortStats;
+class RxPacket;
+
+/*
+ * Headers of a trapped packet, parsed once by SwSwitch::handlePacket and
+ * handed to the RX handlers so that they don't re-parse the L2 header or
+ * look up the ingress port stats again.
+ *
+ * Offsets are from the start of the packet buffer. The L4 fields are only
+ * set for IPv4 and IPv6 packets whose L4 header is within the packet; no
+ * IPv6 extension headers are walked, so ipProto is the first next header.
+ */
+struct ParsedPacketMeta {
+  folly::MacAddress dstMac;
+  folly::MacAddress srcMac;
+  // Ethertype after any 802.1Q tag
+  uint16_t etherType{0};
+  // VLAN ID from the 802.1Q tag, if the packet had one
+  std::optional<uint16_t> vlanTag;
+  // Ingress port and VLAN, as reported by the HwSwitch
+  PortID port{0};
+  VlanID vlan{0};
+  PortStats* portStats{nullptr};
+
+  uint16_t l3Offset{0};
+  // 0 unless the packet is IP with its L4 header in the packet
+  uint16_t l4Offset{0};
+  uint8_t ipProto{0};
+  // IPv4 TTL or IPv6 hop limit
+  uint8_t ttl{0};
+  // Set for IPv4 and IPv6 packets
+  folly::IPAddress dstIp;
+  // Set for TCP and UDP only
+  uint16_t srcL4Port{0};
+  uint16_t dstL4Port{0};
+  // Set for ICMP and ICMPv6 only
+  uint8_t icmpType{0};
+
+  bool hasL4() const {
+    return l4Offset != 0;
+  }
+
+  // Cursor positioned at the L3 header of pkt
+  folly::io::Cursor l3Cursor(const RxPacket* pkt) const;
+
+  /*
+   * Parse pkt in a single pass. pkt must hold at least the ethernet header,
+   * which SwSwitch guarantees by dropping packets shorter than 64 bytes.
+   */
+  static ParsedPacketMeta parse(const RxPacket* pkt, PortStats* portStats);
+};
+
+} // namespace facebook::fboss
@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/PortCounterSlab.h"
+
+#include <folly/Conv.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace facebook::fboss {
+
+std::string portCounterKey(const std::string& portName, PortCounter counter) {
+  switch (counter) {
+    case PortCounter::TRAPPED_PKTS:
+      return folly::to<std::string>(portName, ".trapped.pkts");
+    case PortCounter::TRAPPED_DROPS:
+      return folly::to<std::string>(portName, ".trapped.drops");
+    case PortCounter::HOST_RX_PKTS:
+      return folly::to<std::string>(portName, ".host.rx");
+    case PortCounter::HOST_RX_BYTES:
+      return folly::to<std::string>(portName, ".host.rx.bytes");
+    case PortCounter::LINK_STATE_FLAPS:
+      return folly::to<std::string>(portName, ".link_state.flap");
+    case PortCounter::NUM_PORT_COUNTERS:
+      break;
+  }
+  throw std::invalid_argument(
+      folly::to<std::string>("Invalid port counter ", int(counter)));
+}
+
+PortCounterIndex::PortCounterIndex(
+    std::vector<std::pair<PortID, std::string>> ports) {
+  std::sort(ports.begin(), ports.end());
+  ports.erase(
+      std::unique(
+          ports.begin(),
+          ports.end(),
+          [](const auto& lhs, const auto& rhs) {
+            return lhs.first == rhs.first;
+          }),
+      ports.end());
+  if (!ports.empty()) {
+    slotByPort_.resize(static_cast<size_t>(ports.back().first) + 1, kNoSlot);
+  }
+  ports_.reserve(ports.size());
+  keys_.resize(ports.size() * kNumPortCounters);
+  for (uint32_t slot = 0; slot < ports.size(); ++slot) {
+    const auto& [port, name] = ports[slot];
+    ports_.push_back(port);
+    slotByPort_[static_cast<size_t>(port)] = slot;
+    if (name.empty()) {
+      continue;
+    }
+    for (size_t i = 0; i < kNumPortCounters; ++i) {
+      keys_[slot * kNumPortCounters + i] =
+          portCounterKey(name, static_cast<PortCounter>(i));
+    }
+  }
+}
+
+PortCounterSlab::PortCounterSlab(std::shared_ptr<const PortCounterIndex> index)
+    : index_(std::move(index)),
+      counters_(new std::atomic<uint64_t>[index_->size() * kNumPortCounters]) {
+  for (size_t i = 0; i < index_->size() * kNumPortCounters; ++i) {
+    counters_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+PortCounterRegistry::PortCounterRegistry() {
+  slabs_.wlock()->index = std::make_shared<const PortCounterIndex>(
+      std::vector<std::pair<PortID, std::string>>());
+}
+
+void PortCounterRegistry::setPorts(
+    std::vector<std::pair<PortID, std::string>> ports) {
+  auto index = std::make_shared<const PortCounterIndex>(std::move(ports));
+  auto slabs = slabs_.wlock();
+  // Move the counters of exited threads over to the new layout
+  std::vector<uint64_t> released(index->size() * kNumPortCounters, 0);
+  const auto& oldIndex = *slabs->index;
+  for (uint32_t oldSlot = 0; oldSlot < oldIndex.size(); ++oldSlot) {
+    auto slot = index->slot(oldIndex.port(oldSlot));
+    if (slot == PortCounterIndex::kNoSlot) {
+      continue;
+    }
+    std::copy_n(
+        slabs->released.begin() + oldSlot * kNumPortCounters,
+        kNumPortCounters,
+        released.begin() + slot * kNumPortCounters);
+  }
+  slabs->released = std::move(released);
+  slabs->index = std::move(index);
+  generation_.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<PortCounterSlab> PortCounterRegistry::refreshSlab(
+    const std::shared_ptr<PortCounterSlab>& oldSlab) {
+  auto slabs = slabs_.wlock();
+  auto newSlab = std::make_shared<PortCounterSlab>(slabs->index);
+  if (!oldSlab) {
+    slabs->slabs.push_back(newSlab);
+    return newSlab;
+  }
+  // Only the calling thread writes to oldSlab, so it is stable while its
+  // counters are carried over. Holding the lock keeps the exporter from
+  // seeing both slabs.
+  const auto& oldIndex = oldSlab->index();
+  for (uint32_t slot = 0; slot < oldIndex->size(); ++slot) {
+    auto port = oldIndex->port(slot);
+    for (size_t i = 0; i < kNumPortCounters; ++i) {
+      auto counter = static_cast<PortCounter>(i);
+      newSlab->add(port, counter, oldSlab->get(slot, counter));
+    }
+  }
+  std::replace(slabs->slabs.begin(), slabs->slabs.end(), oldSlab, newSlab);
+  return newSlab;
+}
+
+void PortCounterRegistry::releaseSlab(
+    const std::shared_ptr<PortCounterSlab>& slab) {
+  auto slabs = slabs_.wlock();
+  auto it = std::find(slabs->slabs.begin(), slabs->slabs.end(), slab);
+  if (it == slabs->slabs.end()) {
+    return;
+  }
+  const auto& index = slab->index();
+  for (uint32_t slot = 0; slot < index->size(); ++slot) {
+    auto releasedSlot = slabs->index->slot(index->port(slot));
+    if (releasedSlot == PortCounterIndex::kNoSlot) {
+      continue;
+    }
+    for (size_t i = 0; i < kNumPortCounters; ++i) {
+      slabs->released[releasedSlot * kNumPortCounters + i] +=
+          slab->get(slot, static_cast<PortCounter>(i));
+    }
+  }
+  slabs->slabs.erase(it);
+}
+
+void PortCounterRegistry::sum(
+    const Slabs& slabs,
+    std::vector<uint64_t>& totals) {
+  totals.assign(slabs.released.begin(), slabs.released.end());
+  for (const auto& slab : slabs.slabs) {
+    const auto& index = slab->index();
+    for (uint32_t slot = 0; slot < index->size(); ++slot) {
+      auto totalSlot = slabs.index->slot(index->port(slot));
+      if (totalSlot == PortCounterIndex::kNoSlot) {
+        // Port removed since the slab was created
+        continue;
+      }
+      for (size_t i = 0; i < kNumPortCounters; ++i) {
+        totals[totalSlot * kNumPortCounters + i] +=
+            slab->get(slot, static_cast<PortCounter>(i));
+      }
+    }
+  }
+}
+
+PortCounterValues PortCounterRegistry::getCounters(PortID port) const {
+  PortCounterValues values;
+  values.fill(0);
+  auto slabs = slabs_.rlock();
+  auto slot = slabs->index->slot(port);
+  if (slot == PortCounterIndex::kNoSlot) {
+    return values;
+  }
+  std::copy_n(
+      slabs->released.begin() + slot * kNumPortCounters,
+      kNumPortCounters,
+      values.begin());
+  for (const auto& slab : slabs->slabs) {
+    auto slabSlot = slab->index()->slot(port);
+    if (slabSlot == PortCounterIndex::kNoSlot) {
+      continue;
+    }
+    for (size_t i = 0; i < kNumPortCounters; ++i) {
+      values[i] += slab->get(slabSlot, static_cast<PortCounter>(i));
+    }
+  }
+  return values;
+}
+
+void PortCounterRegistry::forEachCounterDelta(
+    folly::FunctionRef<void(const std::string& key, uint64_t delta)> fn) {
+  auto exported = exported_.wlock();
+  std::shared_ptr<const PortCounterIndex> index;
+  {
+    auto slabs = slabs_.rlock();
+    index = slabs->index;
+    // Only allocates when the index grew
+    sum(*slabs, exported->totals);
+  }
+  if (exported->index != index) {
+    // Ports were added, removed or renamed, carry over what was already
+    // exported for ports still present
+    std::vector<uint64_t> values(index->size() * kNumPortCounters, 0);
+    if (exported->index) {
+      const auto& oldIndex = *exported->index;
+      for (uint32_t oldSlot = 0; oldSlot < oldIndex.size(); ++oldSlot) {
+        auto slot = index->slot(oldIndex.port(oldSlot));
+        if (slot == PortCounterIndex::kNoSlot) {
+          continue;
+        }
+        std::copy_n(
+            exported->values.begin() + oldSlot * kNumPortCounters,
+            kNumPortCounters,
+            values.begin() + slot * kNumPortCounters);
+      }
+    }
+    exported->values = std::move(values);
+    exported->index = index;
+  }
+  for (uint32_t slot = 0; slot < index->size(); ++slot) {
+    for (size_t i = 0; i < kNumPortCounters; ++i) {
+      auto total = exported->totals[slot * kNumPortCounters + i];
+      auto& value = exported->values[slot * kNumPortCounters + i];
+      // Never export negative deltas, e.g. if a port was removed and added
+      // back in between two calls
+      auto delta = total > value ? total - value : 0;
+      value = total;
+      const auto& key = index->key(slot, static_cast<PortCounter>(i));
+      if (delta && !key.empty()) {
+        fn(key, delta);
+      }
+    }
+  }
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,191 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Function.h>
+#include <folly/Synchronized.h>
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fboss/agent/types.h"
+
+namespace facebook::fboss {
+
+/*
+ * Per port counters maintained by the packet handling threads.
+ */
+enum class PortCounter : uint8_t {
+  TRAPPED_PKTS,
+  TRAPPED_DROPS,
+  HOST_RX_PKTS,
+  HOST_RX_BYTES,
+  LINK_STATE_FLAPS,
+  NUM_PORT_COUNTERS,
+};
+
+constexpr auto kNumPortCounters =
+    static_cast<size_t>(PortCounter::NUM_PORT_COUNTERS);
+using PortCounterValues = std::array<uint64_t, kNumPortCounters>;
+
+/*
+ * Name of the fb303 stat exporting counter for the given port. Counters are
+ * exported as SUM stats, so fb303 adds the ".sum" and ".sum.<window>" keys.
+ */
+std::string portCounterKey(const std::string& portName, PortCounter counter);
+
+/*
+ * Dense index of the ports of the switch, along with the fb303 keys of their
+ * counters. Immutable once built, a new index is only built when ports are
+ * added, removed or renamed.
+ */
+class PortCounterIndex {
+ public:
+  static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+  explicit PortCounterIndex(std::vector<std::pair<PortID, std::string>> ports);
+
+  uint32_t slot(PortID port) const {
+    auto idx = static_cast<size_t>(port);
+    return idx < slotByPort_.size() ? slotByPort_[idx] : kNoSlot;
+  }
+  PortID port(uint32_t slot) const {
+    return ports_[slot];
+  }
+  size_t size() const {
+    return ports_.size();
+  }
+  // Empty for ports without a name, which are not exported
+  const std::string& key(uint32_t slot, PortCounter counter) const {
+    return keys_[slot * kNumPortCounters + size_t(counter)];
+  }
+
+ private:
+  std::vector<PortID> ports_;
+  std::vector<std::string> keys_;
+  // Indexed by PortID, which are small integers
+  std::vector<uint32_t> slotByPort_;
+};
+
+/*
+ * Counters of one thread for every port in a PortCounterIndex, in one
+ * contiguous array. Only the owning thread writes to a slab, so increments
+ * are plain relaxed loads and stores, and other threads can read it at any
+ * time without locking.
+ */
+class PortCounterSlab {
+ public:
+  explicit PortCounterSlab(std::shared_ptr<const PortCounterIndex> index);
+
+  const std::shared_ptr<const PortCounterIndex>& index() const {
+    return index_;
+  }
+
+  void add(PortID port, PortCounter counter, uint64_t value) {
+    auto slot = index_->slot(port);
+    if (slot == PortCounterIndex::kNoSlot) {
+      return;
+    }
+    auto& count = counters_[slot * kNumPortCounters + size_t(counter)];
+    count.store(
+        count.load(std::memory_order_relaxed) + value,
+        std::memory_order_relaxed);
+  }
+
+  uint64_t get(uint32_t slot, PortCounter counter) const {
+    return counters_[slot * kNumPortCounters + size_t(counter)].load(
+        std::memory_order_relaxed);
+  }
+
+ private:
+  std::shared_ptr<const PortCounterIndex> index_;
+  std::unique_ptr<std::atomic<uint64_t>[]> counters_;
+};
+
+/*
+ * PortCounterRegistry owns the current port index and the slabs of all
+ * threads. Threads only take the registry lock to swap their slab when the
+ * index changes, so counting never contends with exporting.
+ */
+class PortCounterRegistry {
+ public:
+  PortCounterRegistry();
+
+  /*
+   * Rebuild the port index from (port, name) pairs. Called when ports are
+   * added, removed or renamed.
+   */
+  void setPorts(std::vector<std::pair<PortID, std::string>> ports);
+
+  /*
+   * Generation of the current index, compared by threads on every increment
+   * to find out their slab is stale.
+   */
+  uint64_t generation() const {
+    return generation_.load(std::memory_order_acquire);
+  }
+
+  /*
+   * Create a slab for the current index for the calling thread. If the
+   * thread had a slab for an older index, its counters are carried over.
+   */
+  std::shared_ptr<PortCounterSlab> refreshSlab(
+      const std::shared_ptr<PortCounterSlab>& oldSlab);
+
+  /*
+   * Stop tracking a slab, when its thread exits. Its counters are kept.
+   */
+  void releaseSlab(const std::shared_ptr<PortCounterSlab>& slab);
+
+  /*
+   * Sum of the counters of every thread for one port, zero for ports not in
+   * the index.
+   */
+  PortCounterValues getCounters(PortID port) const;
+
+  /*
+   * Call fn with the key of each counter of each named port which went up
+   * since the previous call, and by how much, summed over every thread.
+   * Meant to be fed to fb303 SUM stats by a single exporter.
+   */
+  void forEachCounterDelta(
+      folly::FunctionRef<void(const std::string& key, uint64_t delta)> fn);
+
+ private:
+  struct Slabs {
+    std::shared_ptr<const PortCounterIndex> index;
+    std::vector<std::shared_ptr<PortCounterSlab>> slabs;
+    // Counters of slabs whose thread exited, laid out like a slab of index
+    std::vector<uint64_t> released;
+  };
+
+  // Sum the counters of every thread into totals, laid out like a slab
+  static void sum(const Slabs& slabs, std::vector<uint64_t>& totals);
+
+  struct Exported {
+    // Index the vectors below are laid out for
+    std::shared_ptr<const PortCounterIndex> index;
+    // Reused by forEachCounterDelta(), sized with the index
+    std::vector<uint64_t> totals;
+    // Totals as of the previous forEachCounterDelta()
+    std::vector<uint64_t> values;
+  };
+
+  std::atomic<uint64_t> generation_{0};
+  folly::Synchronized<Slabs> slabs_;
+  folly::Synchronized<Exported> exported_;
+};
+
+} // namespace facebook::fboss
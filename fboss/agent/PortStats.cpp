@@ -13,13 +13,10 @@
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/normalization/Normalizer.h"
 
-using facebook::fb303::SUM;
-
 namespace facebook::fboss {
 
 const std::string kNameKeySeperator = ".";
 const std::string kUp = "up";
-const std::string kLinkStateFlap = "link_state.flap";
 
 PortStats::PortStats(
     PortID portID,
@@ -39,21 +36,28 @@ void PortStats::setPortName(const std::string& portName) {
 }
 
 void PortStats::trappedPkt() {
+  switchStats_->portCounter(portID_, PortCounter::TRAPPED_PKTS);
   switchStats_->trappedPkt();
 }
 void PortStats::pktDropped() {
+  switchStats_->portCounter(portID_, PortCounter::TRAPPED_DROPS);
   switchStats_->pktDropped();
 }
 void PortStats::pktBogus() {
+  switchStats_->portCounter(portID_, PortCounter::TRAPPED_DROPS);
   switchStats_->pktBogus();
 }
 void PortStats::pktError() {
+  switchStats_->portCounter(portID_, PortCounter::TRAPPED_DROPS);
   switchStats_->pktError();
 }
 void PortStats::pktUnhandled() {
+  switchStats_->portCounter(portID_, PortCounter::TRAPPED_DROPS);
   switchStats_->pktUnhandled();
 }
 void PortStats::pktToHost(uint32_t bytes) {
+  switchStats_->portCounter(portID_, PortCounter::HOST_RX_PKTS);
+  switchStats_->portCounter(portID_, PortCounter::HOST_RX_BYTES, bytes);
   switchStats_->pktToHost(bytes);
 }
 
@@ -140,18 +144,19 @@ void PortStats::dhcpV6DropPkt() {
 }
 
 void PortStats::linkStateChange(bool isUp) {
-  // We decided not to maintain the TLTimeseries in PortStats and use tcData()
-  // to addStatValue based on the key name, because:
+  // We decided not to maintain the TLTimeseries in PortStats and count in
+  // the per port counter slab, exported by key name, because:
   // 1) each thread has its own SwitchStats and PortStats
   // 2) update PortName need to delete old TLTimeseries in the thread which
   // can recognize the name changed.
   // 3) w/o a global lock like the one in ThreadLocalStats, we might have
   // race condition issue when two threads want to delete the same TLTimeseries
   // from the same thread.
-  // Using tcData() can make sure we don't have to maintain the lifecycle of
-  // TLTimeseries and leave ThreadLocalStats do it for us.
+  // SwSwitch::updatePortCounters() adds the slab deltas to tcData() under
+  // <port>.link_state.flap, so ThreadLocalStats still maintains the SUM
+  // timeseries for us.
+  switchStats_->portCounter(portID_, PortCounter::LINK_STATE_FLAPS);
   if (!portName_.empty()) {
-    tcData().addStatValue(getCounterKey(kLinkStateFlap), 1, SUM);
     if (auto normalizer = Normalizer::getInstance()) {
       normalizer->processLinkStateChange(portName_, isUp);
     }
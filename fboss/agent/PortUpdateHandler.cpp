@@ -10,21 +10,38 @@
 #include "fboss/agent/PortUpdateHandler.h"
 #include "fboss/agent/LldpManager.h"
 
+#include <fb303/ServiceData.h>
+
 #include "fboss/agent/PortStats.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/state/DeltaFunctions.h"
 #include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/state/SwitchState.h"
 
 namespace facebook::fboss {
 
+namespace {
+void clearPortCounters(const std::string& portName) {
+  if (portName.empty()) {
+    return;
+  }
+  for (size_t i = 0; i < kNumPortCounters; ++i) {
+    fb303::fbData->clearCounter(
+        portCounterKey(portName, static_cast<PortCounter>(i)));
+  }
+}
+} // namespace
+
 PortUpdateHandler::PortUpdateHandler(SwSwitch* sw)
     : AutoRegisterStateObserver(sw, "PortUpdateHandler"), sw_(sw) {}
 
 void PortUpdateHandler::stateUpdated(const StateDelta& delta) {
   // For now, the stateUpdated is only used to update the portName of PortStats
   // for all threads.
+  // Port counters are indexed by port and keyed by port name
+  bool rebuildPortCounters = false;
   DeltaFunctions::forEachChanged(
       delta.getPortsDelta(),
       [&](const std::shared_ptr<Port>& oldPort,
@@ -36,6 +53,8 @@ void PortUpdateHandler::stateUpdated(const StateDelta& delta) {
           }
         }
         if (oldPort->getName() != newPort->getName()) {
+          rebuildPortCounters = true;
+          clearPortCounters(oldPort->getName());
           for (SwitchStats& switchStats : sw_->getAllThreadsSwitchStats()) {
             // only update the portName when the portStats exists
             PortStats* portStats = switchStats.port(newPort->getID());
@@ -55,9 +74,12 @@ void PortUpdateHandler::stateUpdated(const StateDelta& delta) {
         }
       },
       [&](const std::shared_ptr<Port>& newPort) {
+        rebuildPortCounters = true;
         sw_->portStats(newPort->getID())->setPortStatus(newPort->isUp());
       },
       [&](const std::shared_ptr<Port>& oldPort) {
+        rebuildPortCounters = true;
+        clearPortCounters(oldPort->getName());
         for (SwitchStats& switchStats : sw_->getAllThreadsSwitchStats()) {
           switchStats.deletePortStats(oldPort->getID());
         }
@@ -65,6 +87,14 @@ void PortUpdateHandler::stateUpdated(const StateDelta& delta) {
           sw_->getLldpMgr()->portDown(oldPort->getID());
         }
       });
+
+  if (rebuildPortCounters) {
+    std::vector<std::pair<PortID, std::string>> ports;
+    for (const auto& port : *delta.newState()->getPorts()) {
+      ports.emplace_back(port->getID(), port->getName());
+    }
+    sw_->getPortCounters()->setPorts(std::move(ports));
+  }
 }
 
 } // namespace facebook::fboss
@@ -0,0 +1,637 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StateUpdateRecorder.h"
+
+#include "fboss/agent/Constants.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/state/AclMap.h"
+#include "fboss/agent/state/AggregatePortMap.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/BufferPoolConfigMap.h"
+#include "fboss/agent/state/ControlPlane.h"
+#include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/InterfaceMap.h"
+#include "fboss/agent/state/LabelForwardingInformationBase.h"
+#include "fboss/agent/state/LoadBalancerMap.h"
+#include "fboss/agent/state/MacTable.h"
+#include "fboss/agent/state/MirrorMap.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/QcmConfig.h"
+#include "fboss/agent/state/QosPolicyMap.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/SflowCollectorMap.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchSettings.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+
+#include <folly/FileUtil.h>
+#include <folly/MacAddress.h>
+#include <folly/String.h>
+#include <folly/json.h>
+#include <folly/logging/xlog.h>
+
+#include <type_traits>
+#include <utility>
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+namespace {
+constexpr auto kGeneration = "generation";
+constexpr auto kDelayUs = "delayUs";
+constexpr auto kHwDurationUs = "hwDurationUs";
+constexpr auto kSkipped = "skipped";
+constexpr auto kState = "state";
+constexpr auto kChanges = "changes";
+
+// Changes to a map of nodes
+constexpr auto kAdded = "added";
+constexpr auto kChanged = "changed";
+constexpr auto kRemoved = "removed";
+
+// Changes to a vlan or a route table that is in both states
+constexpr auto kFields = "fields";
+constexpr auto kArpTable = "arpTable";
+constexpr auto kNdpTable = "ndpTable";
+constexpr auto kMacTable = "macTable";
+constexpr auto kId = "id";
+constexpr auto kRoutesV4 = "routesV4";
+constexpr auto kRoutesV6 = "routesV6";
+
+// Top level sections of SwitchState::toFollyDynamic()
+constexpr auto kInterfaces = "interfaces";
+constexpr auto kPorts = "ports";
+constexpr auto kVlans = "vlans";
+constexpr auto kRouteTables = "routeTables";
+constexpr auto kDefaultVlan = "defaultVlan";
+constexpr auto kAcls = "acls";
+constexpr auto kSflowCollectors = "sFlowCollectors";
+constexpr auto kControlPlane = "controlPlane";
+constexpr auto kQosPolicies = "qosPolicies";
+constexpr auto kLoadBalancers = "loadBalancers";
+constexpr auto kMirrors = "mirrors";
+constexpr auto kAggregatePorts = "aggregatePorts";
+constexpr auto kLabelForwardingInformationBase = "labelFib";
+constexpr auto kSwitchSettings = "switchSettings";
+constexpr auto kDefaultDataplaneQosPolicy = "defaultDataPlaneQosPolicy";
+constexpr auto kQcmCfg = "qcmConfig";
+constexpr auto kBufferPoolCfgs = "bufferPoolConfigs";
+} // namespace
+
+namespace facebook::fboss {
+
+namespace {
+
+template <typename T>
+struct IsRoutePrefix : std::false_type {};
+template <typename AddrT>
+struct IsRoutePrefix<RoutePrefix<AddrT>> : std::true_type {};
+
+/*
+ * Node map keys are ids, names, IP or MAC addresses and route prefixes.
+ */
+template <typename KeyT>
+folly::dynamic keyToFollyDynamic(const KeyT& key) {
+  if constexpr (std::is_same_v<KeyT, std::string>) {
+    return key;
+  } else if constexpr (
+      std::is_enum_v<KeyT> || std::is_convertible_v<KeyT, int64_t>) {
+    return static_cast<int64_t>(key);
+  } else if constexpr (std::is_same_v<KeyT, folly::MacAddress>) {
+    return key.toString();
+  } else if constexpr (IsRoutePrefix<KeyT>::value) {
+    return key.toFollyDynamic();
+  } else {
+    return key.str();
+  }
+}
+
+template <typename KeyT>
+KeyT keyFromFollyDynamic(const folly::dynamic& json) {
+  if constexpr (std::is_same_v<KeyT, std::string>) {
+    return json.asString();
+  } else if constexpr (
+      std::is_enum_v<KeyT> || std::is_convertible_v<KeyT, int64_t>) {
+    return static_cast<KeyT>(json.asInt());
+  } else if constexpr (IsRoutePrefix<KeyT>::value) {
+    return KeyT::fromFollyDynamic(json);
+  } else {
+    return KeyT(json.asString());
+  }
+}
+
+// The map type of a NodeMapDelta
+template <typename DeltaT>
+using DeltaMap = std::remove_const_t<
+    std::remove_pointer_t<decltype(std::declval<DeltaT>().getNew())>>;
+
+/*
+ * The nodes added, changed and removed in a map, or null if the map was
+ * removed. Unchanged nodes are skipped without being serialized.
+ */
+template <typename DeltaT>
+folly::dynamic nodeMapChanges(const DeltaT& delta) {
+  using MapT = DeltaMap<DeltaT>;
+  using NodeT = typename DeltaT::Node;
+  if (!delta.getNew()) {
+    return nullptr;
+  }
+  folly::dynamic added = folly::dynamic::array;
+  folly::dynamic changed = folly::dynamic::array;
+  folly::dynamic removed = folly::dynamic::array;
+  DeltaFunctions::forEachChanged(
+      delta,
+      [&](const std::shared_ptr<NodeT>& /*oldNode*/,
+          const std::shared_ptr<NodeT>& newNode) {
+        changed.push_back(newNode->toFollyDynamic());
+      },
+      [&](const std::shared_ptr<NodeT>& newNode) {
+        added.push_back(newNode->toFollyDynamic());
+      },
+      [&](const std::shared_ptr<NodeT>& oldNode) {
+        removed.push_back(keyToFollyDynamic(MapT::Traits::getKey(oldNode)));
+      });
+
+  folly::dynamic changes = folly::dynamic::object;
+  changes[kExtraFields] = delta.getNew()->getExtraFields().toFollyDynamic();
+  changes[kAdded] = std::move(added);
+  changes[kChanged] = std::move(changed);
+  changes[kRemoved] = std::move(removed);
+  return changes;
+}
+
+/*
+ * Apply the changes recorded by nodeMapChanges() to a copy of oldMap.
+ */
+template <typename MapT>
+std::shared_ptr<MapT> applyNodeMapChanges(
+    const std::shared_ptr<MapT>& oldMap,
+    const folly::dynamic& changes) {
+  using NodeT = typename MapT::Node;
+  if (changes.isNull()) {
+    return nullptr;
+  }
+  auto map = oldMap ? oldMap->clone() : std::make_shared<MapT>();
+  map->writableExtraFields() =
+      MapT::ExtraFields::fromFollyDynamic(changes[kExtraFields]);
+  for (const auto& key : changes[kRemoved]) {
+    map->removeNode(keyFromFollyDynamic<typename MapT::KeyType>(key));
+  }
+  for (const auto& node : changes[kChanged]) {
+    map->updateNode(NodeT::fromFollyDynamic(node));
+  }
+  for (const auto& node : changes[kAdded]) {
+    map->addNode(NodeT::fromFollyDynamic(node));
+  }
+  return map;
+}
+
+/*
+ * A vlan without its ARP, NDP and MAC tables, which are recorded entry by
+ * entry.
+ */
+folly::dynamic vlanFields(const std::shared_ptr<Vlan>& vlan) {
+  auto fields = vlan->clone();
+  fields->setArpTable(std::make_shared<ArpTable>());
+  fields->setNdpTable(std::make_shared<NdpTable>());
+  fields->setMacTable(std::make_shared<MacTable>());
+  return fields->toFollyDynamic();
+}
+
+folly::dynamic vlanMapChanges(const VlanMapDelta& delta) {
+  folly::dynamic added = folly::dynamic::array;
+  folly::dynamic changed = folly::dynamic::array;
+  folly::dynamic removed = folly::dynamic::array;
+  DeltaFunctions::forEachChanged(
+      delta,
+      [&](const std::shared_ptr<Vlan>& oldVlan,
+          const std::shared_ptr<Vlan>& newVlan) {
+        // Neighbor and MAC churn only changes a few entries of a vlan
+        VlanDelta vlanDelta(oldVlan, newVlan);
+        folly::dynamic vlan = folly::dynamic::object;
+        vlan[kFields] = vlanFields(newVlan);
+        if (oldVlan->getArpTable() != newVlan->getArpTable()) {
+          vlan[kArpTable] = nodeMapChanges(vlanDelta.getArpDelta());
+        }
+        if (oldVlan->getNdpTable() != newVlan->getNdpTable()) {
+          vlan[kNdpTable] = nodeMapChanges(vlanDelta.getNdpDelta());
+        }
+        if (oldVlan->getMacTable() != newVlan->getMacTable()) {
+          vlan[kMacTable] = nodeMapChanges(vlanDelta.getMacDelta());
+        }
+        changed.push_back(std::move(vlan));
+      },
+      [&](const std::shared_ptr<Vlan>& newVlan) {
+        added.push_back(newVlan->toFollyDynamic());
+      },
+      [&](const std::shared_ptr<Vlan>& oldVlan) {
+        removed.push_back(static_cast<int64_t>(oldVlan->getID()));
+      });
+
+  folly::dynamic changes = folly::dynamic::object;
+  changes[kExtraFields] = delta.getNew()->getExtraFields().toFollyDynamic();
+  changes[kAdded] = std::move(added);
+  changes[kChanged] = std::move(changed);
+  changes[kRemoved] = std::move(removed);
+  return changes;
+}
+
+std::shared_ptr<VlanMap> applyVlanMapChanges(
+    const std::shared_ptr<VlanMap>& oldVlans,
+    const folly::dynamic& changes) {
+  auto vlans = oldVlans->clone();
+  vlans->writableExtraFields() =
+      VlanMap::ExtraFields::fromFollyDynamic(changes[kExtraFields]);
+  for (const auto& id : changes[kRemoved]) {
+    vlans->removeNode(VlanID(id.asInt()));
+  }
+  for (const auto& vlanChanges : changes[kChanged]) {
+    auto vlan = Vlan::fromFollyDynamic(vlanChanges[kFields]);
+    auto oldVlan = oldVlans->getVlan(vlan->getID());
+    auto applyTable = [&](const char* table, const auto& oldTable) {
+      auto tableChanges = vlanChanges.get_ptr(table);
+      return tableChanges ? applyNodeMapChanges(oldTable, *tableChanges)
+                          : oldTable;
+    };
+    vlan->setArpTable(applyTable(kArpTable, oldVlan->getArpTable()));
+    vlan->setNdpTable(applyTable(kNdpTable, oldVlan->getNdpTable()));
+    vlan->setMacTable(applyTable(kMacTable, oldVlan->getMacTable()));
+    vlans->updateNode(vlan);
+  }
+  for (const auto& vlan : changes[kAdded]) {
+    vlans->addNode(Vlan::fromFollyDynamic(vlan));
+  }
+  return vlans;
+}
+
+folly::dynamic routeTableMapChanges(const RTMapDelta& delta) {
+  folly::dynamic added = folly::dynamic::array;
+  folly::dynamic changed = folly::dynamic::array;
+  folly::dynamic removed = folly::dynamic::array;
+  DeltaFunctions::forEachChanged(
+      delta,
+      [&](const std::shared_ptr<RouteTable>& oldTable,
+          const std::shared_ptr<RouteTable>& newTable) {
+        RouteTablesDelta tableDelta(oldTable, newTable);
+        folly::dynamic table = folly::dynamic::object;
+        table[kId] = static_cast<int64_t>(newTable->getID());
+        if (oldTable->getRibV4() != newTable->getRibV4()) {
+          table[kRoutesV4] = nodeMapChanges(tableDelta.getRoutesV4Delta());
+        }
+        if (oldTable->getRibV6() != newTable->getRibV6()) {
+          table[kRoutesV6] = nodeMapChanges(tableDelta.getRoutesV6Delta());
+        }
+        changed.push_back(std::move(table));
+      },
+      [&](const std::shared_ptr<RouteTable>& newTable) {
+        added.push_back(newTable->toFollyDynamic());
+      },
+      [&](const std::shared_ptr<RouteTable>& oldTable) {
+        removed.push_back(static_cast<int64_t>(oldTable->getID()));
+      });
+
+  folly::dynamic changes = folly::dynamic::object;
+  changes[kExtraFields] = delta.getNew()->getExtraFields().toFollyDynamic();
+  changes[kAdded] = std::move(added);
+  changes[kChanged] = std::move(changed);
+  changes[kRemoved] = std::move(removed);
+  return changes;
+}
+
+/*
+ * Routes are changed through the rib, which keeps its radix tree in sync
+ * with the routes map.
+ */
+template <typename AddrT>
+std::shared_ptr<RouteTableRib<AddrT>> applyRouteChanges(
+    const std::shared_ptr<RouteTableRib<AddrT>>& oldRib,
+    const folly::dynamic& changes) {
+  auto rib = oldRib->clone();
+  for (const auto& prefix : changes[kRemoved]) {
+    auto route =
+        rib->exactMatch(RoutePrefix<AddrT>::fromFollyDynamic(prefix));
+    rib->removeRoute(route);
+    rib->removeRouteInRadixTree(route);
+  }
+  for (const auto& routeJson : changes[kChanged]) {
+    auto route = Route<AddrT>::fromFollyDynamic(routeJson);
+    rib->updateRoute(route);
+    rib->updateRouteInRadixTree(route);
+  }
+  for (const auto& routeJson : changes[kAdded]) {
+    auto route = Route<AddrT>::fromFollyDynamic(routeJson);
+    rib->addRoute(route);
+    rib->addRouteInRadixTree(route);
+  }
+  return rib;
+}
+
+std::shared_ptr<RouteTableMap> applyRouteTableMapChanges(
+    const std::shared_ptr<RouteTableMap>& oldTables,
+    const folly::dynamic& changes) {
+  auto tables = oldTables->clone();
+  tables->writableExtraFields() =
+      RouteTableMap::ExtraFields::fromFollyDynamic(changes[kExtraFields]);
+  for (const auto& id : changes[kRemoved]) {
+    tables->removeNode(RouterID(id.asInt()));
+  }
+  for (const auto& tableChanges : changes[kChanged]) {
+    auto table =
+        oldTables->getRouteTable(RouterID(tableChanges[kId].asInt()))->clone();
+    if (auto routes = tableChanges.get_ptr(kRoutesV4)) {
+      table->setRib(applyRouteChanges(table->getRibV4(), *routes));
+    }
+    if (auto routes = tableChanges.get_ptr(kRoutesV6)) {
+      table->setRib(applyRouteChanges(table->getRibV6(), *routes));
+    }
+    tables->updateNode(table);
+  }
+  for (const auto& table : changes[kAdded]) {
+    tables->addNode(RouteTable::fromFollyDynamic(table));
+  }
+  return tables;
+}
+
+template <typename NodeT>
+void addNodeChange(
+    folly::dynamic* changes,
+    const char* section,
+    const std::shared_ptr<NodeT>& oldNode,
+    const std::shared_ptr<NodeT>& newNode) {
+  if (oldNode != newNode) {
+    (*changes)[section] = newNode ? newNode->toFollyDynamic() : nullptr;
+  }
+}
+
+template <typename NodeT>
+std::shared_ptr<NodeT> applyNodeChange(
+    const folly::dynamic& changes,
+    const char* section,
+    const std::shared_ptr<NodeT>& oldNode) {
+  auto json = changes.get_ptr(section);
+  if (!json) {
+    return oldNode;
+  }
+  return json->isNull() ? nullptr : NodeT::fromFollyDynamic(*json);
+}
+
+/*
+ * Node level changes between the two states of delta. Maps and nodes which
+ * are shared between the states are skipped by pointer comparison.
+ */
+folly::dynamic stateChanges(const StateDelta& delta) {
+  const auto& oldState = delta.oldState();
+  const auto& newState = delta.newState();
+  folly::dynamic changes = folly::dynamic::object;
+  auto addMapChanges = [&changes](const char* section, const auto& mapDelta) {
+    if (mapDelta.getOld() != mapDelta.getNew()) {
+      changes[section] = nodeMapChanges(mapDelta);
+    }
+  };
+
+  addMapChanges(kPorts, delta.getPortsDelta());
+  addMapChanges(kAggregatePorts, delta.getAggregatePortsDelta());
+  addMapChanges(kInterfaces, delta.getIntfsDelta());
+  // StateDelta's ACL delta is by priority, the recorded map is by name
+  addMapChanges(
+      kAcls,
+      NodeMapDelta<AclMap>(
+          oldState->getAcls().get(), newState->getAcls().get()));
+  addMapChanges(kSflowCollectors, delta.getSflowCollectorsDelta());
+  addMapChanges(kQosPolicies, delta.getQosPoliciesDelta());
+  addMapChanges(kLoadBalancers, delta.getLoadBalancersDelta());
+  addMapChanges(kMirrors, delta.getMirrorsDelta());
+  addMapChanges(
+      kLabelForwardingInformationBase,
+      delta.getLabelForwardingInformationBaseDelta());
+  addMapChanges(
+      kBufferPoolCfgs,
+      NodeMapDelta<BufferPoolCfgMap>(
+          oldState->getBufferPoolCfgs().get(),
+          newState->getBufferPoolCfgs().get()));
+  if (oldState->getVlans() != newState->getVlans()) {
+    changes[kVlans] = vlanMapChanges(delta.getVlansDelta());
+  }
+  if (oldState->getRouteTables() != newState->getRouteTables()) {
+    changes[kRouteTables] = routeTableMapChanges(delta.getRouteTablesDelta());
+  }
+
+  addNodeChange(
+      &changes,
+      kControlPlane,
+      oldState->getControlPlane(),
+      newState->getControlPlane());
+  addNodeChange(
+      &changes,
+      kSwitchSettings,
+      oldState->getSwitchSettings(),
+      newState->getSwitchSettings());
+  addNodeChange(
+      &changes, kQcmCfg, oldState->getQcmCfg(), newState->getQcmCfg());
+  addNodeChange(
+      &changes,
+      kDefaultDataplaneQosPolicy,
+      oldState->getDefaultDataPlaneQosPolicy(),
+      newState->getDefaultDataPlaneQosPolicy());
+  if (oldState->getDefaultVlan() != newState->getDefaultVlan()) {
+    changes[kDefaultVlan] = static_cast<int64_t>(newState->getDefaultVlan());
+  }
+  return changes;
+}
+
+/*
+ * Apply the changes recorded by stateChanges() to prev. Everything that did
+ * not change is shared with prev, so the delta between the two states only
+ * has the recorded changes, same as in the agent.
+ */
+std::shared_ptr<SwitchState> applyStateChanges(
+    const std::shared_ptr<SwitchState>& prev,
+    const folly::dynamic& changes) {
+  auto state = prev->clone();
+  auto has = [&changes](const char* section) {
+    return changes.get_ptr(section) != nullptr;
+  };
+
+  if (has(kPorts)) {
+    state->resetPorts(applyNodeMapChanges(prev->getPorts(), changes[kPorts]));
+  }
+  if (has(kAggregatePorts)) {
+    state->resetAggregatePorts(applyNodeMapChanges(
+        prev->getAggregatePorts(), changes[kAggregatePorts]));
+  }
+  if (has(kInterfaces)) {
+    state->resetIntfs(
+        applyNodeMapChanges(prev->getInterfaces(), changes[kInterfaces]));
+  }
+  if (has(kAcls)) {
+    state->resetAcls(applyNodeMapChanges(prev->getAcls(), changes[kAcls]));
+  }
+  if (has(kSflowCollectors)) {
+    state->resetSflowCollectors(applyNodeMapChanges(
+        prev->getSflowCollectors(), changes[kSflowCollectors]));
+  }
+  if (has(kQosPolicies)) {
+    state->resetQosPolicies(
+        applyNodeMapChanges(prev->getQosPolicies(), changes[kQosPolicies]));
+  }
+  if (has(kLoadBalancers)) {
+    state->resetLoadBalancers(applyNodeMapChanges(
+        prev->getLoadBalancers(), changes[kLoadBalancers]));
+  }
+  if (has(kMirrors)) {
+    state->resetMirrors(
+        applyNodeMapChanges(prev->getMirrors(), changes[kMirrors]));
+  }
+  if (has(kLabelForwardingInformationBase)) {
+    state->resetLabelForwardingInformationBase(applyNodeMapChanges(
+        prev->getLabelForwardingInformationBase(),
+        changes[kLabelForwardingInformationBase]));
+  }
+  if (has(kBufferPoolCfgs)) {
+    state->resetBufferPoolCfgs(applyNodeMapChanges(
+        prev->getBufferPoolCfgs(), changes[kBufferPoolCfgs]));
+  }
+  if (has(kVlans)) {
+    state->resetVlans(applyVlanMapChanges(prev->getVlans(), changes[kVlans]));
+  }
+  if (has(kRouteTables)) {
+    state->resetRouteTables(applyRouteTableMapChanges(
+        prev->getRouteTables(), changes[kRouteTables]));
+  }
+
+  state->resetControlPlane(
+      applyNodeChange(changes, kControlPlane, prev->getControlPlane()));
+  state->resetSwitchSettings(
+      applyNodeChange(changes, kSwitchSettings, prev->getSwitchSettings()));
+  state->resetQcmCfg(applyNodeChange(changes, kQcmCfg, prev->getQcmCfg()));
+  state->setDefaultDataPlaneQosPolicy(applyNodeChange(
+      changes,
+      kDefaultDataplaneQosPolicy,
+      prev->getDefaultDataPlaneQosPolicy()));
+  if (has(kDefaultVlan)) {
+    state->setDefaultVlan(VlanID(changes[kDefaultVlan].asInt()));
+  }
+  return state;
+}
+
+} // namespace
+
+StateUpdateRecorder::StateUpdateRecorder(
+    const std::string& filePath,
+    size_t maxPendingUpdates)
+    : file_(filePath, O_WRONLY | O_CREAT | O_TRUNC),
+      maxPendingUpdates_(maxPendingUpdates) {
+  XLOG(INFO) << "Recording state updates to " << filePath;
+}
+
+StateUpdateRecorder::~StateUpdateRecorder() {
+  flush();
+}
+
+void StateUpdateRecorder::recordUpdate(
+    std::shared_ptr<SwitchState> state,
+    microseconds hwDuration) {
+  auto appliedAt = steady_clock::now();
+  // Each queued update pins a SwitchState, so do not let them pile up when
+  // the recorder cannot keep up
+  if (pendingUpdates_.load() >= maxPendingUpdates_) {
+    ++skippedUpdates_;
+    ++droppedUpdates_;
+    XLOG_EVERY_MS(WARN, 10000)
+        << "State update recorder is falling behind, "
+        << droppedUpdates_.load() << " updates dropped so far";
+    return;
+  }
+  ++pendingUpdates_;
+  recordThread_.getEventBase()->runInEventBaseThread(
+      [this,
+       state = std::move(state),
+       appliedAt,
+       hwDuration,
+       skipped = std::exchange(skippedUpdates_, 0)]() {
+        writeRecord(state, appliedAt, hwDuration, skipped);
+        --pendingUpdates_;
+      });
+}
+
+void StateUpdateRecorder::flush() {
+  recordThread_.getEventBase()->runInEventBaseThreadAndWait([]() {});
+}
+
+void StateUpdateRecorder::writeRecord(
+    const std::shared_ptr<SwitchState>& state,
+    steady_clock::time_point appliedAt,
+    microseconds hwDuration,
+    uint64_t skipped) {
+  folly::dynamic record = folly::dynamic::object;
+  record[kGeneration] = state->getGeneration();
+  record[kDelayUs] = lastAppliedAt_
+      ? duration_cast<microseconds>(appliedAt - *lastAppliedAt_).count()
+      : 0;
+  record[kHwDurationUs] = hwDuration.count();
+  // Changes of the skipped updates are part of this record
+  record[kSkipped] = static_cast<int64_t>(skipped);
+  if (lastState_) {
+    record[kChanges] = stateChanges(StateDelta(lastState_, state));
+  } else {
+    record[kState] = state->toFollyDynamic();
+  }
+
+  auto line = folly::toJson(record);
+  line.push_back('\n');
+  if (folly::writeFull(file_.fd(), line.data(), line.size()) < 0) {
+    XLOG(ERR) << "Unable to record state update, generation "
+              << state->getGeneration() << ": " << folly::errnoStr(errno);
+  }
+
+  lastState_ = state;
+  lastAppliedAt_ = appliedAt;
+}
+
+std::vector<StateUpdateRecorder::RecordedUpdate> StateUpdateRecorder::readLog(
+    const std::string& filePath) {
+  std::string contents;
+  if (!folly::readFile(filePath.c_str(), contents)) {
+    throw FbossError("Unable to read state update log ", filePath);
+  }
+  std::vector<folly::StringPiece> lines;
+  folly::split('\n', contents, lines, true /* ignoreEmpty */);
+
+  std::vector<RecordedUpdate> updates;
+  updates.reserve(lines.size());
+  std::shared_ptr<SwitchState> prev;
+  for (const auto& line : lines) {
+    auto record = folly::parseJson(line);
+    std::shared_ptr<SwitchState> state;
+    if (auto changes = record.get_ptr(kChanges)) {
+      if (!prev) {
+        throw FbossError(
+            "State update log ", filePath, " does not start with a state");
+      }
+      state = applyStateChanges(prev, *changes);
+    } else {
+      state = SwitchState::fromFollyDynamic(record[kState]);
+    }
+    state->publish();
+    updates.push_back(
+        {microseconds(record[kDelayUs].asInt()),
+         microseconds(record[kHwDurationUs].asInt()),
+         state});
+    prev = std::move(state);
+  }
+  return updates;
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/File.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace facebook::fboss {
+
+class SwitchState;
+
+/*
+ * StateUpdateRecorder writes the sequence of switch states applied to
+ * hardware to a log, with their timing, so that the same sequence of
+ * StateDeltas can be replayed offline against any HwSwitch implementation.
+ *
+ * The log has one JSON record per line. The first record has the complete
+ * switch state, every following record only has the nodes (ports, routes,
+ * neighbor entries...) added, changed or removed since the previous record,
+ * found by walking the StateDelta between the two states. Serialization
+ * happens on the recorder's own thread, so recording only costs the update
+ * thread a shared_ptr copy.
+ *
+ * At most maxPendingUpdates states wait to be written. Updates past that
+ * are dropped and counted; their changes are part of the next record, which
+ * is always taken against the last state written.
+ */
+class StateUpdateRecorder {
+ public:
+  struct RecordedUpdate {
+    // Time since the previous update was applied
+    std::chrono::microseconds delay;
+    // Time the recording HwSwitch took to apply the update
+    std::chrono::microseconds hwDuration;
+    std::shared_ptr<SwitchState> state;
+  };
+
+  StateUpdateRecorder(const std::string& filePath, size_t maxPendingUpdates);
+  ~StateUpdateRecorder();
+
+  /*
+   * Record a newly applied state. state must be published.
+   */
+  void recordUpdate(
+      std::shared_ptr<SwitchState> state,
+      std::chrono::microseconds hwDuration);
+
+  /*
+   * Wait for all updates recorded so far to be written to the log.
+   */
+  void flush();
+
+  /*
+   * Number of updates dropped because the recorder fell behind.
+   */
+  uint64_t droppedUpdates() const {
+    return droppedUpdates_.load();
+  }
+
+  /*
+   * Read back a log written by StateUpdateRecorder. Nodes which did not
+   * change between successive states are shared between them, same as in
+   * the agent, so StateDeltas between the returned states only have the
+   * recorded changes.
+   */
+  static std::vector<RecordedUpdate> readLog(const std::string& filePath);
+
+ private:
+  void writeRecord(
+      const std::shared_ptr<SwitchState>& state,
+      std::chrono::steady_clock::time_point appliedAt,
+      std::chrono::microseconds hwDuration,
+      uint64_t skipped);
+
+  folly::File file_;
+  const size_t maxPendingUpdates_;
+  std::atomic<size_t> pendingUpdates_{0};
+  std::atomic<uint64_t> droppedUpdates_{0};
+  // Updates dropped since the last one queued, accessed from the thread
+  // calling recordUpdate() only
+  uint64_t skippedUpdates_{0};
+  // Accessed from the recorder thread only
+  std::shared_ptr<SwitchState> lastState_;
+  std::optional<std::chrono::steady_clock::time_point> lastAppliedAt_;
+  // Destroyed first, so queued records finish writing
+  folly::ScopedEventBaseThread recordThread_{"StateUpdateRecorder"};
+};
+
+} // namespace facebook::fboss
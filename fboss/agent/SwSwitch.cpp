@@ -14,6 +14,7 @@
 #include "fboss/agent/ApplyThriftConfig.h"
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/Constants.h"
+#include "fboss/agent/CpuPacketScheduler.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/FbossHwUpdateError.h"
 #include "fboss/agent/HwSwitch.h"
@@ -31,6 +32,7 @@
 #include "fboss/agent/MacTableManager.h"
 #include "fboss/agent/MirrorManager.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/ParsedPacketMeta.h"
 #include "fboss/agent/Platform.h"
 #include "fboss/agent/PortStats.h"
 #include "fboss/agent/PortUpdateHandler.h"
@@ -39,6 +41,7 @@
 #include "fboss/agent/RestartTimeTracker.h"
 #include "fboss/agent/RouteUpdateLogger.h"
 #include "fboss/agent/RxPacket.h"
+#include "fboss/agent/StateUpdateRecorder.h"
 #include "fboss/agent/StaticL2ForNeighborObserver.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/ThriftHandler.h"
@@ -59,6 +62,7 @@
 #include "fboss/agent/state/SwitchState.h"
 
 #include <fb303/ServiceData.h>
+#include <fb303/ThreadCachedServiceData.h>
 #include <folly/Demangle.h>
 #include <folly/FileUtil.h>
 #include <folly/GLog.h>
@@ -112,6 +116,19 @@ DEFINE_bool(
     false,
     "Flag to turn on logging of all updates to the FIB");
 
+DEFINE_string(
+    record_state_updates_file,
+    "",
+    "File to record every switch state applied to hardware in, for offline "
+    "replay with state_update_replay_benchmark. Empty disables recording");
+
+DEFINE_uint32(
+    record_state_updates_max_pending,
+    64,
+    "Maximum number of state updates waiting to be written to "
+    "--record_state_updates_file. Updates past that are dropped, and their "
+    "changes recorded with the next update written");
+
 namespace {
 
 /**
@@ -166,6 +183,7 @@ SwSwitch::SwSwitch(std::unique_ptr<Platform> platform)
       arp_(new ArpHandler(this)),
       ipv4_(new IPv4Handler(this)),
       ipv6_(new IPv6Handler(this)),
+      cpuPacketScheduler_(new CpuPacketScheduler()),
       nUpdater_(new NeighborUpdater(this)),
       pcapMgr_(new PktCaptureManager(this)),
       mirrorManager_(new MirrorManager(this)),
@@ -356,10 +374,18 @@ void SwSwitch::updateLldpStats() {
   stats()->LldpNeighborsSize(lldpManager_->getDB()->pruneExpiredNeighbors());
 }
 
+void SwSwitch::updatePortCounters() {
+  portCounters_.forEachCounterDelta(
+      [](const std::string& key, uint64_t delta) {
+        tcData().addStatValue(key, delta, fb303::SUM);
+      });
+}
+
 void SwSwitch::updateStats() {
   updateRouteStats();
   updatePortInfo();
   updateLldpStats();
+  updatePortCounters();
   try {
     getHw()->updateStats(stats());
   } catch (const std::exception& ex) {
@@ -441,6 +467,13 @@ void SwSwitch::init(std::unique_ptr<TunManager> tunMgr, SwitchFlags flags) {
   initialState->publish();
   setStateInternal(initialState);
 
+  if (!FLAGS_record_state_updates_file.empty()) {
+    stateUpdateRecorder_ = std::make_unique<StateUpdateRecorder>(
+        FLAGS_record_state_updates_file,
+        FLAGS_record_state_updates_max_pending);
+    stateUpdateRecorder_->recordUpdate(initialState, microseconds(0));
+  }
+
   if (flags & SwitchFlags::ENABLE_TUN) {
     if (tunMgr) {
       tunMgr_ = std::move(tunMgr);
@@ -906,6 +939,7 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
   // take a non-trivial amount of time, and blocking other users seems
   // undesirable.  So far I don't think this brief discrepancy should cause
   // major issues.
+  auto hwStart = std::chrono::steady_clock::now();
   try {
     newAppliedState = isTransaction ? hw_->stateChangedTransaction(delta)
                                     : hw_->stateChanged(delta);
@@ -922,6 +956,13 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
                 << folly::exceptionStr(ex);
   }
 
+  if (stateUpdateRecorder_) {
+    stateUpdateRecorder_->recordUpdate(
+        newAppliedState,
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - hwStart));
+  }
+
   setStateInternal(newAppliedState);
 
   // Notifies all observers of the current state update.
@@ -991,7 +1032,7 @@ PortStatus SwSwitch::getPortStatus(PortID portID) {
 }
 
 SwitchStats* SwSwitch::createSwitchStats() {
-  SwitchStats* s = new SwitchStats();
+  SwitchStats* s = new SwitchStats(&portCounters_);
   stats_.reset(s);
   return s;
 }
@@ -1031,8 +1072,9 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
     XLOG(DBG3) << "Dropping received packets received on UNINITIALIZED switch";
     return;
   }
-  PortID port = pkt->getSrcPort();
-  portStats(port)->trappedPkt();
+  // Look up the ingress port stats once, handlers get them through meta
+  auto ingressStats = portStats(pkt->getSrcPort());
+  ingressStats->trappedPkt();
 
   pcapMgr_->packetReceived(pkt.get());
 
@@ -1040,19 +1082,23 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
   // Abort processing early if the packet is too short.
   auto len = pkt->getLength();
   if (len < 64) {
-    portStats(port)->pktBogus();
+    ingressStats->pktBogus();
     return;
   }
 
-  // Parse the source and destination MAC, as well as the ethertype.
-  Cursor c(pkt->buf());
-  auto dstMac = PktUtil::readMac(&c);
-  auto srcMac = PktUtil::readMac(&c);
-  auto ethertype = c.readBE<uint16_t>();
-  if (ethertype == 0x8100) {
-    // 802.1Q
-    c += 2; // Advance over the VLAN tag.  We ignore it for now
-    ethertype = c.readBE<uint16_t>();
+  // Parse the headers in a single pass, handlers reuse the result rather
+  // than parsing the packet again.
+  auto meta = ParsedPacketMeta::parse(pkt.get(), ingressStats);
+
+  if (cpuPacketScheduler_->enabled()) {
+    auto packetClass =
+        CpuPacketScheduler::classify(meta, *getState()->getInterfaces());
+    if (!cpuPacketScheduler_->admit(packetClass, meta.port)) {
+      stats()->cpuPacketDropped(packetClass);
+      ingressStats->pktDropped();
+      return;
+    }
+    stats()->cpuPacketAdmitted(packetClass);
   }
 
   XLOG(DBG5) << "trapped packet: src_port=" << pkt->getSrcPort()
@@ -1061,37 +1107,39 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
                      ? folly::to<string>(pkt->getSrcAggregatePort())
                      : "None")
              << " vlan=" << pkt->getSrcVlan() << " length=" << len
-             << " src=" << srcMac << " dst=" << dstMac << " ethertype=0x"
-             << std::hex << ethertype << " :: " << pkt->describeDetails();
+             << " src=" << meta.srcMac << " dst=" << meta.dstMac
+             << " ethertype=0x" << std::hex << meta.etherType
+             << " :: " << pkt->describeDetails();
 
-  switch (ethertype) {
+  switch (meta.etherType) {
     case ArpHandler::ETHERTYPE_ARP:
-      arp_->handlePacket(std::move(pkt), dstMac, srcMac, c);
+      arp_->handlePacket(std::move(pkt), meta);
       return;
     case LldpManager::ETHERTYPE_LLDP:
       if (lldpManager_) {
-        lldpManager_->handlePacket(std::move(pkt), dstMac, srcMac, c);
+        lldpManager_->handlePacket(std::move(pkt), meta);
         return;
       }
       break;
 #if FOLLY_HAS_COROUTINES
     case MKAServiceManager::ETHERTYPE_EAPOL:
       if (mkaServiceManager_) {
-        portStats(port)->MkPduRecvdPkt();
+        ingressStats->MkPduRecvdPkt();
         mkaServiceManager_->handlePacket(std::move(pkt));
         return;
       }
       break;
 #endif
     case IPv4Handler::ETHERTYPE_IPV4:
-      ipv4_->handlePacket(std::move(pkt), dstMac, srcMac, c);
+      ipv4_->handlePacket(std::move(pkt), meta);
       return;
     case IPv6Handler::ETHERTYPE_IPV6:
-      ipv6_->handlePacket(std::move(pkt), dstMac, srcMac, c);
+      ipv6_->handlePacket(std::move(pkt), meta);
       return;
     case LACPDU::EtherType::SLOW_PROTOCOLS: {
       // The only supported protocol in the Ethernet suite's "Slow Protocols"
       // is the Link Aggregation Control Protocol
+      auto c = meta.l3Cursor(pkt.get());
       auto subtype = c.readBE<uint8_t>();
       if (subtype == LACPDU::EtherSubtype::LACP) {
         if (lagManager_) {
@@ -1112,7 +1160,7 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
 
   // If we are still here, we don't know what to do with this packet.
   // Increment a counter and just drop the packet on the floor.
-  portStats(port)->pktUnhandled();
+  ingressStats->pktUnhandled();
 }
 
 void SwSwitch::linkStateChanged(PortID portId, bool up) {
@@ -1361,6 +1409,22 @@ void SwSwitch::sendPacketSwitchedAsync(std::unique_ptr<TxPacket> pkt) noexcept {
   }
 }
 
+void SwSwitch::sendPacketsSwitchedAsync(
+    std::vector<std::unique_ptr<TxPacket>> pkts) noexcept {
+  if (pkts.empty()) {
+    return;
+  }
+  for (const auto& pkt : pkts) {
+    pcapMgr_->packetSent(pkt.get());
+  }
+  auto numPkts = pkts.size();
+  if (!hw_->sendPacketsSwitchedAsync(std::move(pkts))) {
+    // As in sendPacketSwitchedAsync(), only log an error
+    XLOG(ERR) << "failed to send some of " << numPkts
+              << " L2 switched packets";
+  }
+}
+
 void SwSwitch::sendL3Packet(
     std::unique_ptr<TxPacket> pkt,
     std::optional<InterfaceID> maybeIfID) noexcept {
@@ -1370,6 +1434,38 @@ void SwSwitch::sendL3Packet(
     return;
   }
 
+  if (prepareL3Packet(pkt.get(), maybeIfID, getState())) {
+    sendPacketSwitchedAsync(std::move(pkt));
+  }
+}
+
+void SwSwitch::sendL3Packets(
+    std::vector<std::unique_ptr<TxPacket>> pkts,
+    std::optional<InterfaceID> maybeIfID) noexcept {
+  if (!isFullyInitialized()) {
+    XLOG(INFO) << " Dropping " << pkts.size()
+               << " L3 packets since device not yet initialized";
+    for (size_t i = 0; i < pkts.size(); ++i) {
+      stats()->pktDropped();
+    }
+    return;
+  }
+
+  auto state = getState();
+  std::vector<std::unique_ptr<TxPacket>> burst;
+  burst.reserve(pkts.size());
+  for (auto& pkt : pkts) {
+    if (prepareL3Packet(pkt.get(), maybeIfID, state)) {
+      burst.push_back(std::move(pkt));
+    }
+  }
+  sendPacketsSwitchedAsync(std::move(burst));
+}
+
+bool SwSwitch::prepareL3Packet(
+    TxPacket* pkt,
+    std::optional<InterfaceID> maybeIfID,
+    const std::shared_ptr<SwitchState>& state) noexcept {
   // Buffer should not be shared.
   folly::IOBuf* buf = pkt->buf();
   CHECK(!buf->isShared());
@@ -1386,11 +1482,9 @@ void SwSwitch::sendL3Packet(
               << " required=" << l2Len << ", tailroom=" << buf->tailroom()
               << " required=" << tailRoom;
     stats()->pktError();
-    return;
+    return false;
   }
 
-  auto state = getState();
-
   // Get VlanID associated with interface
   VlanID vlanID = getCPUVlan();
   if (maybeIfID.has_value()) {
@@ -1398,7 +1492,7 @@ void SwSwitch::sendL3Packet(
     if (!intf) {
       XLOG(ERR) << "Interface " << *maybeIfID << " doesn't exists in state.";
       stats()->pktDropped();
-      return;
+      return false;
     }
 
     // Extract primary Vlan associated with this interface
@@ -1508,9 +1602,10 @@ void SwSwitch::sendL3Packet(
     // the packet out to the HW. The HW will drop the packet if the vlan is
     // deleted.
     stats()->pktFromHost(l3Len);
-    sendPacketSwitchedAsync(std::move(pkt));
+    return true;
   } catch (const std::exception& ex) {
     XLOG(ERR) << "Failed to send out L3 packet :" << folly::exceptionStr(ex);
+    return false;
   }
 }
 
@@ -1538,6 +1633,8 @@ void SwSwitch::applyConfig(const std::string& reason, bool reload) {
         if (newState && !isValidStateUpdate(StateDelta(state, newState))) {
           throw FbossError("Invalid config passed in, skipping");
         }
+        cpuPacketScheduler_->setConfig(
+            *target->thrift.cpuPacketScheduler_ref());
 
         // Update config cached in SwSwitch. Update this even if the config did
         // not change (as this might be during warmboot).
@@ -1647,6 +1744,33 @@ template std::shared_ptr<Route<folly::IPAddressV6>> SwSwitch::longestMatch(
     const folly::IPAddressV6& address,
     RouterID vrf);
 
+template <typename AddressT>
+std::vector<std::shared_ptr<Route<AddressT>>> SwSwitch::longestMatch(
+    std::shared_ptr<SwitchState> state,
+    folly::Range<const AddressT*> addresses,
+    RouterID vrf) {
+  if (isStandaloneRibEnabled()) {
+    auto fibContainer = state->getFibs()->getFibContainer(vrf);
+
+    return fibContainer->getFib<AddressT>()->longestMatch(addresses);
+  } else {
+    auto routeTable = state->getRouteTables()->getRouteTable(vrf);
+
+    return routeTable->getRib<AddressT>()->longestMatch(addresses);
+  }
+}
+
+template std::vector<std::shared_ptr<Route<folly::IPAddressV4>>>
+SwSwitch::longestMatch(
+    std::shared_ptr<SwitchState> state,
+    folly::Range<const folly::IPAddressV4*> addresses,
+    RouterID vrf);
+template std::vector<std::shared_ptr<Route<folly::IPAddressV6>>>
+SwSwitch::longestMatch(
+    std::shared_ptr<SwitchState> state,
+    folly::Range<const folly::IPAddressV6*> addresses,
+    RouterID vrf);
+
 void SwSwitch::l2LearningUpdateReceived(
     L2Entry l2Entry,
     L2EntryUpdateType l2EntryUpdateType) {
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/PortCounterSlab.h"
 #include "fboss/agent/ThreadHeartbeat.h"
 #include "fboss/agent/Utils.h"
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
@@ -34,6 +35,7 @@
 namespace facebook::fboss {
 
 class ArpHandler;
+class CpuPacketScheduler;
 class IPv4Handler;
 class IPv6Handler;
 class LinkAggregationManager;
@@ -59,6 +61,7 @@ class MacTableManager;
 class ResolvedNexthopMonitor;
 class ResolvedNexthopProbeScheduler;
 class StaticL2ForNeighborObserver;
+class StateUpdateRecorder;
 class MKAServiceManager;
 
 enum class SwitchFlags : int {
@@ -181,6 +184,7 @@ class SwSwitch : public HwSwitch::Callback {
   bool isExiting() const;
 
   void updateLldpStats();
+  void updatePortCounters();
 
   void updateStats();
 
@@ -338,6 +342,14 @@ class SwSwitch : public HwSwitch::Callback {
     return stats_.accessAllThreads();
   }
 
+  /*
+   * Per port counters of all threads. Unlike getAllThreadsSwitchStats(),
+   * reading these does not lock out threads creating their SwitchStats.
+   */
+  PortCounterRegistry* getPortCounters() {
+    return &portCounters_;
+  }
+
   /*
    * Construct and destroy a client to dump packets to the packet distribution
    * service.
@@ -478,6 +490,13 @@ class SwSwitch : public HwSwitch::Callback {
    */
   void sendPacketSwitchedAsync(std::unique_ptr<TxPacket> pkt) noexcept;
 
+  /*
+   * Send a burst of packets as done by sendPacketSwitchedAsync(), in one call
+   * to the HwSwitch.
+   */
+  void sendPacketsSwitchedAsync(
+      std::vector<std::unique_ptr<TxPacket>> pkts) noexcept;
+
   /**
    * Send out L3 packet through HW
    *
@@ -502,6 +521,14 @@ class SwSwitch : public HwSwitch::Callback {
       std::unique_ptr<TxPacket> pkt,
       std::optional<InterfaceID> ifID = std::nullopt) noexcept;
 
+  /**
+   * Send out a burst of L3 packets as done by sendL3Packet(). The packets
+   * are sent with a single sendPacketsSwitchedAsync() call.
+   */
+  void sendL3Packets(
+      std::vector<std::unique_ptr<TxPacket>> pkts,
+      std::optional<InterfaceID> ifID = std::nullopt) noexcept;
+
   /**
    * method to send out a packet from HW to host.
    *
@@ -584,6 +611,10 @@ class SwSwitch : public HwSwitch::Callback {
     return lookupClassRouteUpdater_.get();
   }
 
+  MirrorManager* getMirrorManager() {
+    return mirrorManager_.get();
+  }
+
   rib::RoutingInformationBase* getRib() {
     DCHECK(isStandaloneRibEnabled());
     return rib_.get();
@@ -665,6 +696,16 @@ class SwSwitch : public HwSwitch::Callback {
       const AddressT& address,
       RouterID vrf);
 
+  /*
+   * Batch longestMatch for callers looking up many addresses at once, the
+   * routes are returned in the same order as addresses.
+   */
+  template <typename AddressT>
+  std::vector<std::shared_ptr<Route<AddressT>>> longestMatch(
+      std::shared_ptr<SwitchState> state,
+      folly::Range<const AddressT*> addresses,
+      RouterID vrf);
+
   ResolvedNexthopProbeScheduler* getResolvedNexthopProbeScheduler() {
     return resolvedNexthopProbeScheduler_.get();
   }
@@ -706,6 +747,15 @@ class SwSwitch : public HwSwitch::Callback {
   SwitchStats* createSwitchStats();
   void handlePacket(std::unique_ptr<RxPacket> pkt);
 
+  /*
+   * Prepend the L2 header to an L3 packet for sendL3Packet(). Returns false
+   * if the packet has to be dropped.
+   */
+  bool prepareL3Packet(
+      TxPacket* pkt,
+      std::optional<InterfaceID> maybeIfID,
+      const std::shared_ptr<SwitchState>& state) noexcept;
+
   static void handlePendingUpdatesHelper(SwSwitch* sw);
   void handlePendingUpdates();
   std::shared_ptr<SwitchState> applyUpdate(
@@ -758,6 +808,8 @@ class SwSwitch : public HwSwitch::Callback {
   HwSwitch* hw_;
   std::unique_ptr<Platform> platform_;
   std::atomic<SwitchRunState> runState_{SwitchRunState::UNINITIALIZED};
+  // Must outlive stats_, SwitchStats release their slab on destruction
+  PortCounterRegistry portCounters_;
   folly::ThreadLocalPtr<SwitchStats, SwSwitch> stats_;
   /**
    * The object to sync the interfaces to the system. This pointer could
@@ -851,6 +903,7 @@ class SwSwitch : public HwSwitch::Callback {
   std::unique_ptr<ArpHandler> arp_;
   std::unique_ptr<IPv4Handler> ipv4_;
   std::unique_ptr<IPv6Handler> ipv6_;
+  std::unique_ptr<CpuPacketScheduler> cpuPacketScheduler_;
   std::unique_ptr<NeighborUpdater> nUpdater_;
   std::unique_ptr<PktCaptureManager> pcapMgr_;
   std::unique_ptr<MirrorManager> mirrorManager_;
@@ -869,6 +922,7 @@ class SwSwitch : public HwSwitch::Callback {
   std::unique_ptr<LookupClassRouteUpdater> lookupClassRouteUpdater_;
   std::unique_ptr<StaticL2ForNeighborObserver> staticL2ForNeighborObserver_;
   std::unique_ptr<MacTableManager> macTableManager_;
+  std::unique_ptr<StateUpdateRecorder> stateUpdateRecorder_;
 #if FOLLY_HAS_COROUTINES
   std::unique_ptr<MKAServiceManager> mkaServiceManager_;
 #endif
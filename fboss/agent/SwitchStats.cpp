@@ -21,10 +21,16 @@ namespace facebook::fboss {
 // set to empty string, we'll prepend prefix when fbagent collects counters
 std::string SwitchStats::kCounterPrefix = "";
 
-SwitchStats::SwitchStats()
-    : SwitchStats(fb303::ThreadCachedServiceData::get()->getThreadStats()) {}
+SwitchStats::SwitchStats() : SwitchStats(nullptr) {}
 
-SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
+SwitchStats::SwitchStats(PortCounterRegistry* portCounters)
+    : SwitchStats(
+          fb303::ThreadCachedServiceData::get()->getThreadStats(),
+          portCounters) {}
+
+SwitchStats::SwitchStats(
+    ThreadLocalStatsMap* map,
+    PortCounterRegistry* portCounters)
     : trapPkts_(map, kCounterPrefix + "trapped.pkts", SUM, RATE),
       trapPktDrops_(map, kCounterPrefix + "trapped.drops", SUM, RATE),
       trapPktBogus_(map, kCounterPrefix + "trapped.bogus", SUM, RATE),
@@ -52,6 +58,11 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
       ipv4NoArp_(map, kCounterPrefix + "ipv4.no_arp", SUM, RATE),
       ipv4TtlExceeded_(map, kCounterPrefix + "ipv4.ttl_exceeded", SUM, RATE),
       ipv6HopExceeded_(map, kCounterPrefix + "ipv6.hop_exceeded", SUM, RATE),
+      icmpErrorSuppressed_(
+          map,
+          kCounterPrefix + "icmp.error.suppressed",
+          SUM,
+          RATE),
       udpTooSmall_(map, kCounterPrefix + "udp.too_small", SUM, RATE),
       dhcpV4Pkt_(map, kCounterPrefix + "dhcpV4.pkt", SUM, RATE),
       dhcpV4BadPkt_(map, kCounterPrefix + "dhcpV4.bad_pkt", SUM, RATE),
@@ -170,6 +181,39 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           AVG,
           50,
           100),
+      arpBatchSize_(
+          map,
+          kCounterPrefix + "arp.batch_size",
+          16,
+          0,
+          4096,
+          AVG,
+          50,
+          100),
+      ndpBatchSize_(
+          map,
+          kCounterPrefix + "ndp.batch_size",
+          16,
+          0,
+          4096,
+          AVG,
+          50,
+          100),
+      l2LearningEvents_(map, kCounterPrefix + "l2.learning.events", SUM, RATE),
+      l2LearningUpdates_(
+          map,
+          kCounterPrefix + "l2.learning.updates",
+          SUM,
+          RATE),
+      l2LearningEventsPerUpdate_(
+          map,
+          kCounterPrefix + "l2.learning.events_per_update",
+          16,
+          0,
+          4096,
+          AVG,
+          50,
+          100),
       linkStateChange_(map, kCounterPrefix + "link_state.flap", SUM),
       pcapDistFailure_(map, kCounterPrefix + "pcap_dist_failure.error"),
       updateStatsExceptions_(
@@ -177,6 +221,46 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           kCounterPrefix + "update_stats_exceptions",
           SUM),
       trapPktTooBig_(map, kCounterPrefix + "trapped.packet_too_big", SUM, RATE),
+      cpuSchedHighAdmitted_(
+          map,
+          kCounterPrefix + "cpu_sched.high.admitted",
+          SUM,
+          RATE),
+      cpuSchedHighDrops_(
+          map,
+          kCounterPrefix + "cpu_sched.high.drops",
+          SUM,
+          RATE),
+      cpuSchedNeighborAdmitted_(
+          map,
+          kCounterPrefix + "cpu_sched.neighbor.admitted",
+          SUM,
+          RATE),
+      cpuSchedNeighborDrops_(
+          map,
+          kCounterPrefix + "cpu_sched.neighbor.drops",
+          SUM,
+          RATE),
+      cpuSchedTtlExpiredAdmitted_(
+          map,
+          kCounterPrefix + "cpu_sched.ttl_expired.admitted",
+          SUM,
+          RATE),
+      cpuSchedTtlExpiredDrops_(
+          map,
+          kCounterPrefix + "cpu_sched.ttl_expired.drops",
+          SUM,
+          RATE),
+      cpuSchedDefaultAdmitted_(
+          map,
+          kCounterPrefix + "cpu_sched.default.admitted",
+          SUM,
+          RATE),
+      cpuSchedDefaultDrops_(
+          map,
+          kCounterPrefix + "cpu_sched.default.drops",
+          SUM,
+          RATE),
       LldpRecvdPkt_(map, kCounterPrefix + "lldp.recvd", SUM, RATE),
       LldpBadPkt_(map, kCounterPrefix + "lldp.recv_bad", SUM, RATE),
       LldpValidateMisMatch_(
@@ -216,7 +300,19 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           map,
           kCounterPrefix + "mka_service.recvd",
           SUM,
-          RATE) {}
+          RATE),
+      portCounters_(portCounters) {}
+
+SwitchStats::~SwitchStats() {
+  if (portCounterSlab_) {
+    portCounters_->releaseSlab(portCounterSlab_);
+  }
+}
+
+void SwitchStats::refreshPortCounterSlab() {
+  portCounterGeneration_ = portCounters_->generation();
+  portCounterSlab_ = portCounters_->refreshSlab(portCounterSlab_);
+}
 
 PortStats* FOLLY_NULLABLE SwitchStats::port(PortID portID) {
   auto it = ports_.find(portID);
@@ -243,6 +339,40 @@ PortStats* SwitchStats::createPortStats(PortID portID, std::string portName) {
   return it->second.get();
 }
 
+void SwitchStats::cpuPacketAdmitted(cfg::CpuPacketClass packetClass) {
+  switch (packetClass) {
+    case cfg::CpuPacketClass::HIGH:
+      cpuSchedHighAdmitted_.addValue(1);
+      break;
+    case cfg::CpuPacketClass::NEIGHBOR:
+      cpuSchedNeighborAdmitted_.addValue(1);
+      break;
+    case cfg::CpuPacketClass::TTL_EXPIRED:
+      cpuSchedTtlExpiredAdmitted_.addValue(1);
+      break;
+    case cfg::CpuPacketClass::DEFAULT:
+      cpuSchedDefaultAdmitted_.addValue(1);
+      break;
+  }
+}
+
+void SwitchStats::cpuPacketDropped(cfg::CpuPacketClass packetClass) {
+  switch (packetClass) {
+    case cfg::CpuPacketClass::HIGH:
+      cpuSchedHighDrops_.addValue(1);
+      break;
+    case cfg::CpuPacketClass::NEIGHBOR:
+      cpuSchedNeighborDrops_.addValue(1);
+      break;
+    case cfg::CpuPacketClass::TTL_EXPIRED:
+      cpuSchedTtlExpiredDrops_.addValue(1);
+      break;
+    case cfg::CpuPacketClass::DEFAULT:
+      cpuSchedDefaultDrops_.addValue(1);
+      break;
+  }
+}
+
 AggregatePortStats* SwitchStats::createAggregatePortStats(
     AggregatePortID id,
     std::string name) {
@@ -12,9 +12,12 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/noncopyable.hpp>
 #include <fb303/ThreadCachedServiceData.h>
+#include <glog/logging.h>
 #include <chrono>
 #include "fboss/agent/AggregatePortStats.h"
+#include "fboss/agent/PortCounterSlab.h"
 #include "fboss/agent/PortStats.h"
+#include "fboss/agent/gen-cpp2/agent_config_types.h"
 #include "fboss/agent/types.h"
 
 namespace facebook::fboss {
@@ -33,7 +36,16 @@ class SwitchStats : public boost::noncopyable {
    */
   static std::string kCounterPrefix;
 
+  /*
+   * Without a port counter registry, for users which never count per port,
+   * e.g. hardware stats collection in tests.
+   */
   SwitchStats();
+  /*
+   * Also count per port counters, in a slab registered with portCounters
+   */
+  explicit SwitchStats(PortCounterRegistry* portCounters);
+  ~SwitchStats();
 
   /*
    * Return the PortStats object for the given PortID.
@@ -63,6 +75,20 @@ class SwitchStats : public boost::noncopyable {
     ports_.erase(portID);
   }
 
+  /*
+   * Increment a per port counter. This is an array index and a relaxed
+   * store, the slab is only rebuilt after ports are added or removed.
+   * Requires a port counter registry.
+   */
+  void portCounter(PortID port, PortCounter counter, uint64_t value = 1) {
+    DCHECK(portCounters_) << "SwitchStats built without a port counter "
+                          << "registry can not count per port";
+    if (UNLIKELY(portCounterGeneration_ != portCounters_->generation())) {
+      refreshPortCounterSlab();
+    }
+    portCounterSlab_->add(port, counter, value);
+  }
+
   void trappedPkt() {
     trapPkts_.addValue(1);
   }
@@ -160,6 +186,10 @@ class SwitchStats : public boost::noncopyable {
     ipv6HopExceeded_.addValue(1);
   }
 
+  void icmpErrorSuppressed() {
+    icmpErrorSuppressed_.addValue(1);
+  }
+
   void udpTooSmall() {
     udpTooSmall_.addValue(1);
   }
@@ -274,6 +304,23 @@ class SwitchStats : public boost::noncopyable {
     neighborCacheEventBacklog_.addValue(value);
   }
 
+  void arpBatchSize(int value) {
+    arpBatchSize_.addValue(value);
+  }
+
+  void ndpBatchSize(int value) {
+    ndpBatchSize_.addValue(value);
+  }
+
+  void l2LearningEvent() {
+    l2LearningEvents_.addValue(1);
+  }
+
+  void l2LearningUpdate(int events) {
+    l2LearningUpdates_.addValue(1);
+    l2LearningEventsPerUpdate_.addValue(events);
+  }
+
   void linkStateChange() {
     linkStateChange_.addValue(1);
   }
@@ -290,6 +337,9 @@ class SwitchStats : public boost::noncopyable {
     trapPktTooBig_.addValue(1);
   }
 
+  void cpuPacketAdmitted(cfg::CpuPacketClass packetClass);
+  void cpuPacketDropped(cfg::CpuPacketClass packetClass);
+
   void LldpRecvdPkt() {
     LldpRecvdPkt_.addValue(1);
   }
@@ -342,7 +392,9 @@ class SwitchStats : public boost::noncopyable {
   typedef fb303::ThreadCachedServiceData::TLHistogram TLHistogram;
   typedef fb303::ThreadCachedServiceData::TLCounter TLCounter;
 
-  explicit SwitchStats(ThreadLocalStatsMap* map);
+  SwitchStats(ThreadLocalStatsMap* map, PortCounterRegistry* portCounters);
+
+  void refreshPortCounterSlab();
 
   // Total number of trapped packets
   TLTimeseries trapPkts_;
@@ -403,6 +455,9 @@ class SwitchStats : public boost::noncopyable {
   // IPv6 hop count exceeded
   TLTimeseries ipv6HopExceeded_;
 
+  // ICMP errors not sent because of the ICMP error rate limit
+  TLTimeseries icmpErrorSuppressed_;
+
   // UDP packets dropped due to smaller packet size
   TLTimeseries udpTooSmall_;
 
@@ -489,6 +544,20 @@ class SwitchStats : public boost::noncopyable {
    */
   TLHistogram neighborCacheEventBacklog_;
 
+  /**
+   * Number of neighbor entries programmed by each batched ARP/NDP update
+   */
+  TLHistogram arpBatchSize_;
+  TLHistogram ndpBatchSize_;
+
+  /**
+   * L2 learn/age events received from the HwSwitch, and the state updates
+   * applying them. The events per update histogram is the coalescing ratio.
+   */
+  TLTimeseries l2LearningEvents_;
+  TLTimeseries l2LearningUpdates_;
+  TLHistogram l2LearningEventsPerUpdate_;
+
   /**
    * Link state up/down change count
    */
@@ -508,6 +577,16 @@ class SwitchStats : public boost::noncopyable {
   // Number of packet too big ICMPv6 triggered
   TLTimeseries trapPktTooBig_;
 
+  // Trapped packets admitted/dropped by the CPU packet scheduler, per class
+  TLTimeseries cpuSchedHighAdmitted_;
+  TLTimeseries cpuSchedHighDrops_;
+  TLTimeseries cpuSchedNeighborAdmitted_;
+  TLTimeseries cpuSchedNeighborDrops_;
+  TLTimeseries cpuSchedTtlExpiredAdmitted_;
+  TLTimeseries cpuSchedTtlExpiredDrops_;
+  TLTimeseries cpuSchedDefaultAdmitted_;
+  TLTimeseries cpuSchedDefaultDrops_;
+
   // Number of LLDP packets.
   TLTimeseries LldpRecvdPkt_;
   // Number of bad LLDP packets.
@@ -535,6 +614,11 @@ class SwitchStats : public boost::noncopyable {
   TLTimeseries MKAServiceSendSuccess_;
   // Number of pkts recvd from MkaService.
   TLTimeseries MKAServiceRecvSuccess_;
+
+  // Per port counters of this thread, exported by PortCounterRegistry
+  PortCounterRegistry* portCounters_{nullptr};
+  std::shared_ptr<PortCounterSlab> portCounterSlab_;
+  uint64_t portCounterGeneration_{std::numeric_limits<uint64_t>::max()};
 };
 
 } // namespace facebook::fboss
@@ -521,6 +521,22 @@ void translateToFibError(const FbossHwUpdateError& updError) {
       });
   throw fibError;
 }
+
+// Fill the getIpRoute(s) result for the route matching an address
+template <typename AddrT>
+void fillIpRoute(
+    UnicastRoute& route,
+    const std::shared_ptr<Route<AddrT>>& match) {
+  if (!match || !match->isResolved()) {
+    route.dest.ip = toBinaryAddress(AddrT());
+    route.dest.prefixLength = 0;
+    return;
+  }
+  const auto fwdInfo = match->getForwardInfo();
+  route.dest.ip = toBinaryAddress(match->prefix().network);
+  route.dest.prefixLength = match->prefix().mask;
+  *route.nextHopAddrs_ref() = util::fromFwdNextHops(fwdInfo.getNextHopSet());
+}
 } // namespace
 
 namespace facebook::fboss {
@@ -1376,27 +1392,47 @@ void ThriftHandler::getIpRoute(
 
   auto state = sw_->getState();
   if (ipAddr.isV4()) {
-    auto match = sw_->longestMatch(state, ipAddr.asV4(), RouterID(vrfId));
-    if (!match || !match->isResolved()) {
-      route.dest.ip = toBinaryAddress(IPAddressV4("0.0.0.0"));
-      route.dest.prefixLength = 0;
-      return;
-    }
-    const auto fwdInfo = match->getForwardInfo();
-    route.dest.ip = toBinaryAddress(match->prefix().network);
-    route.dest.prefixLength = match->prefix().mask;
-    *route.nextHopAddrs_ref() = util::fromFwdNextHops(fwdInfo.getNextHopSet());
+    fillIpRoute(
+        route, sw_->longestMatch(state, ipAddr.asV4(), RouterID(vrfId)));
   } else {
-    auto match = sw_->longestMatch(state, ipAddr.asV6(), RouterID(vrfId));
-    if (!match || !match->isResolved()) {
-      route.dest.ip = toBinaryAddress(IPAddressV6("::0"));
-      route.dest.prefixLength = 0;
-      return;
+    fillIpRoute(
+        route, sw_->longestMatch(state, ipAddr.asV6(), RouterID(vrfId)));
+  }
+}
+
+void ThriftHandler::getIpRoutes(
+    std::vector<UnicastRoute>& routes,
+    std::unique_ptr<std::vector<Address>> addrs,
+    int32_t vrfId) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  ensureConfigured(__func__);
+  // Split by address family and look each family up as one batch
+  std::vector<IPAddressV4> v4Addrs;
+  std::vector<size_t> v4Indices;
+  std::vector<IPAddressV6> v6Addrs;
+  std::vector<size_t> v6Indices;
+  for (size_t i = 0; i < addrs->size(); ++i) {
+    folly::IPAddress ipAddr = toIPAddress((*addrs)[i]);
+    if (ipAddr.isV4()) {
+      v4Addrs.push_back(ipAddr.asV4());
+      v4Indices.push_back(i);
+    } else {
+      v6Addrs.push_back(ipAddr.asV6());
+      v6Indices.push_back(i);
     }
-    const auto fwdInfo = match->getForwardInfo();
-    route.dest.ip = toBinaryAddress(match->prefix().network);
-    route.dest.prefixLength = match->prefix().mask;
-    *route.nextHopAddrs_ref() = util::fromFwdNextHops(fwdInfo.getNextHopSet());
+  }
+
+  auto state = sw_->getState();
+  routes.resize(addrs->size());
+  auto v4Matches =
+      sw_->longestMatch(state, folly::crange(v4Addrs), RouterID(vrfId));
+  for (size_t i = 0; i < v4Matches.size(); ++i) {
+    fillIpRoute(routes[v4Indices[i]], v4Matches[i]);
+  }
+  auto v6Matches =
+      sw_->longestMatch(state, folly::crange(v6Addrs), RouterID(vrfId));
+  for (size_t i = 0; i < v6Matches.size(); ++i) {
+    fillIpRoute(routes[v6Indices[i]], v6Matches[i]);
   }
 }
 
@@ -1490,7 +1526,8 @@ void ThriftHandler::startPktCapture(unique_ptr<CaptureInfo> info) {
       *info->name_ref(),
       *info->maxPackets_ref(),
       *info->direction_ref(),
-      *info->filter_ref());
+      *info->filter_ref(),
+      *info->format_ref());
   mgr->startCapture(std::move(capture));
 }
 
@@ -152,6 +152,11 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
       UnicastRoute& route,
       std::unique_ptr<Address> addr,
       int32_t vrfId) override;
+  /* Returns the Ip Route for each address, in the same order */
+  void getIpRoutes(
+      std::vector<UnicastRoute>& routes,
+      std::unique_ptr<std::vector<Address>> addrs,
+      int32_t vrfId) override;
   void getIpRouteDetails(
       RouteDetails& route,
       std::unique_ptr<Address> addr,
@@ -322,6 +322,8 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
   int dropped = 0;
   uint64_t bytes = 0;
   bool fdFail = false;
+  // Packets read in one go are sent to the HwSwitch as one burst
+  std::vector<std::unique_ptr<TxPacket>> pkts;
   try {
     while (sent + dropped < kMaxSentOneTime) {
       std::unique_ptr<TxPacket> pkt;
@@ -353,7 +355,7 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
       } else {
         bytes += ret;
         buf->append(ret);
-        sw_->sendL3Packet(std::move(pkt), ifID_);
+        pkts.push_back(std::move(pkt));
         ++sent;
       }
     } // while
@@ -361,6 +363,7 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
     XLOG_EVERY_MS(ERR, 1000) << "Hit some error when forwarding packets :"
                              << folly::exceptionStr(ex);
   }
+  sw_->sendL3Packets(std::move(pkts), ifID_);
 
   if (fdFail) {
     unregisterHandler();
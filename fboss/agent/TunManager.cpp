@@ -18,6 +18,7 @@ extern "C" {
 #include <sys/ioctl.h>
 }
 
+#include <folly/Conv.h>
 #include <folly/MapUtil.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/lang/CString.h>
@@ -33,6 +34,8 @@ extern "C" {
 
 #include <boost/container/flat_set.hpp>
 
+#include <utility>
+
 namespace {
 const int kDefaultMtu = 1500;
 }
@@ -52,6 +55,7 @@ TunManager::TunManager(SwSwitch* sw, EventBase* evb) : sw_(sw), evb_(evb) {
   }
   auto error = nl_connect(sock_, NETLINK_ROUTE);
   nlCheckError(error, "failed to connect netlink socket to NETLINK_ROUTE");
+  batch_ = std::make_unique<NetlinkBatch>(sock_);
 }
 
 TunManager::~TunManager() {
@@ -81,8 +85,23 @@ void TunManager::stateUpdated(const StateDelta& delta) {
   // SwSwitch is in the configured state. t4155406 should also help
   // with that.
 
-  auto state = delta.newState();
-  evb_->runInEventBaseThread([this, state]() { this->sync(state); });
+  // Only the latest state matters. If a sync is already scheduled it will
+  // pick up this state, so a burst of updates results in a single sync.
+  bool syncScheduled = false;
+  pendingState_.withWLock([&](auto& pendingState) {
+    syncScheduled = pendingState != nullptr;
+    pendingState = delta.newState();
+  });
+  if (!syncScheduled) {
+    evb_->runInEventBaseThread([this]() { this->syncPendingState(); });
+  }
+}
+
+void TunManager::syncPendingState() {
+  auto state = std::exchange(*pendingState_.wlock(), nullptr);
+  if (state) {
+    sync(state);
+  }
 }
 
 bool TunManager::sendPacketToHost(
@@ -98,11 +117,10 @@ bool TunManager::sendPacketToHost(
   return iter->second->sendPacketToHost(std::move(pkt));
 }
 
-void TunManager::addExistingIntf(const std::string& ifName, int ifIndex) {
-  InterfaceID ifID = util::getIDFromTunIntfName(ifName);
+void TunManager::addExistingIntf(InterfaceID ifID, int ifIndex) {
   auto ret = intfs_.emplace(ifID, nullptr);
   if (!ret.second) {
-    throw FbossError("Duplicate interface ", ifName);
+    throw FbossError("Duplicate interface for interface ", ifID);
   }
 
   SCOPE_FAIL {
@@ -112,18 +130,14 @@ void TunManager::addExistingIntf(const std::string& ifName, int ifIndex) {
       new TunIntf(sw_, evb_, ifID, ifIndex, getInterfaceMtu(ifID)));
 }
 
-void TunManager::addNewIntf(
+std::unique_ptr<TunIntf> TunManager::addNewIntf(
     InterfaceID ifID,
     bool isUp,
     const Interface::Addresses& addrs) {
-  auto ret = intfs_.emplace(ifID, nullptr);
-  if (!ret.second) {
+  if (intfs_.find(ifID) != intfs_.end()) {
     throw FbossError("Duplicate interface for interface ", ifID);
   }
 
-  SCOPE_FAIL {
-    intfs_.erase(ret.first);
-  };
   auto intf = std::make_unique<TunIntf>(
       sw_, evb_, ifID, isUp, addrs, getInterfaceMtu(ifID));
 
@@ -143,12 +157,10 @@ void TunManager::addNewIntf(
   for (const auto& addr : addrs) {
     addTunAddress(ifID, ifName, ifIndex, addr.first, addr.second);
   }
-
-  // Store it in local map on success
-  ret.first->second = std::move(intf);
+  return intf;
 }
 
-void TunManager::removeIntf(InterfaceID ifID) {
+std::unique_ptr<TunIntf> TunManager::removeIntf(InterfaceID ifID) {
   auto iter = intfs_.find(ifID);
   if (iter == intfs_.end()) {
     throw FbossError("Cannot find interface ", ifID, " for deleting.");
@@ -163,26 +175,10 @@ void TunManager::removeIntf(InterfaceID ifID) {
 
   // Remove the route table and associated rule
   removeRouteTable(ifID, intf->getIfIndex());
-  intf->setDelete();
+  auto removed = std::move(intf);
+  removed->setDelete();
   intfs_.erase(iter);
-}
-
-void TunManager::addProbedAddr(
-    int ifIndex,
-    const IPAddress& addr,
-    uint8_t mask) {
-  for (auto& intf : intfs_) {
-    if (intf.second->getIfIndex() == ifIndex) {
-      intf.second->addAddress(addr, mask);
-      return;
-    }
-  }
-  // This function is called for all interface addresses discovered from
-  // the host. Since we only create TunIntf object for TUN interfaces,
-  // it is normal we cannot find the interface matching the ifIndex provided.
-  XLOG(DBG3) << "Cannot find interface @ index " << ifIndex
-             << " for probed address " << addr.str() << "/"
-             << static_cast<int>(mask);
+  return removed;
 }
 
 void TunManager::setIntfStatus(
@@ -305,41 +301,45 @@ void TunManager::addRemoveRouteTable(InterfaceID ifID, int ifIndex, bool add) {
     rtnl_route_nh_set_ifindex(nexthop, ifIndex);
     rtnl_route_add_nexthop(route, nexthop);
 
+    struct nl_msg* msg{nullptr};
     if (add) {
-      error = rtnl_route_add(sock_, route, NLM_F_REPLACE);
+      error = rtnl_route_build_add_request(route, NLM_F_REPLACE, &msg);
     } else {
-      error = rtnl_route_delete(sock_, route, 0);
+      error = rtnl_route_build_del_request(route, 0, &msg);
     }
+    nlCheckError(error, "Failed to build request for default route ", addr);
+
     /**
-     * Disable: Because of some weird reason this CHECK fails while deleting
-     * v4 default route. However route actually gets wiped off from Linux
+     * Failures are ignored: Because of some weird reason removing the v4
+     * default route fails. However route actually gets wiped off from Linux
      * routing table.
-    nlCheckError(error, "Failed to ", add ? "add" : "remove",
-                  " default route ", addr, " @ index ", ifIndex,
-                  " in table ", getTableId(ifID), " for interface ", ifID,
-                  ". ErrorCode: ", error);
-      */
-    if (error < 0) {
-      XLOG(WARNING) << "Failed to " << (add ? "add" : "remove")
-                    << " default route " << addr << " @index " << ifIndex
-                    << ". ErrorCode: " << error;
-    }
-    XLOG(INFO) << (add ? "Added" : "Removed") << " default route " << addr
-               << " @ index " << ifIndex << " in table " << getTableId(ifID)
-               << " for interface " << ifID;
+     */
+    batch_->add(
+        msg,
+        folly::to<std::string>(
+            add ? "add" : "remove",
+            " default route ",
+            addr,
+            " @ index ",
+            ifIndex,
+            " in table ",
+            getTableId(ifID),
+            " for interface ",
+            ifID),
+        true /* ignoreError */);
   }
 }
 
-void TunManager::addRemoveSourceRouteRule(
+nl_msg* TunManager::buildSourceRouteRuleRequest(
     InterfaceID ifID,
     const folly::IPAddress& addr,
-    bool add) {
+    bool add) const {
   // We should not add source routing rule for link-local addresses because
   // they can be re-used across interfaces.
   if (addr.isLinkLocal()) {
     XLOG(DBG2) << "Ignoring source routing rule for link-local address "
                << addr;
-    return;
+    return nullptr;
   }
 
   auto rule = rtnl_rule_alloc();
@@ -366,14 +366,21 @@ void TunManager::addRemoveSourceRouteRule(
   auto error = rtnl_rule_set_src(rule, sourceaddr);
   nlCheckError(error, "Failed to set destination route to ", addr);
 
+  struct nl_msg* msg{nullptr};
   if (add) {
-    error = rtnl_rule_add(sock_, rule, NLM_F_REPLACE);
+    error = rtnl_rule_build_add_request(rule, NLM_F_REPLACE, &msg);
   } else {
-    error = rtnl_rule_delete(sock_, rule, 0);
+    error = rtnl_rule_build_delete_request(rule, 0, &msg);
   }
-  nlCheckError(
-      error,
-      "Failed to ",
+  nlCheckError(error, "Failed to build request for rule for address ", addr);
+  return msg;
+}
+
+std::string TunManager::sourceRouteRuleDescription(
+    InterfaceID ifID,
+    const folly::IPAddress& addr,
+    bool add) const {
+  return folly::to<std::string>(
       add ? "add" : "remove",
       " rule for address ",
       addr,
@@ -381,9 +388,15 @@ void TunManager::addRemoveSourceRouteRule(
       getTableId(ifID),
       " for interface ",
       ifID);
-  XLOG(INFO) << (add ? "Added" : "Removed") << " rule for address " << addr
-             << " to lookup table " << getTableId(ifID) << " for interface "
-             << ifID;
+}
+
+void TunManager::addRemoveSourceRouteRule(
+    InterfaceID ifID,
+    const folly::IPAddress& addr,
+    bool add) {
+  if (auto msg = buildSourceRouteRuleRequest(ifID, addr, add)) {
+    batch_->add(msg, sourceRouteRuleDescription(ifID, addr, add));
+  }
 }
 
 void TunManager::addRemoveTunAddress(
@@ -418,6 +431,7 @@ void TunManager::addRemoveTunAddress(
   rtnl_addr_set_prefixlen(tunaddr, mask);
   rtnl_addr_set_ifindex(tunaddr, ifIndex);
 
+  struct nl_msg* msg{nullptr};
   if (add) {
     /**
      * When you bring down interface some routes are purged but some still stay
@@ -426,25 +440,24 @@ void TunManager::addRemoveTunAddress(
      * addresses and routes for that interface with REPLACE flag overriding
      * existing ones if any.
      */
-    error = rtnl_addr_add(sock_, tunaddr, NLM_F_REPLACE);
+    error = rtnl_addr_build_add_request(tunaddr, NLM_F_REPLACE, &msg);
   } else {
-    error = rtnl_addr_delete(sock_, tunaddr, 0);
-  }
-  nlCheckError(
-      error,
-      "Failed to ",
-      add ? "add" : "remove",
-      " address ",
-      addr,
-      "/",
-      static_cast<int>(mask),
-      " to interface ",
-      ifName,
-      " @ index ",
-      ifIndex);
-  XLOG(INFO) << (add ? "Added" : "Removed") << " address " << addr.str() << "/"
-             << static_cast<int>(mask) << " on interface " << ifName
-             << " @ index " << ifIndex;
+    error = rtnl_addr_build_delete_request(tunaddr, 0, &msg);
+  }
+  nlCheckError(error, "Failed to build request for address ", addr);
+
+  batch_->add(
+      msg,
+      folly::to<std::string>(
+          add ? "add" : "remove",
+          " address ",
+          addr,
+          "/",
+          static_cast<int>(mask),
+          " on interface ",
+          ifName,
+          " @ index ",
+          ifIndex));
 }
 
 void TunManager::addTunAddress(
@@ -454,15 +467,11 @@ void TunManager::addTunAddress(
     folly::IPAddress addr,
     uint8_t mask) {
   addRemoveSourceRouteRule(ifID, addr, true);
-  SCOPE_FAIL {
-    try {
-      addRemoveSourceRouteRule(ifID, addr, false);
-    } catch (const std::exception& ex) {
-      XLOG(ERR) << "Failed to removed partially added source rule on "
-                << "interface " << ifName;
-    }
-  };
   addRemoveTunAddress(ifName, ifIndex, addr, mask, true);
+  // Remove the source rule again if the address could not be added
+  if (auto undo = buildSourceRouteRuleRequest(ifID, addr, false)) {
+    batch_->setUndo(undo, sourceRouteRuleDescription(ifID, addr, false));
+  }
 }
 
 void TunManager::removeTunAddress(
@@ -472,15 +481,11 @@ void TunManager::removeTunAddress(
     folly::IPAddress addr,
     uint8_t mask) {
   addRemoveSourceRouteRule(ifID, addr, false);
-  SCOPE_FAIL {
-    try {
-      addRemoveSourceRouteRule(ifID, addr, true);
-    } catch (const std::exception& ex) {
-      XLOG(ERR) << "Failed to add partially added source rule on "
-                << "interface " << ifName;
-    }
-  };
   addRemoveTunAddress(ifName, ifIndex, addr, mask, false);
+  // Restore the source rule if the address could not be removed
+  if (auto undo = buildSourceRouteRuleRequest(ifID, addr, true)) {
+    batch_->setUndo(undo, sourceRouteRuleDescription(ifID, addr, true));
+  }
 }
 
 void TunManager::start() const {
@@ -514,8 +519,8 @@ void TunManager::linkProcessor(struct nl_object* obj, void* data) {
     return;
   }
 
-  static_cast<TunManager*>(data)->addExistingIntf(
-      std::string(name), rtnl_link_get_ifindex(link));
+  static_cast<ProbedIntfs*>(data)->emplace(
+      util::getIDFromTunIntfName(name), rtnl_link_get_ifindex(link));
 }
 
 void TunManager::addressProcessor(struct nl_object* obj, void* data) {
@@ -547,9 +552,11 @@ void TunManager::addressProcessor(struct nl_object* obj, void* data) {
                << " does not have an address at family " << family;
   }
 
+  // Addresses of all interfaces are collected, doProbe() only keeps the ones
+  // of TUN interfaces
   auto ipaddr = IPAddress::createNetwork(buf, -1, false).first;
-  static_cast<TunManager*>(data)->addProbedAddr(
-      rtnl_addr_get_ifindex(addr), ipaddr, nl_addr_get_prefixlen(localaddr));
+  (*static_cast<ProbedAddrs*>(data))[rtnl_addr_get_ifindex(addr)].emplace(
+      ipaddr, nl_addr_get_prefixlen(localaddr));
 }
 
 void TunManager::probe() {
@@ -566,10 +573,6 @@ void TunManager::doProbe(std::lock_guard<std::mutex>& /* lock */) {
     XLOG(INFO) << "Probing of linux state took " << elapsedMs.count() << "ms.";
   };
 
-  CHECK(!probeDone_); // Callers must check for probeDone before calling
-  stop(); // stop all interfaces
-  intfs_.clear(); // clear all interface info
-
   // get links
   struct nl_cache* cache;
   auto error = rtnl_link_alloc_cache(sock_, AF_UNSPEC, &cache);
@@ -577,7 +580,8 @@ void TunManager::doProbe(std::lock_guard<std::mutex>& /* lock */) {
   SCOPE_EXIT {
     nl_cache_free(cache);
   };
-  nl_cache_foreach(cache, &TunManager::linkProcessor, this);
+  ProbedIntfs probedIntfs;
+  nl_cache_foreach(cache, &TunManager::linkProcessor, &probedIntfs);
 
   // get addresses
   struct nl_cache* addressCache;
@@ -586,7 +590,39 @@ void TunManager::doProbe(std::lock_guard<std::mutex>& /* lock */) {
   SCOPE_EXIT {
     nl_cache_free(addressCache);
   };
-  nl_cache_foreach(addressCache, &TunManager::addressProcessor, this);
+  ProbedAddrs probedAddrs;
+  nl_cache_foreach(addressCache, &TunManager::addressProcessor, &probedAddrs);
+
+  // Only touch the interfaces that changed since the last probe. Drop the
+  // ones which are gone from the host or were recreated with another index.
+  // The host interface is gone already, so it is detached and not deleted.
+  size_t numDropped = 0;
+  for (auto iter = intfs_.begin(); iter != intfs_.end();) {
+    auto probed = probedIntfs.find(iter->first);
+    if (probed == probedIntfs.end() ||
+        probed->second != iter->second->getIfIndex()) {
+      iter = intfs_.erase(iter);
+      ++numDropped;
+    } else {
+      ++iter;
+    }
+  }
+  size_t numAdded = 0;
+  for (const auto& [ifID, ifIndex] : probedIntfs) {
+    if (intfs_.find(ifID) == intfs_.end()) {
+      addExistingIntf(ifID, ifIndex);
+      ++numAdded;
+    }
+  }
+
+  // The addresses on the host are the ones sync() has to reconcile against
+  for (auto& intf : intfs_) {
+    auto addrs = probedAddrs.find(intf.second->getIfIndex());
+    intf.second->setAddresses(
+        addrs == probedAddrs.end() ? Interface::Addresses() : addrs->second);
+  }
+  XLOG(INFO) << "Probed " << intfs_.size() << " TUN interfaces, added "
+             << numAdded << " and dropped " << numDropped;
 
   start();
   probeDone_ = true;
@@ -668,6 +704,24 @@ void TunManager::sync(std::shared_ptr<SwitchState> state) {
     doProbe(lock);
   }
 
+  // intfs_ only learns about new interfaces and addresses once their
+  // netlink requests were applied
+  std::vector<std::unique_ptr<TunIntf>> addedIntfs;
+  std::vector<std::unique_ptr<TunIntf>> removedIntfs;
+  std::vector<std::pair<TunIntf*, Addresses>> updatedAddrs;
+
+  // Requests queued by an aborted sync must not be sent by the next one.
+  // Interfaces it created are deleted again. Part of its requests may have
+  // been applied, so the next sync probes the host again and retries
+  // whatever is missing.
+  SCOPE_FAIL {
+    batch_->clear();
+    for (auto& intf : addedIntfs) {
+      intf->setDelete();
+    }
+    probeDone_ = false;
+  };
+
   // prepare old addresses
   IntfToAddrsMap oldIntfToInfo;
   for (const auto& intf : intfs_) {
@@ -726,14 +780,13 @@ void TunManager::sync(std::shared_ptr<SwitchState> state) {
         int ifIndex = intf->getIfIndex();
         const auto& ifName = intf->getName();
 
-        // mutate intf status and addresses
-        intf->setStatus(newStatus);
-        intf->setAddresses(newAddrs);
-
-        // Update interface status
+        // Update interface status. Unlike the netlink changes below it is
+        // applied right away.
         if (oldStatus ^ newStatus) { // old and new status is different
           setIntfStatus(ifName, ifIndex, newStatus);
         }
+        intf->setStatus(newStatus);
+        updatedAddrs.emplace_back(intf.get(), newAddrs);
 
         // We need to add route-table and tun-addresses if interface is brought
         // up recently.
@@ -756,9 +809,26 @@ void TunManager::sync(std::shared_ptr<SwitchState> state) {
       },
       [&](ConstIntfToAddrsMapIter& newIter) {
         auto& statusAddr = newIter->second;
-        addNewIntf(newIter->first, statusAddr.first, statusAddr.second);
+        addedIntfs.push_back(
+            addNewIntf(newIter->first, statusAddr.first, statusAddr.second));
       },
-      [&](ConstIntfToAddrsMapIter& oldIter) { removeIntf(oldIter->first); });
+      [&](ConstIntfToAddrsMapIter& oldIter) {
+        removedIntfs.push_back(removeIntf(oldIter->first));
+      });
+
+  // Apply all netlink changes of this sync at once. Removed interfaces are
+  // only deleted from the host afterwards, as the requests still refer to
+  // them.
+  batch_->flush();
+  removedIntfs.clear();
+  for (auto& [intf, addrs] : updatedAddrs) {
+    intf->setAddresses(addrs);
+  }
+  for (auto& intf : addedIntfs) {
+    auto ifID = intf->getInterfaceID();
+    intfs_.emplace(ifID, std::move(intf));
+  }
+  addedIntfs.clear();
 
   start();
 
@@ -9,7 +9,9 @@
  */
 #pragma once
 
+#include <folly/Synchronized.h>
 #include <folly/io/async/EventBase.h>
+#include "fboss/agent/NetlinkBatch.h"
 #include "fboss/agent/StateObserver.h"
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/types.h"
@@ -37,6 +39,9 @@ class TunManager : public StateObserver {
    * Update the intfs_ map based on the given state update. This
    * overrides the StateObserver stateUpdated api, which is always
    * guaranteed to be called from the update thread.
+   *
+   * The sync itself runs on evb_. Updates arriving while a sync is pending
+   * are coalesced, the pending sync applies the latest state only.
    */
   void stateUpdated(const StateDelta& delta) override;
 
@@ -75,7 +80,9 @@ class TunManager : public StateObserver {
   virtual void startObservingUpdates();
 
   /*
-   * Probe linux for tun interfaces already configured
+   * Probe linux for tun interfaces already configured. Probing again only
+   * adds or drops the interfaces that changed on the host since the last
+   * probe, interfaces still present keep forwarding packets.
    */
   virtual void probe();
 
@@ -94,13 +101,25 @@ class TunManager : public StateObserver {
    * Add a TUN interface. It can happen two ways
    * 1. During probe process when we discover existing Tun interface on linux
    * 2. When we want to create a new TUN interface in linux
+   *
+   * A new interface is returned instead of being added to intfs_, the
+   * caller adds it once the netlink requests setting it up were flushed.
    */
-  void addExistingIntf(const std::string& name, int ifIndex);
-  void
+  void addExistingIntf(InterfaceID ifID, int ifIndex);
+  std::unique_ptr<TunIntf>
   addNewIntf(InterfaceID ifID, bool isUp, const Interface::Addresses& addrs);
 
-  // Remove an existing TUN interface
-  void removeIntf(InterfaceID ifID);
+  /**
+   * Remove an existing TUN interface. The interface is returned so that the
+   * caller can delete it from the host once the netlink requests referring
+   * to it have been flushed.
+   */
+  std::unique_ptr<TunIntf> removeIntf(InterfaceID ifID);
+
+  /**
+   * Apply the latest state passed to stateUpdated, if any.
+   */
+  void syncPendingState();
 
   // A tun interface was changed, update the addresses accordingly
   void updateIntf(InterfaceID ifID, const Interface::Addresses& addrs);
@@ -111,7 +130,8 @@ class TunManager : public StateObserver {
   void setIntfStatus(const std::string& ifName, int ifIndex, bool status);
 
   /**
-   * Add/remove a route table.
+   * Add/remove a route table. Like the other netlink changes below, the
+   * requests are queued in batch_ and applied by the next flush.
    *
    * On Host we create a routing table for every switch interface which has
    * v4/v6 default route with corresponding Tun interface as nexthop. Everything
@@ -144,6 +164,19 @@ class TunManager : public StateObserver {
       const folly::IPAddress& addr,
       bool add);
 
+  /**
+   * Build the request addRemoveSourceRouteRule queues. Returns nullptr for
+   * link-local addresses, which get no source rule.
+   */
+  nl_msg* buildSourceRouteRuleRequest(
+      InterfaceID ifID,
+      const folly::IPAddress& addr,
+      bool add) const;
+  std::string sourceRouteRuleDescription(
+      InterfaceID ifID,
+      const folly::IPAddress& addr,
+      bool add) const;
+
   /**
    * Add/Remove an address to/from a TUN interface on the host
    */
@@ -156,6 +189,7 @@ class TunManager : public StateObserver {
 
   /**
    * Add/Remove address as well source-routing-rule for TUN interface on host.
+   * If the address request fails, the source-routing-rule is reverted.
    */
   void addTunAddress(
       InterfaceID ifID,
@@ -170,13 +204,18 @@ class TunManager : public StateObserver {
       folly::IPAddress addr,
       uint8_t mask);
 
+  // Tun interfaces found by probe, by switch interface ID
+  using ProbedIntfs = boost::container::flat_map<InterfaceID, int /* index */>;
+  // Addresses found by probe, by ifIndex
+  using ProbedAddrs = boost::container::flat_map<int, Interface::Addresses>;
+
   /**
-   * Netlink callback for processing and storing links
+   * Netlink callback for processing and storing links in ProbedIntfs
    */
   static void linkProcessor(struct nl_object* obj, void* data);
 
   /**
-   * Netlink callback for processing and storing addresses
+   * Netlink callback for processing and storing addresses in ProbedAddrs
    */
   static void addressProcessor(struct nl_object* obj, void* data);
 
@@ -185,11 +224,6 @@ class TunManager : public StateObserver {
    */
   virtual void doProbe(std::lock_guard<std::mutex>& mutex);
 
-  /**
-   * Add an address to a TUN interface during probe process.
-   */
-  void addProbedAddr(int ifIndex, const folly::IPAddress& addr, uint8_t mask);
-
   /**
    * Get MTU of switch interface
    */
@@ -221,6 +255,12 @@ class TunManager : public StateObserver {
   // Netlink socket for managing interface/addresses in Host/Linux
   nl_sock* sock_{nullptr};
 
+  // Netlink requests of the ongoing sync, sent together at its end
+  std::unique_ptr<NetlinkBatch> batch_;
+
+  // Latest state from stateUpdated not synced yet
+  folly::Synchronized<std::shared_ptr<SwitchState>> pendingState_;
+
   /**
    * The mutex used to protect `intfs_` which can be used by
    * sync() could manipulate intfs_. Called on the thread that serves evb_.
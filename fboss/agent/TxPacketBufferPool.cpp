@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/TxPacketBufferPool.h"
+
+#include <algorithm>
+
+DEFINE_uint32(
+    tx_buffer_pool_size,
+    64,
+    "Number of free buffers kept per size class for reuse by TX packets, "
+    "on HwSwitch implementations that support it. At most about 184KB of "
+    "buffers are kept at the default. 0 disables the pool");
+
+namespace facebook::fboss {
+
+TxPacketBufferPool::TxPacketBufferPool(size_t maxBuffersPerClass)
+    : maxBuffersPerClass_(maxBuffersPerClass) {}
+
+std::unique_ptr<folly::IOBuf> TxPacketBufferPool::allocate(uint32_t size) {
+  auto it = std::lower_bound(kSizeClasses.begin(), kSizeClasses.end(), size);
+  if (it == kSizeClasses.end()) {
+    auto buf = folly::IOBuf::createCombined(size);
+    buf->append(size);
+    return buf;
+  }
+
+  auto& sizeClass = sizeClasses_[it - kSizeClasses.begin()];
+  std::unique_ptr<folly::IOBuf> buf;
+  {
+    std::lock_guard<std::mutex> g(sizeClass.lock);
+    if (!sizeClass.buffers.empty()) {
+      buf = std::move(sizeClass.buffers.back());
+      sizeClass.buffers.pop_back();
+    }
+  }
+  if (!buf) {
+    buf = folly::IOBuf::createCombined(*it);
+  }
+  buf->append(size);
+  return buf;
+}
+
+void TxPacketBufferPool::release(std::unique_ptr<folly::IOBuf> buf) {
+  if (!buf || buf->isChained() || buf->isShared()) {
+    return;
+  }
+  // A buffer goes to the largest class it can hold. Buffers much bigger
+  // than the largest class were not allocated by the pool, free them.
+  auto capacity = buf->capacity();
+  auto it =
+      std::upper_bound(kSizeClasses.begin(), kSizeClasses.end(), capacity);
+  if (it == kSizeClasses.begin() || capacity >= 2 * kSizeClasses.back()) {
+    return;
+  }
+  auto& sizeClass = sizeClasses_[it - kSizeClasses.begin() - 1];
+  buf->clear();
+  std::lock_guard<std::mutex> g(sizeClass.lock);
+  if (sizeClass.buffers.size() < maxBuffersPerClass_) {
+    sizeClass.buffers.push_back(std::move(buf));
+  }
+}
+
+size_t TxPacketBufferPool::freeBuffers() const {
+  size_t numBuffers = 0;
+  for (const auto& sizeClass : sizeClasses_) {
+    std::lock_guard<std::mutex> g(sizeClass.lock);
+    numBuffers += sizeClass.buffers.size();
+  }
+  return numBuffers;
+}
+
+} // namespace facebook::fboss
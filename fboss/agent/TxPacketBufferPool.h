@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+DECLARE_uint32(tx_buffer_pool_size);
+
+namespace facebook::fboss {
+
+/*
+ * Free list of packet buffers for HwSwitch implementations whose TX packets
+ * are backed by regular heap memory, so that bursts of ARP/NDP replies,
+ * protocol PDUs and ICMP errors reuse buffers instead of hitting malloc for
+ * every packet.
+ *
+ * Buffers are kept in a few size classes, each holding up to
+ * maxBuffersPerClass buffers. Packets larger than the largest class are
+ * allocated and freed as usual. All methods are thread safe.
+ */
+class TxPacketBufferPool {
+ public:
+  static constexpr std::array<uint32_t, 4> kSizeClasses{128, 256, 512, 2048};
+
+  explicit TxPacketBufferPool(size_t maxBuffersPerClass);
+
+  /*
+   * Buffer with size bytes of data, reused from the pool if one is free.
+   */
+  std::unique_ptr<folly::IOBuf> allocate(uint32_t size);
+
+  /*
+   * Return the buffer of a packet that is done with. Buffers that are
+   * chained, shared or of an unexpected capacity are just freed.
+   */
+  void release(std::unique_ptr<folly::IOBuf> buf);
+
+  size_t freeBuffers() const;
+
+ private:
+  struct SizeClass {
+    mutable std::mutex lock;
+    std::vector<std::unique_ptr<folly::IOBuf>> buffers;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  TxPacketBufferPool(TxPacketBufferPool const&) = delete;
+  TxPacketBufferPool& operator=(TxPacketBufferPool const&) = delete;
+
+  const size_t maxBuffersPerClass_;
+  std::array<SizeClass, kSizeClasses.size()> sizeClasses_;
+};
+
+} // namespace facebook::fboss
@@ -8,6 +8,37 @@ namespace cpp2 facebook.fboss.cfg
 include "fboss/agent/switch_config.thrift"
 include "fboss/agent/platform_config.thrift"
 
+/**
+ * Classes of packets trapped to the CPU, for the software CPU packet
+ * scheduler
+ */
+enum CpuPacketClass {
+  // Routing and link protocols: BGP, LACP, LLDP and MACsec
+  HIGH = 0,
+  // ARP and NDP
+  NEIGHBOR = 1,
+  // IP packets with a TTL or hop limit of 1 or less
+  TTL_EXPIRED = 2,
+  // Everything else
+  DEFAULT = 3,
+}
+
+struct CpuPacketRateLimit {
+  // Packets per second handled for each ingress port
+  1: i32 packetsPerSec,
+  // Packets handled at once above the rate, after a quiet period
+  2: i32 burstSize,
+}
+
+/**
+ * Software rate limits applied to trapped packets before they are handled,
+ * per packet class and ingress port. Packets over the limit are dropped.
+ * Classes without a limit are handled as they arrive.
+ */
+struct CpuPacketSchedulerConfig {
+  1: map<CpuPacketClass, CpuPacketRateLimit> rateLimits = {},
+}
+
 struct AgentConfig {
   // This is used to override the default command line arguments we
   // pass to the agent.
@@ -21,4 +52,7 @@ struct AgentConfig {
   // configuration (e.g broadcom config), as well as low-level port
   // tuning params.
   3: platform_config.PlatformConfig platform,
+
+  // Rate limits for packets trapped to the CPU, on top of hardware CoPP.
+  4: CpuPacketSchedulerConfig cpuPacketScheduler,
 }
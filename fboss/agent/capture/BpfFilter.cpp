@@ -0,0 +1,313 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/capture/BpfFilter.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <folly/io/Cursor.h>
+
+#include <array>
+#include <limits>
+
+namespace {
+
+/*
+ * Load size bytes in network byte order from offset into the packet.
+ * Returns false if the load would go past the end of the packet.
+ */
+bool loadPacket(
+    const folly::IOBuf* buf,
+    uint64_t offset,
+    uint32_t size,
+    uint32_t* value) {
+  folly::io::Cursor cursor(buf);
+  if (!cursor.canAdvance(offset + size)) {
+    return false;
+  }
+  cursor.skip(offset);
+  switch (size) {
+    case 4:
+      *value = cursor.readBE<uint32_t>();
+      break;
+    case 2:
+      *value = cursor.readBE<uint16_t>();
+      break;
+    default:
+      *value = cursor.read<uint8_t>();
+      break;
+  }
+  return true;
+}
+
+uint32_t loadSize(uint16_t code) {
+  switch (BPF_SIZE(code)) {
+    case BPF_W:
+      return 4;
+    case BPF_H:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+} // namespace
+
+namespace facebook::fboss {
+
+BpfFilter::BpfFilter(const std::vector<BpfInstruction>& program) {
+  program_.reserve(program.size());
+  for (const auto& insn : program) {
+    auto code = *insn.code_ref();
+    auto jt = *insn.jt_ref();
+    auto jf = *insn.jf_ref();
+    auto k = *insn.k_ref();
+    if (code < 0 || jt < 0 || jt > std::numeric_limits<uint8_t>::max() ||
+        jf < 0 || jf > std::numeric_limits<uint8_t>::max() || k < 0 ||
+        k > std::numeric_limits<uint32_t>::max()) {
+      throw FbossError(
+          "invalid bpf instruction at ",
+          program_.size(),
+          ": { ",
+          code,
+          ", ",
+          jt,
+          ", ",
+          jf,
+          ", ",
+          k,
+          " }");
+    }
+    program_.push_back(
+        {static_cast<uint16_t>(code),
+         static_cast<uint8_t>(jt),
+         static_cast<uint8_t>(jf),
+         static_cast<uint32_t>(k)});
+  }
+  validate();
+}
+
+void BpfFilter::validate() const {
+  if (program_.empty()) {
+    return;
+  }
+  if (program_.size() > BPF_MAXINSNS) {
+    throw FbossError(
+        "bpf program too long: ", program_.size(), " instructions");
+  }
+
+  for (size_t pc = 0; pc < program_.size(); ++pc) {
+    const auto& insn = program_[pc];
+    auto remaining = program_.size() - pc - 1;
+    switch (BPF_CLASS(insn.code)) {
+      case BPF_LD:
+      case BPF_LDX:
+        if (BPF_MODE(insn.code) == BPF_MEM && insn.k >= BPF_MEMWORDS) {
+          throw FbossError("bpf load from invalid memory slot at ", pc);
+        }
+        break;
+      case BPF_ST:
+      case BPF_STX:
+        if (insn.k >= BPF_MEMWORDS) {
+          throw FbossError("bpf store to invalid memory slot at ", pc);
+        }
+        break;
+      case BPF_ALU:
+        if ((BPF_OP(insn.code) == BPF_DIV || BPF_OP(insn.code) == BPF_MOD) &&
+            BPF_SRC(insn.code) == BPF_K && insn.k == 0) {
+          throw FbossError("bpf division by zero at ", pc);
+        }
+        break;
+      case BPF_JMP:
+        if (BPF_OP(insn.code) == BPF_JA) {
+          if (insn.k >= remaining) {
+            throw FbossError("bpf jump out of the program at ", pc);
+          }
+        } else if (insn.jt >= remaining || insn.jf >= remaining) {
+          throw FbossError("bpf jump out of the program at ", pc);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (BPF_CLASS(program_.back().code) != BPF_RET) {
+    throw FbossError("bpf program does not end with a return");
+  }
+}
+
+bool BpfFilter::matches(const folly::IOBuf* buf) const {
+  if (program_.empty()) {
+    return true;
+  }
+
+  uint32_t a = 0;
+  uint32_t x = 0;
+  std::array<uint32_t, BPF_MEMWORDS> mem{};
+
+  for (size_t pc = 0; pc < program_.size(); ++pc) {
+    const auto& insn = program_[pc];
+    switch (BPF_CLASS(insn.code)) {
+      case BPF_LD:
+        switch (BPF_MODE(insn.code)) {
+          case BPF_ABS:
+            if (!loadPacket(buf, insn.k, loadSize(insn.code), &a)) {
+              return false;
+            }
+            break;
+          case BPF_IND:
+            if (!loadPacket(
+                    buf,
+                    static_cast<uint64_t>(x) + insn.k,
+                    loadSize(insn.code),
+                    &a)) {
+              return false;
+            }
+            break;
+          case BPF_LEN:
+            a = buf->computeChainDataLength();
+            break;
+          case BPF_IMM:
+            a = insn.k;
+            break;
+          case BPF_MEM:
+            a = mem[insn.k];
+            break;
+          default:
+            return false;
+        }
+        break;
+      case BPF_LDX:
+        switch (BPF_MODE(insn.code)) {
+          case BPF_LEN:
+            x = buf->computeChainDataLength();
+            break;
+          case BPF_IMM:
+            x = insn.k;
+            break;
+          case BPF_MEM:
+            x = mem[insn.k];
+            break;
+          case BPF_MSH: {
+            // 4 * (pkt[k] & 0xf), the IPv4 header length
+            uint32_t byte;
+            if (!loadPacket(buf, insn.k, 1, &byte)) {
+              return false;
+            }
+            x = (byte & 0xf) << 2;
+            break;
+          }
+          default:
+            return false;
+        }
+        break;
+      case BPF_ST:
+        mem[insn.k] = a;
+        break;
+      case BPF_STX:
+        mem[insn.k] = x;
+        break;
+      case BPF_ALU: {
+        auto operand = BPF_SRC(insn.code) == BPF_X ? x : insn.k;
+        switch (BPF_OP(insn.code)) {
+          case BPF_ADD:
+            a += operand;
+            break;
+          case BPF_SUB:
+            a -= operand;
+            break;
+          case BPF_MUL:
+            a *= operand;
+            break;
+          case BPF_DIV:
+            if (operand == 0) {
+              return false;
+            }
+            a /= operand;
+            break;
+          case BPF_MOD:
+            if (operand == 0) {
+              return false;
+            }
+            a %= operand;
+            break;
+          case BPF_AND:
+            a &= operand;
+            break;
+          case BPF_OR:
+            a |= operand;
+            break;
+          case BPF_XOR:
+            a ^= operand;
+            break;
+          case BPF_LSH:
+            a = operand < 32 ? a << operand : 0;
+            break;
+          case BPF_RSH:
+            a = operand < 32 ? a >> operand : 0;
+            break;
+          case BPF_NEG:
+            a = -a;
+            break;
+          default:
+            return false;
+        }
+        break;
+      }
+      case BPF_JMP: {
+        if (BPF_OP(insn.code) == BPF_JA) {
+          pc += insn.k;
+          break;
+        }
+        auto operand = BPF_SRC(insn.code) == BPF_X ? x : insn.k;
+        bool taken;
+        switch (BPF_OP(insn.code)) {
+          case BPF_JEQ:
+            taken = a == operand;
+            break;
+          case BPF_JGT:
+            taken = a > operand;
+            break;
+          case BPF_JGE:
+            taken = a >= operand;
+            break;
+          case BPF_JSET:
+            taken = (a & operand) != 0;
+            break;
+          default:
+            return false;
+        }
+        pc += taken ? insn.jt : insn.jf;
+        break;
+      }
+      case BPF_RET:
+        // The return value is the snap length, non zero accepts the packet
+        switch (BPF_RVAL(insn.code)) {
+          case BPF_A:
+            return a != 0;
+          case BPF_X:
+            return x != 0;
+          default:
+            return insn.k != 0;
+        }
+      case BPF_MISC:
+        if (BPF_MISCOP(insn.code) == BPF_TAX) {
+          x = a;
+        } else {
+          a = x;
+        }
+        break;
+    }
+  }
+  // validate() guarantees the program ends with a return
+  return false;
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
+#include <folly/io/IOBuf.h>
+#include <linux/filter.h>
+
+#include <vector>
+
+namespace facebook::fboss {
+
+/*
+ * BpfFilter runs a classic BPF program (the same programs tcpdump and
+ * SO_ATTACH_FILTER use) against a packet, starting from the ethernet header.
+ *
+ * The program is validated once at construction, so matches() never reads
+ * outside the program or the scratch memory, and loads past the end of the
+ * packet simply reject it, same as the kernel interpreter. Ancillary (SKF_AD_*)
+ * loads are not supported and never match.
+ */
+class BpfFilter {
+ public:
+  BpfFilter() {}
+  explicit BpfFilter(const std::vector<BpfInstruction>& program);
+
+  bool empty() const {
+    return program_.empty();
+  }
+
+  /*
+   * Returns true if the packet is accepted by the program. An empty filter
+   * accepts every packet.
+   */
+  bool matches(const folly::IOBuf* buf) const;
+
+ private:
+  void validate() const;
+
+  std::vector<struct sock_filter> program_;
+};
+
+} // namespace facebook::fboss
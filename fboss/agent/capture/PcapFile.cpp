@@ -11,10 +11,12 @@
 
 #include "fboss/agent/capture/PcapPkt.h"
 
+#include <folly/Conv.h>
 #include <folly/Exception.h>
 #include <folly/FileUtil.h>
 
 #include <chrono>
+#include <cstring>
 
 using folly::IOBuf;
 using folly::writeFull;
@@ -22,6 +24,46 @@ using folly::writevFull;
 using std::chrono::microseconds;
 using std::chrono::seconds;
 
+namespace {
+
+// pcapng block types and option codes
+constexpr uint32_t kSectionHeaderBlock = 0x0A0D0D0A;
+constexpr uint32_t kInterfaceDescriptionBlock = 0x00000001;
+constexpr uint32_t kEnhancedPacketBlock = 0x00000006;
+constexpr uint32_t kByteOrderMagic = 0x1A2B3C4D;
+constexpr uint16_t kOptEndOfOpt = 0;
+constexpr uint16_t kOptIfName = 2;
+constexpr uint16_t kOptEpbFlags = 2;
+constexpr uint16_t kOptEpbQueue = 6;
+// epb_flags inbound/outbound direction, bits 0-1
+constexpr uint32_t kEpbFlagsInbound = 0x1;
+constexpr uint32_t kEpbFlagsOutbound = 0x2;
+// Link type 1 is ethernet
+constexpr uint16_t kLinkTypeEthernet = 1;
+constexpr int64_t kTxInterfaceKey = -1;
+
+uint32_t pad4(uint32_t len) {
+  return (len + 3) & ~3;
+}
+
+bool hasQueueOption(const PcapPkt& pkt) {
+  return pkt.isRx() && pkt.cosQueue().has_value();
+}
+
+// Length of an enhanced packet block, excluding the packet data
+uint32_t enhancedPktOverhead(const PcapPkt& pkt) {
+  // 7 fixed words, epb_flags, optional epb_queue, end of options and the
+  // trailing block length
+  return 28 + 8 + (hasQueueOption(pkt) ? 8 : 0) + 4 + 4;
+}
+
+template <typename T>
+void append(std::string* out, T value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
 namespace facebook::fboss {
 
 PcapFile::PktHeader::PktHeader(const PcapPkt& pkt) {
@@ -36,10 +78,55 @@ PcapFile::PktHeader::PktHeader(const PcapPkt& pkt) {
   origLen = len;
 }
 
+PcapFile::EnhancedPktHeader::EnhancedPktHeader(
+    const PcapPkt& pkt,
+    uint32_t ifId) {
+  auto tsUsec = std::chrono::duration_cast<microseconds>(
+                    pkt.timestamp().time_since_epoch())
+                    .count();
+  auto len = pkt.buf()->computeChainDataLength();
+
+  blockType = kEnhancedPacketBlock;
+  blockLen = enhancedPktOverhead(pkt) + pad4(len);
+  interfaceId = ifId;
+  // Default if_tsresol is microseconds
+  timeHigh = static_cast<uint64_t>(tsUsec) >> 32;
+  timeLow = static_cast<uint64_t>(tsUsec) & 0xffffffff;
+  includedLen = len;
+  origLen = len;
+}
+
+PcapFile::EnhancedPktTrailer::EnhancedPktTrailer(const PcapPkt& pkt) {
+  data.fill(0);
+  auto len = pkt.buf()->computeChainDataLength();
+  auto put = [this](const auto& value) {
+    std::memcpy(data.data() + size, &value, sizeof(value));
+    size += sizeof(value);
+  };
+
+  // Packet data is padded to 32 bits, padding bytes are already zero
+  size = pad4(len) - len;
+  put(kOptEpbFlags);
+  put(uint16_t(4));
+  put(pkt.isRx() ? kEpbFlagsInbound : kEpbFlagsOutbound);
+  if (hasQueueOption(pkt)) {
+    put(kOptEpbQueue);
+    put(uint16_t(4));
+    put(uint32_t(*pkt.cosQueue()));
+  }
+  put(kOptEndOfOpt);
+  put(uint16_t(0));
+  put(enhancedPktOverhead(pkt) + pad4(len));
+}
+
 PcapFile::PcapFile() {}
 
-PcapFile::PcapFile(folly::StringPiece path, bool overwriteExisting)
-    : file_(path.str().c_str(), openFlags(overwriteExisting), 0644) {}
+PcapFile::PcapFile(
+    folly::StringPiece path,
+    bool overwriteExisting,
+    PcapFormat format)
+    : file_(path.str().c_str(), openFlags(overwriteExisting), 0644),
+      format_(format) {}
 
 PcapFile::~PcapFile() {}
 
@@ -48,6 +135,30 @@ void PcapFile::close() {
 }
 
 void PcapFile::writeGlobalHeader() {
+  if (format_ == PcapFormat::PCAPNG) {
+    struct SectionHeader {
+      uint32_t blockType;
+      uint32_t blockLen;
+      uint32_t byteOrderMagic;
+      uint16_t versionMajor;
+      uint16_t versionMinor;
+      int64_t sectionLen;
+      uint32_t trailingBlockLen;
+    } __attribute__((packed)) shb;
+    shb.blockType = kSectionHeaderBlock;
+    shb.blockLen = sizeof(shb);
+    shb.byteOrderMagic = kByteOrderMagic;
+    shb.versionMajor = 1;
+    shb.versionMinor = 0;
+    // Section length is not known upfront
+    shb.sectionLen = -1;
+    shb.trailingBlockLen = sizeof(shb);
+
+    int ret = writeFull(file_.fd(), &shb, sizeof(shb));
+    folly::checkUnixError(ret, "error writing pcapng section header");
+    return;
+  }
+
   struct GlobalHeader {
     uint32_t magic;
     uint16_t versionMajor;
@@ -72,6 +183,14 @@ void PcapFile::writeGlobalHeader() {
 }
 
 void PcapFile::writePackets(const std::vector<PcapPkt>& pkts) {
+  if (format_ == PcapFormat::PCAPNG) {
+    writePcapngPackets(pkts);
+  } else {
+    writePcapPackets(pkts);
+  }
+}
+
+void PcapFile::writePcapPackets(const std::vector<PcapPkt>& pkts) {
   folly::fbvector<PktHeader> hdrs;
   hdrs.reserve(pkts.size());
   folly::fbvector<struct iovec> iov;
@@ -92,6 +211,73 @@ void PcapFile::writePackets(const std::vector<PcapPkt>& pkts) {
   folly::checkUnixError(ret, "error writing pcap data");
 }
 
+void PcapFile::writePcapngPackets(const std::vector<PcapPkt>& pkts) {
+  // Interface description blocks for interfaces first seen in this batch.
+  // They go ahead of all the packets, so they precede any packet using them.
+  std::string newInterfaces;
+  std::vector<uint32_t> interfaceIds;
+  interfaceIds.reserve(pkts.size());
+  for (const auto& pkt : pkts) {
+    interfaceIds.push_back(getInterfaceId(pkt, &newInterfaces));
+  }
+
+  folly::fbvector<EnhancedPktHeader> hdrs;
+  hdrs.reserve(pkts.size());
+  folly::fbvector<EnhancedPktTrailer> trailers;
+  trailers.reserve(pkts.size());
+  folly::fbvector<struct iovec> iov;
+  // Header, data and trailer, assuming each packet is in a single IOBuf
+  iov.reserve(pkts.size() * 3 + 1);
+
+  if (!newInterfaces.empty()) {
+    iov.push_back({newInterfaces.data(), newInterfaces.size()});
+  }
+  for (size_t i = 0; i < pkts.size(); ++i) {
+    const auto& pkt = pkts[i];
+    hdrs.emplace_back(pkt, interfaceIds[i]);
+    iov.push_back({(void*)&hdrs.back(), sizeof(EnhancedPktHeader)});
+    pkt.buf()->appendToIov(&iov);
+    trailers.emplace_back(pkt);
+    iov.push_back({(void*)trailers.back().data.data(), trailers.back().size});
+  }
+
+  int ret = writevFull(file_.fd(), iov.data(), iov.size());
+  folly::checkUnixError(ret, "error writing pcapng data");
+}
+
+uint32_t PcapFile::getInterfaceId(const PcapPkt& pkt, std::string* newBlocks) {
+  int64_t key = pkt.isRx() ? static_cast<int64_t>(pkt.port()) : kTxInterfaceKey;
+  auto it = interfaceIds_.find(key);
+  if (it != interfaceIds_.end()) {
+    return it->second;
+  }
+
+  std::string name = "cpu";
+  if (pkt.isRx()) {
+    name = folly::to<std::string>("port", static_cast<uint32_t>(pkt.port()));
+  }
+  // Block type and length, link type, snap length, if_name, end of options
+  // and the trailing block length
+  uint32_t blockLen = 16 + 4 + pad4(name.size()) + 4 + 4;
+  append(newBlocks, kInterfaceDescriptionBlock);
+  append(newBlocks, blockLen);
+  append(newBlocks, kLinkTypeEthernet);
+  append(newBlocks, uint16_t(0));
+  // Snap length 0, no limit
+  append(newBlocks, uint32_t(0));
+  append(newBlocks, kOptIfName);
+  append(newBlocks, uint16_t(name.size()));
+  newBlocks->append(name);
+  newBlocks->append(pad4(name.size()) - name.size(), '\0');
+  append(newBlocks, kOptEndOfOpt);
+  append(newBlocks, uint16_t(0));
+  append(newBlocks, blockLen);
+
+  auto id = interfaceIds_.size();
+  interfaceIds_.emplace(key, id);
+  return id;
+}
+
 int PcapFile::openFlags(bool overwriteExisting) {
   int flags = O_CREAT | O_WRONLY;
   if (!overwriteExisting) {
@@ -11,12 +11,26 @@
 
 #include <folly/File.h>
 #include <folly/Range.h>
+#include <folly/container/F14Map.h>
+
+#include <array>
+#include <string>
 #include <vector>
 
 namespace facebook::fboss {
 
 class PcapPkt;
 
+enum class PcapFormat {
+  PCAP,
+  /*
+   * pcapng. RX packets are recorded on one interface per port, with their
+   * CPU queue in the epb_queue option, TX packets on a single "cpu"
+   * interface. The direction is recorded in epb_flags.
+   */
+  PCAPNG,
+};
+
 /*
  * PcapFile supports writing packets to a file in pcap format.
  *
@@ -27,7 +41,10 @@ class PcapPkt;
 class PcapFile {
  public:
   PcapFile();
-  explicit PcapFile(folly::StringPiece path, bool overwriteExisting = false);
+  explicit PcapFile(
+      folly::StringPiece path,
+      bool overwriteExisting = false,
+      PcapFormat format = PcapFormat::PCAP);
   ~PcapFile();
 
   void close();
@@ -49,6 +66,31 @@ class PcapFile {
     uint32_t origLen{0};
   };
 
+  // Fixed part of a pcapng enhanced packet block, packet data follows
+  struct EnhancedPktHeader {
+    explicit EnhancedPktHeader(const PcapPkt& pkt, uint32_t interfaceId);
+
+    uint32_t blockType{0};
+    uint32_t blockLen{0};
+    uint32_t interfaceId{0};
+    uint32_t timeHigh{0};
+    uint32_t timeLow{0};
+    uint32_t includedLen{0};
+    uint32_t origLen{0};
+  };
+
+  // Data padding, options and trailing length of an enhanced packet block
+  struct EnhancedPktTrailer {
+    explicit EnhancedPktTrailer(const PcapPkt& pkt);
+
+    std::array<uint8_t, 28> data;
+    uint32_t size{0};
+  };
+
+  void writePcapPackets(const std::vector<PcapPkt>& pkts);
+  void writePcapngPackets(const std::vector<PcapPkt>& pkts);
+  uint32_t getInterfaceId(const PcapPkt& pkt, std::string* newBlocks);
+
   // Forbidden copy constructor and assignment operator
   PcapFile(PcapFile const&) = delete;
   PcapFile& operator=(PcapFile const&) = delete;
@@ -56,6 +98,9 @@ class PcapFile {
   static int openFlags(bool overwriteExisting);
 
   folly::File file_;
+  PcapFormat format_{PcapFormat::PCAP};
+  // pcapng interface ids, keyed by RX port or -1 for TX
+  folly::F14FastMap<int64_t, uint32_t> interfaceIds_;
 };
 
 } // namespace facebook::fboss
@@ -29,6 +29,9 @@ PcapPkt::PcapPkt(const RxPacket* pkt, TimePoint timestamp)
       buf_(),
       reasons_() {
   pkt->buf()->cloneInto(buf_);
+  if (pkt->cosQueue() >= 0) {
+    cosQueue_ = pkt->cosQueue();
+  }
 }
 
 PcapPkt::PcapPkt(const TxPacket* pkt)
@@ -14,6 +14,7 @@
 #include <folly/io/IOBuf.h>
 
 #include <chrono>
+#include <optional>
 #include <vector>
 
 namespace facebook::fboss {
@@ -109,6 +110,10 @@ class PcapPkt {
   std::vector<RxReason> getReasons() {
     return reasons_;
   }
+  // CPU queue an RX packet was received on, if the HW reports it
+  std::optional<uint32_t> cosQueue() const {
+    return cosQueue_;
+  }
 
   // Move assignment
   PcapPkt(PcapPkt&& other) noexcept {
@@ -124,6 +129,7 @@ class PcapPkt {
     timestamp_ = other.timestamp_;
     buf_ = std::move(other.buf_);
     reasons_ = std::move(other.reasons_);
+    cosQueue_ = other.cosQueue_;
     return *this;
   }
 
@@ -149,6 +155,7 @@ class PcapPkt {
   folly::IOBuf buf_;
   // Reasons for sending packet to CPU
   std::vector<RxReason> reasons_;
+  std::optional<uint32_t> cosQueue_;
 };
 
 } // namespace facebook::fboss
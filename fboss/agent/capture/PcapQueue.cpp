@@ -11,7 +11,6 @@
 
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/TxPacket.h"
-#include "fboss/agent/capture/PcapPkt.h"
 
 DEFINE_int32(
     fboss_pcap_queue_depth,
@@ -25,95 +24,88 @@ namespace facebook::fboss {
 PcapQueue::PcapQueue(uint32_t pktCapacity, uint64_t bytesCapacity)
     : pktCapacity_(
           pktCapacity == 0 ? FLAGS_fboss_pcap_queue_depth : pktCapacity),
-      bytesCapacity_(bytesCapacity) {
-  queue_.reserve(pktCapacity_);
-}
+      bytesCapacity_(bytesCapacity),
+      queue_(pktCapacity_) {}
 
 PcapQueue::~PcapQueue() {}
 
 template <typename PktType>
 void PcapQueue::addPktInternal(const PktType* pkt) {
-  // Check to see if this would exceed the queue capacity.
-  if (queue_.size() >= pktCapacity_) {
-    pktsDropped_ += 1;
-    return;
-  }
-  auto newBytes = bytesInQueue_ + pkt->buf()->computeChainDataLength();
-  if (bytesCapacity_ > 0 && newBytes >= bytesCapacity_) {
-    pktsDropped_ += 1;
+  if (finished_.load(std::memory_order_acquire)) {
     return;
   }
 
-  queue_.emplace_back(pkt);
-}
+  auto len = pkt->buf()->computeChainDataLength();
+  if (bytesCapacity_ > 0) {
+    auto newBytes =
+        bytesInQueue_.fetch_add(len, std::memory_order_relaxed) + len;
+    if (newBytes >= bytesCapacity_) {
+      bytesInQueue_.fetch_sub(len, std::memory_order_relaxed);
+      pktsDropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
 
-void PcapQueue::addPkt(const RxPacket* pkt) {
-  {
-    std::lock_guard<std::mutex> guard(mutex_);
-    addPktInternal(pkt);
+  // The packet is only cloned into the ring once a slot has been claimed
+  if (!queue_.write(pkt)) {
+    if (bytesCapacity_ > 0) {
+      bytesInQueue_.fetch_sub(len, std::memory_order_relaxed);
+    }
+    pktsDropped_.fetch_add(1, std::memory_order_relaxed);
   }
-  cv_.notify_one();
 }
 
-void PcapQueue::addPktLocked(const RxPacket* pkt) {
+void PcapQueue::addPkt(const RxPacket* pkt) {
   addPktInternal(pkt);
-  // It is preferred not to be holding the lock when we signal cv_,
-  // but it is okay to call it with the lock held anyway.  (Having the lock
-  // held will just prevent the reader thread from being able to acquire it
-  // immediately when the reader wakes.)
-  cv_.notify_one();
 }
 
 void PcapQueue::addPkt(const TxPacket* pkt) {
-  {
-    std::lock_guard<std::mutex> guard(mutex_);
-    addPktInternal(pkt);
-  }
-  cv_.notify_one();
-}
-
-void PcapQueue::addPktLocked(const TxPacket* pkt) {
   addPktInternal(pkt);
-  // It is preferred not to be holding the lock when we signal cv_,
-  // but it is okay to call it with the lock held anyway.  (Having the lock
-  // held will just prevent the reader thread from being able to acquire it
-  // immediately when the reader wakes.)
-  cv_.notify_one();
 }
 
 void PcapQueue::finish() {
-  std::lock_guard<std::mutex> guard(mutex_);
-  finished_ = true;
-  cv_.notify_all();
+  // Only a flag: the reader may already be gone (e.g. after a write error)
+  // with the queue full, and finish() is called with captures locked.
+  finished_.store(true, std::memory_order_release);
 }
 
 bool PcapQueue::isFinished() const {
-  std::lock_guard<std::mutex> guard(mutex_);
-  return finished_;
+  return finished_.load(std::memory_order_acquire);
 }
 
 uint64_t PcapQueue::numDropped() const {
-  std::lock_guard<std::mutex> guard(mutex_);
-  return pktsDropped_;
+  return pktsDropped_.load(std::memory_order_relaxed);
 }
 
 bool PcapQueue::wait(std::vector<PcapPkt>* swapQueue) {
   swapQueue->clear();
+  if (readerFinished_) {
+    return false;
+  }
   swapQueue->reserve(pktCapacity_);
 
-  std::unique_lock<std::mutex> guard(mutex_);
-  while (queue_.empty() && !finished_) {
-    cv_.wait(guard);
+  PcapPkt pkt;
+  while (!queue_.tryReadUntil(
+      std::chrono::steady_clock::now() + kFinishPollInterval, pkt)) {
+    if (finished_.load(std::memory_order_acquire)) {
+      // Packets that raced with finish() may have landed since the timeout
+      if (!queue_.read(pkt)) {
+        readerFinished_ = true;
+        return false;
+      }
+      break;
+    }
   }
-  if (queue_.empty()) {
-    DCHECK(finished_);
-    queue_.shrink_to_fit();
-    return false;
+  while (true) {
+    if (bytesCapacity_ > 0) {
+      bytesInQueue_.fetch_sub(
+          pkt.buf()->computeChainDataLength(), std::memory_order_relaxed);
+    }
+    swapQueue->push_back(std::move(pkt));
+    if (swapQueue->size() >= pktCapacity_ || !queue_.read(pkt)) {
+      return true;
+    }
   }
-
-  swapQueue->swap(queue_);
-  bytesInQueue_ = 0;
-  return true;
 }
 
 } // namespace facebook::fboss
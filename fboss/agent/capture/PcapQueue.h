@@ -9,21 +9,28 @@
  */
 #pragma once
 
-#include <condition_variable>
-#include <mutex>
+#include "fboss/agent/capture/PcapPkt.h"
+
+#include <folly/MPMCQueue.h>
+
+#include <atomic>
+#include <chrono>
 #include <vector>
 
 namespace facebook::fboss {
 
 class RxPacket;
 class TxPacket;
-class PcapPkt;
 
 /*
  * PcapQueue stores a queue of PcapPkt objects, for transferring packets
  * from an asynchronous capture thread to a blocking thread that will process
  * the packets.  (For instance, writing them to disk using blocking I/O.)
  *
+ * Packets are added from the RX and TX paths, so adding must never block.
+ * The queue is a bounded lock free ring preallocated to its packet capacity,
+ * a packet that does not fit is dropped and counted without being copied.
+ *
  * There can only be a single reader.
  */
 class PcapQueue {
@@ -32,31 +39,22 @@ class PcapQueue {
   virtual ~PcapQueue();
 
   uint32_t getPktCapacity() const {
-    // pktCapacity_ is const, so no need for locking
     return pktCapacity_;
   }
 
   /*
-   * Get the mutex protecting this PcapQueue.
-   *
-   * This is exposed to allow callers to also protect their own data
-   * with the same mutex if desired.  Callers should call addPktLocked()
-   * instead of addPkt() when they are already holding the PcapQueue mutex.
+   * addPkt() is safe to call from any number of threads concurrently.
    */
-  std::mutex& mutex() const {
-    return mutex_;
-  }
-
   void addPkt(const RxPacket* pkt);
-  void addPktLocked(const RxPacket* pkt);
   void addPkt(const TxPacket* pkt);
-  void addPktLocked(const TxPacket* pkt);
 
   /*
    * finish() signals that no more packets will be added to the queue.
    *
    * This causes wait() to return false in the reader thread once the packets
-   * currently in the queue have been read.
+   * currently in the queue have been read.  Packets added after finish() are
+   * silently discarded.  finish() never blocks, the reader notices it within
+   * kFinishPollInterval.
    */
   void finish();
   bool isFinished() const;
@@ -74,7 +72,7 @@ class PcapQueue {
    * Wait for new packets from the queue.
    *
    * Note: for best performance, the writer should re-use the same vector
-   * for multiple wait() calls.  On subsequent calls the queue will already
+   * for multiple wait() calls.  On subsequent calls the vector will already
    * have the desired capacity, and will not need to reallocate memory.
    */
   bool wait(std::vector<PcapPkt>* swapQueue);
@@ -87,15 +85,17 @@ class PcapQueue {
   template <typename PktType>
   void addPktInternal(const PktType* pkt);
 
-  mutable std::mutex mutex_;
-  std::condition_variable cv_;
+  // How long wait() blocks on an empty queue before checking finished_
+  static constexpr std::chrono::milliseconds kFinishPollInterval{100};
 
-  bool finished_{false};
   const uint32_t pktCapacity_{0};
-  uint64_t bytesCapacity_{0};
-  uint64_t bytesInQueue_{0};
-  uint64_t pktsDropped_{0};
-  std::vector<PcapPkt> queue_;
+  const uint64_t bytesCapacity_{0};
+  std::atomic<uint64_t> bytesInQueue_{0};
+  std::atomic<uint64_t> pktsDropped_{0};
+  std::atomic<bool> finished_{false};
+  // Only accessed by the reader, set once the queue is drained after finish()
+  bool readerFinished_{false};
+  folly::MPMCQueue<PcapPkt> queue_;
 };
 
 } // namespace facebook::fboss
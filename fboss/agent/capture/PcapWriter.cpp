@@ -23,8 +23,9 @@ PcapWriter::PcapWriter(uint32_t maxBufferedPkts) : queue_(maxBufferedPkts) {}
 PcapWriter::PcapWriter(
     StringPiece path,
     bool overwriteExisting,
-    uint32_t maxBufferedPkts)
-    : file_(path, overwriteExisting),
+    uint32_t maxBufferedPkts,
+    PcapFormat format)
+    : file_(path, overwriteExisting, format),
       queue_(maxBufferedPkts),
       thread_(&PcapWriter::threadMain, this) {}
 
@@ -40,8 +41,11 @@ PcapWriter::~PcapWriter() {
   }
 }
 
-void PcapWriter::start(folly::StringPiece path, bool overwriteExisting) {
-  file_ = PcapFile(path, overwriteExisting);
+void PcapWriter::start(
+    folly::StringPiece path,
+    bool overwriteExisting,
+    PcapFormat format) {
+  file_ = PcapFile(path, overwriteExisting, format);
   thread_ = std::thread(&PcapWriter::threadMain, this);
 }
 
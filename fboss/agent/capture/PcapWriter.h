@@ -18,9 +18,10 @@ namespace facebook::fboss {
 
 /*
  * PcapWriter listes to a PcapQueue and writes the packets it receives
- * to a pcap file.
+ * to a pcap or pcapng file.
  *
  * It performs blocking disk I/O, so it performs the writes in its own thread.
+ * Adding packets never blocks and is safe from any thread.
  */
 class PcapWriter {
  public:
@@ -28,34 +29,21 @@ class PcapWriter {
   explicit PcapWriter(
       folly::StringPiece path,
       bool overwriteExisting = false,
-      uint32_t maxBufferedPkts = 0);
+      uint32_t maxBufferedPkts = 0,
+      PcapFormat format = PcapFormat::PCAP);
   virtual ~PcapWriter();
 
-  void start(folly::StringPiece path, bool overwriteExisting = false);
-
-  /*
-   * Get the mutex protecting this PcapWriter.
-   *
-   * This is exposed to allow callers to also protect their own data
-   * with the same mutex if desired.  Callers should call addPktLocked()
-   * instead of addPkt() when they are already holding the PcapWriter mutex.
-   */
-  std::mutex& mutex() const {
-    return queue_.mutex();
-  }
+  void start(
+      folly::StringPiece path,
+      bool overwriteExisting = false,
+      PcapFormat format = PcapFormat::PCAP);
 
   void addPkt(const RxPacket* pkt) {
     queue_.addPkt(pkt);
   }
-  void addPktLocked(const RxPacket* pkt) {
-    queue_.addPktLocked(pkt);
-  }
   void addPkt(const TxPacket* pkt) {
     queue_.addPkt(pkt);
   }
-  void addPktLocked(const TxPacket* pkt) {
-    queue_.addPktLocked(pkt);
-  }
   void finish();
 
   /*
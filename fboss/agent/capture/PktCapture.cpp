@@ -27,15 +27,25 @@ PktCapture::PktCapture(
     folly::StringPiece name,
     uint64_t maxPackets,
     CaptureDirection direction,
-    const CaptureFilter& captureFilter)
+    const CaptureFilter& captureFilter,
+    CaptureFormat format)
     : name_(name.str()),
       maxPackets_(maxPackets),
       direction_(direction),
+      format_(format),
       packetFilter_(captureFilter) {}
 
+StringPiece PktCapture::fileExtension() const {
+  return format_ == CaptureFormat::PCAPNG ? ".pcapng" : ".pcap";
+}
+
 void PktCapture::start(StringPiece path) {
   XLOG(INFO) << "starting packet capture " << toString();
-  writer_.start(path, true);
+  writer_.start(
+      path,
+      true,
+      format_ == CaptureFormat::PCAPNG ? PcapFormat::PCAPNG
+                                       : PcapFormat::PCAP);
 }
 
 void PktCapture::stop() {
@@ -43,23 +53,29 @@ void PktCapture::stop() {
   XLOG(INFO) << "Stopped packet capture " << toString(true);
 }
 
+bool PktCapture::belowMaxPackets() const {
+  return numPacketsSent_.load(std::memory_order_relaxed) +
+      numPacketsReceived_.load(std::memory_order_relaxed) <
+      maxPackets_;
+}
+
 bool PktCapture::packetReceived(const RxPacket* pkt) {
-  std::lock_guard<std::mutex> guard(writer_.mutex());
-  if (direction_ != CaptureDirection::CAPTURE_ONLY_TX &&
-      true == packetFilter_.passes(pkt)) {
-    ++numPacketsReceived_;
-    writer_.addPktLocked(pkt);
+  // Concurrent RX and TX threads may overshoot maxPackets by a few packets
+  if (direction_ != CaptureDirection::CAPTURE_ONLY_TX && belowMaxPackets() &&
+      packetFilter_.passes(pkt)) {
+    numPacketsReceived_.fetch_add(1, std::memory_order_relaxed);
+    writer_.addPkt(pkt);
   }
-  return (numPacketsSent_ + numPacketsReceived_) < maxPackets_;
+  return belowMaxPackets();
 }
 
 bool PktCapture::packetSent(const TxPacket* pkt) {
-  std::lock_guard<std::mutex> guard(writer_.mutex());
-  if (direction_ != CaptureDirection::CAPTURE_ONLY_RX) {
-    ++numPacketsSent_;
-    writer_.addPktLocked(pkt);
+  if (direction_ != CaptureDirection::CAPTURE_ONLY_RX && belowMaxPackets() &&
+      packetFilter_.passes(pkt)) {
+    numPacketsSent_.fetch_add(1, std::memory_order_relaxed);
+    writer_.addPkt(pkt);
   }
-  return (numPacketsSent_ + numPacketsReceived_) < maxPackets_;
+  return belowMaxPackets();
 }
 
 std::string PktCapture::toString(bool withStats) const {
@@ -70,8 +86,9 @@ std::string PktCapture::toString(bool withStats) const {
              : ((direction_ == CaptureDirection::CAPTURE_ONLY_RX) ? "RX only"
                                                                   : "TX only"));
   if (withStats) {
-    ss << ", Packet received:" << numPacketsReceived_
-       << ", Packet sent:" << numPacketsSent_;
+    ss << ", Packet received:" << numPacketsReceived_.load()
+       << ", Packet sent:" << numPacketsSent_.load()
+       << ", Packet dropped:" << writer_.numDropped();
   }
   return ss.str();
 }
@@ -9,11 +9,13 @@
  */
 #pragma once
 
+#include "fboss/agent/capture/BpfFilter.h"
 #include "fboss/agent/capture/PcapWriter.h"
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 
 #include <boost/container/flat_set.hpp>
 #include <folly/Range.h>
+#include <atomic>
 #include <string>
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/TxPacket.h"
@@ -37,17 +39,26 @@ class RxPacketFilter {
   boost::container::flat_set<CpuCosQueueId> cosQueues_;
 };
 
+/*
+ * Filters are evaluated on the RX/TX path before the packet is copied into
+ * the capture, the cheap cos queue check runs ahead of the BPF program.
+ */
 class PacketFilter {
  public:
   explicit PacketFilter(const CaptureFilter& captureFilter)
-      : rxPacketFilter_(captureFilter.get_rxCaptureFilter()) {}
+      : rxPacketFilter_(captureFilter.get_rxCaptureFilter()),
+        bpfFilter_(captureFilter.get_bpfFilter()) {}
 
-  bool passes(const RxPacket* pkt) {
-    return rxPacketFilter_.passes(pkt);
+  bool passes(const RxPacket* pkt) const {
+    return rxPacketFilter_.passes(pkt) && bpfFilter_.matches(pkt->buf());
+  }
+  bool passes(const TxPacket* pkt) const {
+    return bpfFilter_.matches(pkt->buf());
   }
 
  private:
   RxPacketFilter rxPacketFilter_;
+  BpfFilter bpfFilter_;
 };
 
 /*
@@ -63,15 +74,24 @@ class PktCapture {
       folly::StringPiece name,
       uint64_t maxPackets,
       CaptureDirection direction,
-      const CaptureFilter& captureFilter);
+      const CaptureFilter& captureFilter,
+      CaptureFormat format = CaptureFormat::PCAP);
 
   const std::string& name() const {
     return name_;
   }
 
+  // File name extension matching the capture format
+  folly::StringPiece fileExtension() const;
+
   void start(folly::StringPiece path);
   void stop();
 
+  /*
+   * packetReceived() and packetSent() are lock free and may be called
+   * concurrently from the RX and TX threads.  They return false once the
+   * capture has reached maxPackets.
+   */
   bool packetReceived(const RxPacket* pkt);
   bool packetSent(const TxPacket* pkt);
 
@@ -82,15 +102,16 @@ class PktCapture {
   PktCapture(PktCapture const&) = delete;
   PktCapture& operator=(PktCapture const&) = delete;
 
+  bool belowMaxPackets() const;
+
   const std::string name_;
 
-  // Note: the rest of the state in this class is protcted by
-  // the PcapWriter's mutex.
   PcapWriter writer_;
   uint64_t maxPackets_{0};
-  uint64_t numPacketsReceived_{0};
-  uint64_t numPacketsSent_{0};
+  std::atomic<uint64_t> numPacketsReceived_{0};
+  std::atomic<uint64_t> numPacketsSent_{0};
   CaptureDirection direction_{CaptureDirection::CAPTURE_TX_RX};
+  CaptureFormat format_{CaptureFormat::PCAP};
   PacketFilter packetFilter_;
 };
 } // namespace facebook::fboss
@@ -18,6 +18,8 @@
 #include <folly/String.h>
 #include <folly/logging/xlog.h>
 
+#include <vector>
+
 using folly::StringPiece;
 using std::string;
 using std::unique_ptr;
@@ -35,10 +37,10 @@ PktCaptureManager::~PktCaptureManager() {}
 void PktCaptureManager::startCapture(unique_ptr<PktCapture> capture) {
   checkCaptureName(capture->name());
 
-  auto path =
-      folly::to<std::string>(captureDir_, "/", capture->name(), ".pcap");
+  auto path = folly::to<std::string>(
+      captureDir_, "/", capture->name(), capture->fileExtension());
 
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&mutex_);
 
   const auto& name = capture->name();
   if (activeCaptures_.find(name) != activeCaptures_.end()) {
@@ -51,7 +53,7 @@ void PktCaptureManager::startCapture(unique_ptr<PktCapture> capture) {
 }
 
 void PktCaptureManager::stopCapture(StringPiece name) {
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&mutex_);
 
   auto nameStr = name.str();
   auto it = activeCaptures_.find(nameStr);
@@ -65,7 +67,7 @@ void PktCaptureManager::stopCapture(StringPiece name) {
 }
 
 unique_ptr<PktCapture> PktCaptureManager::forgetCapture(StringPiece name) {
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&mutex_);
   auto nameStr = name.str();
   auto activeIt = activeCaptures_.find(nameStr);
   if (activeIt != activeCaptures_.end()) {
@@ -87,50 +89,58 @@ unique_ptr<PktCapture> PktCaptureManager::forgetCapture(StringPiece name) {
 }
 
 void PktCaptureManager::stopAllCaptures() {
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&mutex_);
 
   // FIXME
 }
 
 void PktCaptureManager::forgetAllCaptures() {
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&mutex_);
 
   // FIXME
 }
 
 template <typename Fn>
 void PktCaptureManager::invokeCaptures(const Fn& fn) {
-  std::lock_guard<std::mutex> g(mutex_);
-
-  for (auto it = activeCaptures_.begin(); it != activeCaptures_.end();
-       /* increment in loop */) {
-    // Increment the iterator now, in case this capture deactivates itself and
-    // we need to remove it from the active captures.
-    auto thisIt = it;
-    ++it;
-    PktCapture* capture = thisIt->second.get();
-    bool stillActive = false;
-    try {
-      stillActive = fn(capture);
-    } catch (const std::exception& ex) {
-      XLOG(ERR) << "error when processing packet for capture "
-                << capture->name() << " : " << folly::exceptionStr(ex);
-      stillActive = false;
-    }
-
-    if (!stillActive) {
-      XLOG(INFO) << "auto-stopping packet capture \"" << capture->name()
-                 << "\"";
+  // Captures that reached their packet limit. Empty in the common case, so
+  // this does not allocate.
+  std::vector<std::string> finished;
+  {
+    folly::SharedMutexWritePriority::ReadHolder g(&mutex_);
+    for (const auto& [name, capture] : activeCaptures_) {
+      bool stillActive = false;
       try {
-        inactiveCaptures_[capture->name()] = std::move(thisIt->second);
+        stillActive = fn(capture.get());
       } catch (const std::exception& ex) {
-        XLOG(ERR) << "error adding capture " << capture->name()
-                  << " to the inactive list";
-        // Can't do much else here.  Just continue and forget the capture.
+        XLOG(ERR) << "error when processing packet for capture " << name
+                  << " : " << folly::exceptionStr(ex);
+        stillActive = false;
+      }
+      if (!stillActive) {
+        finished.push_back(name);
       }
-      activeCaptures_.erase(thisIt);
     }
   }
+  if (finished.empty()) {
+    return;
+  }
+
+  folly::SharedMutexWritePriority::WriteHolder g(&mutex_);
+  for (const auto& name : finished) {
+    // Another thread may have retired or stopped the capture meanwhile
+    auto it = activeCaptures_.find(name);
+    if (it == activeCaptures_.end()) {
+      continue;
+    }
+    XLOG(INFO) << "auto-stopping packet capture \"" << name << "\"";
+    try {
+      inactiveCaptures_[name] = std::move(it->second);
+    } catch (const std::exception& ex) {
+      XLOG(ERR) << "error adding capture " << name << " to the inactive list";
+      // Can't do much else here.  Just continue and forget the capture.
+    }
+    activeCaptures_.erase(it);
+  }
 
   bool running = !activeCaptures_.empty();
   capturesRunning_.store(running, std::memory_order_release);
@@ -10,11 +10,11 @@
 #pragma once
 
 #include <folly/Range.h>
+#include <folly/SharedMutex.h>
 
 #include <atomic>
 #include <map>
 #include <memory>
-#include <mutex>
 #include <string>
 
 namespace facebook::fboss {
@@ -89,7 +89,12 @@ class PktCaptureManager {
 
   std::atomic<bool> capturesRunning_{false};
 
-  std::mutex mutex_;
+  /*
+   * Packets are delivered to the active captures under a read lock, so the
+   * RX and TX threads do not serialize on each other. Starting, stopping and
+   * retiring captures takes the write lock.
+   */
+  folly::SharedMutexWritePriority mutex_;
   std::string captureDir_;
   std::map<std::string, std::unique_ptr<PktCapture>> activeCaptures_;
   std::map<std::string, std::unique_ptr<PktCapture>> inactiveCaptures_;
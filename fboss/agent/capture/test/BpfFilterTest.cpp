@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/capture/BpfFilter.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/packet/PktUtil.h"
+
+#include <folly/Conv.h>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+
+BpfInstruction insn(int16_t code, int16_t jt, int16_t jf, int64_t k) {
+  BpfInstruction instruction;
+  *instruction.code_ref() = code;
+  *instruction.jt_ref() = jt;
+  *instruction.jf_ref() = jf;
+  *instruction.k_ref() = k;
+  return instruction;
+}
+
+// tcpdump -ddd "ip and tcp dst port 22"
+std::vector<BpfInstruction> sshProgram() {
+  return {
+      insn(0x28, 0, 0, 12),
+      insn(0x15, 0, 8, 0x800),
+      insn(0x30, 0, 0, 23),
+      insn(0x15, 0, 6, 6),
+      insn(0x28, 0, 0, 20),
+      insn(0x45, 4, 0, 0x1fff),
+      insn(0xb1, 0, 0, 14),
+      insn(0x48, 0, 0, 16),
+      insn(0x15, 0, 1, 22),
+      insn(0x6, 0, 0, 262144),
+      insn(0x6, 0, 0, 0),
+  };
+}
+
+folly::IOBuf tcpPkt(folly::StringPiece dstPort) {
+  return PktUtil::parseHexData(folly::to<std::string>(
+      // dst mac, src mac
+      "02 00 01 00 00 01  02 00 02 01 02 03"
+      // IPv4
+      "08 00"
+      // Version(4), IHL(5), DSCP(0), ECN(0), Total Length(40)
+      "45  00  00 28"
+      // Identification(0), Flags(0), Fragment offset(0)
+      "00 00  00 00"
+      // TTL(31), Protocol(6), Checksum (0, fake)
+      "1F  06  00 00"
+      // Source IP (1.2.3.4)
+      "01 02 03 04"
+      // Destination IP (10.0.0.10)
+      "0a 00 00 0a"
+      // Source port (1024), destination port
+      "04 00",
+      dstPort,
+      // Rest of the TCP header
+      "00 00 00 00  00 00 00 00  50 02 00 00  00 00 00 00"));
+}
+
+} // namespace
+
+TEST(BpfFilterTest, EmptyMatchesAll) {
+  BpfFilter filter;
+  auto pkt = tcpPkt("00 16");
+  EXPECT_TRUE(filter.empty());
+  EXPECT_TRUE(filter.matches(&pkt));
+}
+
+TEST(BpfFilterTest, TcpDstPort) {
+  BpfFilter filter(sshProgram());
+  auto ssh = tcpPkt("00 16");
+  auto http = tcpPkt("00 50");
+  EXPECT_TRUE(filter.matches(&ssh));
+  EXPECT_FALSE(filter.matches(&http));
+}
+
+TEST(BpfFilterTest, ChainedBuffer) {
+  BpfFilter filter(sshProgram());
+  auto ssh = tcpPkt("00 16");
+  // Split the packet in the middle of the IP header
+  auto head = folly::IOBuf::copyBuffer(ssh.data(), 20);
+  head->prependChain(
+      folly::IOBuf::copyBuffer(ssh.data() + 20, ssh.length() - 20));
+  EXPECT_TRUE(filter.matches(head.get()));
+}
+
+TEST(BpfFilterTest, TruncatedPacket) {
+  BpfFilter filter(sshProgram());
+  auto ssh = tcpPkt("00 16");
+  // Out of bounds loads reject the packet
+  auto truncated = folly::IOBuf::copyBuffer(ssh.data(), 30);
+  EXPECT_FALSE(filter.matches(truncated.get()));
+}
+
+TEST(BpfFilterTest, InvalidPrograms) {
+  // Jump past the end of the program
+  EXPECT_THROW(
+      BpfFilter({insn(0x15, 0, 5, 1), insn(0x6, 0, 0, 1)}), FbossError);
+  // Does not end with a return
+  EXPECT_THROW(BpfFilter({insn(0x28, 0, 0, 12)}), FbossError);
+  // Scratch memory out of range
+  EXPECT_THROW(
+      BpfFilter({insn(0x02, 0, 0, 16), insn(0x6, 0, 0, 1)}), FbossError);
+  // Division by constant zero
+  EXPECT_THROW(
+      BpfFilter({insn(0x34, 0, 0, 0), insn(0x6, 0, 0, 1)}), FbossError);
+}
@@ -31,6 +31,22 @@ void pktWaitThread(PcapQueue* queue, std::vector<PcapPkt>* results) {
   }
 }
 
+namespace {
+std::unique_ptr<MockRxPacket> makePkt() {
+  auto pkt = MockRxPacket::fromHex(
+      // dst mac, src mac
+      "02 00 01 00 00 01  02 00 02 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00 00 01"
+      // ARP
+      "08 06");
+  pkt->padToLength(68);
+  pkt->setSrcPort(PortID(1));
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+} // namespace
+
 TEST(PcapQueueTest, SimpleAdd) {
   PcapQueue queue(100);
   std::vector<PcapPkt> waitedPkts;
@@ -71,3 +87,22 @@ TEST(PcapQueueTest, SimpleAdd) {
   ByteRange waitedPktData = waitedPktBufClone->coalesce();
   EXPECT_EQ(expectedPktData, waitedPktData);
 }
+
+TEST(PcapQueueTest, FinishFullQueueWithoutReader) {
+  PcapQueue queue(4);
+  auto pkt = makePkt();
+  for (auto i = 0; i < 5; ++i) {
+    queue.addPkt(pkt.get());
+  }
+  EXPECT_EQ(1, queue.numDropped());
+
+  // Must not wait for a reader to make room
+  queue.finish();
+  EXPECT_TRUE(queue.isFinished());
+  queue.addPkt(pkt.get());
+
+  // Packets queued before finish() are still handed out
+  std::vector<PcapPkt> waitedPkts;
+  pktWaitThread(&queue, &waitedPkts);
+  EXPECT_EQ(4, waitedPkts.size());
+}
@@ -71,6 +71,30 @@ TEST(PcapWriterTest, Write) {
   }
 }
 
+TEST(PcapWriterTest, WritePcapng) {
+  char tmpPath[] = "fbossPcapTest.XXXXXX";
+  int tmpFD = mkstemp(tmpPath);
+  folly::checkUnixError(tmpFD, "failed to create temporary file");
+  SCOPE_EXIT {
+    close(tmpFD);
+    unlink(tmpPath);
+  };
+
+  PcapWriter writer(tmpPath, true, 0, PcapFormat::PCAPNG);
+  uint32_t numPkts = 1000;
+  addPackets(&writer, numPkts);
+  writer.finish();
+  EXPECT_EQ(0, writer.numDropped());
+
+  // libpcap reads pcapng files transparently
+  auto pcapPkts = readPcapFile(tmpPath);
+  EXPECT_EQ(numPkts, pcapPkts.size());
+  for (const auto& pktInfo : pcapPkts) {
+    EXPECT_EQ(68, pktInfo.hdr.len);
+    EXPECT_EQ(68, pktInfo.hdr.caplen);
+  }
+}
+
 TEST(PcapWriterTest, Drop) {
   char tmpPath[] = "fbossPcapTest.XXXXXX";
   int tmpFD = mkstemp(tmpPath);
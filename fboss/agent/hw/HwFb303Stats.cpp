@@ -67,6 +67,13 @@ void HwFb303Stats::removeStat(const std::string& statName) {
   counters_.erase(stat->getName());
 }
 
+HwFb303Stats::CounterHandle HwFb303Stats::getCounterHandle(
+    const std::string& statName) {
+  auto stat = getCounterIf(statName);
+  CHECK(stat) << "No stat: " << statName;
+  return stat;
+}
+
 void HwFb303Stats::updateStat(
     const std::chrono::seconds& now,
     const std::string& statName,
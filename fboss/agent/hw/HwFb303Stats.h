@@ -14,12 +14,20 @@
 
 #include "folly/container/F14Map.h"
 
+#include <chrono>
 #include <optional>
 #include <string>
 namespace facebook::fboss {
 
 class HwFb303Stats {
  public:
+  /*
+   * Direct handle to a stat, for callers updating the same stats every
+   * collection cycle without building stat names. A handle stays valid
+   * until its stat is removed or renamed.
+   */
+  using CounterHandle = stats::MonotonicCounter*;
+
   ~HwFb303Stats();
 
   int64_t getCounterLastIncrement(const std::string& statName) const;
@@ -36,14 +44,24 @@ class HwFb303Stats {
       int64_t val);
   void removeStat(const std::string& statName);
 
+  CounterHandle getCounterHandle(const std::string& statName);
+  static void updateStat(
+      const std::chrono::seconds& now,
+      CounterHandle counter,
+      int64_t val) {
+    counter->updateValue(now, val);
+  }
+
+  const stats::MonotonicCounter* getCounterIf(
+      const std::string& statName) const;
+
  private:
   /*
    * Update queue stat
    */
   stats::MonotonicCounter* getCounterIf(const std::string& statName);
-  const stats::MonotonicCounter* getCounterIf(
-      const std::string& statName) const;
 
-  folly::F14FastMap<std::string, stats::MonotonicCounter> counters_;
+  // Node map, so handles survive inserts of other stats
+  folly::F14NodeMap<std::string, stats::MonotonicCounter> counters_;
 };
 } // namespace facebook::fboss
@@ -16,7 +16,8 @@
 
 namespace facebook::fboss {
 
-std::array<folly::StringPiece, 23> HwPortFb303Stats::kPortStatKeys() {
+std::array<folly::StringPiece, HwPortFb303Stats::kNumPortStats>
+HwPortFb303Stats::kPortStatKeys() {
   return {
       kInBytes(),
       kInUnicastPkts(),
@@ -44,7 +45,8 @@ std::array<folly::StringPiece, 23> HwPortFb303Stats::kPortStatKeys() {
   };
 }
 
-std::array<folly::StringPiece, 3> HwPortFb303Stats::kQueueStatKeys() {
+std::array<folly::StringPiece, HwPortFb303Stats::kNumQueueStats>
+HwPortFb303Stats::kQueueStatKeys() {
   return {kOutCongestionDiscards(), kOutBytes(), kOutPkts()};
 }
 
@@ -88,6 +90,25 @@ void HwPortFb303Stats::reinitStats(std::optional<std::string> oldPortName) {
       portCounters_.reinitStat(newStatName, oldStatName);
     }
   }
+  resolveCounterHandles();
+}
+
+void HwPortFb303Stats::resolveCounterHandles() {
+  auto portStatKeys = kPortStatKeys();
+  for (size_t i = 0; i < portStatKeys.size(); ++i) {
+    portCounterHandles_[i] =
+        portCounters_.getCounterHandle(statName(portStatKeys[i], portName_));
+  }
+  queueCounterHandles_.clear();
+  for (const auto& [queueId, queueName] : queueId2Name_) {
+    QueueCounterHandles queueHandles{queueId, {}};
+    auto queueStatKeys = kQueueStatKeys();
+    for (size_t i = 0; i < queueStatKeys.size(); ++i) {
+      queueHandles.counters[i] = portCounters_.getCounterHandle(
+          statName(queueStatKeys[i], portName_, queueId, queueName));
+    }
+    queueCounterHandles_.push_back(queueHandles);
+  }
 }
 
 /*
@@ -126,6 +147,7 @@ void HwPortFb303Stats::queueChanged(int queueId, const std::string& queueName) {
   for (auto statKey : kQueueStatKeys()) {
     reinitStat(statKey, queueId, oldQueueName);
   }
+  resolveCounterHandles();
 }
 
 void HwPortFb303Stats::queueRemoved(int queueId) {
@@ -135,104 +157,62 @@ void HwPortFb303Stats::queueRemoved(int queueId) {
         statName(statKey, portName_, queueId, queueId2Name_[queueId]));
   }
   queueId2Name_.erase(queueId);
+  resolveCounterHandles();
 }
 
 void HwPortFb303Stats::updateStats(
     const HwPortStats& curPortStats,
     const std::chrono::seconds& retrievedAt) {
   timeRetrieved_ = retrievedAt;
-  updateStat(timeRetrieved_, kInBytes(), *curPortStats.inBytes__ref());
-  updateStat(
-      timeRetrieved_, kInUnicastPkts(), *curPortStats.inUnicastPkts__ref());
-  updateStat(
-      timeRetrieved_, kInMulticastPkts(), *curPortStats.inMulticastPkts__ref());
-  updateStat(
-      timeRetrieved_, kInBroadcastPkts(), *curPortStats.inBroadcastPkts__ref());
-  updateStat(
-      timeRetrieved_, kInDiscardsRaw(), *curPortStats.inDiscardsRaw__ref());
-  updateStat(timeRetrieved_, kInDiscards(), *curPortStats.inDiscards__ref());
-  updateStat(timeRetrieved_, kInErrors(), *curPortStats.inErrors__ref());
-  updateStat(timeRetrieved_, kInPause(), *curPortStats.inPause__ref());
-  updateStat(
-      timeRetrieved_, kInIpv4HdrErrors(), *curPortStats.inIpv4HdrErrors__ref());
-  updateStat(
-      timeRetrieved_, kInIpv6HdrErrors(), *curPortStats.inIpv6HdrErrors__ref());
-  updateStat(
-      timeRetrieved_,
-      kInDstNullDiscards(),
-      *curPortStats.inDstNullDiscards__ref());
-  // Egress Stats
-  updateStat(timeRetrieved_, kOutBytes(), *curPortStats.outBytes__ref());
-  updateStat(
-      timeRetrieved_, kOutUnicastPkts(), *curPortStats.outUnicastPkts__ref());
-  updateStat(
-      timeRetrieved_,
-      kOutMulticastPkts(),
-      *curPortStats.outMulticastPkts__ref());
-  updateStat(
-      timeRetrieved_,
-      kOutBroadcastPkts(),
-      *curPortStats.outBroadcastPkts__ref());
-  updateStat(timeRetrieved_, kOutDiscards(), *curPortStats.outDiscards__ref());
-  updateStat(timeRetrieved_, kOutErrors(), *curPortStats.outErrors__ref());
-  updateStat(timeRetrieved_, kOutPause(), *curPortStats.outPause__ref());
-  updateStat(
-      timeRetrieved_,
-      kOutCongestionDiscards(),
-      *curPortStats.outCongestionDiscardPkts__ref());
-  updateStat(
-      timeRetrieved_,
-      kWredDroppedPackets(),
-      *curPortStats.wredDroppedPackets__ref());
-  updateStat(
-      timeRetrieved_, kOutEcnCounter(), *curPortStats.outEcnCounter__ref());
-  updateStat(
-      timeRetrieved_,
-      kFecCorrectable(),
-      *curPortStats.fecCorrectableErrors_ref());
-  updateStat(
-      timeRetrieved_,
-      kFecUncorrectable(),
-      *curPortStats.fecUncorrectableErrors_ref());
-
-  // Update queue stats
-  auto updateQueueStat = [this](
-                             folly::StringPiece statKey,
-                             int queueId,
-                             const std::map<int16_t, int64_t>& queueStats) {
-    auto qitr = queueStats.find(queueId);
-    CHECK(qitr != queueStats.end())
-        << "Missing stat: " << statKey
-        << " for queue: :" << queueId2Name_[queueId];
-    updateStat(timeRetrieved_, statKey, queueId, qitr->second);
+  // Values in kPortStatKeys order
+  std::array<int64_t, kNumPortStats> portStatValues{
+      *curPortStats.inBytes__ref(),
+      *curPortStats.inUnicastPkts__ref(),
+      *curPortStats.inMulticastPkts__ref(),
+      *curPortStats.inBroadcastPkts__ref(),
+      *curPortStats.inDiscards__ref(),
+      *curPortStats.inErrors__ref(),
+      *curPortStats.inPause__ref(),
+      *curPortStats.inIpv4HdrErrors__ref(),
+      *curPortStats.inIpv6HdrErrors__ref(),
+      *curPortStats.inDstNullDiscards__ref(),
+      *curPortStats.inDiscardsRaw__ref(),
+      // Egress Stats
+      *curPortStats.outBytes__ref(),
+      *curPortStats.outUnicastPkts__ref(),
+      *curPortStats.outMulticastPkts__ref(),
+      *curPortStats.outBroadcastPkts__ref(),
+      *curPortStats.outDiscards__ref(),
+      *curPortStats.outErrors__ref(),
+      *curPortStats.outPause__ref(),
+      *curPortStats.outCongestionDiscardPkts__ref(),
+      *curPortStats.wredDroppedPackets__ref(),
+      *curPortStats.outEcnCounter__ref(),
+      *curPortStats.fecCorrectableErrors_ref(),
+      *curPortStats.fecUncorrectableErrors_ref(),
   };
-  for (const auto& queueIdAndName : queueId2Name_) {
-    updateQueueStat(
-        kOutCongestionDiscards(),
-        queueIdAndName.first,
-        *curPortStats.queueOutDiscardBytes__ref());
-    updateQueueStat(
-        kOutBytes(), queueIdAndName.first, *curPortStats.queueOutBytes__ref());
-    updateQueueStat(
-        kOutPkts(), queueIdAndName.first, *curPortStats.queueOutPackets__ref());
+  for (size_t i = 0; i < kNumPortStats; ++i) {
+    HwFb303Stats::updateStat(
+        timeRetrieved_, portCounterHandles_[i], portStatValues[i]);
+  }
+
+  // Update queue stats, maps in kQueueStatKeys order
+  std::array<const std::map<int16_t, int64_t>*, kNumQueueStats> queueStats{
+      &*curPortStats.queueOutDiscardBytes__ref(),
+      &*curPortStats.queueOutBytes__ref(),
+      &*curPortStats.queueOutPackets__ref(),
+  };
+  for (const auto& queueHandles : queueCounterHandles_) {
+    for (size_t i = 0; i < kNumQueueStats; ++i) {
+      auto qitr = queueStats[i]->find(queueHandles.queueId);
+      CHECK(qitr != queueStats[i]->end())
+          << "Missing stat: " << kQueueStatKeys()[i]
+          << " for queue: :" << queueId2Name_[queueHandles.queueId];
+      HwFb303Stats::updateStat(
+          timeRetrieved_, queueHandles.counters[i], qitr->second);
+    }
   }
   updateQueueWatermarkStats(*curPortStats.queueWatermarkBytes__ref());
   portStats_ = curPortStats;
 }
-
-void HwPortFb303Stats::updateStat(
-    const std::chrono::seconds& now,
-    folly::StringPiece statKey,
-    int queueId,
-    int64_t val) {
-  portCounters_.updateStat(
-      now, statName(statKey, portName_, queueId, queueId2Name_[queueId]), val);
-}
-
-void HwPortFb303Stats::updateStat(
-    const std::chrono::seconds& now,
-    folly::StringPiece statKey,
-    int64_t val) {
-  portCounters_.updateStat(now, statName(statKey, portName_), val);
-}
 } // namespace facebook::fboss
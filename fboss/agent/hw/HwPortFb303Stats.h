@@ -15,8 +15,10 @@
 
 #include "folly/container/F14Map.h"
 
+#include <array>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace facebook::fboss {
 
@@ -70,8 +72,10 @@ class HwPortFb303Stats {
       int queueId,
       folly::StringPiece queueName);
 
-  static std::array<folly::StringPiece, 23> kPortStatKeys();
-  static std::array<folly::StringPiece, 3> kQueueStatKeys();
+  static constexpr size_t kNumPortStats = 23;
+  static constexpr size_t kNumQueueStats = 3;
+  static std::array<folly::StringPiece, kNumPortStats> kPortStatKeys();
+  static std::array<folly::StringPiece, kNumQueueStats> kQueueStatKeys();
   int64_t getCounterLastIncrement(folly::StringPiece statKey) const;
 
  private:
@@ -98,26 +102,24 @@ class HwPortFb303Stats {
       const std::string& statName,
       std::optional<std::string> oldStatName);
   /*
-   * update port stat
+   * Resolve counter handles, must be called whenever port or queue stat
+   * names change
    */
-  void updateStat(
-      const std::chrono::seconds& now,
-      folly::StringPiece statKey,
-      int64_t val);
-  /*
-   * update port queue stat
-   */
-  void updateStat(
-      const std::chrono::seconds& now,
-      folly::StringPiece statKey,
-      int queueId,
-      int64_t val);
+  void resolveCounterHandles();
 
   void updateQueueWatermarkStats(
       const std::map<int16_t, int64_t>& queueWatermarkBytes) const;
   std::chrono::seconds timeRetrieved_{0};
   std::string portName_;
   HwFb303Stats portCounters_;
+  // Indexed like kPortStatKeys
+  std::array<HwFb303Stats::CounterHandle, kNumPortStats> portCounterHandles_;
+  struct QueueCounterHandles {
+    int queueId;
+    // Indexed like kQueueStatKeys
+    std::array<HwFb303Stats::CounterHandle, kNumQueueStats> counters;
+  };
+  std::vector<QueueCounterHandles> queueCounterHandles_;
   QueueId2Name queueId2Name_;
   HwPortStats portStats_;
 };
@@ -1856,6 +1856,19 @@ int BcmCinter::bcm_tx(int unit, bcm_pkt_t* tx_pkt, void* /*cookie*/) {
   return 0;
 }
 
+int BcmCinter::bcm_tx_array(
+    int unit,
+    bcm_pkt_t** pkt,
+    int count,
+    bcm_pkt_cb_f /*all_done_cb*/,
+    void* /*cookie*/) {
+  // Replayed as one bcm_tx() per packet
+  for (int i = 0; i < count; i++) {
+    bcm_tx(unit, pkt[i], nullptr);
+  }
+  return 0;
+}
+
 int BcmCinter::bcm_pkt_free(int /*unit*/, bcm_pkt_t* /*pkt*/) {
   return 0;
 }
@@ -532,6 +532,12 @@ class BcmCinter : public BcmSdkInterface, public BcmInterface {
   int bcm_vlan_port_remove(int unit, bcm_vlan_t vid, bcm_pbmp_t pbmp) override;
   int bcm_l2_station_delete(int unit, int station_id) override;
   int bcm_tx(int unit, bcm_pkt_t* tx_pkt, void* cookie) override;
+  int bcm_tx_array(
+      int unit,
+      bcm_pkt_t** pkt,
+      int count,
+      bcm_pkt_cb_f all_done_cb,
+      void* cookie) override;
   int bcm_port_stat_enable_set(int unit, bcm_gport_t port, int enable) override;
   int bcm_stat_clear(int unit, bcm_port_t port) override;
   int bcm_port_speed_set(int unit, bcm_port_t port, int speed) override;
@@ -762,6 +768,14 @@ class BcmCinter : public BcmSdkInterface, public BcmInterface {
       uint64* /* value */) override {
     return 0;
   }
+  int bcm_field_stat_multi_get(
+      int /* unit */,
+      int /* stat_id */,
+      int /* nstat */,
+      bcm_field_stat_t* /* stat_arr */,
+      uint64* /* value_arr */) override {
+    return 0;
+  }
   int bcm_field_stat_size(int /*unit*/, int /*stat_id*/, int* /*stat_size*/)
       override {
     return 0;
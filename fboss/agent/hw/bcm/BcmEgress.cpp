@@ -218,7 +218,7 @@ void BcmEgress::program(
 
   // update warmboot cache if needed
   if (egressId2EgressCitr != warmBootCache->egressId2Egress_end()) {
-    warmBootCache->programmed(egressId2EgressCitr);
+    programmedEgress(egressId2EgressCitr, vrf, intfId, ip);
   }
   CHECK_NE(id_, INVALID);
 }
@@ -276,6 +276,14 @@ BcmWarmBootCache::EgressId2EgressCitr BcmEgress::findEgress(
   return hw_->getWarmBootCache()->findEgressFromHost(vrf, ip, intfId);
 }
 
+void BcmEgress::programmedEgress(
+    BcmWarmBootCache::EgressId2EgressCitr citr,
+    bcm_vrf_t vrf,
+    bcm_if_t intfId,
+    const folly::IPAddress& ip) const {
+  hw_->getWarmBootCache()->programmedEgressFromHost(citr, vrf, ip, intfId);
+}
+
 BcmEgress::~BcmEgress() {
   if (id_ == INVALID) {
     return;
@@ -572,7 +580,7 @@ void BcmEgress::programToTrunk(
 
   // update warmboot cache if needed
   if (egressId2EgressCitr != warmBootCache->egressId2Egress_end()) {
-    warmBootCache->programmed(egressId2EgressCitr);
+    programmedEgress(egressId2EgressCitr, vrf, intfId, ip);
   }
   CHECK_NE(id_, INVALID);
 }
@@ -128,6 +128,12 @@ class BcmEgress : public BcmEgressBase {
  private:
   virtual BcmWarmBootCache::EgressId2EgressCitr
   findEgress(bcm_vrf_t vrf, bcm_if_t intfId, const folly::IPAddress& ip) const;
+  // Claim the egress returned by findEgress() once it is programmed
+  virtual void programmedEgress(
+      BcmWarmBootCache::EgressId2EgressCitr citr,
+      bcm_vrf_t vrf,
+      bcm_if_t intfId,
+      const folly::IPAddress& ip) const;
 
   bool alreadyExists(const bcm_l3_egress_t& newEgress) const;
   void program(
@@ -213,6 +213,13 @@ class BcmInterface {
 
   virtual int bcm_tx(int unit, bcm_pkt_t* tx_pkt, void* cookie) = 0;
 
+  virtual int bcm_tx_array(
+      int unit,
+      bcm_pkt_t** pkt,
+      int count,
+      bcm_pkt_cb_f all_done_cb,
+      void* cookie) = 0;
+
   virtual int
   bcm_l3_egress_get(int unit, bcm_if_t intf, bcm_l3_egress_t* egr) = 0;
 
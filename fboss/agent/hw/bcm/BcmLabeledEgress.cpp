@@ -25,6 +25,14 @@ BcmWarmBootCache::EgressId2EgressCitr BcmLabeledEgress::findEgress(
       BcmLabeledHostKey(vrf, getLabel(), ip, bcmIntf->getInterface()->getID()));
 }
 
+void BcmLabeledEgress::programmedEgress(
+    BcmWarmBootCache::EgressId2EgressCitr citr,
+    bcm_vrf_t /*vrf*/,
+    bcm_if_t /*intfId*/,
+    const folly::IPAddress& /*ip*/) const {
+  hw_->getWarmBootCache()->programmed(citr);
+}
+
 void BcmLabeledEgress::prepareEgressObject(
     bcm_if_t intfId,
     bcm_port_t port,
@@ -36,6 +36,11 @@ class BcmLabeledEgress : public BcmEgress {
       bcm_vrf_t vrf,
       bcm_if_t intfId,
       const folly::IPAddress& ip) const override;
+  void programmedEgress(
+      BcmWarmBootCache::EgressId2EgressCitr citr,
+      bcm_vrf_t vrf,
+      bcm_if_t intfId,
+      const folly::IPAddress& ip) const override;
 
   bcm_mpls_label_t label_;
 };
@@ -497,6 +497,13 @@ class BcmSdkInterface {
       bcm_field_stat_t stat,
       uint64* value) = 0;
 
+  virtual int bcm_field_stat_multi_get(
+      int unit,
+      int stat_id,
+      int nstat,
+      bcm_field_stat_t* stat_arr,
+      uint64* value_arr) = 0;
+
   virtual int bcm_field_stat_size(int unit, int stat_id, int* stat_size) = 0;
 
   virtual int bcm_field_stat_config_get(
@@ -24,6 +24,32 @@
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/packet/SflowStructs.h"
+
+DEFINE_bool(
+    sflow_export_batched,
+    false,
+    "Export sFlow samples from a dedicated thread as sFlow v5 datagrams "
+    "holding multiple samples, instead of one thrift encoded sample per "
+    "datagram sent from the RX thread");
+DEFINE_int32(
+    sflow_export_queue_size,
+    16384,
+    "Number of sFlow samples queued for export before samples are dropped");
+DEFINE_int32(
+    sflow_datagram_max_size,
+    1400,
+    "Maximum size in bytes of batched sFlow datagrams");
+DEFINE_int32(
+    sflow_export_flush_interval_ms,
+    100,
+    "Maximum time a sample waits for its sFlow datagram to fill up");
+DEFINE_int32(
+    sflow_counter_sample_interval_s,
+    20,
+    "Interval at which counter samples of sampled ports are exported, 0 to "
+    "disable counter samples");
 
 using namespace std;
 
@@ -103,6 +129,18 @@ folly::IPAddress getLocalIPv6() {
   XLOG(DBG2) << "Failed to get loopback ipv6 address, returned default one ::";
   return folly::IPAddress("::");
 }
+
+constexpr uint32_t kFlowSampleFormat = 1;
+constexpr uint32_t kCounterSampleFormat = 2;
+constexpr uint32_t kSampledHeaderFormat = 1;
+constexpr uint32_t kIfTypeEthernet = 6;
+constexpr uint32_t kIfDirectionFullDuplex = 1;
+
+template <typename T>
+T counterValue(int64_t value) {
+  // Counters are STAT_UNINITIALIZED until first collected
+  return value < 0 ? 0 : static_cast<T>(value);
+}
 } // namespace
 
 namespace facebook::fboss {
@@ -195,20 +233,189 @@ BcmSflowExporter::~BcmSflowExporter() {
   }
 }
 
+SflowDatagramBuilder::SflowDatagramBuilder(size_t maxSize)
+    : maxSize_(maxSize),
+      datagram_(folly::IOBuf::create(maxSize)),
+      sampleBuf_(folly::IOBuf::create(maxSize)),
+      recordBuf_(folly::IOBuf::create(maxSize)) {
+  datagram_->append(maxSize);
+  sampleBuf_->append(maxSize);
+  recordBuf_->append(maxSize);
+}
+
+void SflowDatagramBuilder::reset(
+    const folly::IPAddress& agentAddress,
+    uint32_t sequenceNumber,
+    uint32_t uptimeMs) {
+  sflow::SampleDatagram datagram;
+  datagram.datagramV5.agentAddress = agentAddress;
+  datagram.datagramV5.subAgentID = 0;
+  datagram.datagramV5.sequenceNumber = sequenceNumber;
+  datagram.datagramV5.uptime = uptimeMs;
+  datagram.datagramV5.samplesCnt = 0;
+  datagram.datagramV5.samples = nullptr;
+
+  folly::io::RWPrivateCursor cursor(datagram_.get());
+  datagram.serialize(&cursor);
+  length_ = maxSize_ - cursor.length();
+  // The sample count is the last field of the header, and is updated as
+  // samples are added
+  numSamplesOffset_ = length_ - sizeof(uint32_t);
+  numSamples_ = 0;
+}
+
+bool SflowDatagramBuilder::addSampleRecord(
+    uint32_t sampleType,
+    const uint8_t* data,
+    size_t len) {
+  sflow::SampleRecord record;
+  record.sampleType = sampleType;
+  record.sampleDataLen = len;
+  record.sampleData = const_cast<uint8_t*>(data);
+  auto paddedLen = (len + sflow::XDR_BASIC_BLOCK_SIZE - 1) /
+      sflow::XDR_BASIC_BLOCK_SIZE * sflow::XDR_BASIC_BLOCK_SIZE;
+  if (length_ + record.size() - len + paddedLen > maxSize_) {
+    return false;
+  }
+
+  folly::io::RWPrivateCursor cursor(datagram_.get());
+  cursor.skip(length_);
+  record.serialize(&cursor);
+  length_ = maxSize_ - cursor.length();
+
+  folly::io::RWPrivateCursor countCursor(datagram_.get());
+  countCursor.skip(numSamplesOffset_);
+  countCursor.writeBE<uint32_t>(++numSamples_);
+  return true;
+}
+
+bool SflowDatagramBuilder::addFlowSample(
+    const SflowPacketInfo& info,
+    uint32_t sequenceNumber,
+    uint32_t samplingRate,
+    uint32_t drops) {
+  const auto& packetData = *info.packetData_ref();
+  sflow::SampledHeader header;
+  header.protocol = sflow::HeaderProtocol::ETHERNET_ISO88023;
+  header.frameLength = std::max(
+      counterValue<uint32_t>(*info.frameLength_ref()),
+      static_cast<uint32_t>(packetData.size()));
+  header.stripped = counterValue<uint32_t>(*info.payloadRemoved_ref());
+  header.headerLength = packetData.size();
+  header.header = reinterpret_cast<const uint8_t*>(packetData.data());
+  // Leave room for the flow record, sample and sample record headers
+  if (header.size() + 64 > maxSize_) {
+    return false;
+  }
+  folly::io::RWPrivateCursor recordCursor(recordBuf_.get());
+  header.serialize(&recordCursor);
+
+  sflow::FlowRecord record;
+  record.flowFormat = kSampledHeaderFormat;
+  record.flowDataLen = maxSize_ - recordCursor.length();
+  record.flowData = recordBuf_->writableData();
+
+  auto srcPort = static_cast<uint16_t>(*info.srcPort_ref());
+  auto dstPort = static_cast<uint16_t>(*info.dstPort_ref());
+  sflow::FlowSample sample;
+  sample.sequenceNumber = sequenceNumber;
+  sample.sourceID = *info.ingressSampled_ref() ? srcPort : dstPort;
+  sample.samplingRate = samplingRate;
+  sample.samplePool = 0;
+  sample.drops = drops;
+  sample.input = srcPort;
+  sample.output = dstPort;
+  sample.flowRecordsCnt = 1;
+  sample.flowRecords = &record;
+  folly::io::RWPrivateCursor sampleCursor(sampleBuf_.get());
+  sample.serialize(&sampleCursor);
+
+  return addSampleRecord(
+      kFlowSampleFormat, sampleBuf_->data(), maxSize_ - sampleCursor.length());
+}
+
+bool SflowDatagramBuilder::addCounterSample(
+    PortID port,
+    uint32_t sequenceNumber,
+    const HwPortStats& stats) {
+  sflow::IfCounters counters{};
+  counters.ifIndex = port;
+  counters.ifType = kIfTypeEthernet;
+  counters.ifDirection = kIfDirectionFullDuplex;
+  // Speed and status are not part of HwPortStats, and are left unknown
+  counters.ifInOctets = counterValue<uint64_t>(*stats.inBytes__ref());
+  counters.ifInUcastPkts = counterValue<uint32_t>(*stats.inUnicastPkts__ref());
+  counters.ifInMulticastPkts =
+      counterValue<uint32_t>(*stats.inMulticastPkts__ref());
+  counters.ifInBroadcastPkts =
+      counterValue<uint32_t>(*stats.inBroadcastPkts__ref());
+  counters.ifInDiscards = counterValue<uint32_t>(*stats.inDiscards__ref());
+  counters.ifInErrors = counterValue<uint32_t>(*stats.inErrors__ref());
+  counters.ifOutOctets = counterValue<uint64_t>(*stats.outBytes__ref());
+  counters.ifOutUcastPkts =
+      counterValue<uint32_t>(*stats.outUnicastPkts__ref());
+  counters.ifOutMulticastPkts =
+      counterValue<uint32_t>(*stats.outMulticastPkts__ref());
+  counters.ifOutBroadcastPkts =
+      counterValue<uint32_t>(*stats.outBroadcastPkts__ref());
+  counters.ifOutDiscards = counterValue<uint32_t>(*stats.outDiscards__ref());
+  counters.ifOutErrors = counterValue<uint32_t>(*stats.outErrors__ref());
+  folly::io::RWPrivateCursor recordCursor(recordBuf_.get());
+  counters.serialize(&recordCursor);
+
+  sflow::CounterRecord record;
+  record.counterFormat = sflow::IfCounters::FORMAT;
+  record.counterDataLen = maxSize_ - recordCursor.length();
+  record.counterData = recordBuf_->writableData();
+
+  sflow::CounterSample sample;
+  sample.sequenceNumber = sequenceNumber;
+  sample.sourceID = port;
+  sample.counterRecordsCnt = 1;
+  sample.counterRecords = &record;
+  folly::io::RWPrivateCursor sampleCursor(sampleBuf_.get());
+  sample.serialize(&sampleCursor);
+
+  return addSampleRecord(
+      kCounterSampleFormat,
+      sampleBuf_->data(),
+      maxSize_ - sampleCursor.length());
+}
+
+BcmSflowExporterTable::BcmSflowExporterTable(PortStatsFn portStatsFn)
+    : portStatsFn_(std::move(portStatsFn)),
+      created_(std::chrono::steady_clock::now()) {
+  if (FLAGS_sflow_export_batched) {
+    queue_ = std::make_unique<folly::MPMCQueue<SflowPacketInfo>>(
+        FLAGS_sflow_export_queue_size);
+    exportThread_ = std::thread([this]() {
+      initThread("SflowExport");
+      exportLoop();
+    });
+  }
+}
+
+BcmSflowExporterTable::~BcmSflowExporterTable() {
+  stopExport_.store(true, std::memory_order_release);
+  if (exportThread_.joinable()) {
+    exportThread_.join();
+  }
+}
+
 bool BcmSflowExporterTable::contains(
     const shared_ptr<SflowCollector>& c) const {
-  auto iter = map_.find(c->getID());
-  return iter != map_.end();
+  auto exporters = map_.rlock();
+  return exporters->find(c->getID()) != exporters->end();
 }
 
 size_t BcmSflowExporterTable::size() const {
-  return map_.size();
+  return map_.rlock()->size();
 }
 
 void BcmSflowExporterTable::addExporter(const shared_ptr<SflowCollector>& c) {
   try {
     auto exporter = make_unique<BcmSflowExporter>(c->getAddress());
-    map_.emplace(c->getID(), move(exporter));
+    map_.wlock()->emplace(c->getID(), move(exporter));
   } catch (const fboss::thrift::FbossBaseError& ex) {
     XLOG(ERR) << "Could not add exporter: "
               << c->getAddress().getFullyQualified()
@@ -222,31 +429,37 @@ void BcmSflowExporterTable::addExporter(const shared_ptr<SflowCollector>& c) {
 
 void BcmSflowExporterTable::removeExporter(const std::string& id) {
   XLOG(INFO) << "Removed sFlow exporter " << id;
-  map_.erase(id);
+  map_.wlock()->erase(id);
 }
 
 void BcmSflowExporterTable::updateSamplingRates(
     PortID id,
     int64_t inRate,
     int64_t outRate) {
-  std::pair<int64_t, int64_t> rates(inRate, outRate);
-  auto it = port2samplingRates_.find(id);
-  if (it != port2samplingRates_.end()) {
-    it->second = rates;
-  } else {
-    port2samplingRates_.insert(std::make_pair(id, rates));
-  }
+  SamplingRates rates(inRate, outRate);
+  port2samplingRates_.wlock()->insert_or_assign(id, rates);
 
   // We piggyback the update of local IPv6
-  localIP_ = getLocalIPv6();
+  auto localIP = getLocalIPv6();
+  *localIP_.wlock() = localIP;
 }
 
-void BcmSflowExporterTable::sendToAll(const SflowPacketInfo& info) {
-  if (map_.empty()) {
+void BcmSflowExporterTable::sendToAll(SflowPacketInfo info) {
+  if (map_.rlock()->empty()) {
     XLOG(DBG1)
         << "zero sFlow collectors with sflow enabled, skipping sample export";
     return;
   }
+  if (queue_) {
+    if (!queue_->write(std::move(info))) {
+      samplesDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return;
+  }
+  sendSerialized(info);
+}
+
+void BcmSflowExporterTable::sendSerialized(const SflowPacketInfo& info) {
   // Serialize info to a string and wrap it in an IOBuf for sending
   string output;
   apache::thrift::BinarySerializer::serialize(info, &output);
@@ -262,10 +475,124 @@ void BcmSflowExporterTable::sendToAll(const SflowPacketInfo& info) {
     iovec_len = 1;
   }
 
-  for (const auto& c : map_) {
+  for (const auto& c : *map_.rlock()) {
     // TODO: prob need to handle ret code?
     c.second->sendUDPDatagram(vec, iovec_len);
   }
+  samplesExported_.fetch_add(1, std::memory_order_relaxed);
+  datagramsSent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t BcmSflowExporterTable::uptimeMs() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - created_)
+      .count();
+}
+
+void BcmSflowExporterTable::exportLoop() {
+  using std::chrono::steady_clock;
+  SflowDatagramBuilder builder(FLAGS_sflow_datagram_max_size);
+  startDatagram(&builder);
+
+  auto flushInterval =
+      std::chrono::milliseconds(FLAGS_sflow_export_flush_interval_ms);
+  auto counterInterval =
+      std::chrono::seconds(FLAGS_sflow_counter_sample_interval_s);
+  auto sendCounters = portStatsFn_ && counterInterval.count() > 0;
+  auto now = steady_clock::now();
+  auto nextFlush = now + flushInterval;
+  auto nextCounters =
+      sendCounters ? now + counterInterval : steady_clock::time_point::max();
+
+  SflowPacketInfo info;
+  while (!stopExport_.load(std::memory_order_acquire)) {
+    if (queue_->tryReadUntil(std::min(nextFlush, nextCounters), info)) {
+      addFlowSample(&builder, info);
+    }
+    // Checked after every sample too, so a steady stream of samples does not
+    // hold back partial datagrams or counter samples
+    now = steady_clock::now();
+    if (now >= nextCounters) {
+      addCounterSamples(&builder);
+      nextCounters = now + counterInterval;
+    }
+    if (now >= nextFlush) {
+      sendDatagram(&builder);
+      nextFlush = now + flushInterval;
+    }
+  }
+
+  while (queue_->read(info)) {
+    addFlowSample(&builder, info);
+  }
+  sendDatagram(&builder);
+}
+
+void BcmSflowExporterTable::startDatagram(SflowDatagramBuilder* builder) {
+  auto agentAddress = localIP_.copy();
+  if (agentAddress.empty()) {
+    agentAddress = folly::IPAddress("::");
+  }
+  builder->reset(agentAddress, ++datagramSequence_, uptimeMs());
+}
+
+void BcmSflowExporterTable::addFlowSample(
+    SflowDatagramBuilder* builder,
+    const SflowPacketInfo& info) {
+  auto ingress = *info.ingressSampled_ref();
+  PortID port(ingress ? *info.srcPort_ref() : *info.dstPort_ref());
+  uint32_t samplingRate = 0;
+  {
+    auto rates = port2samplingRates_.rlock();
+    auto it = rates->find(port);
+    if (it != rates->end()) {
+      samplingRate = ingress ? it->second.first : it->second.second;
+    }
+  }
+  auto sequenceNumber = ++flowSequence_[port];
+  auto drops = static_cast<uint32_t>(samplesDropped());
+  if (builder->addFlowSample(info, sequenceNumber, samplingRate, drops)) {
+    return;
+  }
+  sendDatagram(builder);
+  if (!builder->addFlowSample(info, sequenceNumber, samplingRate, drops)) {
+    XLOG(DBG2) << "sFlow sample of " << info.packetData_ref()->size()
+               << " bytes does not fit in a datagram, dropping it";
+    samplesDropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void BcmSflowExporterTable::addCounterSamples(SflowDatagramBuilder* builder) {
+  auto rates = port2samplingRates_.copy();
+  for (const auto& [port, stats] : portStatsFn_()) {
+    // Only ports with sFlow enabled
+    auto it = rates.find(port);
+    if (it == rates.end() ||
+        (it->second.first == 0 && it->second.second == 0)) {
+      continue;
+    }
+    auto sequenceNumber = ++counterSequence_[port];
+    if (!builder->addCounterSample(port, sequenceNumber, stats)) {
+      sendDatagram(builder);
+      builder->addCounterSample(port, sequenceNumber, stats);
+    }
+  }
+}
+
+void BcmSflowExporterTable::sendDatagram(SflowDatagramBuilder* builder) {
+  if (builder->numSamples() == 0) {
+    return;
+  }
+  auto data = builder->data();
+  iovec vec;
+  vec.iov_base = const_cast<uint8_t*>(data.data());
+  vec.iov_len = data.size();
+  for (const auto& c : *map_.rlock()) {
+    c.second->sendUDPDatagram(&vec, 1);
+  }
+  samplesExported_.fetch_add(builder->numSamples(), std::memory_order_relaxed);
+  datagramsSent_.fetch_add(1, std::memory_order_relaxed);
+  startDatagram(builder);
 }
 
 } // namespace facebook::fboss
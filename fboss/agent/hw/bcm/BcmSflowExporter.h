@@ -9,11 +9,22 @@
  */
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <folly/IPAddress.h>
+#include <folly/MPMCQueue.h>
+#include <folly/Range.h>
 #include <folly/SocketAddress.h>
+#include <folly/Synchronized.h>
+#include <folly/io/IOBuf.h>
 
+#include "fboss/agent/hw/gen-cpp2/hardware_stats_types.h"
 #include "fboss/agent/if/gen-cpp2/sflow_types.h"
 #include "fboss/agent/state/SflowCollector.h"
 #include "fboss/agent/types.h"
@@ -44,10 +55,67 @@ class BcmSflowExporter {
   int socket_{-1};
 };
 
+/*
+ * Builds sFlow v5 datagrams holding as many flow and counter samples as fit
+ * in maxSize bytes. The datagram and per sample scratch buffers are
+ * allocated once and reused for every datagram.
+ */
+class SflowDatagramBuilder {
+ public:
+  explicit SflowDatagramBuilder(size_t maxSize);
+
+  /*
+   * Start a new, empty datagram.
+   */
+  void reset(
+      const folly::IPAddress& agentAddress,
+      uint32_t sequenceNumber,
+      uint32_t uptimeMs);
+
+  /*
+   * Add a sample to the datagram. Returns false, leaving the datagram
+   * unchanged, if the sample does not fit.
+   */
+  bool addFlowSample(
+      const SflowPacketInfo& info,
+      uint32_t sequenceNumber,
+      uint32_t samplingRate,
+      uint32_t drops);
+  bool addCounterSample(
+      PortID port,
+      uint32_t sequenceNumber,
+      const HwPortStats& stats);
+
+  uint32_t numSamples() const {
+    return numSamples_;
+  }
+  folly::ByteRange data() const {
+    return folly::ByteRange(datagram_->data(), length_);
+  }
+
+ private:
+  bool addSampleRecord(uint32_t sampleType, const uint8_t* data, size_t len);
+
+  const size_t maxSize_;
+  std::unique_ptr<folly::IOBuf> datagram_;
+  std::unique_ptr<folly::IOBuf> sampleBuf_;
+  std::unique_ptr<folly::IOBuf> recordBuf_;
+  size_t length_{0};
+  size_t numSamplesOffset_{0};
+  uint32_t numSamples_{0};
+};
+
 class BcmSflowExporterTable {
  public:
-  BcmSflowExporterTable() = default;
-  ~BcmSflowExporterTable() = default;
+  using PortStatsFn = std::function<std::map<PortID, HwPortStats>()>;
+
+  /*
+   * With --sflow_export_batched, samples are queued and exported in sFlow v5
+   * datagrams by a dedicated thread, along with periodic counter samples of
+   * every sampled port from portStatsFn.
+   */
+  explicit BcmSflowExporterTable(PortStatsFn portStatsFn = nullptr);
+  ~BcmSflowExporterTable();
 
   bool contains(const std::shared_ptr<SflowCollector>& collector) const;
   size_t size() const;
@@ -56,19 +124,56 @@ class BcmSflowExporterTable {
 
   void updateSamplingRates(PortID id, int64_t inRate, int64_t outRate);
 
-  void sendToAll(const SflowPacketInfo& info);
+  void sendToAll(SflowPacketInfo info);
+
+  uint64_t samplesExported() const {
+    return samplesExported_.load(std::memory_order_relaxed);
+  }
+  uint64_t samplesDropped() const {
+    return samplesDropped_.load(std::memory_order_relaxed);
+  }
+  uint64_t datagramsSent() const {
+    return datagramsSent_.load(std::memory_order_relaxed);
+  }
 
  private:
   // no copy or assignment
   BcmSflowExporterTable(BcmSflowExporterTable const&) = delete;
   BcmSflowExporterTable& operator=(BcmSflowExporterTable const&) = delete;
 
-  std::unordered_map<std::string, std::unique_ptr<BcmSflowExporter>> map_;
-  std::unordered_map<
-      PortID,
-      std::pair<int64_t /* ingress rate */, int64_t /* egress rate */>>
+  using SamplingRates =
+      std::pair<int64_t /* ingress rate */, int64_t /* egress rate */>;
+
+  void sendSerialized(const SflowPacketInfo& info);
+  void exportLoop();
+  void startDatagram(SflowDatagramBuilder* builder);
+  void addFlowSample(
+      SflowDatagramBuilder* builder,
+      const SflowPacketInfo& info);
+  void addCounterSamples(SflowDatagramBuilder* builder);
+  void sendDatagram(SflowDatagramBuilder* builder);
+  uint32_t uptimeMs() const;
+
+  folly::Synchronized<
+      std::unordered_map<std::string, std::unique_ptr<BcmSflowExporter>>>
+      map_;
+  folly::Synchronized<std::unordered_map<PortID, SamplingRates>>
       port2samplingRates_;
-  folly::IPAddress localIP_;
+  folly::Synchronized<folly::IPAddress> localIP_;
+
+  // Batched export pipeline
+  PortStatsFn portStatsFn_;
+  const std::chrono::steady_clock::time_point created_;
+  std::unique_ptr<folly::MPMCQueue<SflowPacketInfo>> queue_;
+  std::atomic<bool> stopExport_{false};
+  std::atomic<uint64_t> samplesExported_{0};
+  std::atomic<uint64_t> samplesDropped_{0};
+  std::atomic<uint64_t> datagramsSent_{0};
+  // Accessed from the export thread only
+  uint32_t datagramSequence_{0};
+  std::unordered_map<PortID, uint32_t> flowSequence_;
+  std::unordered_map<PortID, uint32_t> counterSequence_;
+  std::thread exportThread_;
 };
 
 } // namespace facebook::fboss
@@ -23,6 +23,10 @@
 #include "fboss/lib/config/PlatformConfigUtils.h"
 
 #include <boost/container/flat_map.hpp>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <array>
 
 #include <thrift/lib/cpp/util/EnumUtils.h>
 
@@ -30,6 +34,11 @@ extern "C" {
 #include <bcm/field.h>
 }
 
+DEFINE_bool(
+    batched_acl_stats,
+    true,
+    "Read all counter types of an ACL stat with a single SDK call");
+
 namespace {
 
 struct LaneRateMapKey {
@@ -131,14 +140,18 @@ void BcmStatUpdater::updateStats() {
 void BcmStatUpdater::updateAclStats() {
   auto now = duration_cast<seconds>(system_clock::now().time_since_epoch());
   auto lockedAclStats = aclStats_.wlock();
-  for (auto& entry : *lockedAclStats) {
+  for (auto& [handle, counters] : lockedAclStats->handles) {
     // Fetch all counter types at once
-    std::vector<cfg::CounterType> counters;
-    for (auto& counterItr : entry.second) {
-      counters.push_back(counterItr.first);
-    }
-    for (auto& stat : getAclTrafficStats(entry.first, counters)) {
-      entry.second[stat.first]->updateValue(now, stat.second);
+    auto stats = FLAGS_batched_acl_stats
+        ? getAclTrafficStatsBatched(handle, counters.types)
+        : getAclTrafficStats(handle, counters.types);
+    for (size_t i = 0; i < counters.types.size(); ++i) {
+      auto value = stats[counters.types[i]];
+      if (counters.lastValues[i] == value) {
+        continue;
+      }
+      lockedAclStats->fb303Stats.updateStat(now, counters.statNames[i], value);
+      counters.lastValues[i] = value;
     }
   }
 }
@@ -216,20 +229,25 @@ double BcmStatUpdater::calculateLaneRate(std::shared_ptr<Port> swPort) {
 size_t BcmStatUpdater::getAclStatCounterCount() const {
   size_t count = 0;
   auto lockedAclStats = aclStats_.rlock();
-  for (auto& iter : *lockedAclStats) {
-    count += iter.second.size();
+  for (auto& iter : lockedAclStats->handles) {
+    count += iter.second.types.size();
   }
   return count;
 }
 
-MonotonicCounter* FOLLY_NULLABLE BcmStatUpdater::getAclStatCounterIf(
+const MonotonicCounter* FOLLY_NULLABLE BcmStatUpdater::getAclStatCounterIf(
     BcmAclStatHandle handle,
     cfg::CounterType counterType) {
   auto lockedAclStats = aclStats_.rlock();
-  if (auto iter = lockedAclStats->find(handle); iter != lockedAclStats->end()) {
-    auto counterIter = iter->second.find(counterType);
-    return counterIter != iter->second.end() ? counterIter->second.get()
-                                             : nullptr;
+  auto iter = lockedAclStats->handles.find(handle);
+  if (iter == lockedAclStats->handles.end()) {
+    return nullptr;
+  }
+  const auto& counters = iter->second;
+  for (size_t i = 0; i < counters.types.size(); ++i) {
+    if (counters.types[i] == counterType) {
+      return lockedAclStats->fb303Stats.getCounterIf(counters.statNames[i]);
+    }
   }
   return nullptr;
 }
@@ -291,13 +309,12 @@ void BcmStatUpdater::refreshAclStats() {
 
   while (!toBeRemovedAclStats_.empty()) {
     auto handle = toBeRemovedAclStats_.front();
-    auto itr = lockedAclStats->begin();
-    while (itr != lockedAclStats->end()) {
-      if (itr->first == handle) {
-        lockedAclStats->erase(itr++);
-      } else {
-        ++itr;
+    auto itr = lockedAclStats->handles.find(handle);
+    if (itr != lockedAclStats->handles.end()) {
+      for (const auto& statName : itr->second.statNames) {
+        lockedAclStats->fb303Stats.removeStat(statName);
       }
+      lockedAclStats->handles.erase(itr);
     }
     toBeRemovedAclStats_.pop();
   }
@@ -307,28 +324,20 @@ void BcmStatUpdater::refreshAclStats() {
     auto handle = toBeAddedAclStats_.front().first.handle;
     const auto& aclStatName = toBeAddedAclStats_.front().first.aclStatName;
     auto counterType = toBeAddedAclStats_.front().second;
-    auto itr = lockedAclStats->find(handle);
-    if (itr != lockedAclStats->end()) {
-      auto counterItr = itr->second.find(counterType);
-      if (counterItr != itr->second.end()) {
-        throw FbossError(
-            "Duplicate ACL stat, handle=",
-            handle,
-            ", type=",
-            apache::thrift::util::enumNameSafe(counterType));
-      }
-      // counter name exists, but counter type doesn't
-      itr->second[counterType] = std::make_unique<MonotonicCounter>(
-          aclStatName + "." + counterTypeToString(counterType),
-          fb303::SUM,
-          fb303::RATE);
-    } else {
-      lockedAclStats->operator[](handle)[counterType] =
-          std::make_unique<MonotonicCounter>(
-              aclStatName + "." + counterTypeToString(counterType),
-              fb303::SUM,
-              fb303::RATE);
+    auto& counters = lockedAclStats->handles[handle];
+    if (std::find(counters.types.begin(), counters.types.end(), counterType) !=
+        counters.types.end()) {
+      throw FbossError(
+          "Duplicate ACL stat, handle=",
+          handle,
+          ", type=",
+          apache::thrift::util::enumNameSafe(counterType));
     }
+    auto statName = aclStatName + "." + counterTypeToString(counterType);
+    lockedAclStats->fb303Stats.reinitStat(statName, std::nullopt);
+    counters.types.push_back(counterType);
+    counters.statNames.push_back(std::move(statName));
+    counters.lastValues.emplace_back();
     toBeAddedAclStats_.pop();
   }
 }
@@ -424,4 +433,34 @@ BcmTrafficCounterStats BcmStatUpdater::getAclTrafficStats(
   }
   return stats;
 }
+
+BcmTrafficCounterStats BcmStatUpdater::getAclTrafficStatsBatched(
+    BcmAclStatHandle handle,
+    const std::vector<cfg::CounterType>& counters) {
+  // Flex counter stats are already read for all counter types at once
+  if (hw_->getPlatform()->getAsic()->isSupported(
+          HwAsic::Feature::INGRESS_FIELD_PROCESSOR_FLEX_COUNTER)) {
+    return BcmIngressFieldProcessorFlexCounter::getAclTrafficFlexCounterStats(
+        hw_->getUnit(), handle, counters);
+  }
+  // There are only packets and bytes counter types
+  std::array<bcm_field_stat_t, 2> statTypes;
+  std::array<uint64, 2> values;
+  CHECK_LE(counters.size(), statTypes.size());
+  for (size_t i = 0; i < counters.size(); ++i) {
+    statTypes[i] = utility::cfgCounterTypeToBcmCounterType(counters[i]);
+  }
+  auto rv = bcm_field_stat_multi_get(
+      hw_->getUnit(),
+      handle,
+      counters.size(),
+      statTypes.data(),
+      values.data());
+  bcmCheckError(rv, "Failed to get bcm_field_stat, handle=", handle);
+  BcmTrafficCounterStats stats;
+  for (size_t i = 0; i < counters.size(); ++i) {
+    stats[counters[i]] = values[i];
+  }
+  return stats;
+}
 } // namespace facebook::fboss
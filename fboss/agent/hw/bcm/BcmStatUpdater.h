@@ -10,12 +10,14 @@
 #pragma once
 
 #include "common/stats/MonotonicCounter.h"
+#include "fboss/agent/hw/HwFb303Stats.h"
 #include "fboss/agent/hw/bcm/BcmTableStats.h"
 #include "fboss/agent/hw/bcm/types.h"
 #include "fboss/agent/types.h"
 
 #include <boost/container/flat_map.hpp>
 #include <folly/Synchronized.h>
+#include <optional>
 #include <queue>
 
 extern "C" {
@@ -170,7 +172,7 @@ class BcmStatUpdater {
    *  thread safety.
    */
 
-  MonotonicCounter* getAclStatCounterIf(
+  const MonotonicCounter* getAclStatCounterIf(
       BcmAclStatHandle handle,
       cfg::CounterType counterType);
   size_t getAclStatCounterCount() const;
@@ -203,6 +205,9 @@ class BcmStatUpdater {
   BcmTrafficCounterStats getAclTrafficStats(
       BcmAclStatHandle handle,
       const std::vector<cfg::CounterType>& counters);
+  BcmTrafficCounterStats getAclTrafficStatsBatched(
+      BcmAclStatHandle handle,
+      const std::vector<cfg::CounterType>& counters);
 
   void updateHwTableStats();
   void updatePrbsStats();
@@ -231,14 +236,21 @@ class BcmStatUpdater {
   std::queue<BcmAclStatHandle> toBeRemovedAclStats_;
   std::queue<std::pair<BcmAclStatDescriptor, cfg::CounterType>>
       toBeAddedAclStats_;
-  // Outer-map key: BcmAclStatHandle
-  // Inner-map key: counter type, value: MonotonicCounter
-  // Usually one BcmAclStatHandle can get both packets and bytes counters back
-  // at one function call.
-  folly::Synchronized<std::unordered_map<
-      BcmAclStatHandle,
-      std::unordered_map<cfg::CounterType, std::unique_ptr<MonotonicCounter>>>>
-      aclStats_;
+  // Counters collected for one BcmAclStatHandle. Usually one handle can get
+  // both packets and bytes counters back at one function call.
+  struct BcmAclStatCounters {
+    std::vector<cfg::CounterType> types;
+    // fb303 stat names and last published values, indexed like types
+    std::vector<std::string> statNames;
+    std::vector<std::optional<uint64_t>> lastValues;
+  };
+  struct BcmAclStats {
+    std::unordered_map<BcmAclStatHandle, BcmAclStatCounters> handles;
+    // Only counters whose value changed since the last collection are
+    // published, idle ACLs cost a hw read but no fb303 update
+    HwFb303Stats fb303Stats;
+  };
+  folly::Synchronized<BcmAclStats> aclStats_;
 
   folly::Synchronized<std::map<int32_t, LanePrbsStatsTable>> portAsicPrbsStats_;
 }; // namespace facebook::fboss
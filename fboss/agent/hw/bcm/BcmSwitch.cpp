@@ -11,6 +11,7 @@
 
 #include <boost/cast.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <optional>
@@ -22,6 +23,7 @@
 #include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
 
+#include "fboss/agent/AlpmUtils.h"
 #include "fboss/agent/Constants.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/LacpTypes.h"
@@ -181,6 +183,10 @@ DEFINE_int32(
     "Content aware processor group ID for ACLs specific to qcm");
 // Put lowest priority for this group among all i.e. lower than acl_g_pri.
 DEFINE_int32(qcm_ifp_pri, -1, "Group priority for ACL field group");
+DEFINE_bool(
+    alpm_route_ordering,
+    true,
+    "Sort route adds and deletes of a state update for ALPM when enabled");
 
 enum : uint8_t {
   kRxCallbackPriority = 1,
@@ -213,6 +219,63 @@ bool bothStandAloneRibOrRouteTableRibUsed(
   return routeTableModified(delta) && fibModified(delta);
 }
 
+// Pairs of old and new route, old route is null for added routes
+template <typename RouteT>
+using RouteChanges =
+    std::vector<std::pair<std::shared_ptr<RouteT>, std::shared_ptr<RouteT>>>;
+
+/*
+ * Added and changed routes of a routes delta, in delta order or in ALPM
+ * programming order if alpmOrder is set.
+ */
+template <typename RouteT, typename RoutesDeltaT>
+RouteChanges<RouteT> addedAndChangedRoutes(
+    const RoutesDeltaT& routesDelta,
+    bool alpmOrder) {
+  RouteChanges<RouteT> changes;
+  facebook::fboss::DeltaFunctions::forEachChanged(
+      routesDelta,
+      [&](const std::shared_ptr<RouteT>& oldRoute,
+          const std::shared_ptr<RouteT>& newRoute) {
+        changes.emplace_back(oldRoute, newRoute);
+      },
+      [&](const std::shared_ptr<RouteT>& addedRoute) {
+        changes.emplace_back(nullptr, addedRoute);
+      },
+      [](const std::shared_ptr<RouteT>& /*removedRoute*/) {});
+  if (alpmOrder) {
+    std::stable_sort(
+        changes.begin(), changes.end(), [](const auto& lhs, const auto& rhs) {
+          return facebook::fboss::alpmAddOrderLess(
+              lhs.second->prefix(), rhs.second->prefix());
+        });
+  }
+  return changes;
+}
+
+/*
+ * Removed routes of a routes delta, in delta order or in reverse ALPM
+ * programming order if alpmOrder is set.
+ */
+template <typename RouteT, typename RoutesDeltaT>
+std::vector<std::shared_ptr<RouteT>> removedRoutes(
+    const RoutesDeltaT& routesDelta,
+    bool alpmOrder) {
+  std::vector<std::shared_ptr<RouteT>> removed;
+  facebook::fboss::DeltaFunctions::forEachRemoved(
+      routesDelta, [&](const std::shared_ptr<RouteT>& removedRoute) {
+        removed.push_back(removedRoute);
+      });
+  if (alpmOrder) {
+    std::stable_sort(
+        removed.begin(), removed.end(), [](const auto& lhs, const auto& rhs) {
+          return facebook::fboss::alpmAddOrderLess(
+              rhs->prefix(), lhs->prefix());
+        });
+  }
+  return removed;
+}
+
 /*
  * For the devices/SDK we use on pre-TH4, the only events we should get (and
  * process) are ADD and DELETE. Learning generates ADD, aging generates DELETE,
@@ -369,7 +432,8 @@ BcmSwitch::BcmSwitch(BcmPlatform* platform, uint32_t featuresDesired)
       qosPolicyTable_(new BcmQosPolicyTable(this)),
       aclTable_(new BcmAclTable(this)),
       trunkTable_(new BcmTrunkTable(this)),
-      sFlowExporterTable_(new BcmSflowExporterTable()),
+      sFlowExporterTable_(new BcmSflowExporterTable(
+          [this]() { return sFlowPortStats_.copy(); })),
       rtag7LoadBalancer_(new BcmRtag7LoadBalancer(this)),
       mirrorTable_(new BcmMirrorTable(this)),
       bstStatsMgr_(new BcmBstStatsMgr(this)),
@@ -383,6 +447,8 @@ BcmSwitch::BcmSwitch(BcmPlatform* platform, uint32_t featuresDesired)
 BcmSwitch::~BcmSwitch() {
   XLOG(INFO) << "Destroying BcmSwitch";
   resetTables();
+  // Pooled packets must be freed before the unit goes away
+  txPktPool_.reset();
   if (unitObject_) {
     // In agent this would be done in the signal handler
     // gracefulExit().  In bcm_tests there is no signal.
@@ -394,6 +460,9 @@ BcmSwitch::~BcmSwitch() {
 void BcmSwitch::resetTables() {
   std::unique_lock<std::mutex> lk(lock_);
   unregisterCallbacks();
+  // Stops the sFlow export thread, no more samples come in once callbacks
+  // are unregistered
+  sFlowExporterTable_.reset();
   labelMap_.reset();
   routeTable_.reset();
   l3NextHopTable_.reset();
@@ -497,6 +566,7 @@ void BcmSwitch::gracefulExit(folly::dynamic& switchState) {
 
   switchState[kHwSwitch] = toFollyDynamic();
   unitObject_->writeWarmBootState(switchState);
+  txPktPool_.reset();
   unitObject_.reset();
   XLOG(INFO)
       << "[Exit] BRCM Graceful Exit time "
@@ -755,6 +825,11 @@ HwInitResult BcmSwitch::init(
 
   BcmAPI::initUnit(unit_, platform_);
 
+  if (FLAGS_tx_buffer_pool_size && !usePKTIO()) {
+    txPktPool_ =
+        std::make_shared<BcmTxPktPool>(unit_, FLAGS_tx_buffer_pool_size);
+  }
+
   bootType_ = platform_->getWarmBootHelper()->canWarmBoot()
       ? BootType::WARM_BOOT
       : BootType::COLD_BOOT;
@@ -786,6 +861,7 @@ HwInitResult BcmSwitch::init(
   bcmStatUpdater_ = std::make_unique<BcmStatUpdater>(this);
 
   XLOG(INFO) << " Is ALPM enabled: " << BcmAPI::isAlpmEnabled();
+  alpmRouteOrdering_ = FLAGS_alpm_route_ordering && BcmAPI::isAlpmEnabled();
   // Additional switch configuration
   auto state = make_shared<SwitchState>();
   bcm_port_config_t pcfg;
@@ -2236,16 +2312,14 @@ void BcmSwitch::processRemovedRoutes(const StateDelta& delta) {
       continue;
     }
     RouterID id = rtDelta.getOld()->getID();
-    forEachRemoved(
-        rtDelta.getRoutesV4Delta(),
-        &BcmSwitch::processRemovedRoute<RouteV4>,
-        this,
-        id);
-    forEachRemoved(
-        rtDelta.getRoutesV6Delta(),
-        &BcmSwitch::processRemovedRoute<RouteV6>,
-        this,
-        id);
+    for (const auto& route : removedRoutes<RouteV4>(
+             rtDelta.getRoutesV4Delta(), alpmRouteOrdering_)) {
+      processRemovedRoute(id, route);
+    }
+    for (const auto& route : removedRoutes<RouteV6>(
+             rtDelta.getRoutesV6Delta(), alpmRouteOrdering_)) {
+      processRemovedRoute(id, route);
+    }
   }
 }
 
@@ -2262,16 +2336,14 @@ void BcmSwitch::processRemovedFibRoutes(const StateDelta& delta) {
     CHECK(oldFib);
     RouterID vrf = oldFib->getID();
 
-    forEachRemoved(
-        fibDelta.getV4FibDelta(),
-        &BcmSwitch::processRemovedRoute<RouteV4>,
-        this,
-        vrf);
-    forEachRemoved(
-        fibDelta.getV6FibDelta(),
-        &BcmSwitch::processRemovedRoute<RouteV6>,
-        this,
-        vrf);
+    for (const auto& route :
+         removedRoutes<RouteV4>(fibDelta.getV4FibDelta(), alpmRouteOrdering_)) {
+      processRemovedRoute(vrf, route);
+    }
+    for (const auto& route :
+         removedRoutes<RouteV6>(fibDelta.getV6FibDelta(), alpmRouteOrdering_)) {
+      processRemovedRoute(vrf, route);
+    }
   }
 }
 
@@ -2299,28 +2371,20 @@ void BcmSwitch::processRouteTableDelta(
       continue;
     }
     RouterID id = rtDelta.getNew()->getID();
-    forEachChanged(
-        rtDelta.template getRoutesDelta<AddrT>(),
-        [&](const shared_ptr<RouteT>& oldRoute,
-            const shared_ptr<RouteT>& newRoute) {
-          try {
-            processChangedRoute(id, oldRoute, newRoute);
-          } catch (const BcmError& e) {
-            rethrowIfHwNotFull(e);
-            discardedPrefixes[id].push_back(oldRoute->prefix());
-          }
-        },
-        [&](const shared_ptr<RouteT>& addedRoute) {
-          try {
-            processAddedRoute(id, addedRoute);
-          } catch (const BcmError& e) {
-            rethrowIfHwNotFull(e);
-            discardedPrefixes[id].push_back(addedRoute->prefix());
-          }
-        },
-        [](const shared_ptr<RouteT>& /*deletedRoute*/) {
-          // do nothing
-        });
+    auto changes = addedAndChangedRoutes<RouteT>(
+        rtDelta.template getRoutesDelta<AddrT>(), alpmRouteOrdering_);
+    for (const auto& [oldRoute, newRoute] : changes) {
+      try {
+        if (oldRoute) {
+          processChangedRoute(id, oldRoute, newRoute);
+        } else {
+          processAddedRoute(id, newRoute);
+        }
+      } catch (const BcmError& e) {
+        rethrowIfHwNotFull(e);
+        discardedPrefixes[id].push_back(newRoute->prefix());
+      }
+    }
   }
 
   // discard  routes
@@ -2359,21 +2423,22 @@ void BcmSwitch::processAddedChangedFibRoutes(
     CHECK(newFib);
     RouterID vrf = newFib->getID();
 
-    forEachChanged(
-        fibDelta.getV4FibDelta(),
-        &BcmSwitch::processChangedRoute<RouteV4>,
-        &BcmSwitch::processAddedRoute<RouteV4>,
-        [&](BcmSwitch*, const RouterID&, const shared_ptr<RouteV4>&) {},
-        this,
-        vrf);
-
-    forEachChanged(
-        fibDelta.getV6FibDelta(),
-        &BcmSwitch::processChangedRoute<RouteV6>,
-        &BcmSwitch::processAddedRoute<RouteV6>,
-        [&](BcmSwitch*, const RouterID&, const shared_ptr<RouteV6>&) {},
-        this,
-        vrf);
+    for (const auto& [oldRoute, newRoute] : addedAndChangedRoutes<RouteV4>(
+             fibDelta.getV4FibDelta(), alpmRouteOrdering_)) {
+      if (oldRoute) {
+        processChangedRoute(vrf, oldRoute, newRoute);
+      } else {
+        processAddedRoute(vrf, newRoute);
+      }
+    }
+    for (const auto& [oldRoute, newRoute] : addedAndChangedRoutes<RouteV6>(
+             fibDelta.getV6FibDelta(), alpmRouteOrdering_)) {
+      if (oldRoute) {
+        processChangedRoute(vrf, oldRoute, newRoute);
+      } else {
+        processAddedRoute(vrf, newRoute);
+      }
+    }
   }
 }
 
@@ -2495,6 +2560,17 @@ bool BcmSwitch::sendPacketSwitchedAsync(unique_ptr<TxPacket> pkt) noexcept {
   return BCM_SUCCESS(BcmTxPacket::sendAsync(std::move(bcmPkt), this));
 }
 
+bool BcmSwitch::sendPacketsSwitchedAsync(
+    std::vector<unique_ptr<TxPacket>> pkts) noexcept {
+  std::vector<unique_ptr<BcmTxPacket>> bcmPkts;
+  bcmPkts.reserve(pkts.size());
+  for (auto& pkt : pkts) {
+    bcmPkts.emplace_back(
+        boost::polymorphic_downcast<BcmTxPacket*>(pkt.release()));
+  }
+  return BCM_SUCCESS(BcmTxPacket::sendArrayAsync(std::move(bcmPkts), this));
+}
+
 bool BcmSwitch::sendPacketOutOfPortAsync(
     unique_ptr<TxPacket> pkt,
     PortID portID,
@@ -2566,6 +2642,15 @@ void BcmSwitch::unregisterSwitchEventCallback(bcm_switch_event_t eventID) {
 
 void BcmSwitch::updateGlobalStats() {
   portTable_->updatePortStats();
+  if (sFlowExporterTable_->size() > 0) {
+    std::map<PortID, HwPortStats> portStats;
+    for (const auto& [portId, bcmPort] : *portTable_) {
+      if (auto stats = bcmPort->getPortStats()) {
+        portStats.emplace(portId, std::move(*stats));
+      }
+    }
+    sFlowPortStats_.wlock()->swap(portStats);
+  }
   trunkTable_->updateStats();
   bcmStatUpdater_->updateStats();
 
@@ -3106,7 +3191,7 @@ bool BcmSwitch::handleSflowPacket(BcmPacketT& bcmPacket) noexcept {
              << *info.vlan_ref() << ',' << info.packetData_ref()->length()
              << ")\n";
 
-  sFlowExporterTable_->sendToAll(info);
+  sFlowExporterTable_->sendToAll(std::move(info));
 
   // If it is only here because of sFlow, we're done
   if (sampleOnly) {
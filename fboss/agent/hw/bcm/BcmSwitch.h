@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <folly/Synchronized.h>
 #include <folly/dynamic.h>
 #include <folly/io/async/EventBase.h>
 #include <gtest/gtest_prod.h>
@@ -22,6 +23,7 @@
 #include "fboss/agent/types.h"
 
 #include <boost/container/flat_map.hpp>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -66,6 +68,7 @@ class BcmRxPacket;
 class BcmStatUpdater;
 class BcmSwitchEventCallback;
 class BcmTrunkTable;
+class BcmTxPktPool;
 class BcmUnit;
 class BcmWarmBootCache;
 class BcmWarmBootHelper;
@@ -236,6 +239,8 @@ class BcmSwitch : public BcmSwitchIf {
 
   std::unique_ptr<TxPacket> allocatePacket(uint32_t size) const override;
   bool sendPacketSwitchedAsync(std::unique_ptr<TxPacket> pkt) noexcept override;
+  bool sendPacketsSwitchedAsync(
+      std::vector<std::unique_ptr<TxPacket>> pkts) noexcept override;
   bool sendPacketOutOfPortAsync(
       std::unique_ptr<TxPacket> pkt,
       PortID portID,
@@ -546,6 +551,14 @@ class BcmSwitch : public BcmSwitchIf {
 
   bool usePKTIO() const;
 
+  /*
+   * TX packets for allocatePacket() to reuse, null if --tx_buffer_pool_size
+   * is 0 or when using PKTIO.
+   */
+  const std::shared_ptr<BcmTxPktPool>& getTxPktPool() const {
+    return txPktPool_;
+  }
+
  private:
   enum Flags : uint32_t { RX_REGISTERED = 0x01, LINKSCAN_REGISTERED = 0x02 };
   enum DeltaType { ADDED, REMOVED, CHANGED };
@@ -956,6 +969,10 @@ class BcmSwitch : public BcmSwitchIf {
   std::unique_ptr<BcmStatUpdater> bcmStatUpdater_;
   std::unique_ptr<BcmCosManager> cosManager_;
   std::unique_ptr<BcmTrunkTable> trunkTable_;
+  // Port stats for sFlow counter samples, refreshed by updateGlobalStats().
+  // The sFlow export thread reads this instead of the port table, and must
+  // be constructed after it.
+  folly::Synchronized<std::map<PortID, HwPortStats>> sFlowPortStats_;
   std::unique_ptr<BcmSflowExporterTable> sFlowExporterTable_;
   std::unique_ptr<BcmControlPlane> controlPlane_;
   std::unique_ptr<BcmRtag7LoadBalancer> rtag7LoadBalancer_;
@@ -970,7 +987,11 @@ class BcmSwitch : public BcmSwitchIf {
   std::unique_ptr<BcmMacTable> macTable_;
 
   std::unique_ptr<BcmUnit> unitObject_;
+  // Packets in flight keep the pool alive until they are freed
+  std::shared_ptr<BcmTxPktPool> txPktPool_;
   BootType bootType_{BootType::UNINITIALIZED};
+  // Program route updates in ALPM friendly order, see alpmAddOrderLess
+  bool alpmRouteOrdering_{false};
   int64_t bstStatsUpdateTime_{0};
   std::unique_ptr<BcmQcmManager> qcmManager_;
   std::unique_ptr<BcmPtpTcMgr> ptpTcMgr_;
@@ -17,6 +17,8 @@
 #include "fboss/agent/packet/EthHdr.h"
 #include "fboss/agent/packet/PktUtil.h"
 
+#include <algorithm>
+
 extern "C" {
 #include <bcm/tx.h>
 }
@@ -30,8 +32,10 @@ namespace {
 constexpr auto kVlanTagSize = 4;
 #endif
 
+constexpr uint32 kTxPktFlags = BCM_TX_CRC_APPEND | BCM_TX_ETHER;
+
 using namespace facebook::fboss;
-void freeTxBuf(void* /*ptr*/, void* arg) {
+void freeTxBuf(void* ptr, void* arg) {
   // Put the BcmTxIoBufUserData back into a unique_ptr.
   // This will delete it when we return.
   unique_ptr<facebook::fboss::BcmFreeTxBufUserData> freeTxBufUserData(
@@ -40,7 +44,11 @@ void freeTxBuf(void* /*ptr*/, void* arg) {
   int rv;
   if (!bcmPacket.usePktIO) {
     bcm_pkt_t* pkt = bcmPacket.ptrUnion.pkt;
-    rv = bcm_pkt_free(pkt->unit, pkt);
+    if (auto& pool = freeTxBufUserData->pool) {
+      rv = pool->release(pkt, ptr, freeTxBufUserData->capacity);
+    } else {
+      rv = bcm_pkt_free(pkt->unit, pkt);
+    }
   } else {
 #ifdef INCLUDE_PKTIO
     bcm_pktio_pkt_t* pktioPkt = bcmPacket.ptrUnion.pktioPkt;
@@ -53,28 +61,102 @@ void freeTxBuf(void* /*ptr*/, void* arg) {
   freeTxBufUserData->bcmSwitch->getSwitchStats()->txPktFree();
 }
 
-inline void txCallbackImpl(int /*unit*/, bcm_pkt_t* pkt, void* cookie) {
-  // Put the BcmTxCallbackUserData back into a unique_ptr.
-  // This will delete it when we return.
-  unique_ptr<facebook::fboss::BcmTxCallbackUserData> bcmTxCbUserData(
-      static_cast<facebook::fboss::BcmTxCallbackUserData*>(cookie));
-  const BcmPacketT& bcmPacket = bcmTxCbUserData->txPacket->getPkt();
+inline void txDoneImpl(
+    BcmTxPacket* txPacket,
+    const BcmSwitch* bcmSwitch,
+    std::chrono::steady_clock::time_point end) {
+  const BcmPacketT& bcmPacket = txPacket->getPkt();
   // PKTIO is synchronous.  This function is for non-PKTIO only.
   DCHECK_EQ(false, bcmPacket.usePktIO);
-  DCHECK_EQ(pkt, bcmPacket.ptrUnion.pkt);
 
   // Now we reset the pkt buffer back to what was originally allocated
-  pkt->pkt_data->data = bcmTxCbUserData->txPacket->buf()->writableBuffer();
+  bcmPacket.ptrUnion.pkt->pkt_data->data = txPacket->buf()->writableBuffer();
 
-  auto end = std::chrono::steady_clock::now();
   auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
-      end - bcmTxCbUserData->txPacket->getQueueTime());
-  bcmTxCbUserData->bcmSwitch->getSwitchStats()->txSentDone(duration.count());
+      end - txPacket->getQueueTime());
+  bcmSwitch->getSwitchStats()->txSentDone(duration.count());
+}
+
+inline void txCallbackImpl(int /*unit*/, bcm_pkt_t* pkt, void* cookie) {
+  // Put the BcmTxCallbackUserData back into a unique_ptr.
+  // This will delete it when we return.
+  unique_ptr<facebook::fboss::BcmTxCallbackUserData> bcmTxCbUserData(
+      static_cast<facebook::fboss::BcmTxCallbackUserData*>(cookie));
+  DCHECK_EQ(pkt, bcmTxCbUserData->txPacket->getPkt().ptrUnion.pkt);
+  txDoneImpl(
+      bcmTxCbUserData->txPacket.get(),
+      bcmTxCbUserData->bcmSwitch,
+      std::chrono::steady_clock::now());
 }
 } // namespace
 
 namespace facebook::fboss {
 
+BcmTxPktPool::BcmTxPktPool(int unit, size_t maxPktsPerClass)
+    : unit_(unit), maxPktsPerClass_(maxPktsPerClass) {}
+
+BcmTxPktPool::~BcmTxPktPool() {
+  for (auto& sizeClass : sizeClasses_) {
+    for (auto pkt : sizeClass.pkts) {
+      bcmLogError(bcm_pkt_free(unit_, pkt), "Failed to free pooled packet");
+    }
+  }
+}
+
+int BcmTxPktPool::allocate(
+    uint32_t size,
+    bcm_pkt_t** pkt,
+    uint32_t* capacity) {
+  const auto& kSizeClasses = TxPacketBufferPool::kSizeClasses;
+  auto it = std::lower_bound(kSizeClasses.begin(), kSizeClasses.end(), size);
+  if (it == kSizeClasses.end()) {
+    *capacity = size;
+    return bcm_pkt_alloc(unit_, size, kTxPktFlags, pkt);
+  }
+
+  *capacity = *it;
+  auto& sizeClass = sizeClasses_[it - kSizeClasses.begin()];
+  {
+    std::lock_guard<std::mutex> g(sizeClass.lock);
+    if (!sizeClass.pkts.empty()) {
+      *pkt = sizeClass.pkts.back();
+      sizeClass.pkts.pop_back();
+      return BCM_E_NONE;
+    }
+  }
+  return bcm_pkt_alloc(unit_, *it, kTxPktFlags, pkt);
+}
+
+int BcmTxPktPool::release(bcm_pkt_t* pkt, void* data, uint32_t capacity) {
+  const auto& kSizeClasses = TxPacketBufferPool::kSizeClasses;
+  auto it = std::find(kSizeClasses.begin(), kSizeClasses.end(), capacity);
+  if (it != kSizeClasses.end()) {
+    auto& sizeClass = sizeClasses_[it - kSizeClasses.begin()];
+    std::lock_guard<std::mutex> g(sizeClass.lock);
+    if (sizeClass.pkts.size() < maxPktsPerClass_) {
+      // Reset what the previous send set up, such as the destination port,
+      // cos and callback, and point the packet at its whole buffer again
+      auto rv = bcm_pkt_flags_init(unit_, pkt, kTxPktFlags);
+      if (BCM_SUCCESS(rv)) {
+        BCM_PKT_ONE_BUF_SETUP(pkt, static_cast<uint8*>(data), capacity);
+        sizeClass.pkts.push_back(pkt);
+        return rv;
+      }
+      bcmLogError(rv, "Failed to reset pooled packet");
+    }
+  }
+  return bcm_pkt_free(unit_, pkt);
+}
+
+size_t BcmTxPktPool::freePkts() const {
+  size_t numPkts = 0;
+  for (const auto& sizeClass : sizeClasses_) {
+    std::lock_guard<std::mutex> g(sizeClass.lock);
+    numPkts += sizeClass.pkts.size();
+  }
+  return numPkts;
+}
+
 std::mutex& BcmTxPacket::syncPktMutex() {
   static std::mutex _syncPktMutex;
   return _syncPktMutex;
@@ -103,14 +185,17 @@ BcmTxPacket::BcmTxPacket(int unit, uint32_t size, const BcmSwitch* bcmSwitch)
   void* bufData = nullptr;
   uint32_t allocatedCapacity = size;
 
+  std::shared_ptr<BcmTxPktPool> pool;
+
   bcmPacket_.usePktIO = usePktIO;
   if (!usePktIO) {
     bcmPacket_.ptrUnion.pkt = nullptr;
-    rv = bcm_pkt_alloc(
-        unit,
-        size,
-        BCM_TX_CRC_APPEND | BCM_TX_ETHER,
-        &(bcmPacket_.ptrUnion.pkt));
+    pool = bcmSwitch->getTxPktPool();
+    if (pool) {
+      rv = pool->allocate(size, &(bcmPacket_.ptrUnion.pkt), &allocatedCapacity);
+    } else {
+      rv = bcm_pkt_alloc(unit, size, kTxPktFlags, &(bcmPacket_.ptrUnion.pkt));
+    }
     if (BCM_FAILURE(rv)) {
       bcmSwitch->getSwitchStats()->txPktAllocErrors();
       bcmCheckError(rv, "Failed to allocate packet.");
@@ -154,8 +239,8 @@ BcmTxPacket::BcmTxPacket(int unit, uint32_t size, const BcmSwitch* bcmSwitch)
 
   DCHECK(bufData);
 
-  auto freeTxBufUserData =
-      std::make_unique<BcmFreeTxBufUserData>(bcmPacket_, bcmSwitch);
+  auto freeTxBufUserData = std::make_unique<BcmFreeTxBufUserData>(
+      bcmPacket_, bcmSwitch, std::move(pool), allocatedCapacity);
 
   buf_ = IOBuf::takeOwnership(
       bufData,
@@ -186,17 +271,7 @@ inline int BcmTxPacket::sendImpl(
 
   if (!usePktIO) {
     bcm_pkt_t* bcmPkt = pkt->bcmPacket_.ptrUnion.pkt;
-    const auto buf = pkt->buf();
-
-    // TODO(aeckert): Setting the pkt len manually should be replaced in future
-    // releases of bcm with BCM_PKT_TX_LEN_SET or bcm_flags_len_setup
-    DCHECK(bcmPkt->pkt_data);
-    bcmPkt->pkt_data->len = buf->length();
-
-    // Now we also set the buffer that will be sent out to point at
-    // buf->writableBuffer in case there is unused header space in the IOBuf
-    bcmPkt->pkt_data->data = buf->writableData();
-
+    pkt->prepareTx();
     pkt->queued_ = std::chrono::steady_clock::now();
 
     txCbUserData =
@@ -305,6 +380,20 @@ inline int BcmTxPacket::sendImpl(
   return rv;
 }
 
+inline void BcmTxPacket::prepareTx() {
+  bcm_pkt_t* bcmPkt = bcmPacket_.ptrUnion.pkt;
+  const auto buf = this->buf();
+
+  // TODO(aeckert): Setting the pkt len manually should be replaced in future
+  // releases of bcm with BCM_PKT_TX_LEN_SET or bcm_flags_len_setup
+  DCHECK(bcmPkt->pkt_data);
+  bcmPkt->pkt_data->len = buf->length();
+
+  // Now we also set the buffer that will be sent out to point at
+  // buf->writableBuffer in case there is unused header space in the IOBuf
+  bcmPkt->pkt_data->data = buf->writableData();
+}
+
 void BcmTxPacket::txCallbackAsync(int unit, bcm_pkt_t* pkt, void* cookie) {
   txCallbackImpl(unit, pkt, cookie);
 }
@@ -316,6 +405,20 @@ void BcmTxPacket::txCallbackSync(int unit, bcm_pkt_t* pkt, void* cookie) {
   syncPktCV().notify_one();
 }
 
+void BcmTxPacket::txArrayCallback(
+    int /*unit*/,
+    bcm_pkt_t* /*pkt*/,
+    void* cookie) {
+  // Put the BcmTxArrayCallbackUserData back into a unique_ptr.
+  // This will delete it and all its packets when we return.
+  unique_ptr<BcmTxArrayCallbackUserData> bcmTxCbUserData(
+      static_cast<BcmTxArrayCallbackUserData*>(cookie));
+  auto end = std::chrono::steady_clock::now();
+  for (auto& txPacket : bcmTxCbUserData->txPackets) {
+    txDoneImpl(txPacket.get(), bcmTxCbUserData->bcmSwitch, end);
+  }
+}
+
 int BcmTxPacket::sendAsync(
     unique_ptr<BcmTxPacket> pkt,
     const BcmSwitch* bcmSwitch) noexcept {
@@ -357,6 +460,69 @@ int BcmTxPacket::sendSync(
   return rv;
 }
 
+int BcmTxPacket::sendArrayAsync(
+    std::vector<unique_ptr<BcmTxPacket>> pkts,
+    const BcmSwitch* bcmSwitch) noexcept {
+  if (pkts.empty()) {
+    return BCM_E_NONE;
+  }
+  if (pkts.size() == 1 || pkts.front()->bcmPacket_.usePktIO) {
+    int rv = BCM_E_NONE;
+    for (auto& pkt : pkts) {
+      auto pktRv = sendAsync(std::move(pkt), bcmSwitch);
+      if (BCM_FAILURE(pktRv)) {
+        rv = pktRv;
+      }
+    }
+    return rv;
+  }
+
+  std::vector<bcm_pkt_t*> bcmPkts;
+  bcmPkts.reserve(pkts.size());
+  auto queued = std::chrono::steady_clock::now();
+  for (auto& pkt : pkts) {
+    bcm_pkt_t* bcmPkt = pkt->bcmPacket_.ptrUnion.pkt;
+    // The SDK only calls back once the whole array is sent
+    DCHECK(bcmPkt->call_back == nullptr);
+    pkt->prepareTx();
+    pkt->queued_ = queued;
+    bcmPkts.push_back(bcmPkt);
+  }
+
+  auto unit = bcmPkts.front()->unit;
+  auto count = bcmPkts.size();
+  auto txCbUserData = std::make_unique<BcmTxArrayCallbackUserData>(
+      std::move(pkts), std::move(bcmPkts), bcmSwitch);
+  auto rv = bcm_tx_array(
+      unit,
+      txCbUserData->bcmPkts.data(),
+      count,
+      BcmTxPacket::txArrayCallback,
+      txCbUserData.get());
+  auto stats = bcmSwitch->getSwitchStats();
+  if (BCM_SUCCESS(rv)) {
+    /*
+     * Release the unique pointer without destroying the TxPacket objects.
+     * The unique pointer will be reconstructed during the Tx callback to
+     * reset the packets and to increment the switch stats.
+     */
+    txCbUserData.release();
+    for (size_t i = 0; i < count; ++i) {
+      stats->txSent();
+    }
+  } else {
+    bcmLogError(rv, "failed to send packet array");
+    for (size_t i = 0; i < count; ++i) {
+      if (rv == BCM_E_MEMORY) {
+        stats->txPktAllocErrors();
+      } else {
+        stats->txError();
+      }
+    }
+  }
+  return rv;
+}
+
 void BcmTxPacket::setCos(uint8_t cos) noexcept {
   if (!bcmPacket_.usePktIO) {
     bcmPacket_.ptrUnion.pkt->cos = cos;
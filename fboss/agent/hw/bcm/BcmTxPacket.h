@@ -9,11 +9,15 @@
  */
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "fboss/agent/TxPacket.h"
+#include "fboss/agent/TxPacketBufferPool.h"
 #include "fboss/agent/hw/bcm/BcmError.h"
 #include "fboss/agent/hw/bcm/BcmTypes.h"
 
@@ -31,11 +35,69 @@ namespace facebook::fboss {
 class BcmTxPacket;
 class BcmSwitch;
 
+/*
+ * Free list of TX packets along with their DMA buffers, so that bursts of
+ * packets sent to the ASIC don't go through bcm_pkt_alloc() and
+ * bcm_pkt_free() for every packet.
+ *
+ * Packets are kept in the size classes of TxPacketBufferPool, each holding
+ * up to maxPktsPerClass packets. Only used for bcm_tx(), PKTIO packets are
+ * allocated and freed as usual. All methods are thread safe.
+ */
+class BcmTxPktPool {
+ public:
+  BcmTxPktPool(int unit, size_t maxPktsPerClass);
+  ~BcmTxPktPool();
+
+  /*
+   * Packet with a DMA buffer of at least size bytes, reused from the pool if
+   * one is free. The actual size of the buffer is returned in capacity.
+   *
+   * Returns an Bcm error code.
+   */
+  int allocate(uint32_t size, bcm_pkt_t** pkt, uint32_t* capacity);
+
+  /*
+   * Return a packet which is done with, along with its DMA buffer data and
+   * its capacity. Packets not allocated by the pool, or exceeding the
+   * number of packets kept, are freed.
+   *
+   * Returns an Bcm error code.
+   */
+  int release(bcm_pkt_t* pkt, void* data, uint32_t capacity);
+
+  size_t freePkts() const;
+
+ private:
+  struct SizeClass {
+    mutable std::mutex lock;
+    std::vector<bcm_pkt_t*> pkts;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  BcmTxPktPool(BcmTxPktPool const&) = delete;
+  BcmTxPktPool& operator=(BcmTxPktPool const&) = delete;
+
+  const int unit_;
+  const size_t maxPktsPerClass_;
+  std::array<SizeClass, TxPacketBufferPool::kSizeClasses.size()> sizeClasses_;
+};
+
 struct BcmFreeTxBufUserData {
-  BcmFreeTxBufUserData(const BcmPacketT& bcmPacket, const BcmSwitch* bcmSwitch)
-      : bcmPacket(bcmPacket), bcmSwitch(bcmSwitch) {}
+  BcmFreeTxBufUserData(
+      const BcmPacketT& bcmPacket,
+      const BcmSwitch* bcmSwitch,
+      std::shared_ptr<BcmTxPktPool> pool,
+      uint32_t capacity)
+      : bcmPacket(bcmPacket),
+        bcmSwitch(bcmSwitch),
+        pool(std::move(pool)),
+        capacity(capacity) {}
   const BcmPacketT& bcmPacket;
   const BcmSwitch* bcmSwitch;
+  // Set if the packet came from the pool, and goes back to it once freed
+  std::shared_ptr<BcmTxPktPool> pool;
+  uint32_t capacity;
 };
 
 struct BcmTxCallbackUserData {
@@ -47,6 +109,20 @@ struct BcmTxCallbackUserData {
   const BcmSwitch* bcmSwitch;
 };
 
+struct BcmTxArrayCallbackUserData {
+  BcmTxArrayCallbackUserData(
+      std::vector<std::unique_ptr<BcmTxPacket>> txPackets,
+      std::vector<bcm_pkt_t*> bcmPkts,
+      const BcmSwitch* bcmSwitch)
+      : txPackets(std::move(txPackets)),
+        bcmPkts(std::move(bcmPkts)),
+        bcmSwitch(bcmSwitch) {}
+  std::vector<std::unique_ptr<BcmTxPacket>> txPackets;
+  // Array handed to bcm_tx_array(), kept until all the packets are sent
+  std::vector<bcm_pkt_t*> bcmPkts;
+  const BcmSwitch* bcmSwitch;
+};
+
 class BcmTxPacket : public TxPacket {
  public:
   BcmTxPacket(int unit, uint32_t size, const BcmSwitch* bcmSwitch);
@@ -116,13 +192,29 @@ class BcmTxPacket : public TxPacket {
   static int sendSync(
       std::unique_ptr<BcmTxPacket> pkt,
       const BcmSwitch* bcmSwitch) noexcept;
+  /*
+   * Send a burst of BcmTxPackets asynchronously, with a single
+   * bcm_tx_array() call. PKTIO has no array send, so with PKTIO the packets
+   * are sent one by one.
+   *
+   * Assumes ownership of the packets, which are deleted once the whole
+   * burst is sent.
+   *
+   * Returns an Bcm error code, the last one if several packets failed.
+   */
+  static int sendArrayAsync(
+      std::vector<std::unique_ptr<BcmTxPacket>> pkts,
+      const BcmSwitch* bcmSwitch) noexcept;
 
  private:
   inline static int sendImpl(
       std::unique_ptr<BcmTxPacket> pkt,
       const BcmSwitch* bcmSwitch) noexcept;
+  // Point the bcm_pkt_t at the data of the IOBuf, for bcm_tx()
+  inline void prepareTx();
   static void txCallbackAsync(int unit, bcm_pkt_t* pkt, void* cookie);
   static void txCallbackSync(int unit, bcm_pkt_t* pkt, void* cookie);
+  static void txArrayCallback(int unit, bcm_pkt_t* pkt, void* cookie);
 
   // Forbidden copy constructor and assignment operator
   BcmTxPacket(BcmTxPacket const&) = delete;
@@ -260,6 +260,8 @@ void BcmWarmBootCache::populateFromWarmBootState(
   }
 
   // Extract BcmHost and its egress object from the warm boot file
+  vrfIp2EgressFromBcmHostInWarmBootFile_.reserve(hostTable[kHosts].size());
+  egressId2WeightInWarmBootFile_.reserve(hostTable[kHosts].size());
   for (const auto& hostEntry : hostTable[kHosts]) {
     auto egressId = hostEntry[kEgressId].asInt();
     if (egressId == BcmEgressBase::INVALID) {
@@ -373,6 +375,17 @@ void BcmWarmBootCache::populateFromWarmBootState(
   }
 }
 
+BcmWarmBootCache::HostKey BcmWarmBootCache::makeHostKey(
+    bcm_vrf_t vrf,
+    const folly::IPAddress& addr,
+    std::optional<bcm_if_t> intf) {
+  // only care about the intf if addr is v6 link-local
+  if (!addr.isV6() || !addr.isLinkLocal()) {
+    intf = std::nullopt;
+  }
+  return std::make_tuple(vrf, addr, intf);
+}
+
 BcmWarmBootCache::EgressId2EgressCitr BcmWarmBootCache::findEgressFromHost(
     bcm_vrf_t vrf,
     const folly::IPAddress& addr,
@@ -382,18 +395,25 @@ BcmWarmBootCache::EgressId2EgressCitr BcmWarmBootCache::findEgressFromHost(
   if (vrfIp2EgressFromBcmHostInWarmBootFile_.size() == 0) {
     return egressId2Egress_.end();
   }
-  // only care about the intf if addr is v6 link-local
-  if (!addr.isV6() || !addr.isLinkLocal()) {
-    intf = std::nullopt;
-  }
-  auto key = std::make_tuple(vrf, addr, intf);
-  auto it = vrfIp2EgressFromBcmHostInWarmBootFile_.find(key);
+  auto it = vrfIp2EgressFromBcmHostInWarmBootFile_.find(
+      makeHostKey(vrf, addr, intf));
   if (it == vrfIp2EgressFromBcmHostInWarmBootFile_.cend()) {
     return egressId2Egress_.end();
   }
   return findEgress(it->second);
 }
 
+void BcmWarmBootCache::programmedEgressFromHost(
+    EgressId2EgressCitr citr,
+    bcm_vrf_t vrf,
+    const folly::IPAddress& addr,
+    std::optional<bcm_if_t> intf) {
+  programmed(citr);
+  // Only one BcmEgress is ever created per host key, so once it owns the
+  // egress the mapping is of no further use.
+  vrfIp2EgressFromBcmHostInWarmBootFile_.erase(makeHostKey(vrf, addr, intf));
+}
+
 BcmWarmBootCache::EgressId2EgressCitr
 BcmWarmBootCache::findEgressFromLabeledHostKey(const BcmLabeledHostKey& key) {
   // check if this MPLS next hop identified by labeld host key is saved in warm
@@ -477,7 +497,9 @@ void BcmWarmBootCache::populate(std::optional<folly::dynamic> warmBootState) {
   bcm_l3_info_t l3Info;
   bcm_l3_info_t_init(&l3Info);
   bcm_l3_info(hw_->getUnit(), &l3Info);
+  egressId2Egress_.reserve(egressId2WeightInWarmBootFile_.size());
   if (hw_->getPlatform()->getAsic()->isSupported(HwAsic::Feature::HOSTTABLE)) {
+    vrfIp2Host_.reserve(l3Info.l3info_used_host);
     // Traverse V4 hosts
     rv = bcm_l3_host_traverse(
         hw_->getUnit(),
@@ -23,6 +23,7 @@ extern "C" {
 #include <folly/MacAddress.h>
 #include <folly/container/F14Map.h>
 #include <folly/dynamic.h>
+#include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include <algorithm>
@@ -127,13 +128,31 @@ class BcmWarmBootCache {
   typedef boost::container::flat_map<VlanID, bcm_if_t>
       Vlan2BcmIfIdInWarmBootFile;
 
-  typedef folly::F14FastMap<VrfAndIP, bcm_l3_host_t> VrfAndIP2Host;
-  typedef folly::F14FastMap<VrfAndPrefix, bcm_l3_route_t> VrfAndPrefix2Route;
-  typedef boost::container::flat_map<EgressId2Weight, EcmpEgress>
+  struct EgressId2WeightHash {
+    size_t operator()(const EgressId2Weight& egressId2Weight) const {
+      size_t hash = 0;
+      for (const auto& egressIdAndWeight : egressId2Weight) {
+        hash = folly::hash::hash_combine(
+            hash, egressIdAndWeight.first, egressIdAndWeight.second);
+      }
+      return hash;
+    }
+  };
+  /*
+   * The tables below scale with the number of routes, hosts and next hops.
+   * They are hash maps so populate() is linear rather than paying a sorted
+   * insert per entry. Tables holding bcm structs are node maps: the struct is
+   * freed as soon as the entry is claimed (erased), instead of staying in the
+   * table's backing array until the whole cache goes away.
+   */
+  typedef folly::F14NodeMap<VrfAndIP, bcm_l3_host_t> VrfAndIP2Host;
+  typedef folly::F14NodeMap<VrfAndPrefix, bcm_l3_route_t> VrfAndPrefix2Route;
+  typedef folly::F14NodeMap<EgressId2Weight, EcmpEgress, EgressId2WeightHash>
       EgressIds2Ecmp;
-  using VrfAndIP2Route = boost::container::flat_map<VrfAndIP, bcm_l3_route_t>;
-  using EgressId2Egress = boost::container::flat_map<EgressId, Egress>;
-  using HostTableInWarmBootFile = boost::container::flat_map<HostKey, EgressId>;
+  using VrfAndIP2Route = folly::F14NodeMap<VrfAndIP, bcm_l3_route_t>;
+  using EgressId2Egress = folly::F14NodeMap<EgressId, Egress>;
+  using HostTableInWarmBootFile = folly::F14FastMap<HostKey, EgressId>;
+  using EgressId2RefCount = folly::F14FastMap<EgressId, uint64_t>;
   using MplsNextHop2EgressIdInWarmBootFile =
       boost::container::flat_map<BcmLabeledHostKey, EgressId>;
   using LabelStackKey =
@@ -314,10 +333,24 @@ class BcmWarmBootCache {
   EgressId2EgressCitr findEgress(EgressId id) const {
     return egressId2Egress_.find(id);
   }
+  /*
+   * Find the egress the host <vrf, addr, intf> pointed to in the warm boot
+   * file. Callers claim the returned egress with programmedEgressFromHost()
+   * once it is programmed.
+   */
   EgressId2EgressCitr findEgressFromHost(
       bcm_vrf_t vrf,
       const folly::IPAddress& addr,
       std::optional<bcm_if_t> intf);
+  /*
+   * Claim an egress found with findEgressFromHost(), dropping the warm boot
+   * file mapping of the host along with it.
+   */
+  void programmedEgressFromHost(
+      EgressId2EgressCitr citr,
+      bcm_vrf_t vrf,
+      const folly::IPAddress& addr,
+      std::optional<bcm_if_t> intf);
 
   EgressId2EgressCitr findEgressFromLabeledHostKey(
       const BcmLabeledHostKey& key);
@@ -607,6 +640,10 @@ class BcmWarmBootCache {
   const EgressId2Weight& getPathsForEcmp(EgressId ecmp) const;
   folly::dynamic getWarmBootState() const;
   void populateFromWarmBootState(const folly::dynamic& warmBootState);
+  static HostKey makeHostKey(
+      bcm_vrf_t vrf,
+      const folly::IPAddress& addr,
+      std::optional<bcm_if_t> intf);
   // No copy or assignment.
   BcmWarmBootCache(const BcmWarmBootCache&) = delete;
   BcmWarmBootCache& operator=(const BcmWarmBootCache&) = delete;
@@ -617,9 +654,10 @@ class BcmWarmBootCache {
   Vlan2BcmIfIdInWarmBootFile vlan2BcmIfIdInWarmBootFile_;
 
   // This is the set of egress ids pointed by BcmHost in warm boot file.
-  EgressId2Weight egressId2WeightInWarmBootFile_;
+  EgressId2RefCount egressId2WeightInWarmBootFile_;
   // Mapping from <vrf, ip, intf> to the egress,
-  // based on the BcmHost in warm boot file.
+  // based on the BcmHost in warm boot file. Entries are dropped as soon as
+  // their egress is claimed, see programmedEgressFromHost().
   HostTableInWarmBootFile vrfIp2EgressFromBcmHostInWarmBootFile_;
 
   // Mapping from Labeled Host Key to Egress ID
@@ -688,6 +726,8 @@ class BcmWarmBootCache {
   QosMapId2QosMap qosMapId2QosMap_;
 
   cfg::L2LearningMode l2LearningMode_;
+
+  friend class BcmWarmBootCacheBenchmarkHelper;
 };
 
 } // namespace facebook::fboss
@@ -900,6 +900,13 @@ int __real_bcm_pkt_free(int unit, bcm_pkt_t* pkt);
 
 int __real_bcm_tx(int unit, bcm_pkt_t* tx_pkt, void* cookie);
 
+int __real_bcm_tx_array(
+    int unit,
+    bcm_pkt_t** pkt,
+    int count,
+    bcm_pkt_cb_f all_done_cb,
+    void* cookie);
+
 int __real_bcm_l3_egress_destroy(int unit, bcm_if_t intf);
 
 int __real_bcm_port_control_get(
@@ -1214,6 +1221,13 @@ int __real_bcm_field_stat_get(
     bcm_field_stat_t stat,
     uint64* value);
 
+int __real_bcm_field_stat_multi_get(
+    int unit,
+    int stat_id,
+    int nstat,
+    bcm_field_stat_t* stat_arr,
+    uint64* value_arr);
+
 int __real_bcm_field_stat_size(int unit, int stat_id, int* stat_size);
 
 int __real_bcm_field_stat_config_get(
@@ -2544,6 +2558,20 @@ int __wrap_bcm_tx(int unit, bcm_pkt_t* tx_pkt, void* cookie) {
   }
 }
 
+int __wrap_bcm_tx_array(
+    int unit,
+    bcm_pkt_t** pkt,
+    int count,
+    bcm_pkt_cb_f all_done_cb,
+    void* cookie) {
+  // Same as bcm_tx, the packets may be freed once the SDK call is executed
+  {
+    TIME_CALL;
+    CALL_WRAPPERS_RV_CINTER_FIRST(
+        bcm_tx_array(unit, pkt, count, all_done_cb, cookie));
+  }
+}
+
 int __wrap_bcm_rx_stop(int unit, bcm_rx_cfg_t* cfg) {
   CALL_WRAPPERS_RV(bcm_rx_stop(unit, cfg));
 }
@@ -3170,6 +3198,16 @@ int __wrap_bcm_field_stat_get(
   CALL_WRAPPERS_RV(bcm_field_stat_get(unit, stat_id, stat, value));
 }
 
+int __wrap_bcm_field_stat_multi_get(
+    int unit,
+    int stat_id,
+    int nstat,
+    bcm_field_stat_t* stat_arr,
+    uint64* value_arr) {
+  CALL_WRAPPERS_RV(
+      bcm_field_stat_multi_get(unit, stat_id, nstat, stat_arr, value_arr));
+}
+
 int __wrap_bcm_field_stat_size(int unit, int stat_id, int* stat_size) {
   CALL_WRAPPERS_RV(bcm_field_stat_size(unit, stat_id, stat_size));
 }
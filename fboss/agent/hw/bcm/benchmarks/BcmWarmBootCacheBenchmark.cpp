@@ -0,0 +1,211 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/Constants.h"
+#include "fboss/agent/hw/bcm/BcmSwitch.h"
+#include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
+#include "fboss/agent/hw/test/ConfigFactory.h"
+#include "fboss/agent/hw/test/HwSwitchEnsemble.h"
+#include "fboss/agent/hw/test/HwSwitchEnsembleFactory.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
+#include <folly/IPAddressV6.h>
+#include <folly/dynamic.h>
+#include <folly/json.h>
+
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+DEFINE_int32(wb_cache_routes, 200'000, "Number of routes in the cache");
+DEFINE_int32(wb_cache_hosts, 50'000, "Number of hosts in the cache");
+
+namespace {
+
+constexpr bcm_if_t kEgressIdBase = 200'000;
+constexpr bcm_if_t kIntfId = 2000;
+constexpr bcm_vrf_t kVrfId = 0;
+// Fraction of the routes that are fully qualified (/128)
+constexpr int kHostRoutePercent = 25;
+
+int64_t rssKb() {
+  std::string statm;
+  folly::readFile("/proc/self/statm", statm);
+  std::istringstream in(statm);
+  int64_t size, resident;
+  in >> size >> resident;
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+folly::IPAddressV6 makeIp(uint16_t subnet, uint32_t index, bool inHostBits) {
+  folly::ByteArray16 bytes{};
+  bytes[0] = 0x24;
+  bytes[1] = 0x01;
+  bytes[2] = 0xdb;
+  bytes[3] = 0x00;
+  bytes[4] = subnet >> 8;
+  bytes[5] = subnet & 0xff;
+  auto offset = inHostBits ? 12 : 6;
+  bytes[offset] = index >> 24;
+  bytes[offset + 1] = (index >> 16) & 0xff;
+  bytes[offset + 2] = (index >> 8) & 0xff;
+  bytes[offset + 3] = index & 0xff;
+  return folly::IPAddressV6(bytes);
+}
+
+} // namespace
+
+namespace facebook::fboss {
+
+/*
+ * Feeds BcmWarmBootCache a synthetic warm boot file and synthetic h/w table
+ * traversals, so cache population and claim cost can be measured at scales
+ * beyond what the ASIC under test can hold.
+ */
+class BcmWarmBootCacheBenchmarkHelper {
+ public:
+  explicit BcmWarmBootCacheBenchmarkHelper(BcmWarmBootCache* cache)
+      : cache_(cache) {}
+
+  void populateFromWarmBootState(const folly::dynamic& warmBootState) {
+    cache_->populateFromWarmBootState(warmBootState);
+  }
+  void addHost(bcm_l3_host_t* host) {
+    BcmWarmBootCache::hostTraversalCallback(0, 0, host, cache_);
+  }
+  void addRoute(bcm_l3_route_t* route) {
+    BcmWarmBootCache::routeTraversalCallback(0, 0, route, cache_);
+  }
+  void addEgress(bcm_if_t egressId, bcm_l3_egress_t* egress) {
+    BcmWarmBootCache::egressTraversalCallback(0, egressId, egress, cache_);
+  }
+
+ private:
+  BcmWarmBootCache* cache_;
+};
+
+BENCHMARK(BcmWarmBootCachePopulateAndClaim) {
+  folly::BenchmarkSuspender suspender;
+  auto ensemble = createHwEnsemble({});
+  auto bcmSwitch = static_cast<BcmSwitch*>(ensemble->getHwSwitch());
+  auto config = utility::onePortPerVlanConfig(
+      bcmSwitch, ensemble->masterLogicalPortIds());
+  ensemble->applyInitialConfig(config);
+
+  // Synthetic warm boot file: the programmed state plus one host entry per
+  // synthetic host, each pointing to its own egress
+  folly::dynamic warmBootState = folly::dynamic::object;
+  warmBootState[kSwSwitch] = ensemble->getProgrammedState()->toFollyDynamic();
+  warmBootState[kHwSwitch] = bcmSwitch->toFollyDynamic();
+  auto& hosts = warmBootState[kHwSwitch][kHostTable][kHosts];
+  std::vector<folly::IPAddressV6> hostIps;
+  for (auto i = 0; i < FLAGS_wb_cache_hosts; ++i) {
+    hostIps.push_back(makeIp(0xffff, i, true));
+    folly::dynamic host = folly::dynamic::object;
+    host[kVrf] = kVrfId;
+    host[kIp] = hostIps.back().str();
+    host[kEgressId] = kEgressIdBase + i;
+    hosts.push_back(std::move(host));
+  }
+
+  std::vector<bcm_l3_route_t> routes(FLAGS_wb_cache_routes);
+  std::vector<std::pair<folly::IPAddressV6, uint8_t>> prefixes;
+  for (auto i = 0; i < FLAGS_wb_cache_routes; ++i) {
+    bool hostRoute = i % 100 < kHostRoutePercent;
+    uint8_t mask = hostRoute ? 128 : 64;
+    auto ip = makeIp(hostRoute ? 0xfffe : 0, i, hostRoute);
+    auto& route = routes[i];
+    bcm_l3_route_t_init(&route);
+    route.l3a_flags = BCM_L3_IP6;
+    route.l3a_vrf = kVrfId;
+    route.l3a_intf = kEgressIdBase + i % FLAGS_wb_cache_hosts;
+    memcpy(route.l3a_ip6_net, ip.bytes(), sizeof(route.l3a_ip6_net));
+    memcpy(
+        route.l3a_ip6_mask,
+        folly::IPAddressV6::fetchMask(mask).data(),
+        sizeof(route.l3a_ip6_mask));
+    prefixes.emplace_back(ip, mask);
+  }
+
+  auto rssBefore = rssKb();
+  auto cache = std::make_unique<BcmWarmBootCache>(bcmSwitch);
+  BcmWarmBootCacheBenchmarkHelper helper(cache.get());
+  auto populateStart = std::chrono::steady_clock::now();
+  suspender.dismiss();
+  helper.populateFromWarmBootState(warmBootState);
+  for (auto i = 0; i < FLAGS_wb_cache_hosts; ++i) {
+    bcm_l3_egress_t egress;
+    bcm_l3_egress_t_init(&egress);
+    egress.intf = kIntfId;
+    egress.port = 1;
+    helper.addEgress(kEgressIdBase + i, &egress);
+
+    bcm_l3_host_t host;
+    bcm_l3_host_t_init(&host);
+    host.l3a_flags = BCM_L3_IP6;
+    host.l3a_vrf = kVrfId;
+    host.l3a_intf = kEgressIdBase + i;
+    memcpy(host.l3a_ip6_addr, hostIps[i].bytes(), sizeof(host.l3a_ip6_addr));
+    helper.addHost(&host);
+  }
+  for (auto& route : routes) {
+    helper.addRoute(&route);
+  }
+  suspender.rehire();
+  std::chrono::duration<double, std::milli> populateMsecs =
+      std::chrono::steady_clock::now() - populateStart;
+  auto rssPopulated = rssKb();
+
+  // Claim everything, the way BcmEgress, BcmHost and BcmRoute do on replay
+  auto claimStart = std::chrono::steady_clock::now();
+  suspender.dismiss();
+  for (const auto& hostIp : hostIps) {
+    folly::IPAddress ip(hostIp);
+    auto egressItr = cache->findEgressFromHost(kVrfId, ip, std::nullopt);
+    if (egressItr != cache->egressId2Egress_end()) {
+      cache->programmedEgressFromHost(egressItr, kVrfId, ip, std::nullopt);
+    }
+    auto hostItr = cache->findHost(kVrfId, ip);
+    if (hostItr != cache->vrfAndIP2Host_end()) {
+      cache->programmed(hostItr);
+    }
+  }
+  for (const auto& [prefix, mask] : prefixes) {
+    folly::IPAddress ip(prefix);
+    auto hostRouteItr = cache->findHostRouteFromRouteTable(kVrfId, ip);
+    if (hostRouteItr != cache->vrfAndIP2Route_end()) {
+      cache->programmed(hostRouteItr);
+      continue;
+    }
+    auto routeItr = cache->findRoute(kVrfId, ip, mask);
+    if (routeItr != cache->vrfAndPrefix2Route_end()) {
+      cache->programmed(routeItr);
+    }
+  }
+  suspender.rehire();
+  std::chrono::duration<double, std::milli> claimMsecs =
+      std::chrono::steady_clock::now() - claimStart;
+  auto rssClaimed = rssKb();
+
+  folly::dynamic result = folly::dynamic::object;
+  result["routes"] = FLAGS_wb_cache_routes;
+  result["hosts"] = FLAGS_wb_cache_hosts;
+  result["populate_msecs"] = populateMsecs.count();
+  result["claim_msecs"] = claimMsecs.count();
+  result["populate_rss_kb"] = rssPopulated - rssBefore;
+  result["rss_after_claim_kb"] = rssClaimed - rssBefore;
+  std::cout << folly::toPrettyJson(result) << std::endl;
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmSflowExporter.h"
+
+#include <folly/io/Cursor.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <thread>
+
+DECLARE_bool(sflow_export_batched);
+DECLARE_int32(sflow_datagram_max_size);
+
+using namespace facebook::fboss;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kMaxDatagramSize = 1400;
+// version, address type, IPv6 agent address, sub agent, sequence, uptime
+constexpr size_t kNumSamplesOffset = 4 + 4 + 16 + 4 + 4 + 4;
+
+SflowPacketInfo makeSample(PortID port, size_t packetSize) {
+  SflowPacketInfo info;
+  *info.ingressSampled_ref() = true;
+  *info.egressSampled_ref() = false;
+  info.srcPort_ref() = static_cast<int16_t>(port);
+  info.dstPort_ref() = 0;
+  info.vlan_ref() = 1;
+  *info.packetData_ref() = std::string(packetSize, 'x');
+  *info.frameLength_ref() = packetSize;
+  return info;
+}
+
+uint32_t numSamples(folly::ByteRange datagram) {
+  auto buf = folly::IOBuf::wrapBuffer(datagram.data(), datagram.size());
+  folly::io::Cursor cursor(buf.get());
+  cursor.skip(kNumSamplesOffset);
+  return cursor.readBE<uint32_t>();
+}
+
+/*
+ * A UDP socket bound to an ephemeral loopback port, standing in for an sFlow
+ * collector.
+ */
+class LoopbackCollector {
+ public:
+  LoopbackCollector() {
+    socket_ = ::socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    CHECK_GE(socket_, 0);
+    int rcvBuf = 16 << 20;
+    setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+    timeval timeout{0, 200000};
+    setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    folly::SocketAddress addr("::1", 0);
+    sockaddr_storage storage;
+    addr.getAddress(&storage);
+    CHECK_EQ(
+        ::bind(
+            socket_,
+            reinterpret_cast<sockaddr*>(&storage),
+            addr.getActualSize()),
+        0);
+    addr.setFromLocalAddress(folly::NetworkSocket::fromFd(socket_));
+    port_ = addr.getPort();
+  }
+  ~LoopbackCollector() {
+    ::close(socket_);
+  }
+
+  uint16_t port() const {
+    return port_;
+  }
+
+  /*
+   * Receive datagrams until none arrive for the receive timeout, returning
+   * the number of samples received.
+   */
+  uint64_t receiveAll(size_t* maxDatagramSize) {
+    uint64_t samples = 0;
+    std::vector<uint8_t> buf(64 * 1024);
+    while (true) {
+      auto len = ::recv(socket_, buf.data(), buf.size(), 0);
+      if (len <= 0) {
+        return samples;
+      }
+      *maxDatagramSize = std::max(*maxDatagramSize, size_t(len));
+      samples += numSamples(folly::ByteRange(buf.data(), len));
+    }
+  }
+
+ private:
+  int socket_{-1};
+  uint16_t port_{0};
+};
+
+} // namespace
+
+TEST(BcmSflowExporterTest, DatagramBuilderBatchesSamples) {
+  SflowDatagramBuilder builder(kMaxDatagramSize);
+  builder.reset(folly::IPAddress("2401:db00::1"), 1, 0);
+  EXPECT_EQ(builder.numSamples(), 0);
+
+  HwPortStats stats;
+  *stats.inBytes__ref() = 1000;
+  EXPECT_TRUE(builder.addCounterSample(PortID(1), 1, stats));
+
+  uint32_t sequence = 0;
+  while (builder.addFlowSample(
+      makeSample(PortID(1), 128), ++sequence, 1000, 0)) {
+  }
+  // After the 40 byte header and a 116 byte counter sample, a flow sample
+  // with a 128 byte sampled header takes 192 bytes
+  EXPECT_EQ(builder.numSamples(), 1 + 6);
+  EXPECT_LE(builder.data().size(), kMaxDatagramSize);
+  EXPECT_EQ(numSamples(builder.data()), builder.numSamples());
+
+  // Reset reuses the buffers for the next datagram
+  builder.reset(folly::IPAddress("2401:db00::1"), 2, 0);
+  EXPECT_EQ(builder.numSamples(), 0);
+  EXPECT_EQ(numSamples(builder.data()), 0);
+}
+
+TEST(BcmSflowExporterTest, BatchedExportOverLoopback) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_sflow_export_batched = true;
+  FLAGS_sflow_datagram_max_size = kMaxDatagramSize;
+  constexpr auto kNumSamples = 100000;
+
+  LoopbackCollector collector;
+  auto table = std::make_unique<BcmSflowExporterTable>();
+  table->addExporter(
+      std::make_shared<SflowCollector>("::1", collector.port()));
+  table->updateSamplingRates(PortID(1), 1000, 0);
+
+  uint64_t received = 0;
+  size_t maxDatagramSize = 0;
+  std::thread receiver(
+      [&]() { received = collector.receiveAll(&maxDatagramSize); });
+
+  auto start = steady_clock::now();
+  for (auto i = 0; i < kNumSamples; ++i) {
+    table->sendToAll(makeSample(PortID(1), 128));
+  }
+  auto enqueued = steady_clock::now();
+  // Wait for the export thread to drain the queue and flush the last datagram
+  auto deadline = enqueued + std::chrono::seconds(10);
+  while (table->samplesExported() + table->samplesDropped() < kNumSamples &&
+         steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto done = steady_clock::now();
+  auto exported = table->samplesExported();
+  auto dropped = table->samplesDropped();
+  auto datagrams = table->datagramsSent();
+  receiver.join();
+
+  auto enqueueUs = duration_cast<microseconds>(enqueued - start).count();
+  auto exportUs = duration_cast<microseconds>(done - start).count();
+  XLOG(INFO) << "Enqueued " << kNumSamples << " samples at "
+             << kNumSamples * 1e6 / std::max<int64_t>(enqueueUs, 1)
+             << " samples/s, exported " << exported << " samples in "
+             << datagrams << " datagrams at "
+             << exported * 1e6 / std::max<int64_t>(exportUs, 1)
+             << " samples/s, dropped " << dropped << ", received "
+             << received;
+
+  EXPECT_EQ(exported + dropped, kNumSamples);
+  EXPECT_GT(received, 0);
+  EXPECT_LE(maxDatagramSize, kMaxDatagramSize);
+  // Samples are batched, and loopback may drop datagrams but not add any
+  EXPECT_LE(received, kNumSamples);
+  EXPECT_GT(exported, datagrams);
+}
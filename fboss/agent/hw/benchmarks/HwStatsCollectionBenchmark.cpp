@@ -15,8 +15,49 @@
 #include "fboss/agent/hw/test/HwSwitchEnsembleFactory.h"
 
 #include <folly/Benchmark.h>
+#include <folly/Format.h>
 #include <folly/logging/xlog.h>
 
+DEFINE_int32(
+    stats_collection_acls,
+    0,
+    "Number of ACLs, each with a packets and bytes counter, to program "
+    "before collecting stats");
+
+namespace {
+
+void addAclsWithCounters(facebook::fboss::cfg::SwitchConfig* config) {
+  using namespace facebook::fboss;
+  cfg::TrafficPolicyConfig policy;
+  for (auto i = 0; i < FLAGS_stats_collection_acls; ++i) {
+    auto aclName = folly::sformat("stats_acl_{}", i);
+    auto counterName = folly::sformat("stats_acl_counter_{}", i);
+    cfg::AclEntry acl;
+    *acl.name_ref() = aclName;
+    *acl.actionType_ref() = cfg::AclActionType::PERMIT;
+    acl.proto_ref() = 6;
+    acl.l4DstPort_ref() = 1024 + i;
+    config->acls_ref()->push_back(acl);
+
+    cfg::TrafficCounter counter;
+    *counter.name_ref() = counterName;
+    *counter.types_ref() = {cfg::CounterType::PACKETS, cfg::CounterType::BYTES};
+    config->trafficCounters_ref()->push_back(counter);
+
+    cfg::MatchAction matchAction;
+    matchAction.counter_ref() = counterName;
+    cfg::MatchToAction action;
+    *action.matcher_ref() = aclName;
+    *action.action_ref() = matchAction;
+    policy.matchToAction_ref()->push_back(action);
+  }
+  if (FLAGS_stats_collection_acls) {
+    config->dataPlaneTrafficPolicy_ref() = policy;
+  }
+}
+
+} // namespace
+
 namespace facebook::fboss {
 
 /*
@@ -30,6 +71,8 @@ namespace facebook::fboss {
  *   for us. Having the framework be aware that we are doing internal
  *   iteration (by letting it pick number of iterations), and calculating
  *   cost of a single iterations does not seem to have more fidelity
+ * Use --stats_collection_acls to measure ACL heavy configs, where
+ * ACL counter collection dominates.
  */
 BENCHMARK(HwStatsCollection) {
   folly::BenchmarkSuspender suspender;
@@ -37,6 +80,7 @@ BENCHMARK(HwStatsCollection) {
   auto hwSwitch = ensemble->getHwSwitch();
   auto config =
       utility::onePortPerVlanConfig(hwSwitch, ensemble->masterLogicalPortIds());
+  addAclsWithCounters(&config);
   ensemble->applyInitialConfig(config);
   SwitchStats dummy;
   suspender.dismiss();
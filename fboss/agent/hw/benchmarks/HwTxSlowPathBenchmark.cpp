@@ -9,6 +9,7 @@
  */
 
 #include "fboss/agent/Platform.h"
+#include "fboss/agent/TxPacket.h"
 #include "fboss/agent/hw/test/ConfigFactory.h"
 #include "fboss/agent/hw/test/HwSwitchEnsemble.h"
 #include "fboss/agent/hw/test/HwSwitchEnsembleFactory.h"
@@ -23,12 +24,18 @@
 #include <chrono>
 #include <iostream>
 #include <thread>
+#include <vector>
 
 DEFINE_bool(json, true, "Output in json form");
 DEFINE_bool(
     setup_for_warmboot,
     false,
     "Set to true will prepare the device for warmboot");
+DEFINE_uint32(
+    tx_burst_size,
+    0,
+    "Send packets in bursts of this many with sendPacketsSwitchedAsync. "
+    "0 sends them one at a time");
 
 namespace facebook::fboss {
 
@@ -59,6 +66,8 @@ void runTxSlowPathBenchmark() {
     const auto kSrcIp = folly::IPAddressV6("2620:0:1cfe:face:b00c::3");
     const auto kDstIp = folly::IPAddressV6("2620:0:1cfe:face:b00c::4");
     const auto kSrcMac = folly::MacAddress{"fa:ce:b0:00:00:0c"};
+    const auto burstSize = FLAGS_tx_burst_size;
+    std::vector<std::unique_ptr<TxPacket>> burst;
     while (!packetTxDone) {
       for (auto i = 0; i < 1'000; ++i) {
         // Send packet
@@ -69,9 +78,21 @@ void runTxSlowPathBenchmark() {
             cpuMac,
             kSrcIp,
             kDstIp);
-        hwSwitch->sendPacketSwitchedAsync(std::move(txPacket));
+        if (!burstSize) {
+          hwSwitch->sendPacketSwitchedAsync(std::move(txPacket));
+          continue;
+        }
+        burst.push_back(std::move(txPacket));
+        if (burst.size() == burstSize) {
+          hwSwitch->sendPacketsSwitchedAsync(std::move(burst));
+          burst.clear();
+        }
       }
     }
+    // Send the last, partial burst
+    if (!burst.empty()) {
+      hwSwitch->sendPacketsSwitchedAsync(std::move(burst));
+    }
   });
 
   auto [pktsBefore, bytesBefore] =
@@ -97,6 +118,7 @@ void runTxSlowPathBenchmark() {
     folly::dynamic cpuTxRateJson = folly::dynamic::object;
     cpuTxRateJson["cpu_tx_pps"] = pps;
     cpuTxRateJson["cpu_tx_bytes_per_sec"] = bytesPerSec;
+    cpuTxRateJson["cpu_tx_burst_size"] = FLAGS_tx_burst_size;
     std::cout << toPrettyJson(cpuTxRateJson) << std::endl;
   } else {
     XLOG(INFO) << " Pkts before: " << pktsBefore << " Pkts after: " << pktsAfter
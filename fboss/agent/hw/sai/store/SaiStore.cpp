@@ -12,6 +12,15 @@
 
 #include <folly/Singleton.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace {
 struct singleton_tag_type {};
 } // namespace
@@ -38,19 +47,88 @@ void SaiStore::setSwitchId(sai_object_id_t switchId) {
 
 void SaiStore::reload(
     const folly::dynamic* adapterKeysJson,
-    const folly::dynamic* adapterKeys2AdapterHostKeyJson) {
+    const folly::dynamic* adapterKeys2AdapterHostKeyJson,
+    size_t numThreads) {
+  struct StoreReload {
+    size_t numKeys;
+    std::function<void()> reload;
+    std::function<void()> report;
+  };
+  std::vector<StoreReload> reloads;
   tupleForEach(
-      [adapterKeysJson, adapterKeys2AdapterHostKeyJson](auto& store) {
+      [&reloads, adapterKeysJson, adapterKeys2AdapterHostKeyJson](
+          auto& store) {
         const folly::dynamic* adapterKeys = adapterKeysJson
             ? adapterKeysJson->get_ptr(store.objectTypeName())
             : nullptr;
         const folly::dynamic* adapterHostKeys = adapterKeys2AdapterHostKeyJson
             ? adapterKeys2AdapterHostKeyJson->get_ptr(store.objectTypeName())
             : nullptr;
-
-        store.reload(adapterKeys, adapterHostKeys);
+        reloads.push_back(
+            {adapterKeys ? adapterKeys->size() : 0,
+             [&store, adapterKeys, adapterHostKeys]() {
+               store.reload(adapterKeys, adapterHostKeys);
+             },
+             [&store]() {
+               if (store.size()) {
+                 XLOGF(
+                     DBG1,
+                     "SaiStore reloaded {} {} objects in {} us",
+                     store.size(),
+                     store.objectTypeName(),
+                     store.lastReloadDuration().count());
+               }
+             }});
       },
       stores_);
+
+  auto begin = std::chrono::steady_clock::now();
+  numThreads = std::min(numThreads, reloads.size());
+  if (numThreads <= 1) {
+    for (auto& storeReload : reloads) {
+      storeReload.reload();
+    }
+  } else {
+    // Start with the largest stores (routes, next hops, neighbors...) so they
+    // do not end up as the tail of the reload
+    std::stable_sort(
+        reloads.begin(), reloads.end(), [](const auto& a, const auto& b) {
+          return a.numKeys > b.numKeys;
+        });
+    std::atomic<size_t> next{0};
+    std::mutex exceptionLock;
+    std::exception_ptr exception;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < numThreads; ++i) {
+      workers.emplace_back([&]() {
+        for (auto idx = next++; idx < reloads.size(); idx = next++) {
+          try {
+            reloads[idx].reload();
+          } catch (...) {
+            std::lock_guard<std::mutex> g{exceptionLock};
+            if (!exception) {
+              exception = std::current_exception();
+            }
+          }
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+  for (const auto& storeReload : reloads) {
+    storeReload.report();
+  }
+  XLOG(DBG1) << "SaiStore reload done in "
+             << std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - begin)
+                    .count()
+             << " ms using " << std::max<size_t>(numThreads, 1)
+             << " thread(s)";
 }
 
 void SaiStore::release() {
@@ -22,10 +22,12 @@
 
 #include <folly/dynamic.h>
 
+#include <chrono>
 #include <memory>
 #include <optional>
 #include <sstream>
 #include <type_traits>
+#include <unordered_map>
 
 extern "C" {
 #include <sai.h>
@@ -114,6 +116,7 @@ class SaiObjectStore {
       XLOG(FATAL)
           << "Attempted to reload() on a SaiObjectStore without a switchId";
     }
+    auto begin = std::chrono::steady_clock::now();
     auto keys = getAdapterKeys(adapterKeysJson);
     if constexpr (SaiObjectHasConditionalAttributes<SaiObjectTraits>::value) {
       keys.erase(
@@ -132,18 +135,38 @@ class SaiObjectStore {
               }),
           keys.end());
     }
-    for (const auto k : keys) {
-      ObjectType obj = getObject(k, adapterKeys2AdapterHostKey);
-      auto adapterHostKey = obj.adapterHostKey();
-      XLOGF(DBG5, "SaiStore reloaded {}", obj);
-      auto ins = objects_.refOrInsert(adapterHostKey, std::move(obj));
-      if (!ins.second) {
-        XLOG(FATAL) << "[" << saiObjectTypeToString(SaiObjectTraits::ObjectType)
-                    << "]"
-                    << " Unexpected duplicate adapterHostKey";
+    warmBootHandles_.reserve(warmBootHandles_.size() + keys.size());
+    bool reloaded = false;
+    if constexpr (!AdapterHostKeyWarmbootRecoverable<SaiObjectTraits>::value) {
+      // API tests program using API and reload without json
+      // such cases has null adapterKeys2AdapterHostKey json
+      if (adapterKeys2AdapterHostKey) {
+        auto adapterHostKeys =
+            adapterHostKeysFromFollyDynamic(*adapterKeys2AdapterHostKey);
+        for (const auto& k : keys) {
+          auto iter = adapterHostKeys.find(k);
+          CHECK(iter != adapterHostKeys.end());
+          insertReloadedObject(ObjectType(k, std::move(iter->second)));
+        }
+        reloaded = true;
       }
-      warmBootHandles_.emplace(adapterHostKey, ins.first);
     }
+    if (!reloaded) {
+      for (const auto& k : keys) {
+        insertReloadedObject(ObjectType(k));
+      }
+    }
+    lastReloadDuration_ =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - begin);
+  }
+
+  /*
+   * Time spent in the last reload(), including adapter key discovery and
+   * fetching the attributes of every object.
+   */
+  std::chrono::microseconds lastReloadDuration() const {
+    return lastReloadDuration_;
   }
 
   std::shared_ptr<ObjectType> setObject(
@@ -297,17 +320,16 @@ class SaiObjectStore {
   }
 
  private:
-  ObjectType getObject(
-      typename SaiObjectTraits::AdapterKey key,
-      const folly::dynamic* adapterKey2AdapterHostKey) {
-    if constexpr (!AdapterHostKeyWarmbootRecoverable<SaiObjectTraits>::value) {
-      if (auto ahk = getAdapterHostKey(key, adapterKey2AdapterHostKey)) {
-        return ObjectType(key, ahk.value());
-      }
-      // API tests program using API and reload without json
-      // such cases has null adapterKeys2AdapterHostKey json
+  void insertReloadedObject(ObjectType obj) {
+    auto adapterHostKey = obj.adapterHostKey();
+    XLOGF(DBG5, "SaiStore reloaded {}", obj);
+    auto ins = objects_.refOrInsert(adapterHostKey, std::move(obj));
+    if (!ins.second) {
+      XLOG(FATAL) << "[" << saiObjectTypeToString(SaiObjectTraits::ObjectType)
+                  << "]"
+                  << " Unexpected duplicate adapterHostKey";
     }
-    return ObjectType(key);
+    warmBootHandles_.emplace(adapterHostKey, ins.first);
   }
 
   std::pair<std::shared_ptr<ObjectType>, bool> program(
@@ -338,21 +360,35 @@ class SaiObjectStore {
                            : getObjectKeys<SaiObjectTraits>(switchId_.value());
   }
 
-  std::optional<typename SaiObjectTraits::AdapterHostKey> getAdapterHostKey(
-      const typename SaiObjectTraits::AdapterKey& key,
-      const folly::dynamic* adapterKeys2AdapterHostKey) {
-    if (!adapterKeys2AdapterHostKey) {
-      return std::nullopt;
+  /*
+   * Decode the whole adapter key -> adapter host key json of this object type
+   * up front, so reload does a hash lookup per object instead of formatting
+   * the adapter key and searching the dynamic object.
+   */
+  static std::unordered_map<
+      typename SaiObjectTraits::AdapterKey,
+      typename SaiObjectTraits::AdapterHostKey>
+  adapterHostKeysFromFollyDynamic(const folly::dynamic& json) {
+    static_assert(
+        AdapterKeyIsObjectId<SaiObjectTraits>::value,
+        "adapter host keys are only saved for objects keyed by object id");
+    std::unordered_map<
+        typename SaiObjectTraits::AdapterKey,
+        typename SaiObjectTraits::AdapterHostKey>
+        adapterHostKeys;
+    adapterHostKeys.reserve(json.size());
+    for (const auto& [key, value] : json.items()) {
+      adapterHostKeys.emplace(
+          typename SaiObjectTraits::AdapterKey{
+              folly::to<sai_object_id_t>(key.asString())},
+          SaiObject<SaiObjectTraits>::follyDynamicToAdapterHostKey(value));
     }
-    auto iter = adapterKeys2AdapterHostKey->find(folly::to<std::string>(key));
-    CHECK(iter != adapterKeys2AdapterHostKey->items().end());
-
-    return SaiObject<SaiObjectTraits>::follyDynamicToAdapterHostKey(
-        iter->second);
+    return adapterHostKeys;
   }
 
   std::optional<sai_object_id_t> switchId_;
   bool objectOwnedByAdapter_{false};
+  std::chrono::microseconds lastReloadDuration_{0};
   UnorderedRefMap<typename SaiObjectTraits::AdapterHostKey, ObjectType>
       objects_;
   std::unordered_map<
@@ -394,10 +430,17 @@ class SaiStore {
 
   /*
    * Reload the SaiStore from the current SAI state via SAI api calls.
+   *
+   * Reloading a SaiObjectStore only reads the adapter and the json of its own
+   * object type, so the stores are independent of each other and are spread
+   * over numThreads workers. Adapter calls are still serialized by
+   * SaiApiLock; the workers overlap json decoding and object construction
+   * with them.
    */
   void reload(
       const folly::dynamic* adapterKeys = nullptr,
-      const folly::dynamic* adapterKeys2AdapterHostKey = nullptr);
+      const folly::dynamic* adapterKeys2AdapterHostKey = nullptr,
+      size_t numThreads = 1);
 
   /*
    *
@@ -222,3 +222,35 @@ TEST_F(NextHopGroupStoreTest, nextHopGroupJson) {
   EXPECT_FALSE(nhgAk2AhkJson.items().end() == iter);
   EXPECT_EQ(iter->second, json);
 }
+
+TEST_F(NextHopGroupStoreTest, parallelReloadFromJson) {
+  auto nextHopGroupId = createNextHopGroup();
+  folly::IPAddress ip1{"10.10.10.1"};
+  folly::IPAddress ip2{"10.10.10.2"};
+  auto nextHopId1 = createNextHop(ip1);
+  auto nextHopId2 = createNextHop(ip2);
+  auto nextHopGroupMemberId1 =
+      createNextHopGroupMember(nextHopGroupId, nextHopId1, std::nullopt);
+  createNextHopGroupMember(nextHopGroupId, nextHopId2, std::nullopt);
+
+  SaiStore s(0);
+  s.reload();
+  auto adapterKeysJson = s.adapterKeysFollyDynamic();
+  auto ak2AhkJson = s.adapterKeys2AdapterHostKeysFollyDynamic();
+
+  SaiStore s2(0);
+  s2.reload(&adapterKeysJson, &ak2AhkJson, 4);
+
+  SaiNextHopGroupTraits::AdapterHostKey k;
+  k.insert(SaiIpNextHopTraits::AdapterHostKey{42, ip1});
+  k.insert(SaiIpNextHopTraits::AdapterHostKey{42, ip2});
+  auto got = s2.get<SaiNextHopGroupTraits>().get(k);
+  EXPECT_TRUE(got);
+  EXPECT_EQ(got->adapterKey(), nextHopGroupId);
+
+  auto gotMember = s2.get<SaiNextHopGroupMemberTraits>().get(
+      SaiNextHopGroupMemberTraits::AdapterHostKey{nextHopGroupId, nextHopId1});
+  EXPECT_TRUE(gotMember);
+  EXPECT_EQ(gotMember->adapterKey(), nextHopGroupMemberId1);
+  EXPECT_EQ(s2.get<SaiIpNextHopTraits>().size(), 2);
+}
@@ -83,6 +83,11 @@ DEFINE_bool(
     false,
     "Fail if any warm boot handles are left unclaimed.");
 
+DEFINE_uint32(
+    sai_store_reload_threads,
+    4,
+    "Number of threads used to reload SaiStore object stores on init");
+
 namespace {
 /*
  * For the devices/SDK we use, the only events we should get (and process)
@@ -651,6 +656,9 @@ bool SaiSwitch::isValidStateUpdate(const StateDelta& delta) const {
 
 std::unique_ptr<TxPacket> SaiSwitch::allocatePacket(uint32_t size) const {
   getSwitchStats()->txPktAlloc();
+  if (const auto& pool = getTxBufferPool()) {
+    return std::make_unique<SaiTxPacket>(size, pool);
+  }
   return std::make_unique<SaiTxPacket>(size);
 }
 
@@ -659,6 +667,20 @@ bool SaiSwitch::sendPacketSwitchedAsync(
   return sendPacketSwitchedSync(std::move(pkt));
 }
 
+bool SaiSwitch::sendPacketsSwitchedAsync(
+    std::vector<std::unique_ptr<TxPacket>> pkts) noexcept {
+  // SAI hostif sends one packet per call, but the ASIC feature lookup and
+  // the hostif API are the same for the whole burst
+  auto checkSmacEqualsDmac = platform_->getAsic()->isSupported(
+      HwAsic::Feature::SMAC_EQUALS_DMAC_CHECK_ENABLED);
+  auto& hostifApi = SaiApiTable::getInstance()->hostifApi();
+  bool allSent = true;
+  for (auto& pkt : pkts) {
+    allSent &= sendPacketSwitched(pkt.get(), checkSmacEqualsDmac, hostifApi);
+  }
+  return allSent;
+}
+
 bool SaiSwitch::sendPacketOutOfPortAsync(
     std::unique_ptr<TxPacket> pkt,
     PortID portID,
@@ -957,7 +979,8 @@ void SaiSwitch::initStoreAndManagersLocked(
     const folly::dynamic* adapterKeys2AdapterHostKeys) {
   auto saiStore = SaiStore::getInstance();
   saiStore->setSwitchId(switchId_);
-  saiStore->reload(adapterKeys, adapterKeys2AdapterHostKeys);
+  saiStore->reload(
+      adapterKeys, adapterKeys2AdapterHostKeys, FLAGS_sai_store_reload_threads);
   managerTable_->createSaiTableManagers(platform_, concurrentIndices_.get());
   /*
    * SwitchState does not have notion of AclTableGroup or AclTable today.
@@ -1193,9 +1216,19 @@ bool SaiSwitch::isValidStateUpdateLocked(
 }
 
 bool SaiSwitch::sendPacketSwitchedSync(std::unique_ptr<TxPacket> pkt) noexcept {
+  return sendPacketSwitched(
+      pkt.get(),
+      platform_->getAsic()->isSupported(
+          HwAsic::Feature::SMAC_EQUALS_DMAC_CHECK_ENABLED),
+      SaiApiTable::getInstance()->hostifApi());
+}
+
+bool SaiSwitch::sendPacketSwitched(
+    TxPacket* pkt,
+    bool checkSmacEqualsDmac,
+    HostifApi& hostifApi) noexcept {
   folly::io::Cursor cursor(pkt->buf());
-  if (platform_->getAsic()->isSupported(
-          HwAsic::Feature::SMAC_EQUALS_DMAC_CHECK_ENABLED)) {
+  if (checkSmacEqualsDmac) {
     EthHdr ethHdr{cursor};
     if (ethHdr.getSrcMac() == ethHdr.getDstMac()) {
       auto* pktData = pkt->buf()->writableData();
@@ -1218,7 +1251,6 @@ bool SaiSwitch::sendPacketSwitchedSync(std::unique_ptr<TxPacket> pkt) noexcept {
   SaiHostifApiPacket txPacket{
       reinterpret_cast<void*>(pkt->buf()->writableData()),
       pkt->buf()->length()};
-  auto& hostifApi = SaiApiTable::getInstance()->hostifApi();
   auto rv = hostifApi.send(attributes, switchId_, txPacket);
   if (rv != SAI_STATUS_SUCCESS) {
     saiLogError(
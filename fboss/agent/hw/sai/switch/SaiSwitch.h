@@ -79,6 +79,9 @@ class SaiSwitch : public HwSwitch {
 
   bool sendPacketSwitchedAsync(std::unique_ptr<TxPacket> pkt) noexcept override;
 
+  bool sendPacketsSwitchedAsync(
+      std::vector<std::unique_ptr<TxPacket>> pkts) noexcept override;
+
   bool sendPacketOutOfPortAsync(
       std::unique_ptr<TxPacket> pkt,
       PortID portID,
@@ -180,6 +183,12 @@ class SaiSwitch : public HwSwitch {
   void switchRunStateChangedImpl(SwitchRunState newState) override;
 
   void updateStatsImpl(SwitchStats* switchStats) override;
+
+  bool sendPacketSwitched(
+      TxPacket* pkt,
+      bool checkSmacEqualsDmac,
+      HostifApi& hostifApi) noexcept;
+
   template <typename LockPolicyT>
   void updateResourceUsage(const LockPolicyT& lockPolicy);
   /*
@@ -12,6 +12,7 @@
 #include "fboss/agent/hw/sai/switch/SaiManagerTable.h"
 
 #include "fboss/agent/TxPacket.h"
+#include "fboss/agent/TxPacketBufferPool.h"
 
 namespace facebook::fboss {
 
@@ -21,6 +22,24 @@ class SaiTxPacket : public TxPacket {
     buf_ = folly::IOBuf::createCombined(size);
     buf_->append(size);
   }
+
+  /*
+   * Packet whose buffer comes from pool, and goes back to it once the
+   * packet is sent or dropped.
+   */
+  SaiTxPacket(uint32_t size, std::shared_ptr<TxPacketBufferPool> pool)
+      : pool_(std::move(pool)) {
+    buf_ = pool_->allocate(size);
+  }
+
+  ~SaiTxPacket() override {
+    if (pool_) {
+      pool_->release(std::move(buf_));
+    }
+  }
+
+ private:
+  std::shared_ptr<TxPacketBufferPool> pool_;
 };
 
 } // namespace facebook::fboss
@@ -0,0 +1,287 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/sai/tracer/SaiBinaryTracer.h"
+
+#include "fboss/agent/SysError.h"
+
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/logging/xlog.h>
+
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Flush to file once this many bytes are pending, even before the interval
+constexpr size_t kFlushBytes = 1 << 20;
+
+size_t alignUp(size_t size) {
+  return (size + facebook::fboss::kSaiTraceAlignment - 1) &
+      ~(facebook::fboss::kSaiTraceAlignment - 1);
+}
+
+uint64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+namespace facebook::fboss {
+
+SaiBinaryTracer::SaiBinaryTracer(
+    const std::string& filePath,
+    size_t ringSlots,
+    std::chrono::milliseconds flushInterval)
+    : ring_(ringSlots),
+      file_(filePath, O_RDWR | O_CREAT | O_TRUNC),
+      flushInterval_(flushInterval) {
+  SaiTraceFileHeader fileHeader{};
+  std::memcpy(fileHeader.magic, kSaiTraceMagic, sizeof(kSaiTraceMagic));
+  fileHeader.version = kSaiTraceVersion;
+  fileHeader.attrValueSize = sizeof(sai_attribute_value_t);
+  if (folly::writeFull(file_.fd(), &fileHeader, sizeof(fileHeader)) < 0) {
+    throw SysError(errno, "error writing sai trace header to ", filePath);
+  }
+  flushThread_ = std::thread([this] { flushLoop(); });
+}
+
+SaiBinaryTracer::~SaiBinaryTracer() {
+  running_.store(false, std::memory_order_release);
+  flushThread_.join();
+  if (auto dropped = droppedRecords()) {
+    XLOG(ERR) << "Sai binary tracer dropped " << dropped
+              << " records, trace is incomplete";
+  }
+  fsync(file_.fd());
+}
+
+void SaiBinaryTracer::logApiInitialize(
+    const char** variables,
+    const char** values,
+    int size) {
+  std::string payload;
+  for (int i = 0; i < size; ++i) {
+    payload.append(variables[i]).push_back('\0');
+    payload.append(values[i]).push_back('\0');
+  }
+  record(
+      SaiTraceOp::API_INITIALIZE,
+      SAI_OBJECT_TYPE_NULL,
+      SAI_NULL_OBJECT_ID,
+      SAI_NULL_OBJECT_ID,
+      0,
+      nullptr,
+      SAI_STATUS_SUCCESS,
+      payload.data(),
+      payload.size());
+}
+
+void SaiBinaryTracer::logApiQuery(sai_api_t api) {
+  // Api id is carried as the object id, there is no object type to derive
+  // the api from
+  record(
+      SaiTraceOp::API_QUERY,
+      SAI_OBJECT_TYPE_NULL,
+      api,
+      SAI_NULL_OBJECT_ID,
+      0,
+      nullptr,
+      SAI_STATUS_SUCCESS,
+      nullptr,
+      0);
+}
+
+void SaiBinaryTracer::logCreate(
+    sai_object_type_t objectType,
+    sai_object_id_t objectId,
+    sai_object_id_t switchId,
+    uint32_t attrCount,
+    const sai_attribute_t* attrList,
+    sai_status_t rv) {
+  record(
+      SaiTraceOp::CREATE,
+      objectType,
+      objectId,
+      switchId,
+      attrCount,
+      attrList,
+      rv,
+      nullptr,
+      0);
+}
+
+void SaiBinaryTracer::logRemove(
+    sai_object_type_t objectType,
+    sai_object_id_t objectId,
+    sai_status_t rv) {
+  record(
+      SaiTraceOp::REMOVE,
+      objectType,
+      objectId,
+      SAI_NULL_OBJECT_ID,
+      0,
+      nullptr,
+      rv,
+      nullptr,
+      0);
+}
+
+void SaiBinaryTracer::logSetAttr(
+    sai_object_type_t objectType,
+    sai_object_id_t objectId,
+    const sai_attribute_t* attr,
+    sai_status_t rv) {
+  record(
+      SaiTraceOp::SET,
+      objectType,
+      objectId,
+      SAI_NULL_OBJECT_ID,
+      1,
+      attr,
+      rv,
+      nullptr,
+      0);
+}
+
+void SaiBinaryTracer::logSendHostifPacket(
+    sai_object_id_t hostifId,
+    sai_size_t bufferSize,
+    const uint8_t* buffer,
+    uint32_t attrCount,
+    const sai_attribute_t* attrList,
+    sai_status_t rv) {
+  record(
+      SaiTraceOp::SEND_PACKET,
+      SAI_OBJECT_TYPE_HOSTIF_PACKET,
+      hostifId,
+      SAI_NULL_OBJECT_ID,
+      attrCount,
+      attrList,
+      rv,
+      buffer,
+      bufferSize);
+}
+
+void SaiBinaryTracer::record(
+    SaiTraceOp op,
+    sai_object_type_t objectType,
+    sai_object_id_t objectId,
+    sai_object_id_t switchId,
+    uint32_t attrCount,
+    const sai_attribute_t* attrList,
+    sai_status_t rv,
+    const void* payload,
+    size_t payloadSize) {
+  if (attrCount > std::numeric_limits<uint16_t>::max()) {
+    // Does not fit SaiTraceRecordHeader::attrCount, a truncated count
+    // would make the rest of the trace undecodable
+    XLOG(ERR) << "Not tracing sai call with " << attrCount
+              << " attributes, op " << static_cast<int>(op)
+              << ", object type " << objectType;
+    rejectedRecords_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  // Encoding buffer is reused across calls on the same thread so steady
+  // state tracing does not allocate
+  static thread_local std::vector<uint8_t> scratch;
+
+  auto attrBytes = attrCount * sizeof(SaiTraceAttr);
+  scratch.resize(sizeof(SaiTraceRecordHeader) + attrBytes);
+  auto attrOffset = sizeof(SaiTraceRecordHeader);
+
+  for (uint32_t i = 0; i < attrCount; ++i) {
+    SaiTraceAttr traceAttr{};
+    traceAttr.id = attrList[i].id;
+    traceAttr.value = attrList[i].value;
+    if (auto desc = saiTraceListDesc(objectType, attrList[i].id)) {
+      auto list = reinterpret_cast<const SaiTraceList*>(
+          reinterpret_cast<const uint8_t*>(&attrList[i].value) +
+          desc->offset);
+      if (list->list && list->count) {
+        auto listBytes = list->count * desc->elemSize;
+        auto start = static_cast<const uint8_t*>(list->list);
+        scratch.insert(scratch.end(), start, start + listBytes);
+        scratch.resize(alignUp(scratch.size()));
+        traceAttr.listBytes = alignUp(listBytes);
+      }
+    }
+    std::memcpy(
+        scratch.data() + attrOffset + i * sizeof(traceAttr),
+        &traceAttr,
+        sizeof(traceAttr));
+  }
+
+  if (payloadSize) {
+    auto start = static_cast<const uint8_t*>(payload);
+    scratch.insert(scratch.end(), start, start + payloadSize);
+  }
+  scratch.resize(alignUp(scratch.size()));
+
+  SaiTraceRecordHeader header{};
+  header.size = scratch.size();
+  header.op = static_cast<uint16_t>(op);
+  header.attrCount = attrCount;
+  header.api = op == SaiTraceOp::API_QUERY ? static_cast<int32_t>(objectId)
+                                           : saiTraceObjectApi(objectType);
+  header.objectType = objectType;
+  header.rv = rv;
+  header.payloadSize = payloadSize;
+  header.timestampUs = nowUs();
+  header.oid = objectId;
+  header.switchId = switchId;
+  std::memcpy(scratch.data(), &header, sizeof(header));
+
+  ring_.tryWrite(scratch.data(), scratch.size());
+}
+
+void SaiBinaryTracer::flushLoop() {
+  std::vector<uint8_t> buf;
+  buf.reserve(kFlushBytes + SaiTraceRing::kSlotSize);
+
+  while (running_.load(std::memory_order_acquire)) {
+    bool drained = false;
+    while (buf.size() < kFlushBytes) {
+      if (!ring_.tryRead(buf)) {
+        drained = true;
+        break;
+      }
+    }
+    writeOut(buf);
+    if (drained) {
+      std::this_thread::sleep_for(flushInterval_);
+    }
+  }
+
+  // Producers may still have pushed records before we were stopped
+  while (ring_.tryRead(buf)) {
+    if (buf.size() >= kFlushBytes) {
+      writeOut(buf);
+    }
+  }
+  writeOut(buf);
+}
+
+void SaiBinaryTracer::writeOut(std::vector<uint8_t>& buf) {
+  if (buf.empty()) {
+    return;
+  }
+  if (folly::writeFull(file_.fd(), buf.data(), buf.size()) < 0) {
+    XLOG(ERR) << "error writing " << buf.size()
+              << " bytes to sai trace: " << folly::errnoStr(errno);
+  }
+  buf.clear();
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/hw/sai/tracer/SaiTraceRecord.h"
+#include "fboss/agent/hw/sai/tracer/SaiTraceRing.h"
+
+#include <folly/File.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+extern "C" {
+#include <sai.h>
+}
+
+namespace facebook::fboss {
+
+/*
+ * Binary counterpart of the C code generated by SaiTracer. Every SAI call is
+ * encoded as a fixed layout record (see SaiTraceRecord.h) on the calling
+ * thread and pushed into a lock free ring. A background thread drains the
+ * ring into the trace file. Traces are turned back into C code or replayed
+ * with sai_trace_replayer.
+ */
+class SaiBinaryTracer {
+ public:
+  SaiBinaryTracer(
+      const std::string& filePath,
+      size_t ringSlots,
+      std::chrono::milliseconds flushInterval);
+  ~SaiBinaryTracer();
+
+  void logApiInitialize(const char** variables, const char** values, int size);
+
+  void logApiQuery(sai_api_t api);
+
+  void logCreate(
+      sai_object_type_t objectType,
+      sai_object_id_t objectId,
+      sai_object_id_t switchId,
+      uint32_t attrCount,
+      const sai_attribute_t* attrList,
+      sai_status_t rv);
+
+  void logRemove(
+      sai_object_type_t objectType,
+      sai_object_id_t objectId,
+      sai_status_t rv);
+
+  void logSetAttr(
+      sai_object_type_t objectType,
+      sai_object_id_t objectId,
+      const sai_attribute_t* attr,
+      sai_status_t rv);
+
+  // Entry objects (route, neighbor, fdb, inseg) are keyed by a struct
+  // instead of an object id, the key is stored as the record payload.
+  template <typename EntryT>
+  void logEntryOp(
+      SaiTraceOp op,
+      sai_object_type_t objectType,
+      const EntryT* entry,
+      uint32_t attrCount,
+      const sai_attribute_t* attrList,
+      sai_status_t rv) {
+    record(
+        op,
+        objectType,
+        SAI_NULL_OBJECT_ID,
+        entry->switch_id,
+        attrCount,
+        attrList,
+        rv,
+        entry,
+        sizeof(EntryT));
+  }
+
+  void logSendHostifPacket(
+      sai_object_id_t hostifId,
+      sai_size_t bufferSize,
+      const uint8_t* buffer,
+      uint32_t attrCount,
+      const sai_attribute_t* attrList,
+      sai_status_t rv);
+
+  // Records lost to a full ring or rejected as not encodable
+  uint64_t droppedRecords() const {
+    return ring_.droppedRecords() +
+        rejectedRecords_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void record(
+      SaiTraceOp op,
+      sai_object_type_t objectType,
+      sai_object_id_t objectId,
+      sai_object_id_t switchId,
+      uint32_t attrCount,
+      const sai_attribute_t* attrList,
+      sai_status_t rv,
+      const void* payload,
+      size_t payloadSize);
+
+  void flushLoop();
+  void writeOut(std::vector<uint8_t>& buf);
+
+  SaiTraceRing ring_;
+  folly::File file_;
+  std::chrono::milliseconds flushInterval_;
+  std::atomic<uint64_t> rejectedRecords_{0};
+  std::atomic<bool> running_{true};
+  std::thread flushThread_;
+};
+
+} // namespace facebook::fboss
@@ -0,0 +1,325 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/sai/tracer/SaiTraceRecord.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <folly/FileUtil.h>
+#include <folly/MapUtil.h>
+
+#include <cstring>
+#include <map>
+
+using folly::to;
+using std::string;
+
+namespace {
+
+struct ObjectInfo {
+  sai_api_t api;
+  const char* name;
+};
+
+const std::map<sai_object_type_t, ObjectInfo>& objectInfos() {
+  static const std::map<sai_object_type_t, ObjectInfo> kObjectInfos{
+      {SAI_OBJECT_TYPE_ACL_ENTRY, {SAI_API_ACL, "acl_entry"}},
+      {SAI_OBJECT_TYPE_ACL_TABLE, {SAI_API_ACL, "acl_table"}},
+      {SAI_OBJECT_TYPE_ACL_TABLE_GROUP, {SAI_API_ACL, "acl_table_group"}},
+      {SAI_OBJECT_TYPE_ACL_TABLE_GROUP_MEMBER,
+       {SAI_API_ACL, "acl_table_group_member"}},
+      {SAI_OBJECT_TYPE_BRIDGE, {SAI_API_BRIDGE, "bridge"}},
+      {SAI_OBJECT_TYPE_BRIDGE_PORT, {SAI_API_BRIDGE, "bridge_port"}},
+      {SAI_OBJECT_TYPE_BUFFER_POOL, {SAI_API_BUFFER, "buffer_pool"}},
+      {SAI_OBJECT_TYPE_BUFFER_PROFILE, {SAI_API_BUFFER, "buffer_profile"}},
+      {SAI_OBJECT_TYPE_FDB_ENTRY, {SAI_API_FDB, "fdb_entry"}},
+      {SAI_OBJECT_TYPE_HASH, {SAI_API_HASH, "hash"}},
+      {SAI_OBJECT_TYPE_HOSTIF, {SAI_API_HOSTIF, "hostif"}},
+      {SAI_OBJECT_TYPE_HOSTIF_PACKET, {SAI_API_HOSTIF, "hostif_packet"}},
+      {SAI_OBJECT_TYPE_HOSTIF_TRAP, {SAI_API_HOSTIF, "hostif_trap"}},
+      {SAI_OBJECT_TYPE_HOSTIF_TRAP_GROUP,
+       {SAI_API_HOSTIF, "hostif_trap_group"}},
+      {SAI_OBJECT_TYPE_INSEG_ENTRY, {SAI_API_MPLS, "inseg_entry"}},
+      {SAI_OBJECT_TYPE_MIRROR_SESSION, {SAI_API_MIRROR, "mirror_session"}},
+      {SAI_OBJECT_TYPE_NEIGHBOR_ENTRY, {SAI_API_NEIGHBOR, "neighbor_entry"}},
+      {SAI_OBJECT_TYPE_NEXT_HOP, {SAI_API_NEXT_HOP, "next_hop"}},
+      {SAI_OBJECT_TYPE_NEXT_HOP_GROUP,
+       {SAI_API_NEXT_HOP_GROUP, "next_hop_group"}},
+      {SAI_OBJECT_TYPE_NEXT_HOP_GROUP_MEMBER,
+       {SAI_API_NEXT_HOP_GROUP, "next_hop_group_member"}},
+      {SAI_OBJECT_TYPE_PORT, {SAI_API_PORT, "port"}},
+      {SAI_OBJECT_TYPE_PORT_SERDES, {SAI_API_PORT, "port_serdes"}},
+      {SAI_OBJECT_TYPE_QOS_MAP, {SAI_API_QOS_MAP, "qos_map"}},
+      {SAI_OBJECT_TYPE_QUEUE, {SAI_API_QUEUE, "queue"}},
+      {SAI_OBJECT_TYPE_ROUTE_ENTRY, {SAI_API_ROUTE, "route_entry"}},
+      {SAI_OBJECT_TYPE_ROUTER_INTERFACE,
+       {SAI_API_ROUTER_INTERFACE, "router_interface"}},
+      {SAI_OBJECT_TYPE_SAMPLEPACKET, {SAI_API_SAMPLEPACKET, "samplepacket"}},
+      {SAI_OBJECT_TYPE_SCHEDULER, {SAI_API_SCHEDULER, "scheduler"}},
+      {SAI_OBJECT_TYPE_SCHEDULER_GROUP,
+       {SAI_API_SCHEDULER_GROUP, "scheduler_group"}},
+      {SAI_OBJECT_TYPE_SWITCH, {SAI_API_SWITCH, "switch"}},
+      {SAI_OBJECT_TYPE_TAM, {SAI_API_TAM, "tam"}},
+      {SAI_OBJECT_TYPE_TAM_EVENT, {SAI_API_TAM, "tam_event"}},
+      {SAI_OBJECT_TYPE_TAM_EVENT_ACTION, {SAI_API_TAM, "tam_event_action"}},
+      {SAI_OBJECT_TYPE_TAM_REPORT, {SAI_API_TAM, "tam_report"}},
+      {SAI_OBJECT_TYPE_VIRTUAL_ROUTER,
+       {SAI_API_VIRTUAL_ROUTER, "virtual_router"}},
+      {SAI_OBJECT_TYPE_VLAN, {SAI_API_VLAN, "vlan"}},
+      {SAI_OBJECT_TYPE_VLAN_MEMBER, {SAI_API_VLAN, "vlan_member"}},
+  };
+  return kObjectInfos;
+}
+
+const std::map<sai_api_t, string>& apiVarNames() {
+  static const std::map<sai_api_t, string> kApiVarNames{
+      {SAI_API_ACL, "acl_api"},
+      {SAI_API_BRIDGE, "bridge_api"},
+      {SAI_API_BUFFER, "buffer_api"},
+      {SAI_API_FDB, "fdb_api"},
+      {SAI_API_HASH, "hash_api"},
+      {SAI_API_HOSTIF, "hostif_api"},
+      {SAI_API_MIRROR, "mirror_api"},
+      {SAI_API_MPLS, "mpls_api"},
+      {SAI_API_NEIGHBOR, "neighbor_api"},
+      {SAI_API_NEXT_HOP, "next_hop_api"},
+      {SAI_API_NEXT_HOP_GROUP, "next_hop_group_api"},
+      {SAI_API_PORT, "port_api"},
+      {SAI_API_QOS_MAP, "qos_map_api"},
+      {SAI_API_QUEUE, "queue_api"},
+      {SAI_API_ROUTE, "route_api"},
+      {SAI_API_ROUTER_INTERFACE, "router_interface_api"},
+      {SAI_API_SAMPLEPACKET, "samplepacket_api"},
+      {SAI_API_SCHEDULER, "scheduler_api"},
+      {SAI_API_SCHEDULER_GROUP, "scheduler_group_api"},
+      {SAI_API_SWITCH, "switch_api"},
+      {SAI_API_TAM, "tam_api"},
+      {SAI_API_VIRTUAL_ROUTER, "virtual_router_api"},
+      {SAI_API_VLAN, "vlan_api"},
+  };
+  return kApiVarNames;
+}
+
+constexpr auto kObjListOffset = offsetof(sai_attribute_value_t, objlist);
+constexpr auto kS8ListOffset = offsetof(sai_attribute_value_t, s8list);
+constexpr auto kS32ListOffset = offsetof(sai_attribute_value_t, s32list);
+constexpr auto kU32ListOffset = offsetof(sai_attribute_value_t, u32list);
+constexpr auto kQosMapListOffset = offsetof(sai_attribute_value_t, qosmap);
+constexpr auto kAclActionObjListOffset =
+    offsetof(sai_attribute_value_t, aclaction) +
+    offsetof(sai_acl_action_data_t, parameter) +
+    offsetof(sai_acl_action_parameter_t, objlist);
+
+static_assert(
+    offsetof(sai_u32_list_t, count) ==
+            offsetof(facebook::fboss::SaiTraceList, count) &&
+        offsetof(sai_u32_list_t, list) ==
+            offsetof(facebook::fboss::SaiTraceList, list),
+    "SAI list layout does not match SaiTraceList");
+
+} // namespace
+
+namespace facebook::fboss {
+
+std::optional<SaiTraceListDesc> saiTraceListDesc(
+    sai_object_type_t objectType,
+    sai_attr_id_t attrId) {
+  // Keep in sync with the *ListAttr() helpers used by the *ApiTracer files
+  switch (objectType) {
+    case SAI_OBJECT_TYPE_ACL_ENTRY:
+      if (attrId == SAI_ACL_ENTRY_ATTR_ACTION_MIRROR_INGRESS ||
+          attrId == SAI_ACL_ENTRY_ATTR_ACTION_MIRROR_EGRESS) {
+        return SaiTraceListDesc{
+            kAclActionObjListOffset, sizeof(sai_object_id_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_ACL_TABLE:
+      if (attrId == SAI_ACL_TABLE_ATTR_ACL_BIND_POINT_TYPE_LIST ||
+          attrId == SAI_ACL_TABLE_ATTR_ACL_ACTION_TYPE_LIST) {
+        return SaiTraceListDesc{kS32ListOffset, sizeof(int32_t)};
+      }
+      if (attrId == SAI_ACL_TABLE_ATTR_ENTRY_LIST) {
+        return SaiTraceListDesc{kObjListOffset, sizeof(sai_object_id_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_ACL_TABLE_GROUP:
+      if (attrId == SAI_ACL_TABLE_GROUP_ATTR_ACL_BIND_POINT_TYPE_LIST) {
+        return SaiTraceListDesc{kS32ListOffset, sizeof(int32_t)};
+      }
+      if (attrId == SAI_ACL_TABLE_GROUP_ATTR_MEMBER_LIST) {
+        return SaiTraceListDesc{kObjListOffset, sizeof(sai_object_id_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_BRIDGE:
+      if (attrId == SAI_BRIDGE_ATTR_PORT_LIST) {
+        return SaiTraceListDesc{kObjListOffset, sizeof(sai_object_id_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_HASH:
+      if (attrId == SAI_HASH_ATTR_NATIVE_HASH_FIELD_LIST) {
+        return SaiTraceListDesc{kS32ListOffset, sizeof(int32_t)};
+      }
+      if (attrId == SAI_HASH_ATTR_UDF_GROUP_LIST) {
+        return SaiTraceListDesc{kObjListOffset, sizeof(sai_object_id_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_NEXT_HOP:
+      if (attrId == SAI_NEXT_HOP_ATTR_LABELSTACK) {
+        return SaiTraceListDesc{kU32ListOffset, sizeof(uint32_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_NEXT_HOP_GROUP:
+      if (attrId == SAI_NEXT_HOP_GROUP_ATTR_NEXT_HOP_MEMBER_LIST) {
+        return SaiTraceListDesc{kObjListOffset, sizeof(sai_object_id_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_PORT:
+      if (attrId == SAI_PORT_ATTR_HW_LANE_LIST ||
+          attrId == SAI_PORT_ATTR_SERDES_PREEMPHASIS) {
+        return SaiTraceListDesc{kU32ListOffset, sizeof(uint32_t)};
+      }
+      if (attrId == SAI_PORT_ATTR_QOS_QUEUE_LIST) {
+        return SaiTraceListDesc{kObjListOffset, sizeof(sai_object_id_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_PORT_SERDES:
+      switch (attrId) {
+        case SAI_PORT_SERDES_ATTR_IDRIVER:
+        case SAI_PORT_SERDES_ATTR_TX_FIR_PRE1:
+        case SAI_PORT_SERDES_ATTR_TX_FIR_PRE2:
+        case SAI_PORT_SERDES_ATTR_TX_FIR_MAIN:
+        case SAI_PORT_SERDES_ATTR_TX_FIR_POST1:
+        case SAI_PORT_SERDES_ATTR_TX_FIR_POST2:
+        case SAI_PORT_SERDES_ATTR_TX_FIR_POST3:
+          return SaiTraceListDesc{kU32ListOffset, sizeof(uint32_t)};
+        default:
+          break;
+      }
+      break;
+    case SAI_OBJECT_TYPE_QOS_MAP:
+      if (attrId == SAI_QOS_MAP_ATTR_MAP_TO_VALUE_LIST) {
+        return SaiTraceListDesc{kQosMapListOffset, sizeof(sai_qos_map_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_SWITCH:
+      if (attrId == SAI_SWITCH_ATTR_PORT_LIST ||
+          attrId == SAI_SWITCH_ATTR_TAM_OBJECT_ID) {
+        return SaiTraceListDesc{kObjListOffset, sizeof(sai_object_id_t)};
+      }
+      if (attrId == SAI_SWITCH_ATTR_SWITCH_HARDWARE_INFO) {
+        return SaiTraceListDesc{kS8ListOffset, sizeof(int8_t)};
+      }
+      break;
+    case SAI_OBJECT_TYPE_VLAN:
+      if (attrId == SAI_VLAN_ATTR_MEMBER_LIST) {
+        return SaiTraceListDesc{kObjListOffset, sizeof(sai_object_id_t)};
+      }
+      break;
+    default:
+      break;
+  }
+  return std::nullopt;
+}
+
+sai_api_t saiTraceObjectApi(sai_object_type_t objectType) {
+  auto info = folly::get_ptr(objectInfos(), objectType);
+  return info ? info->api : SAI_API_UNSPECIFIED;
+}
+
+string saiTraceApiVarName(sai_api_t api) {
+  return folly::get_default(apiVarNames(), api, to<string>("api_", api));
+}
+
+string saiTraceFnName(SaiTraceOp op, sai_object_type_t objectType) {
+  auto info = folly::get_ptr(objectInfos(), objectType);
+  if (!info) {
+    throw FbossError("Unsupported object type in sai trace: ", objectType);
+  }
+  switch (op) {
+    case SaiTraceOp::CREATE:
+      return to<string>("create_", info->name);
+    case SaiTraceOp::REMOVE:
+      return to<string>("remove_", info->name);
+    case SaiTraceOp::SET:
+      return to<string>("set_", info->name, "_attribute");
+    case SaiTraceOp::SEND_PACKET:
+      return "send_hostif_packet";
+    case SaiTraceOp::API_INITIALIZE:
+    case SaiTraceOp::API_QUERY:
+      break;
+  }
+  throw FbossError("No function name for sai trace op ", static_cast<int>(op));
+}
+
+SaiTraceReader::SaiTraceReader(const string& filePath) {
+  if (!folly::readFile(filePath.c_str(), buffer_)) {
+    throw FbossError("Unable to read sai trace ", filePath);
+  }
+  SaiTraceFileHeader fileHeader;
+  if (buffer_.size() < sizeof(fileHeader)) {
+    throw FbossError("Truncated sai trace header in ", filePath);
+  }
+  std::memcpy(&fileHeader, buffer_.data(), sizeof(fileHeader));
+  if (std::memcmp(fileHeader.magic, kSaiTraceMagic, sizeof(kSaiTraceMagic)) ||
+      fileHeader.version != kSaiTraceVersion) {
+    throw FbossError(
+        filePath, " is not a version ", kSaiTraceVersion, " sai trace");
+  }
+  if (fileHeader.attrValueSize != sizeof(sai_attribute_value_t)) {
+    throw FbossError(
+        "Sai trace ",
+        filePath,
+        " was written with a different SAI version, attribute value size ",
+        fileHeader.attrValueSize,
+        " vs ",
+        sizeof(sai_attribute_value_t));
+  }
+  offset_ = sizeof(fileHeader);
+}
+
+bool SaiTraceReader::next(SaiTraceRecord& record) {
+  if (offset_ + sizeof(SaiTraceRecordHeader) > buffer_.size()) {
+    // A trailing partial header means the writer was killed mid-flush
+    return false;
+  }
+  auto base = reinterpret_cast<const uint8_t*>(buffer_.data()) + offset_;
+  std::memcpy(&record.header, base, sizeof(record.header));
+  if (record.header.size < sizeof(record.header) ||
+      offset_ + record.header.size > buffer_.size()) {
+    return false;
+  }
+
+  auto objectType = static_cast<sai_object_type_t>(record.header.objectType);
+  auto attrBase = base + sizeof(record.header);
+  auto listData = attrBase + record.header.attrCount * sizeof(SaiTraceAttr);
+  record.attrs.resize(record.header.attrCount);
+  for (auto i = 0; i < record.header.attrCount; ++i) {
+    SaiTraceAttr traceAttr;
+    std::memcpy(
+        &traceAttr, attrBase + i * sizeof(traceAttr), sizeof(traceAttr));
+    record.attrs[i].id = traceAttr.id;
+    record.attrs[i].value = traceAttr.value;
+    if (auto desc = saiTraceListDesc(objectType, traceAttr.id)) {
+      auto list = reinterpret_cast<SaiTraceList*>(
+          reinterpret_cast<uint8_t*>(&record.attrs[i].value) + desc->offset);
+      // SAI treats list payloads of attributes as read only
+      list->list =
+          traceAttr.listBytes ? const_cast<uint8_t*>(listData) : nullptr;
+    }
+    listData += traceAttr.listBytes;
+  }
+  record.payload = listData;
+  record.payloadSize = record.header.payloadSize;
+
+  offset_ += record.header.size;
+  return true;
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <sai.h>
+}
+
+namespace facebook::fboss {
+
+/*
+ * Binary SAI trace format.
+ *
+ * A trace file starts with a SaiTraceFileHeader followed by a sequence of
+ * records. Every record is laid out as
+ *
+ *   SaiTraceRecordHeader
+ *   SaiTraceAttr[attrCount]
+ *   list data of every attribute, in attribute order (attr.listBytes each)
+ *   payload (entry key, hostif packet or profile key/values)
+ *   padding up to a multiple of kSaiTraceAlignment
+ *
+ * Attribute values are stored as raw sai_attribute_value_t. For attributes
+ * that carry out-of-line lists (see saiTraceListDesc), the list pointer
+ * inside the value is meaningless and is re-pointed at the list data by the
+ * reader.
+ */
+constexpr char kSaiTraceMagic[8] = {'S', 'A', 'I', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t kSaiTraceVersion = 1;
+constexpr size_t kSaiTraceAlignment = 8;
+
+enum class SaiTraceOp : uint16_t {
+  API_INITIALIZE = 0,
+  API_QUERY = 1,
+  CREATE = 2,
+  REMOVE = 3,
+  SET = 4,
+  SEND_PACKET = 5,
+};
+
+struct SaiTraceFileHeader {
+  char magic[8];
+  uint32_t version;
+  // Traces can only be read by a binary built against the same SAI headers
+  uint32_t attrValueSize;
+};
+
+struct SaiTraceRecordHeader {
+  // Total record size, including this header and trailing padding
+  uint32_t size;
+  uint16_t op;
+  uint16_t attrCount;
+  int32_t api;
+  int32_t objectType;
+  int32_t rv;
+  uint32_t payloadSize;
+  uint64_t timestampUs;
+  uint64_t oid;
+  uint64_t switchId;
+};
+
+struct SaiTraceAttr {
+  sai_attr_id_t id;
+  uint32_t listBytes;
+  sai_attribute_value_t value;
+};
+
+// Every sai_*_list_t shares this layout
+struct SaiTraceList {
+  uint32_t count;
+  void* list;
+};
+
+// Location and element size of the list embedded in an attribute value
+struct SaiTraceListDesc {
+  size_t offset;
+  size_t elemSize;
+};
+
+std::optional<SaiTraceListDesc> saiTraceListDesc(
+    sai_object_type_t objectType,
+    sai_attr_id_t attrId);
+
+sai_api_t saiTraceObjectApi(sai_object_type_t objectType);
+
+// Variable name used by the C trace for an api, e.g. "route_api"
+std::string saiTraceApiVarName(sai_api_t api);
+
+// Function name of the api call, e.g. "create_next_hop_group_member"
+std::string saiTraceFnName(SaiTraceOp op, sai_object_type_t objectType);
+
+// Decoded record. Attributes and payload point into the reader's buffer.
+struct SaiTraceRecord {
+  SaiTraceRecordHeader header;
+  std::vector<sai_attribute_t> attrs;
+  const uint8_t* payload{nullptr};
+  size_t payloadSize{0};
+};
+
+class SaiTraceReader {
+ public:
+  explicit SaiTraceReader(const std::string& filePath);
+
+  // Decode the next record, returns false at end of trace
+  bool next(SaiTraceRecord& record);
+
+ private:
+  std::string buffer_;
+  size_t offset_{0};
+};
+
+} // namespace facebook::fboss
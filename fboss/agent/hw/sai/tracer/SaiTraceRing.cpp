@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/sai/tracer/SaiTraceRing.h"
+
+#include <folly/Bits.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace facebook::fboss {
+
+SaiTraceRing::SaiTraceRing(size_t numSlots)
+    : capacity_(folly::nextPowTwo(std::max<size_t>(numSlots, 2))),
+      mask_(capacity_ - 1),
+      slots_(new Slot[capacity_]) {
+  for (uint64_t i = 0; i < capacity_; ++i) {
+    slots_[i].seq.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool SaiTraceRing::tryWrite(const uint8_t* data, size_t size) {
+  uint64_t numSlots = (size + kSlotSize - 1) / kSlotSize;
+  if (numSlots == 0 || numSlots > capacity_) {
+    droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  auto pos = tail_.load(std::memory_order_relaxed);
+  while (true) {
+    // The consumer releases slots in order, so the last slot of the range
+    // being free for this lap implies all the slots before it are free too.
+    auto lastPos = pos + numSlots - 1;
+    auto seq = slots_[lastPos & mask_].seq.load(std::memory_order_acquire);
+    if (seq == lastPos) {
+      if (tail_.compare_exchange_weak(
+              pos, pos + numSlots, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (seq < lastPos) {
+      droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+
+  for (uint64_t i = 0; i < numSlots; ++i) {
+    auto offset = i * kSlotSize;
+    std::memcpy(
+        slots_[(pos + i) & mask_].data,
+        data + offset,
+        std::min(kSlotSize, size - offset));
+  }
+  // Publish back to front, see class comment
+  for (auto i = numSlots; i-- > 0;) {
+    slots_[(pos + i) & mask_].seq.store(pos + i + 1, std::memory_order_release);
+  }
+  return true;
+}
+
+bool SaiTraceRing::tryRead(std::vector<uint8_t>& out) {
+  auto& first = slots_[head_ & mask_];
+  if (first.seq.load(std::memory_order_acquire) != head_ + 1) {
+    return false;
+  }
+  uint32_t size;
+  std::memcpy(&size, first.data, sizeof(size));
+  uint64_t numSlots = (size + kSlotSize - 1) / kSlotSize;
+
+  for (uint64_t i = 0; i < numSlots; ++i) {
+    auto& slot = slots_[(head_ + i) & mask_];
+    auto offset = i * kSlotSize;
+    auto chunk = std::min<size_t>(kSlotSize, size - offset);
+    out.insert(out.end(), slot.data, slot.data + chunk);
+    slot.seq.store(head_ + i + capacity_, std::memory_order_release);
+  }
+  head_ += numSlots;
+  return true;
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace facebook::fboss {
+
+/*
+ * Bounded multi-producer, single-consumer ring of fixed size slots.
+ *
+ * A record occupies one or more consecutive slots. Producers reserve the
+ * whole range with a single CAS on the tail, copy the record in, then
+ * publish the slots back to front, so the consumer only has to check the
+ * first slot of a record to know the whole record is visible.
+ * Each record must start with its uint32_t length in bytes.
+ *
+ * Writers never block: if the ring is full the record is dropped and
+ * accounted in droppedRecords().
+ */
+class SaiTraceRing {
+ public:
+  static constexpr size_t kSlotSize = 256;
+
+  // numSlots is rounded up to a power of 2
+  explicit SaiTraceRing(size_t numSlots);
+
+  bool tryWrite(const uint8_t* data, size_t size);
+
+  // Consumer side, appends the next record to out. Only one thread may read.
+  bool tryRead(std::vector<uint8_t>& out);
+
+  uint64_t droppedRecords() const {
+    return droppedRecords_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> seq;
+    uint8_t data[kSlotSize];
+  };
+
+  const uint64_t capacity_;
+  const uint64_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  alignas(64) uint64_t head_{0};
+  std::atomic<uint64_t> droppedRecords_{0};
+};
+
+} // namespace facebook::fboss
@@ -75,6 +75,23 @@ DEFINE_int32(
     6,
     "Default number of the lists initialzied by SAI replayer");
 
+DEFINE_bool(
+    enable_binary_sai_trace,
+    false,
+    "Record SAI calls as compact binary records instead of generated C code. "
+    "Use sai_trace_replayer to replay the trace or convert it to C code");
+
+DEFINE_string(
+    sai_binary_log,
+    "/var/facebook/logs/fboss/sai_replayer.bin",
+    "File path to the binary SAI trace");
+
+DEFINE_int32(
+    sai_binary_log_ring_slots,
+    65536,
+    "Number of 256 byte slots buffering binary SAI trace records before "
+    "they are flushed. Records are dropped when the buffer is full");
+
 DEFINE_int32(
     log_timeout,
     100,
@@ -293,7 +310,12 @@ inline void printHex(std::ostringstream& outStringStream, uint8_t u8) {
 namespace facebook::fboss {
 
 SaiTracer::SaiTracer() {
-  if (FLAGS_enable_replayer) {
+  if (FLAGS_enable_replayer && FLAGS_enable_binary_sai_trace) {
+    binaryTracer_ = std::make_unique<SaiBinaryTracer>(
+        FLAGS_sai_binary_log,
+        FLAGS_sai_binary_log_ring_slots,
+        std::chrono::milliseconds(FLAGS_log_timeout));
+  } else if (FLAGS_enable_replayer) {
     asyncLogger_ =
         std::make_unique<AsyncLogger>(FLAGS_sai_log, FLAGS_log_timeout);
 
@@ -306,7 +328,10 @@ SaiTracer::SaiTracer() {
 }
 
 SaiTracer::~SaiTracer() {
-  if (FLAGS_enable_replayer) {
+  if (binaryTracer_) {
+    // Drains the ring and closes the trace
+    binaryTracer_.reset();
+  } else if (FLAGS_enable_replayer) {
     writeFooter();
     asyncLogger_->forceFlush();
     asyncLogger_->stopFlushThread();
@@ -332,6 +357,11 @@ void SaiTracer::logApiInitialize(
     const char** variables,
     const char** values,
     int size) {
+  if (binaryTracer_) {
+    binaryTracer_->logApiInitialize(variables, values, size);
+    return;
+  }
+
   vector<string> lines;
 
   for (int i = 0; i < size; ++i) {
@@ -367,6 +397,11 @@ void SaiTracer::logApiQuery(sai_api_t api_id, const std::string& api_var) {
 
   init_api_.emplace(api_id, api_var);
 
+  if (binaryTracer_) {
+    binaryTracer_->logApiQuery(api_id);
+    return;
+  }
+
   writeToFile(
       {to<string>("sai_", api_var, "_t* ", api_var),
        to<string>(
@@ -382,6 +417,17 @@ void SaiTracer::logSwitchCreateFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logCreate(
+        SAI_OBJECT_TYPE_SWITCH,
+        *switch_id,
+        *switch_id,
+        attr_count,
+        attr_list,
+        rv);
+    return;
+  }
+
   // First fill in attribute list
   vector<string> lines =
       setAttrList(attr_list, attr_count, SAI_OBJECT_TYPE_SWITCH);
@@ -424,6 +470,17 @@ void SaiTracer::logRouteEntryCreateFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::CREATE,
+        SAI_OBJECT_TYPE_ROUTE_ENTRY,
+        route_entry,
+        attr_count,
+        attr_list,
+        rv);
+    return;
+  }
+
   // First fill in attribute list
   vector<string> lines =
       setAttrList(attr_list, attr_count, SAI_OBJECT_TYPE_ROUTE_ENTRY);
@@ -460,6 +517,17 @@ void SaiTracer::logNeighborEntryCreateFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::CREATE,
+        SAI_OBJECT_TYPE_NEIGHBOR_ENTRY,
+        neighbor_entry,
+        attr_count,
+        attr_list,
+        rv);
+    return;
+  }
+
   // First fill in attribute list
   vector<string> lines =
       setAttrList(attr_list, attr_count, SAI_OBJECT_TYPE_NEIGHBOR_ENTRY);
@@ -496,6 +564,17 @@ void SaiTracer::logFdbEntryCreateFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::CREATE,
+        SAI_OBJECT_TYPE_FDB_ENTRY,
+        fdb_entry,
+        attr_count,
+        attr_list,
+        rv);
+    return;
+  }
+
   // First fill in attribute list
   vector<string> lines =
       setAttrList(attr_list, attr_count, SAI_OBJECT_TYPE_FDB_ENTRY);
@@ -532,6 +611,17 @@ void SaiTracer::logInsegEntryCreateFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::CREATE,
+        SAI_OBJECT_TYPE_INSEG_ENTRY,
+        inseg_entry,
+        attr_count,
+        attr_list,
+        rv);
+    return;
+  }
+
   // First fill in attribute list
   vector<string> lines =
       setAttrList(attr_list, attr_count, SAI_OBJECT_TYPE_INSEG_ENTRY);
@@ -571,6 +661,17 @@ void SaiTracer::logCreateFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logCreate(
+        object_type,
+        *create_object_id,
+        switch_id,
+        attr_count,
+        attr_list,
+        rv);
+    return;
+  }
+
   // First fill in attribute list
   vector<string> lines = setAttrList(attr_list, attr_count, object_type);
 
@@ -600,6 +701,17 @@ void SaiTracer::logRouteEntryRemoveFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::REMOVE,
+        SAI_OBJECT_TYPE_ROUTE_ENTRY,
+        route_entry,
+        0,
+        nullptr,
+        rv);
+    return;
+  }
+
   vector<string> lines{};
   setRouteEntry(route_entry, lines);
 
@@ -627,6 +739,17 @@ void SaiTracer::logNeighborEntryRemoveFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::REMOVE,
+        SAI_OBJECT_TYPE_NEIGHBOR_ENTRY,
+        neighbor_entry,
+        0,
+        nullptr,
+        rv);
+    return;
+  }
+
   vector<string> lines{};
   setNeighborEntry(neighbor_entry, lines);
 
@@ -654,6 +777,17 @@ void SaiTracer::logFdbEntryRemoveFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::REMOVE,
+        SAI_OBJECT_TYPE_FDB_ENTRY,
+        fdb_entry,
+        0,
+        nullptr,
+        rv);
+    return;
+  }
+
   vector<string> lines{};
   setFdbEntry(fdb_entry, lines);
 
@@ -681,6 +815,17 @@ void SaiTracer::logInsegEntryRemoveFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::REMOVE,
+        SAI_OBJECT_TYPE_INSEG_ENTRY,
+        inseg_entry,
+        0,
+        nullptr,
+        rv);
+    return;
+  }
+
   vector<string> lines{};
   setInsegEntry(inseg_entry, lines);
 
@@ -710,6 +855,11 @@ void SaiTracer::logRemoveFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logRemove(object_type, remove_object_id, rv);
+    return;
+  }
+
   vector<string> lines{};
 
   // Log current timestamp, object id and return value
@@ -742,6 +892,12 @@ void SaiTracer::logRouteEntrySetAttrFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::SET, SAI_OBJECT_TYPE_ROUTE_ENTRY, route_entry, 1, attr, rv);
+    return;
+  }
+
   // Setup one attribute
   vector<string> lines = setAttrList(attr, 1, SAI_OBJECT_TYPE_ROUTE_ENTRY);
 
@@ -773,6 +929,17 @@ void SaiTracer::logNeighborEntrySetAttrFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::SET,
+        SAI_OBJECT_TYPE_NEIGHBOR_ENTRY,
+        neighbor_entry,
+        1,
+        attr,
+        rv);
+    return;
+  }
+
   // Setup one attribute
   vector<string> lines = setAttrList(attr, 1, SAI_OBJECT_TYPE_NEIGHBOR_ENTRY);
 
@@ -804,6 +971,12 @@ void SaiTracer::logFdbEntrySetAttrFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::SET, SAI_OBJECT_TYPE_FDB_ENTRY, fdb_entry, 1, attr, rv);
+    return;
+  }
+
   // Setup one attribute
   vector<string> lines = setAttrList(attr, 1, SAI_OBJECT_TYPE_FDB_ENTRY);
 
@@ -835,6 +1008,12 @@ void SaiTracer::logInsegEntrySetAttrFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logEntryOp(
+        SaiTraceOp::SET, SAI_OBJECT_TYPE_INSEG_ENTRY, inseg_entry, 1, attr, rv);
+    return;
+  }
+
   // Setup one attribute
   vector<string> lines = setAttrList(attr, 1, SAI_OBJECT_TYPE_INSEG_ENTRY);
 
@@ -868,6 +1047,11 @@ void SaiTracer::logSetAttrFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logSetAttr(object_type, set_object_id, attr, rv);
+    return;
+  }
+
   // Setup one attribute
   vector<string> lines = setAttrList(attr, 1, object_type);
 
@@ -901,6 +1085,12 @@ void SaiTracer::logSendHostifPacketFn(
     return;
   }
 
+  if (binaryTracer_) {
+    binaryTracer_->logSendHostifPacket(
+        hostif_id, buffer_size, buffer, attr_count, attr_list, rv);
+    return;
+  }
+
   vector<string> lines =
       setAttrList(attr_list, attr_count, SAI_OBJECT_TYPE_HOSTIF_PACKET);
 
@@ -14,6 +14,7 @@
 #include <tuple>
 
 #include "fboss/agent/AsyncLogger.h"
+#include "fboss/agent/hw/sai/tracer/SaiBinaryTracer.h"
 
 #include <folly/File.h>
 #include <folly/String.h>
@@ -26,6 +27,7 @@ extern "C" {
 
 DECLARE_bool(enable_replayer);
 DECLARE_bool(enable_packet_log);
+DECLARE_bool(enable_binary_sai_trace);
 
 namespace facebook::fboss {
 
@@ -218,6 +220,8 @@ class SaiTracer {
   uint32_t maxListCount_;
   uint32_t numCalls_;
   std::unique_ptr<AsyncLogger> asyncLogger_;
+  // Set instead of asyncLogger_ when FLAGS_enable_binary_sai_trace is on
+  std::unique_ptr<SaiBinaryTracer> binaryTracer_;
 
   // Variables mappings in generated C code
   // varCounts map from object type to the current counter
@@ -0,0 +1,623 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+/*
+ * Offline tool for binary SAI traces written with --enable_binary_sai_trace.
+ *
+ * --sai_trace_to_c=<file> converts the trace to the same C code SaiTracer
+ * generates in text mode, which can then be built into sai_replayer.
+ * Without it, the trace is replayed directly against the SAI implementation
+ * this binary is linked with (e.g. fake SAI). Object ids handed out during
+ * replay differ from the recorded ones, so ids are remapped for the object
+ * acted upon, entry keys, and attributes whose SAI metadata says they hold
+ * object ids. SAI implementations built without the metadata library only
+ * get recorded object lists remapped, which is enough for implementations
+ * that hand out ids deterministically, like fake SAI.
+ */
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/hw/sai/tracer/SaiTraceRecord.h"
+#include "fboss/agent/hw/sai/tracer/SaiTracer.h"
+
+#include <folly/MapUtil.h>
+#include <folly/init/Init.h>
+#include <folly/logging/xlog.h>
+
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+extern "C" {
+#include <sai.h>
+#include <saimetadatautils.h>
+}
+
+// Not every SAI implementation links in the SAI metadata library
+#pragma weak sai_metadata_get_attr_metadata
+
+DECLARE_string(sai_log);
+
+DEFINE_string(sai_trace, "", "Binary SAI trace to replay or convert");
+
+DEFINE_string(
+    sai_trace_to_c,
+    "",
+    "If set, convert the binary trace to generated C code at this path "
+    "instead of replaying it");
+
+using facebook::fboss::FbossError;
+using facebook::fboss::SaiTraceOp;
+using facebook::fboss::SaiTraceReader;
+using facebook::fboss::SaiTraceRecord;
+using facebook::fboss::SaiTracer;
+
+namespace {
+
+std::unordered_map<std::string, std::string> kSaiProfileValues;
+
+const char* saiProfileGetValue(
+    sai_switch_profile_id_t /*profile_id*/,
+    const char* variable) {
+  auto itr = kSaiProfileValues.find(variable);
+  return itr != kSaiProfileValues.end() ? itr->second.c_str() : nullptr;
+}
+
+int saiProfileGetNextValue(
+    sai_switch_profile_id_t /* profile_id */,
+    const char** variable,
+    const char** value) {
+  static auto itr = kSaiProfileValues.begin();
+  if (!value) {
+    itr = kSaiProfileValues.begin();
+    return 0;
+  }
+  if (itr == kSaiProfileValues.end()) {
+    return -1;
+  }
+  *variable = itr->first.c_str();
+  *value = itr->second.c_str();
+  ++itr;
+  return 0;
+}
+
+sai_service_method_table_t kSaiServiceMethodTable = {
+    .profile_get_value = saiProfileGetValue,
+    .profile_get_next_value = saiProfileGetNextValue,
+};
+
+std::vector<std::pair<std::string, std::string>> profileValues(
+    const SaiTraceRecord& record) {
+  std::vector<std::pair<std::string, std::string>> kvs;
+  auto cur = reinterpret_cast<const char*>(record.payload);
+  auto end = cur + record.payloadSize;
+  while (cur < end) {
+    std::string key(cur);
+    cur += key.size() + 1;
+    std::string value(cur);
+    cur += value.size() + 1;
+    kvs.emplace_back(std::move(key), std::move(value));
+  }
+  return kvs;
+}
+
+template <typename EntryT>
+EntryT entryKey(const SaiTraceRecord& record) {
+  if (record.payloadSize < sizeof(EntryT)) {
+    throw FbossError("Truncated entry key in sai trace");
+  }
+  EntryT entry;
+  std::memcpy(&entry, record.payload, sizeof(entry));
+  return entry;
+}
+
+using CreateFn = sai_status_t (*)(
+    sai_object_id_t*,
+    sai_object_id_t,
+    uint32_t,
+    const sai_attribute_t*);
+using RemoveFn = sai_status_t (*)(sai_object_id_t);
+using SetFn = sai_status_t (*)(sai_object_id_t, const sai_attribute_t*);
+
+struct ObjectFns {
+  CreateFn create;
+  RemoveFn remove;
+  SetFn set;
+};
+
+class TraceReplayer {
+ public:
+  void replay(SaiTraceReader& reader) {
+    SaiTraceRecord record;
+    uint64_t count = 0;
+    uint64_t mismatches = 0;
+    auto begin = std::chrono::steady_clock::now();
+    while (reader.next(record)) {
+      auto rv = replayOne(record);
+      if (rv != record.header.rv) {
+        XLOG(WARN) << "Record " << count << " returned " << rv
+                   << ", trace recorded " << record.header.rv;
+        ++mismatches;
+      }
+      ++count;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - begin);
+    XLOG(INFO) << "Replayed " << count << " sai calls in " << elapsed.count()
+               << "ms, " << mismatches << " return value mismatches";
+  }
+
+ private:
+  sai_status_t replayOne(SaiTraceRecord& record) {
+    auto op = static_cast<SaiTraceOp>(record.header.op);
+    auto objectType = static_cast<sai_object_type_t>(record.header.objectType);
+    switch (op) {
+      case SaiTraceOp::API_INITIALIZE:
+        for (auto& [key, value] : profileValues(record)) {
+          kSaiProfileValues.emplace(key, value);
+        }
+        return sai_api_initialize(0, &kSaiServiceMethodTable);
+      case SaiTraceOp::API_QUERY: {
+        void* api;
+        auto rv =
+            sai_api_query(static_cast<sai_api_t>(record.header.api), &api);
+        apis_[static_cast<sai_api_t>(record.header.api)] = api;
+        return rv;
+      }
+      case SaiTraceOp::CREATE:
+      case SaiTraceOp::REMOVE:
+      case SaiTraceOp::SET:
+        remapAttrs(record);
+        switch (objectType) {
+          case SAI_OBJECT_TYPE_ROUTE_ENTRY:
+            return entryOp<sai_route_api_t, sai_route_entry_t>(
+                op, record, SAI_API_ROUTE);
+          case SAI_OBJECT_TYPE_NEIGHBOR_ENTRY:
+            return entryOp<sai_neighbor_api_t, sai_neighbor_entry_t>(
+                op, record, SAI_API_NEIGHBOR);
+          case SAI_OBJECT_TYPE_FDB_ENTRY:
+            return entryOp<sai_fdb_api_t, sai_fdb_entry_t>(
+                op, record, SAI_API_FDB);
+          case SAI_OBJECT_TYPE_INSEG_ENTRY:
+            return entryOp<sai_mpls_api_t, sai_inseg_entry_t>(
+                op, record, SAI_API_MPLS);
+          default:
+            return objectOp(op, objectType, record);
+        }
+      case SaiTraceOp::SEND_PACKET: {
+        remapAttrs(record);
+        auto api = apiTable<sai_hostif_api_t>(SAI_API_HOSTIF);
+        return api->send_hostif_packet(
+            remap(record.header.oid),
+            record.payloadSize,
+            record.payload,
+            record.attrs.size(),
+            record.attrs.data());
+      }
+    }
+    throw FbossError("Unknown sai trace op ", record.header.op);
+  }
+
+  sai_status_t objectOp(
+      SaiTraceOp op,
+      sai_object_type_t objectType,
+      const SaiTraceRecord& record) {
+    if (objectType == SAI_OBJECT_TYPE_SWITCH && op == SaiTraceOp::CREATE) {
+      sai_object_id_t switchId;
+      auto rv = apiTable<sai_switch_api_t>(SAI_API_SWITCH)
+                    ->create_switch(
+                        &switchId, record.attrs.size(), record.attrs.data());
+      oids_[record.header.oid] = switchId;
+      return rv;
+    }
+    auto fns = objectFns(objectType);
+    switch (op) {
+      case SaiTraceOp::CREATE: {
+        sai_object_id_t oid;
+        auto rv = fns.create(
+            &oid,
+            remap(record.header.switchId),
+            record.attrs.size(),
+            record.attrs.data());
+        oids_[record.header.oid] = oid;
+        return rv;
+      }
+      case SaiTraceOp::REMOVE: {
+        auto rv = fns.remove(remap(record.header.oid));
+        oids_.erase(record.header.oid);
+        return rv;
+      }
+      case SaiTraceOp::SET:
+        return fns.set(remap(record.header.oid), record.attrs.data());
+      default:
+        throw FbossError("Unexpected object op ", static_cast<int>(op));
+    }
+  }
+
+  template <typename ApiT, typename EntryT>
+  sai_status_t
+  entryOp(SaiTraceOp op, const SaiTraceRecord& record, sai_api_t apiId) {
+    auto entry = entryKey<EntryT>(record);
+    remapEntry(entry);
+    auto api = apiTable<ApiT>(apiId);
+    if constexpr (std::is_same_v<EntryT, sai_route_entry_t>) {
+      return entryCall(
+          op,
+          record,
+          &entry,
+          api->create_route_entry,
+          api->remove_route_entry,
+          api->set_route_entry_attribute);
+    } else if constexpr (std::is_same_v<EntryT, sai_neighbor_entry_t>) {
+      return entryCall(
+          op,
+          record,
+          &entry,
+          api->create_neighbor_entry,
+          api->remove_neighbor_entry,
+          api->set_neighbor_entry_attribute);
+    } else if constexpr (std::is_same_v<EntryT, sai_fdb_entry_t>) {
+      return entryCall(
+          op,
+          record,
+          &entry,
+          api->create_fdb_entry,
+          api->remove_fdb_entry,
+          api->set_fdb_entry_attribute);
+    } else {
+      return entryCall(
+          op,
+          record,
+          &entry,
+          api->create_inseg_entry,
+          api->remove_inseg_entry,
+          api->set_inseg_entry_attribute);
+    }
+  }
+
+  template <typename EntryT, typename Create, typename Remove, typename Set>
+  sai_status_t entryCall(
+      SaiTraceOp op,
+      const SaiTraceRecord& record,
+      const EntryT* entry,
+      Create create,
+      Remove remove,
+      Set set) {
+    switch (op) {
+      case SaiTraceOp::CREATE:
+        return create(entry, record.attrs.size(), record.attrs.data());
+      case SaiTraceOp::REMOVE:
+        return remove(entry);
+      default:
+        return set(entry, record.attrs.data());
+    }
+  }
+
+  void remapEntry(sai_route_entry_t& entry) {
+    entry.switch_id = remap(entry.switch_id);
+    entry.vr_id = remap(entry.vr_id);
+  }
+  void remapEntry(sai_neighbor_entry_t& entry) {
+    entry.switch_id = remap(entry.switch_id);
+    entry.rif_id = remap(entry.rif_id);
+  }
+  void remapEntry(sai_fdb_entry_t& entry) {
+    entry.switch_id = remap(entry.switch_id);
+    entry.bv_id = remap(entry.bv_id);
+  }
+  void remapEntry(sai_inseg_entry_t& entry) {
+    entry.switch_id = remap(entry.switch_id);
+  }
+
+  void remapAttrs(SaiTraceRecord& record) {
+    auto objectType = static_cast<sai_object_type_t>(record.header.objectType);
+    for (auto& attr : record.attrs) {
+      // Lists only point at valid data if the trace recorded them
+      auto desc = facebook::fboss::saiTraceListDesc(objectType, attr.id);
+      const sai_attr_metadata_t* meta = sai_metadata_get_attr_metadata
+          ? sai_metadata_get_attr_metadata(objectType, attr.id)
+          : nullptr;
+      if (!meta) {
+        // All the recorded lists of 8 byte elements are object lists
+        if (desc && desc->elemSize == sizeof(sai_object_id_t)) {
+          remapList(*reinterpret_cast<sai_object_list_t*>(
+              reinterpret_cast<uint8_t*>(&attr.value) + desc->offset));
+        }
+        continue;
+      }
+      switch (meta->attrvaluetype) {
+        case SAI_ATTR_VALUE_TYPE_OBJECT_ID:
+          attr.value.oid = remap(attr.value.oid);
+          break;
+        case SAI_ATTR_VALUE_TYPE_OBJECT_LIST:
+          if (desc) {
+            remapList(attr.value.objlist);
+          }
+          break;
+        case SAI_ATTR_VALUE_TYPE_ACL_FIELD_DATA_OBJECT_ID:
+          attr.value.aclfield.data.oid = remap(attr.value.aclfield.data.oid);
+          break;
+        case SAI_ATTR_VALUE_TYPE_ACL_ACTION_DATA_OBJECT_ID:
+          attr.value.aclaction.parameter.oid =
+              remap(attr.value.aclaction.parameter.oid);
+          break;
+        case SAI_ATTR_VALUE_TYPE_ACL_ACTION_DATA_OBJECT_LIST:
+          if (desc) {
+            remapList(attr.value.aclaction.parameter.objlist);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  void remapList(sai_object_list_t& list) {
+    for (uint32_t i = 0; list.list && i < list.count; ++i) {
+      list.list[i] = remap(list.list[i]);
+    }
+  }
+
+  sai_object_id_t remap(sai_object_id_t oid) const {
+    return folly::get_default(oids_, oid, oid);
+  }
+
+  template <typename ApiT>
+  ApiT* apiTable(sai_api_t api) {
+    auto itr = apis_.find(api);
+    if (itr != apis_.end()) {
+      return static_cast<ApiT*>(itr->second);
+    }
+    void* table = nullptr;
+    sai_api_query(api, &table);
+    apis_[api] = table;
+    return static_cast<ApiT*>(table);
+  }
+
+#define SAI_TRACE_OBJECT_FNS(OBJECT, API, ApiT, name)        \
+  case SAI_OBJECT_TYPE_##OBJECT: {                           \
+    auto api = apiTable<ApiT>(SAI_API_##API);                \
+    return {                                                 \
+        api->create_##name,                                  \
+        api->remove_##name,                                  \
+        api->set_##name##_attribute};                        \
+  }
+
+  ObjectFns objectFns(sai_object_type_t objectType) {
+    switch (objectType) {
+      SAI_TRACE_OBJECT_FNS(ACL_ENTRY, ACL, sai_acl_api_t, acl_entry)
+      SAI_TRACE_OBJECT_FNS(ACL_TABLE, ACL, sai_acl_api_t, acl_table)
+      SAI_TRACE_OBJECT_FNS(
+          ACL_TABLE_GROUP, ACL, sai_acl_api_t, acl_table_group)
+      SAI_TRACE_OBJECT_FNS(
+          ACL_TABLE_GROUP_MEMBER, ACL, sai_acl_api_t, acl_table_group_member)
+      SAI_TRACE_OBJECT_FNS(BRIDGE, BRIDGE, sai_bridge_api_t, bridge)
+      SAI_TRACE_OBJECT_FNS(BRIDGE_PORT, BRIDGE, sai_bridge_api_t, bridge_port)
+      SAI_TRACE_OBJECT_FNS(BUFFER_POOL, BUFFER, sai_buffer_api_t, buffer_pool)
+      SAI_TRACE_OBJECT_FNS(
+          BUFFER_PROFILE, BUFFER, sai_buffer_api_t, buffer_profile)
+      SAI_TRACE_OBJECT_FNS(HASH, HASH, sai_hash_api_t, hash)
+      SAI_TRACE_OBJECT_FNS(HOSTIF_TRAP, HOSTIF, sai_hostif_api_t, hostif_trap)
+      SAI_TRACE_OBJECT_FNS(
+          HOSTIF_TRAP_GROUP, HOSTIF, sai_hostif_api_t, hostif_trap_group)
+      SAI_TRACE_OBJECT_FNS(
+          MIRROR_SESSION, MIRROR, sai_mirror_api_t, mirror_session)
+      SAI_TRACE_OBJECT_FNS(NEXT_HOP, NEXT_HOP, sai_next_hop_api_t, next_hop)
+      SAI_TRACE_OBJECT_FNS(
+          NEXT_HOP_GROUP,
+          NEXT_HOP_GROUP,
+          sai_next_hop_group_api_t,
+          next_hop_group)
+      SAI_TRACE_OBJECT_FNS(
+          NEXT_HOP_GROUP_MEMBER,
+          NEXT_HOP_GROUP,
+          sai_next_hop_group_api_t,
+          next_hop_group_member)
+      SAI_TRACE_OBJECT_FNS(PORT, PORT, sai_port_api_t, port)
+      SAI_TRACE_OBJECT_FNS(PORT_SERDES, PORT, sai_port_api_t, port_serdes)
+      SAI_TRACE_OBJECT_FNS(QOS_MAP, QOS_MAP, sai_qos_map_api_t, qos_map)
+      SAI_TRACE_OBJECT_FNS(QUEUE, QUEUE, sai_queue_api_t, queue)
+      SAI_TRACE_OBJECT_FNS(
+          ROUTER_INTERFACE,
+          ROUTER_INTERFACE,
+          sai_router_interface_api_t,
+          router_interface)
+      SAI_TRACE_OBJECT_FNS(
+          SAMPLEPACKET, SAMPLEPACKET, sai_samplepacket_api_t, samplepacket)
+      SAI_TRACE_OBJECT_FNS(SCHEDULER, SCHEDULER, sai_scheduler_api_t, scheduler)
+      SAI_TRACE_OBJECT_FNS(TAM, TAM, sai_tam_api_t, tam)
+      SAI_TRACE_OBJECT_FNS(TAM_EVENT, TAM, sai_tam_api_t, tam_event)
+      SAI_TRACE_OBJECT_FNS(
+          TAM_EVENT_ACTION, TAM, sai_tam_api_t, tam_event_action)
+      SAI_TRACE_OBJECT_FNS(TAM_REPORT, TAM, sai_tam_api_t, tam_report)
+      SAI_TRACE_OBJECT_FNS(
+          VIRTUAL_ROUTER,
+          VIRTUAL_ROUTER,
+          sai_virtual_router_api_t,
+          virtual_router)
+      SAI_TRACE_OBJECT_FNS(VLAN, VLAN, sai_vlan_api_t, vlan)
+      SAI_TRACE_OBJECT_FNS(VLAN_MEMBER, VLAN, sai_vlan_api_t, vlan_member)
+      case SAI_OBJECT_TYPE_SWITCH: {
+        auto api = apiTable<sai_switch_api_t>(SAI_API_SWITCH);
+        return {nullptr, api->remove_switch, api->set_switch_attribute};
+      }
+      default:
+        throw FbossError("Unsupported object type in sai trace ", objectType);
+    }
+  }
+
+#undef SAI_TRACE_OBJECT_FNS
+
+  std::unordered_map<sai_object_id_t, sai_object_id_t> oids_;
+  std::unordered_map<sai_api_t, void*> apis_;
+};
+
+// Feed the trace through SaiTracer's text mode, producing the same C code
+// as a live run with --enable_binary_sai_trace=false
+void convertToC(SaiTraceReader& reader) {
+  auto tracer = SaiTracer::getInstance();
+  SaiTraceRecord record;
+  while (reader.next(record)) {
+    auto op = static_cast<SaiTraceOp>(record.header.op);
+    auto objectType = static_cast<sai_object_type_t>(record.header.objectType);
+    auto rv = static_cast<sai_status_t>(record.header.rv);
+    auto attrCount = static_cast<uint32_t>(record.attrs.size());
+    auto attrs = record.attrs.data();
+    sai_object_id_t oid = record.header.oid;
+
+    switch (op) {
+      case SaiTraceOp::API_INITIALIZE: {
+        auto kvs = profileValues(record);
+        std::vector<const char*> variables;
+        std::vector<const char*> values;
+        for (const auto& [key, value] : kvs) {
+          variables.push_back(key.c_str());
+          values.push_back(value.c_str());
+        }
+        tracer->logApiInitialize(
+            variables.data(), values.data(), variables.size());
+        break;
+      }
+      case SaiTraceOp::API_QUERY: {
+        auto api = static_cast<sai_api_t>(record.header.api);
+        tracer->logApiQuery(api, facebook::fboss::saiTraceApiVarName(api));
+        break;
+      }
+      case SaiTraceOp::CREATE:
+        switch (objectType) {
+          case SAI_OBJECT_TYPE_SWITCH:
+            tracer->logSwitchCreateFn(&oid, attrCount, attrs, rv);
+            break;
+          case SAI_OBJECT_TYPE_ROUTE_ENTRY: {
+            auto entry = entryKey<sai_route_entry_t>(record);
+            tracer->logRouteEntryCreateFn(&entry, attrCount, attrs, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_NEIGHBOR_ENTRY: {
+            auto entry = entryKey<sai_neighbor_entry_t>(record);
+            tracer->logNeighborEntryCreateFn(&entry, attrCount, attrs, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_FDB_ENTRY: {
+            auto entry = entryKey<sai_fdb_entry_t>(record);
+            tracer->logFdbEntryCreateFn(&entry, attrCount, attrs, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_INSEG_ENTRY: {
+            auto entry = entryKey<sai_inseg_entry_t>(record);
+            tracer->logInsegEntryCreateFn(&entry, attrCount, attrs, rv);
+            break;
+          }
+          default:
+            tracer->logCreateFn(
+                facebook::fboss::saiTraceFnName(op, objectType),
+                &oid,
+                record.header.switchId,
+                attrCount,
+                attrs,
+                objectType,
+                rv);
+        }
+        break;
+      case SaiTraceOp::REMOVE:
+        switch (objectType) {
+          case SAI_OBJECT_TYPE_ROUTE_ENTRY: {
+            auto entry = entryKey<sai_route_entry_t>(record);
+            tracer->logRouteEntryRemoveFn(&entry, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_NEIGHBOR_ENTRY: {
+            auto entry = entryKey<sai_neighbor_entry_t>(record);
+            tracer->logNeighborEntryRemoveFn(&entry, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_FDB_ENTRY: {
+            auto entry = entryKey<sai_fdb_entry_t>(record);
+            tracer->logFdbEntryRemoveFn(&entry, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_INSEG_ENTRY: {
+            auto entry = entryKey<sai_inseg_entry_t>(record);
+            tracer->logInsegEntryRemoveFn(&entry, rv);
+            break;
+          }
+          default:
+            tracer->logRemoveFn(
+                facebook::fboss::saiTraceFnName(op, objectType),
+                oid,
+                objectType,
+                rv);
+        }
+        break;
+      case SaiTraceOp::SET:
+        switch (objectType) {
+          case SAI_OBJECT_TYPE_ROUTE_ENTRY: {
+            auto entry = entryKey<sai_route_entry_t>(record);
+            tracer->logRouteEntrySetAttrFn(&entry, attrs, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_NEIGHBOR_ENTRY: {
+            auto entry = entryKey<sai_neighbor_entry_t>(record);
+            tracer->logNeighborEntrySetAttrFn(&entry, attrs, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_FDB_ENTRY: {
+            auto entry = entryKey<sai_fdb_entry_t>(record);
+            tracer->logFdbEntrySetAttrFn(&entry, attrs, rv);
+            break;
+          }
+          case SAI_OBJECT_TYPE_INSEG_ENTRY: {
+            auto entry = entryKey<sai_inseg_entry_t>(record);
+            tracer->logInsegEntrySetAttrFn(&entry, attrs, rv);
+            break;
+          }
+          default:
+            tracer->logSetAttrFn(
+                facebook::fboss::saiTraceFnName(op, objectType),
+                oid,
+                attrs,
+                objectType,
+                rv);
+        }
+        break;
+      case SaiTraceOp::SEND_PACKET:
+        tracer->logSendHostifPacketFn(
+            oid, record.payloadSize, record.payload, attrCount, attrs, rv);
+        break;
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  folly::init(&argc, &argv);
+  if (FLAGS_sai_trace.empty()) {
+    XLOG(FATAL) << "--sai_trace is required";
+  }
+  SaiTraceReader reader(FLAGS_sai_trace);
+
+  // This binary links the tracer to read traces, make sure it does not
+  // record a new binary trace of its own.
+  FLAGS_enable_binary_sai_trace = false;
+  if (!FLAGS_sai_trace_to_c.empty()) {
+    FLAGS_enable_replayer = true;
+    FLAGS_enable_packet_log = true;
+    FLAGS_sai_log = FLAGS_sai_trace_to_c;
+    convertToC(reader);
+  } else {
+    FLAGS_enable_replayer = false;
+    if (!sai_metadata_get_attr_metadata) {
+      XLOG(WARN) << "SAI implementation has no attribute metadata, only "
+                 << "object lists are remapped";
+    }
+    TraceReplayer().replay(reader);
+  }
+  return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/sai/tracer/SaiBinaryTracer.h"
+#include "fboss/agent/hw/sai/tracer/SaiTraceRecord.h"
+
+#include <folly/experimental/TestUtil.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <limits>
+
+using namespace facebook::fboss;
+
+namespace {
+
+constexpr sai_object_id_t kSwitchId = 1;
+
+std::unique_ptr<SaiBinaryTracer> makeTracer(
+    const folly::test::TemporaryFile& file) {
+  return std::make_unique<SaiBinaryTracer>(
+      file.path().string(), 64, std::chrono::milliseconds(1));
+}
+
+} // namespace
+
+TEST(SaiTraceRecordTest, CreateWithList) {
+  folly::test::TemporaryFile traceFile;
+  std::vector<uint32_t> lanes{1, 2, 3};
+  std::vector<sai_attribute_t> attrs(2);
+  attrs[0].id = SAI_PORT_ATTR_HW_LANE_LIST;
+  attrs[0].value.u32list.count = lanes.size();
+  attrs[0].value.u32list.list = lanes.data();
+  attrs[1].id = SAI_PORT_ATTR_SPEED;
+  attrs[1].value.u32 = 100000;
+  {
+    auto tracer = makeTracer(traceFile);
+    tracer->logCreate(
+        SAI_OBJECT_TYPE_PORT,
+        42,
+        kSwitchId,
+        attrs.size(),
+        attrs.data(),
+        SAI_STATUS_SUCCESS);
+    tracer->logSetAttr(
+        SAI_OBJECT_TYPE_PORT, 42, &attrs[1], SAI_STATUS_FAILURE);
+    tracer->logRemove(SAI_OBJECT_TYPE_PORT, 42, SAI_STATUS_SUCCESS);
+  }
+
+  SaiTraceReader reader(traceFile.path().string());
+  SaiTraceRecord record;
+  ASSERT_TRUE(reader.next(record));
+  EXPECT_EQ(static_cast<uint16_t>(SaiTraceOp::CREATE), record.header.op);
+  EXPECT_EQ(SAI_OBJECT_TYPE_PORT, record.header.objectType);
+  EXPECT_EQ(SAI_API_PORT, record.header.api);
+  EXPECT_EQ(42, record.header.oid);
+  EXPECT_EQ(kSwitchId, record.header.switchId);
+  EXPECT_EQ(SAI_STATUS_SUCCESS, record.header.rv);
+  EXPECT_EQ(0, record.header.size % kSaiTraceAlignment);
+  ASSERT_EQ(2, record.attrs.size());
+  EXPECT_EQ(SAI_PORT_ATTR_HW_LANE_LIST, record.attrs[0].id);
+  const auto& laneList = record.attrs[0].value.u32list;
+  ASSERT_EQ(lanes.size(), laneList.count);
+  // The list points into the trace, not at the recorded address
+  EXPECT_NE(lanes.data(), laneList.list);
+  EXPECT_EQ(lanes, std::vector<uint32_t>(laneList.list, laneList.list + 3));
+  EXPECT_EQ(SAI_PORT_ATTR_SPEED, record.attrs[1].id);
+  EXPECT_EQ(100000, record.attrs[1].value.u32);
+
+  ASSERT_TRUE(reader.next(record));
+  EXPECT_EQ(static_cast<uint16_t>(SaiTraceOp::SET), record.header.op);
+  EXPECT_EQ(SAI_STATUS_FAILURE, record.header.rv);
+  ASSERT_EQ(1, record.attrs.size());
+  EXPECT_EQ(100000, record.attrs[0].value.u32);
+
+  ASSERT_TRUE(reader.next(record));
+  EXPECT_EQ(static_cast<uint16_t>(SaiTraceOp::REMOVE), record.header.op);
+  EXPECT_TRUE(record.attrs.empty());
+
+  EXPECT_FALSE(reader.next(record));
+}
+
+TEST(SaiTraceRecordTest, EntryAndPacketPayloads) {
+  folly::test::TemporaryFile traceFile;
+  sai_route_entry_t routeEntry{};
+  routeEntry.switch_id = kSwitchId;
+  routeEntry.vr_id = 7;
+  routeEntry.destination.addr_family = SAI_IP_ADDR_FAMILY_IPV4;
+  routeEntry.destination.addr.ip4 = 0x0a000000;
+  routeEntry.destination.mask.ip4 = 0xff000000;
+  sai_attribute_t nextHop;
+  nextHop.id = SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID;
+  nextHop.value.oid = 9;
+  std::vector<uint8_t> packet{0xde, 0xad, 0xbe, 0xef, 0x01};
+  {
+    auto tracer = makeTracer(traceFile);
+    tracer->logEntryOp(
+        SaiTraceOp::CREATE,
+        SAI_OBJECT_TYPE_ROUTE_ENTRY,
+        &routeEntry,
+        1,
+        &nextHop,
+        SAI_STATUS_SUCCESS);
+    tracer->logSendHostifPacket(
+        5, packet.size(), packet.data(), 0, nullptr, SAI_STATUS_SUCCESS);
+  }
+
+  SaiTraceReader reader(traceFile.path().string());
+  SaiTraceRecord record;
+  ASSERT_TRUE(reader.next(record));
+  EXPECT_EQ(SAI_OBJECT_TYPE_ROUTE_ENTRY, record.header.objectType);
+  EXPECT_EQ(kSwitchId, record.header.switchId);
+  ASSERT_EQ(sizeof(routeEntry), record.payloadSize);
+  EXPECT_EQ(0, std::memcmp(&routeEntry, record.payload, sizeof(routeEntry)));
+  ASSERT_EQ(1, record.attrs.size());
+  EXPECT_EQ(9, record.attrs[0].value.oid);
+
+  ASSERT_TRUE(reader.next(record));
+  EXPECT_EQ(static_cast<uint16_t>(SaiTraceOp::SEND_PACKET), record.header.op);
+  EXPECT_EQ(5, record.header.oid);
+  EXPECT_EQ(
+      packet,
+      std::vector<uint8_t>(
+          record.payload, record.payload + record.payloadSize));
+
+  EXPECT_FALSE(reader.next(record));
+}
+
+TEST(SaiTraceRecordTest, TooManyAttributes) {
+  folly::test::TemporaryFile traceFile;
+  {
+    auto tracer = makeTracer(traceFile);
+    // Rejected before the attributes are looked at
+    tracer->logCreate(
+        SAI_OBJECT_TYPE_PORT,
+        42,
+        kSwitchId,
+        std::numeric_limits<uint16_t>::max() + 1,
+        nullptr,
+        SAI_STATUS_SUCCESS);
+    EXPECT_EQ(1, tracer->droppedRecords());
+  }
+
+  SaiTraceReader reader(traceFile.path().string());
+  SaiTraceRecord record;
+  EXPECT_FALSE(reader.next(record));
+}
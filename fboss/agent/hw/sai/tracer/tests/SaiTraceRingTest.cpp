@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/sai/tracer/SaiTraceRing.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+
+using namespace facebook::fboss;
+
+namespace {
+
+// Record of size bytes starting with its length, filled with fill
+std::vector<uint8_t> makeRecord(uint32_t size, uint8_t fill) {
+  std::vector<uint8_t> record(size, fill);
+  std::memcpy(record.data(), &size, sizeof(size));
+  return record;
+}
+
+bool writeRecord(SaiTraceRing& ring, const std::vector<uint8_t>& record) {
+  return ring.tryWrite(record.data(), record.size());
+}
+
+} // namespace
+
+TEST(SaiTraceRingTest, WriteRead) {
+  SaiTraceRing ring(4);
+  std::vector<uint8_t> out;
+  EXPECT_FALSE(ring.tryRead(out));
+
+  auto record = makeRecord(64, 0xab);
+  EXPECT_TRUE(writeRecord(ring, record));
+  EXPECT_TRUE(ring.tryRead(out));
+  EXPECT_EQ(record, out);
+  EXPECT_FALSE(ring.tryRead(out));
+}
+
+TEST(SaiTraceRingTest, MultiSlotRecord) {
+  SaiTraceRing ring(8);
+  auto small = makeRecord(16, 1);
+  auto large = makeRecord(SaiTraceRing::kSlotSize * 2 + 10, 2);
+  EXPECT_TRUE(writeRecord(ring, small));
+  EXPECT_TRUE(writeRecord(ring, large));
+
+  std::vector<uint8_t> out;
+  EXPECT_TRUE(ring.tryRead(out));
+  EXPECT_EQ(small, out);
+  out.clear();
+  EXPECT_TRUE(ring.tryRead(out));
+  EXPECT_EQ(large, out);
+}
+
+TEST(SaiTraceRingTest, FullRingDrops) {
+  SaiTraceRing ring(4);
+  auto record = makeRecord(SaiTraceRing::kSlotSize, 3);
+  for (auto i = 0; i < 4; ++i) {
+    EXPECT_TRUE(writeRecord(ring, record));
+  }
+  EXPECT_FALSE(writeRecord(ring, record));
+  EXPECT_EQ(1, ring.droppedRecords());
+
+  // Reading frees up slots for the next lap
+  std::vector<uint8_t> out;
+  EXPECT_TRUE(ring.tryRead(out));
+  EXPECT_TRUE(writeRecord(ring, record));
+  EXPECT_EQ(1, ring.droppedRecords());
+
+  // Records larger than the ring can never be written
+  EXPECT_FALSE(writeRecord(ring, makeRecord(SaiTraceRing::kSlotSize * 5, 4)));
+  EXPECT_EQ(2, ring.droppedRecords());
+}
+
+TEST(SaiTraceRingTest, ConcurrentWriters) {
+  constexpr auto kWriters = 4;
+  constexpr auto kRecordsPerWriter = 10000;
+  SaiTraceRing ring(64);
+
+  std::vector<std::thread> writers;
+  for (auto w = 0; w < kWriters; ++w) {
+    writers.emplace_back([&ring, w] {
+      // Alternate single and multi slot records
+      for (auto i = 0; i < kRecordsPerWriter; ++i) {
+        auto size = i % 2 ? 32 : SaiTraceRing::kSlotSize + 32;
+        auto record = makeRecord(size, w);
+        while (!writeRecord(ring, record)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<int> received(kWriters, 0);
+  std::vector<uint8_t> out;
+  auto total = 0;
+  while (total < kWriters * kRecordsPerWriter) {
+    out.clear();
+    if (!ring.tryRead(out)) {
+      std::this_thread::yield();
+      continue;
+    }
+    // Records must come out whole, never interleaved with another writer's
+    uint32_t size;
+    std::memcpy(&size, out.data(), sizeof(size));
+    ASSERT_EQ(size, out.size());
+    auto writer = out.back();
+    ASSERT_LT(writer, kWriters);
+    for (auto i = sizeof(size); i < out.size(); ++i) {
+      ASSERT_EQ(writer, out[i]);
+    }
+    ++received[writer];
+    ++total;
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  for (auto count : received) {
+    EXPECT_EQ(kRecordsPerWriter, count);
+  }
+}
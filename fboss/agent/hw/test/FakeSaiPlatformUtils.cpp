@@ -0,0 +1,34 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/test/FakeSaiPlatformUtils.h"
+
+#include "fboss/agent/AgentConfig.h"
+#include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/platforms/common/PlatformProductInfo.h"
+
+namespace facebook::fboss::utility {
+
+std::unique_ptr<SaiFakePlatform> createFakeSaiPlatform() {
+  auto platform = std::make_unique<SaiFakePlatform>(fakeProductInfo());
+  cfg::AgentConfig thriftAgentConfig;
+  thriftAgentConfig.platform_ref()->platformSettings_ref() = {};
+  thriftAgentConfig.platform_ref()->platformSettings_ref()->insert(
+      std::make_pair(
+          cfg::PlatformAttributes::CONNECTION_HANDLE,
+          "test connection handle"));
+  platform->init(
+      std::make_unique<AgentConfig>(
+          std::move(thriftAgentConfig), "fakeSaiConfigStr"),
+      (HwSwitch::FeaturesDesired::PACKET_RX_DESIRED |
+       HwSwitch::FeaturesDesired::LINKSCAN_DESIRED));
+  return platform;
+}
+
+} // namespace facebook::fboss::utility
@@ -0,0 +1,25 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/platforms/sai/SaiFakePlatform.h"
+
+#include <memory>
+
+namespace facebook::fboss::utility {
+
+/*
+ * SaiFakePlatform initialized with a minimal agent config, so the SAI
+ * HwSwitch code can run against the fake SAI implementation without any
+ * hardware. The HwSwitch itself is not initialized yet.
+ */
+std::unique_ptr<SaiFakePlatform> createFakeSaiPlatform();
+
+} // namespace facebook::fboss::utility
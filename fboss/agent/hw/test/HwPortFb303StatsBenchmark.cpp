@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/HwPortFb303Stats.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include "common/init/Init.h"
+
+#include <memory>
+#include <vector>
+
+using namespace facebook::fboss;
+using namespace std::chrono;
+
+namespace {
+
+// 256 logical ports with 8 queues each, a fully populated large switch
+constexpr auto kNumPorts = 256;
+constexpr auto kNumQueues = 8;
+
+std::vector<std::unique_ptr<HwPortFb303Stats>> makePortStats() {
+  HwPortFb303Stats::QueueId2Name queueId2Name;
+  for (auto queueId = 0; queueId < kNumQueues; ++queueId) {
+    queueId2Name.emplace(queueId, folly::sformat("queue{}", queueId));
+  }
+  std::vector<std::unique_ptr<HwPortFb303Stats>> portStats;
+  for (auto port = 0; port < kNumPorts; ++port) {
+    portStats.push_back(std::make_unique<HwPortFb303Stats>(
+        folly::sformat("eth1/{}/1", port + 1), queueId2Name));
+  }
+  return portStats;
+}
+
+HwPortStats makeHwPortStats() {
+  HwPortStats stats;
+  for (auto queueId = 0; queueId < kNumQueues; ++queueId) {
+    (*stats.queueOutDiscardBytes__ref())[queueId] = 0;
+    (*stats.queueOutBytes__ref())[queueId] = 0;
+    (*stats.queueOutPackets__ref())[queueId] = 0;
+  }
+  return stats;
+}
+
+} // namespace
+
+/*
+ * One iteration is one stats collection cycle, updating every port and
+ * queue counter of the switch.
+ */
+BENCHMARK(HwPortFb303StatsUpdate, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto portStats = makePortStats();
+  auto hwStats = makeHwPortStats();
+  auto now = duration_cast<seconds>(system_clock::now().time_since_epoch());
+  suspender.dismiss();
+  for (auto i = 0; i < iters; ++i) {
+    *hwStats.inBytes__ref() = *hwStats.outBytes__ref() = i;
+    for (auto& stats : portStats) {
+      stats->updateStats(hwStats, now);
+    }
+  }
+  suspender.rehire();
+}
+
+/*
+ * Port rename re-resolves counter handles, this is off the collection path
+ * but should stay cheap.
+ */
+BENCHMARK(HwPortFb303StatsPortRename, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto portStats = makePortStats();
+  suspender.dismiss();
+  for (auto i = 0; i < iters; ++i) {
+    portStats[i % kNumPorts]->portNameChanged(folly::sformat("renamed{}", i));
+  }
+  suspender.rehire();
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/StateUpdateRecorder.h"
+#include "fboss/agent/hw/mock/MockPlatform.h"
+#include "fboss/agent/hw/sai/switch/SaiSwitch.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/hw/test/FakeSaiPlatformUtils.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/Format.h>
+#include <folly/String.h>
+#include <folly/init/Init.h>
+#include <folly/logging/xlog.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+DEFINE_string(
+    replay_state_update_file,
+    "",
+    "State update log recorded with --record_state_updates_file to replay");
+DEFINE_string(
+    replay_hw_switches,
+    "sim,mock,fake_sai",
+    "Comma separated HwSwitch implementations to replay the state updates "
+    "against. Supported: sim, mock, fake_sai");
+DEFINE_bool(
+    replay_with_recorded_delays,
+    false,
+    "Wait between updates as long as when they were recorded, instead of "
+    "replaying them back to back");
+
+using namespace facebook::fboss;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+uint32_t maxPortId(const std::shared_ptr<SwitchState>& state) {
+  uint32_t maxPort = 0;
+  for (const auto& port : *state->getPorts()) {
+    maxPort = std::max(maxPort, static_cast<uint32_t>(port->getID()));
+  }
+  return maxPort;
+}
+
+std::unique_ptr<Platform> makeSimPlatform(
+    const std::shared_ptr<SwitchState>& initialState) {
+  auto platform = std::make_unique<SimPlatform>(
+      folly::MacAddress("02:00:00:00:00:01"), maxPortId(initialState));
+  platform->getHwSwitch()->init(nullptr, false /*failHwCallsOnWarmboot*/);
+  return platform;
+}
+
+std::unique_ptr<Platform> makeMockPlatform() {
+  // The mock HwSwitch returns the new state of every delta unchanged, so this
+  // is the cost of the replay loop itself
+  return std::make_unique<testing::NiceMock<MockPlatform>>();
+}
+
+std::unique_ptr<Platform> makeFakeSaiPlatform() {
+  auto platform = utility::createFakeSaiPlatform();
+  platform->getHwSwitch()->init(nullptr, false /*failHwCallsOnWarmboot*/);
+  platform->initPorts();
+  static_cast<SaiSwitch*>(platform->getHwSwitch())
+      ->switchRunStateChanged(SwitchRunState::INITIALIZED);
+  return platform;
+}
+
+std::unique_ptr<Platform> makePlatform(
+    const std::string& hwSwitch,
+    const std::shared_ptr<SwitchState>& initialState) {
+  if (hwSwitch == "sim") {
+    return makeSimPlatform(initialState);
+  } else if (hwSwitch == "mock") {
+    return makeMockPlatform();
+  } else if (hwSwitch == "fake_sai") {
+    return makeFakeSaiPlatform();
+  }
+  throw FbossError("Unsupported HwSwitch for replay: ", hwSwitch);
+}
+
+microseconds percentile(const std::vector<microseconds>& sorted, double pct) {
+  if (sorted.empty()) {
+    return microseconds(0);
+  }
+  auto idx = static_cast<size_t>(pct / 100 * (sorted.size() - 1));
+  return sorted[idx];
+}
+
+void report(const std::string& name, std::vector<microseconds> latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  microseconds total(0);
+  for (auto latency : latencies) {
+    total += latency;
+  }
+  XLOG(INFO) << folly::sformat(
+      "{:<10} updates={} total={}us p50={}us p90={}us p99={}us max={}us",
+      name,
+      latencies.size(),
+      total.count(),
+      percentile(latencies, 50).count(),
+      percentile(latencies, 90).count(),
+      percentile(latencies, 99).count(),
+      latencies.empty() ? 0 : latencies.back().count());
+}
+
+/*
+ * Apply the recorded states one delta at a time, timing each stateChanged()
+ * call. The first recorded state is the starting point and is not timed.
+ */
+std::vector<microseconds> replay(
+    HwSwitch* hw,
+    const std::vector<StateUpdateRecorder::RecordedUpdate>& updates) {
+  std::vector<microseconds> latencies;
+  latencies.reserve(updates.size());
+  auto prev = std::make_shared<SwitchState>();
+  for (size_t i = 0; i < updates.size(); ++i) {
+    const auto& update = updates[i];
+    if (i > 0 && FLAGS_replay_with_recorded_delays) {
+      std::this_thread::sleep_for(update.delay);
+    }
+    StateDelta delta(prev, update.state);
+    auto start = steady_clock::now();
+    auto applied = hw->stateChanged(delta);
+    auto latency = duration_cast<microseconds>(steady_clock::now() - start);
+    if (applied != update.state) {
+      XLOG(WARN) << "Update " << i << " was only partially applied";
+    }
+    if (i > 0) {
+      latencies.push_back(latency);
+    }
+    prev = update.state;
+  }
+  return latencies;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv, true);
+  if (FLAGS_replay_state_update_file.empty()) {
+    XLOG(ERR) << "--replay_state_update_file is required";
+    return 1;
+  }
+
+  auto updates = StateUpdateRecorder::readLog(FLAGS_replay_state_update_file);
+  if (updates.empty()) {
+    XLOG(ERR) << "No state updates in " << FLAGS_replay_state_update_file;
+    return 1;
+  }
+
+  std::vector<microseconds> recorded;
+  for (size_t i = 1; i < updates.size(); ++i) {
+    recorded.push_back(updates[i].hwDuration);
+  }
+  report("recorded", std::move(recorded));
+
+  std::vector<std::string> hwSwitches;
+  folly::split(',', FLAGS_replay_hw_switches, hwSwitches, true);
+  for (const auto& hwSwitch : hwSwitches) {
+    auto platform = makePlatform(hwSwitch, updates.front().state);
+    report(hwSwitch, replay(platform->getHwSwitch(), updates));
+  }
+  return 0;
+}
@@ -0,0 +1,323 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/network/if/gen-cpp2/Address_types.h"
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/ApplyThriftConfig.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/ThriftHandler.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/hw/test/ConfigFactory.h"
+#include "fboss/agent/hw/test/FakeSaiPlatformUtils.h"
+#include "fboss/agent/state/AggregatePort.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+#include "fboss/agent/test/TestUtils.h"
+#include "fboss/agent/test/TrunkUtils.h"
+
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <folly/MacAddress.h>
+#include <folly/init/Init.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+DEFINE_string(
+    sw_switch_benchmark_hw,
+    "sim",
+    "HwSwitch to drive SwSwitch with, sim or fake_sai");
+DEFINE_int32(
+    sw_switch_benchmark_updates,
+    1000,
+    "Number of state updates to run for each scenario");
+DEFINE_int32(
+    sw_switch_benchmark_route_batch,
+    100,
+    "Number of routes added or deleted by each route churn update");
+
+/*
+ * Count every heap allocation in the process, so the benchmark can report
+ * allocations per update. This includes allocations by the other SwSwitch
+ * threads while a scenario runs, which is part of the cost of an update.
+ */
+namespace {
+std::atomic<uint64_t> allocations{0};
+} // namespace
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+using namespace facebook::fboss;
+using facebook::network::toBinaryAddress;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+constexpr auto kNumPorts = 32;
+constexpr auto kAggPortKey = 1;
+constexpr auto kClientId = 1;
+const folly::MacAddress kNeighborMac("02:00:00:00:0f:01");
+
+struct ScenarioResult {
+  std::vector<microseconds> latencies;
+  microseconds elapsed{0};
+  uint64_t allocations{0};
+};
+
+std::unique_ptr<Platform> makePlatform() {
+  if (FLAGS_sw_switch_benchmark_hw == "sim") {
+    return std::make_unique<SimPlatform>(
+        folly::MacAddress("02:00:00:00:00:01"), kNumPorts);
+  } else if (FLAGS_sw_switch_benchmark_hw == "fake_sai") {
+    return utility::createFakeSaiPlatform();
+  }
+  throw FbossError("Unsupported HwSwitch: ", FLAGS_sw_switch_benchmark_hw);
+}
+
+/*
+ * A SwSwitch with one interface per port and the first two ports in an
+ * aggregate port, configured the same way wedge_agent would be at startup.
+ */
+class BenchmarkSwitch {
+ public:
+  BenchmarkSwitch() : sw_(std::make_unique<SwSwitch>(makePlatform())) {
+    sw_->init(nullptr, SwitchFlags::DEFAULT);
+    for (const auto& port : *sw_->getState()->getPorts()) {
+      if (ports_.size() == kNumPorts) {
+        break;
+      }
+      ports_.push_back(port->getID());
+    }
+
+    config_ = utility::onePortPerVlanConfig(sw_->getHw(), ports_);
+    utility::addAggPort(
+        kAggPortKey, {int32_t(ports_[0]), int32_t(ports_[1])}, &config_);
+    sw_->updateStateBlocking(
+        "benchmark config", [this](const std::shared_ptr<SwitchState>& state) {
+          return applyThriftConfig(state, &config_, sw_->getPlatform());
+        });
+    sw_->initialConfigApplied(steady_clock::now());
+    sw_->fibSynced();
+    handler_ = std::make_unique<ThriftHandler>(sw_.get());
+  }
+
+  ~BenchmarkSwitch() {
+    sw_->stop();
+  }
+
+  SwSwitch* sw() const {
+    return sw_.get();
+  }
+  ThriftHandler* handler() const {
+    return handler_.get();
+  }
+  const std::vector<PortID>& ports() const {
+    return ports_;
+  }
+  VlanID vlan(int idx) const {
+    return VlanID(*config_.vlans_ref()[idx].id_ref());
+  }
+  InterfaceID intf(int idx) const {
+    return InterfaceID(*config_.interfaces_ref()[idx].intfID_ref());
+  }
+
+ private:
+  std::unique_ptr<SwSwitch> sw_;
+  std::unique_ptr<ThriftHandler> handler_;
+  std::vector<PortID> ports_;
+  cfg::SwitchConfig config_;
+};
+
+/*
+ * Run updateFn(i) for every update and time each call. updateFn must only
+ * return once its state update has been applied.
+ */
+template <typename UpdateFn>
+ScenarioResult runScenario(UpdateFn updateFn) {
+  ScenarioResult result;
+  result.latencies.reserve(FLAGS_sw_switch_benchmark_updates);
+  auto allocationsBefore = allocations.load();
+  auto begin = steady_clock::now();
+  for (auto i = 0; i < FLAGS_sw_switch_benchmark_updates; ++i) {
+    auto start = steady_clock::now();
+    updateFn(i);
+    result.latencies.push_back(
+        duration_cast<microseconds>(steady_clock::now() - start));
+  }
+  result.elapsed = duration_cast<microseconds>(steady_clock::now() - begin);
+  result.allocations = allocations.load() - allocationsBefore;
+  return result;
+}
+
+void report(const std::string& scenario, ScenarioResult result) {
+  auto& latencies = result.latencies;
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double pct) {
+    return latencies[static_cast<size_t>(pct / 100 * (latencies.size() - 1))]
+        .count();
+  };
+  auto updates = latencies.size();
+  std::cout << folly::sformat(
+                   "{:<14} {:>10.1f} updates/s  p50 {:>7}us  p99 {:>7}us  "
+                   "{:>9.1f} allocs/update",
+                   scenario,
+                   updates * 1e6 / std::max<int64_t>(result.elapsed.count(), 1),
+                   percentile(50),
+                   percentile(99),
+                   static_cast<double>(result.allocations) / updates)
+            << std::endl;
+}
+
+std::unique_ptr<std::vector<UnicastRoute>> makeRoutes(int batch) {
+  auto routes = std::make_unique<std::vector<UnicastRoute>>();
+  for (auto i = 0; i < FLAGS_sw_switch_benchmark_route_batch; ++i) {
+    auto idx = batch * FLAGS_sw_switch_benchmark_route_batch + i;
+    UnicastRoute route;
+    route.dest.ip = toBinaryAddress(folly::IPAddress(folly::sformat(
+        "2401:db00:{:x}:{:x}::", (idx >> 16) & 0xffff, idx & 0xffff)));
+    route.dest.prefixLength = 64;
+    // Next hops in the subnets of the first two interfaces
+    route.nextHopAddrs_ref()->push_back(
+        toBinaryAddress(folly::IPAddress("1::10")));
+    route.nextHopAddrs_ref()->push_back(
+        toBinaryAddress(folly::IPAddress("2::10")));
+    routes->push_back(std::move(route));
+  }
+  return routes;
+}
+
+std::unique_ptr<std::vector<IpPrefix>> toPrefixes(
+    const std::vector<UnicastRoute>& routes) {
+  auto prefixes = std::make_unique<std::vector<IpPrefix>>();
+  for (const auto& route : routes) {
+    prefixes->push_back(route.dest);
+  }
+  return prefixes;
+}
+
+/*
+ * Route churn through the thrift API, as routing protocol agents do.
+ * Even updates add a batch of routes, odd updates delete it.
+ */
+ScenarioResult routeChurn(BenchmarkSwitch* bs) {
+  std::unique_ptr<std::vector<IpPrefix>> toDelete;
+  return runScenario([&](int i) {
+    if (i % 2 == 0) {
+      auto routes = makeRoutes(i / 2);
+      toDelete = toPrefixes(*routes);
+      bs->handler()->addUnicastRoutes(kClientId, std::move(routes));
+    } else {
+      bs->handler()->deleteUnicastRoutes(kClientId, std::move(toDelete));
+    }
+  });
+}
+
+/*
+ * Neighbor churn, resolving and expiring ARP entries on the first vlan the
+ * same way the neighbor cache programs them.
+ */
+ScenarioResult neighborChurn(BenchmarkSwitch* bs) {
+  auto vlan = bs->vlan(0);
+  auto intf = bs->intf(0);
+  auto port = PortDescriptor(bs->ports()[0]);
+  return runScenario([&](int i) {
+    auto ip = folly::IPAddressV4::fromLongHBO(
+        folly::IPAddressV4("1.0.0.0").toLongHBO() + 2 + (i / 2) % 250);
+    bs->sw()->updateStateBlocking(
+        "neighbor churn", [&](const std::shared_ptr<SwitchState>& state) {
+          auto newState = state;
+          auto arpTable = newState->getVlans()
+                              ->getVlan(vlan)
+                              ->getArpTable()
+                              ->modify(vlan, &newState);
+          if (i % 2 == 0) {
+            arpTable->addEntry(ip, kNeighborMac, port, intf);
+          } else {
+            arpTable->removeEntry(ip);
+          }
+          return newState;
+        });
+  });
+}
+
+/*
+ * Link flaps as reported by the HwSwitch link scan callback.
+ */
+ScenarioResult portFlaps(BenchmarkSwitch* bs) {
+  return runScenario([&](int i) {
+    auto port = bs->ports()[(i / 2) % bs->ports().size()];
+    bs->sw()->linkStateChanged(port, i % 2 != 0);
+    waitForStateUpdates(bs->sw());
+  });
+}
+
+/*
+ * LACP moving an aggregate port member in and out of forwarding, the state
+ * update LinkAggregationManager issues on every LACP transition.
+ */
+ScenarioResult lacpTransitions(BenchmarkSwitch* bs) {
+  auto aggPortId = AggregatePortID(kAggPortKey);
+  return runScenario([&](int i) {
+    auto port = bs->ports()[i % 2];
+    auto forwarding = (i / 2) % 2 == 0 ? AggregatePort::Forwarding::ENABLED
+                                       : AggregatePort::Forwarding::DISABLED;
+    bs->sw()->updateStateBlocking(
+        "lacp transition", [&](const std::shared_ptr<SwitchState>& state) {
+          auto newState = state;
+          auto aggPort = newState->getAggregatePorts()
+                             ->getAggregatePort(aggPortId)
+                             ->modify(&newState);
+          aggPort->setForwardingState(port, forwarding);
+          return newState;
+        });
+  });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv, true);
+
+  BenchmarkSwitch bs;
+  std::cout << "SwSwitch on " << FLAGS_sw_switch_benchmark_hw << ", "
+            << FLAGS_sw_switch_benchmark_updates << " updates per scenario"
+            << std::endl;
+  report("route_churn", routeChurn(&bs));
+  report("neighbor_churn", neighborChurn(&bs));
+  report("port_flaps", portFlaps(&bs));
+  report("lacp", lacpTransitions(&bs));
+  return 0;
+}
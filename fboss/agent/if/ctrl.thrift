@@ -417,8 +417,33 @@ struct RxCaptureFilter {
   # can put additional Rx filters here if need be
 }
 
+/*
+ * One classic BPF instruction, as printed by `tcpdump -ddd <expression>`.
+ * code is the opcode, jt/jf are the jump offsets and k the generic field.
+ */
+struct BpfInstruction {
+  1: i16 code
+  2: i16 jt
+  3: i16 jf
+  4: i64 k
+}
+
 struct CaptureFilter {
   1: RxCaptureFilter rxCaptureFilter;
+  /*
+   * Compiled BPF program applied to both RX and TX packets, before the
+   * packet is copied into the capture. An empty program matches everything.
+   */
+  2: list<BpfInstruction> bpfFilter
+}
+
+enum CaptureFormat {
+  PCAP = 0,
+  /*
+   * pcapng, with one interface per port and the CPU queue of RX packets
+   * recorded on every packet
+   */
+  PCAPNG = 1
 }
 
 struct CaptureInfo {
@@ -438,6 +463,7 @@ struct CaptureInfo {
    * set of criteria that packet must meet to be captured
    */
   4: CaptureFilter  filter
+  5: CaptureFormat format = PCAP
 }
 
 struct RouteUpdateLoggingInfo {
@@ -679,6 +705,15 @@ service FbossCtrl extends fb303.FacebookService {
    */
   UnicastRoute getIpRoute(1: Address.Address addr 2: i32 vrfId)
     throws (1: fboss.FbossBaseError error)
+  /*
+   * Bulk getIpRoute, returns the IP route of each address in addrs, in the
+   * same order. Lookups are batched, which is much cheaper than one
+   * getIpRoute call per address for tools resolving many addresses.
+   */
+  list<UnicastRoute> getIpRoutes(
+    1: list<Address.Address> addrs,
+    2: i32 vrfId
+  ) throws (1: fboss.FbossBaseError error)
   RouteDetails getIpRouteDetails(1: Address.Address addr 2: i32 vrfId)
     throws (1: fboss.FbossBaseError error)
   map<i32, InterfaceDetail> getAllInterfaces()
@@ -220,3 +220,100 @@ TEST(SflowStructsTest, Serialize) {
     EXPECT_EQ(b.at(i), data[i]);
   }
 }
+
+TEST(SflowStructsTest, SerializeCounterSample) {
+  int bufSize = 1024;
+
+  sflow::IfCounters counters{};
+  counters.ifIndex = 7;
+  counters.ifType = 6; // ethernetCsmacd
+  counters.ifSpeed = 100000000000;
+  counters.ifInOctets = 0x0102030405060708;
+  counters.ifPromiscuousMode = 1;
+  EXPECT_EQ(counters.size(), 88);
+
+  std::vector<uint8_t> cb(bufSize);
+  auto cbuf = folly::IOBuf::wrapBuffer(cb.data(), bufSize);
+  folly::io::RWPrivateCursor cc(cbuf.get());
+  counters.serialize(&cc);
+  EXPECT_EQ(88, bufSize - cc.length());
+
+  sflow::CounterRecord crecord;
+  crecord.counterFormat = sflow::IfCounters::FORMAT;
+  crecord.counterDataLen = counters.size();
+  crecord.counterData = cb.data();
+  EXPECT_EQ(96, crecord.size());
+
+  sflow::CounterSample csample;
+  csample.sequenceNumber = 3;
+  csample.sourceID = 7;
+  csample.counterRecordsCnt = 1;
+  csample.counterRecords = &crecord;
+  EXPECT_EQ(108, csample.size(crecord.size()));
+
+  std::vector<uint8_t> b(bufSize);
+  auto buf = folly::IOBuf::wrapBuffer(b.data(), bufSize);
+  folly::io::RWPrivateCursor cursor(buf.get());
+  csample.serialize(&cursor);
+  EXPECT_EQ(108, bufSize - cursor.length());
+
+  constexpr auto data = folly::make_array<uint8_t>(
+      0x00,
+      0x00,
+      0x00,
+      0x03, // seq no.
+      0x00,
+      0x00,
+      0x00,
+      0x07, // source id
+      0x00,
+      0x00,
+      0x00,
+      0x01, // record count
+      0x00,
+      0x00,
+      0x00,
+      0x01, // counter format
+      0x00,
+      0x00,
+      0x00,
+      0x58, // counter data size
+      0x00,
+      0x00,
+      0x00,
+      0x07, // ifIndex
+      0x00,
+      0x00,
+      0x00,
+      0x06, // ifType
+      0x00,
+      0x00,
+      0x00,
+      0x17,
+      0x48,
+      0x76,
+      0xe8,
+      0x00, // ifSpeed
+      0x00,
+      0x00,
+      0x00,
+      0x00, // ifDirection
+      0x00,
+      0x00,
+      0x00,
+      0x00, // ifStatus
+      0x01,
+      0x02,
+      0x03,
+      0x04,
+      0x05,
+      0x06,
+      0x07,
+      0x08); // ifInOctets
+
+  for (int i = 0; i < data.size(); ++i) {
+    EXPECT_EQ(b.at(i), data[i]);
+  }
+  // ifPromiscuousMode is last
+  EXPECT_EQ(b.at(107), 1);
+}
@@ -11,6 +11,9 @@
 
 #include "fboss/agent/state/NodeMap-defs.h"
 
+#include <algorithm>
+#include <numeric>
+
 namespace facebook::fboss {
 
 template <typename AddressT>
@@ -58,6 +61,40 @@ ForwardingInformationBase<AddressT>::longestMatch(
   return longestMatchRoute;
 }
 
+template <typename AddressT>
+std::vector<std::shared_ptr<Route<AddressT>>>
+ForwardingInformationBase<AddressT>::longestMatch(
+    folly::Range<const AddressT*> addresses) const {
+  std::vector<std::shared_ptr<Route<AddressT>>> matches(addresses.size());
+  std::vector<uint8_t> matchLengths(addresses.size(), 0);
+  // Addresses in a subnet are contiguous once sorted, so a single pass over
+  // the routes finds the addresses under each one with binary searches,
+  // instead of a pass over the routes per address.
+  std::vector<size_t> order(addresses.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&addresses](size_t a, size_t b) {
+    return addresses[a] < addresses[b];
+  });
+  for (const auto& prefixAndRoute : Base::getAllNodes()) {
+    const auto& network = prefixAndRoute.first.network;
+    const auto mask = prefixAndRoute.first.mask;
+    auto first =
+        std::partition_point(order.begin(), order.end(), [&](size_t i) {
+          return addresses[i].mask(mask) < network;
+        });
+    auto last = std::partition_point(first, order.end(), [&](size_t i) {
+      return addresses[i].mask(mask) == network;
+    });
+    for (; first != last; ++first) {
+      if (!matches[*first] || mask > matchLengths[*first]) {
+        matches[*first] = prefixAndRoute.second;
+        matchLengths[*first] = mask;
+      }
+    }
+  }
+  return matches;
+}
+
 FBOSS_INSTANTIATE_NODE_MAP(
     ForwardingInformationBase<folly::IPAddressV4>,
     ForwardingInformationBaseTraits<folly::IPAddressV4>);
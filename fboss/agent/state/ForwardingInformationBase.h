@@ -15,6 +15,9 @@
 
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
+#include <folly/Range.h>
+
+#include <vector>
 
 namespace facebook::fboss {
 
@@ -40,6 +43,10 @@ class ForwardingInformationBase
 
   std::shared_ptr<Route<AddressT>> longestMatch(const AddressT& address) const;
 
+  // Batch longestMatch, results are in the same order as addresses
+  std::vector<std::shared_ptr<Route<AddressT>>> longestMatch(
+      folly::Range<const AddressT*> addresses) const;
+
  private:
   // Inherit the constructors required for clone()
   using Base::Base;
@@ -12,6 +12,7 @@
 #include "fboss/agent/Constants.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/state/NodeBase-defs.h"
+#include "fboss/agent/state/ParallelSerialization.h"
 
 #include <folly/dynamic.h>
 #include <folly/json.h>
@@ -103,12 +104,12 @@ NodeMapT<MapTypeT, TraitsT>::removeNodeIf(const KeyType& key) {
 
 template <typename MapTypeT, typename TraitsT>
 folly::dynamic NodeMapT<MapTypeT, TraitsT>::toFollyDynamic() const {
-  folly::dynamic nodesJson = folly::dynamic::array;
-  for (const auto& node : *this) {
-    nodesJson.push_back(node->toFollyDynamic());
-  }
+  const auto& nodes = getAllNodes();
   folly::dynamic json = folly::dynamic::object;
-  json[kEntries] = std::move(nodesJson);
+  json[kEntries] = toFollyDynamicArrayParallel(
+      nodes.size(), [&nodes](size_t i) {
+        return nodes.nth(i)->second->toFollyDynamic();
+      });
   json[kExtraFields] = getExtraFields().toFollyDynamic();
   return json;
 }
@@ -117,9 +118,9 @@ template <typename MapTypeT, typename TraitsT>
 std::shared_ptr<MapTypeT> NodeMapT<MapTypeT, TraitsT>::fromFollyDynamic(
     const folly::dynamic& nodesJson) {
   auto nodeMap = std::make_shared<MapTypeT>();
-  auto entries = nodesJson[kEntries];
-  for (const auto& entry : entries) {
-    nodeMap->addNode(Node::fromFollyDynamic(entry));
+  const auto& entries = nodesJson[kEntries];
+  for (const auto& node : fromFollyDynamicArrayParallel<Node>(entries)) {
+    nodeMap->addNode(node);
   }
   nodeMap->writableExtraFields() =
       ExtraFields::fromFollyDynamic(nodesJson[kExtraFields]);
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/ParallelSerialization.h"
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+DEFINE_uint32(
+    state_serialization_threads,
+    1,
+    "Threads used to serialize and deserialize large switch state subtrees, "
+    "e.g. for warm boot and state dumps. 1 does all the work on the calling "
+    "thread");
+
+namespace {
+
+folly::CPUThreadPoolExecutor* serializationExecutor(uint32_t numThreads) {
+  // Leaked on purpose, state may still be dumped while exiting
+  static auto executor = new folly::CPUThreadPoolExecutor(
+      numThreads,
+      std::make_shared<folly::NamedThreadFactory>("StateSerialization"));
+  if (executor->numThreads() != numThreads) {
+    executor->setNumThreads(numThreads);
+  }
+  return executor;
+}
+
+struct Chunks {
+  std::atomic<size_t> next{0};
+  std::mutex lock;
+  std::condition_variable allDone;
+  size_t done{0};
+  std::exception_ptr error;
+};
+
+} // namespace
+
+namespace facebook::fboss {
+
+void forEachChunkParallel(
+    size_t size,
+    size_t minChunkSize,
+    const std::function<void(size_t begin, size_t end)>& fn) {
+  const auto numThreads = FLAGS_state_serialization_threads;
+  const auto numChunks = std::min<size_t>(
+      numThreads, size / std::max<size_t>(minChunkSize, 1));
+  if (numChunks <= 1) {
+    if (size) {
+      fn(0, size);
+    }
+    return;
+  }
+
+  // Tasks may outlive this call, once all chunks are claimed they return
+  // without touching fn
+  auto chunks = std::make_shared<Chunks>();
+  auto runChunks = [chunks, numChunks, size, &fn]() {
+    size_t chunk;
+    while ((chunk = chunks->next.fetch_add(1)) < numChunks) {
+      std::exception_ptr error;
+      try {
+        fn(chunk * size / numChunks, (chunk + 1) * size / numChunks);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> g(chunks->lock);
+      if (error && !chunks->error) {
+        chunks->error = error;
+      }
+      if (++chunks->done == numChunks) {
+        chunks->allDone.notify_all();
+      }
+    }
+  };
+  auto executor = serializationExecutor(numThreads);
+  for (size_t i = 1; i < numChunks; ++i) {
+    executor->add(runChunks);
+  }
+  runChunks();
+
+  std::unique_lock<std::mutex> lock(chunks->lock);
+  chunks->allDone.wait(lock, [&] { return chunks->done == numChunks; });
+  if (chunks->error) {
+    std::rethrow_exception(chunks->error);
+  }
+}
+
+} // namespace facebook::fboss
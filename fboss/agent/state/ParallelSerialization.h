@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/dynamic.h>
+#include <gflags/gflags.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+DECLARE_uint32(state_serialization_threads);
+
+namespace facebook::fboss {
+
+/*
+ * Helpers to serialize and deserialize large SwitchState subtrees (routes,
+ * neighbor and MAC tables, ACLs ...) in parallel, on a process wide executor
+ * bounded to --state_serialization_threads threads. With the default of a
+ * single thread all the work runs on the calling thread, as before.
+ */
+
+// Entries below which splitting a map across threads isn't worth it
+constexpr size_t kMinParallelSerializationChunk = 1024;
+
+/*
+ * Split [0, size) in up to --state_serialization_threads chunks of at least
+ * minChunkSize entries and call fn(begin, end) for each of them, in
+ * parallel. Returns once all chunks are done, rethrowing the first exception
+ * thrown by fn.
+ *
+ * Calls may be nested: the calling thread runs chunks itself until none is
+ * left and only then waits for the ones other threads picked up, so nested
+ * calls never wait on work queued behind them.
+ */
+void forEachChunkParallel(
+    size_t size,
+    size_t minChunkSize,
+    const std::function<void(size_t begin, size_t end)>& fn);
+
+// folly::dynamic array of nodeToJson(i) for i in [0, size)
+template <typename NodeToJson>
+folly::dynamic toFollyDynamicArrayParallel(
+    size_t size,
+    const NodeToJson& nodeToJson) {
+  folly::dynamic json = folly::dynamic::array;
+  if (FLAGS_state_serialization_threads <= 1 ||
+      size < 2 * kMinParallelSerializationChunk) {
+    for (size_t i = 0; i < size; ++i) {
+      json.push_back(nodeToJson(i));
+    }
+    return json;
+  }
+  std::vector<folly::dynamic> nodesJson(size);
+  forEachChunkParallel(
+      size, kMinParallelSerializationChunk, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i) {
+          nodesJson[i] = nodeToJson(i);
+        }
+      });
+  for (auto& nodeJson : nodesJson) {
+    json.push_back(std::move(nodeJson));
+  }
+  return json;
+}
+
+// Node::fromFollyDynamic of every entry of a folly::dynamic array, in order
+template <typename Node>
+std::vector<std::shared_ptr<Node>> fromFollyDynamicArrayParallel(
+    const folly::dynamic& entries) {
+  std::vector<std::shared_ptr<Node>> nodes(entries.size());
+  forEachChunkParallel(
+      entries.size(),
+      kMinParallelSerializationChunk,
+      [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i) {
+          nodes[i] = Node::fromFollyDynamic(entries[i]);
+        }
+      });
+  return nodes;
+}
+
+} // namespace facebook::fboss
@@ -10,6 +10,7 @@
 #include "RouteTableRib.h"
 
 #include "fboss/agent/state/NodeMap-defs.h"
+#include "fboss/agent/state/ParallelSerialization.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteTable.h"
 #include "fboss/agent/state/SwitchState.h"
@@ -47,12 +48,12 @@ FBOSS_INSTANTIATE_NODE_MAP(
 
 template <typename AddrT>
 folly::dynamic RouteTableRib<AddrT>::toFollyDynamic() const {
-  folly::dynamic routesJson = folly::dynamic::array;
-  for (const auto& route : *nodeMap_) {
-    routesJson.push_back(route->toFollyDynamic());
-  }
+  const auto& nodes = nodeMap_->getAllNodes();
   folly::dynamic routes = folly::dynamic::object;
-  routes[kRoutes] = std::move(routesJson);
+  routes[kRoutes] =
+      toFollyDynamicArrayParallel(nodes.size(), [&nodes](size_t i) {
+        return nodes.nth(i)->second->toFollyDynamic();
+      });
   return routes;
 }
 
@@ -60,9 +61,9 @@ template <typename AddrT>
 std::shared_ptr<RouteTableRib<AddrT>> RouteTableRib<AddrT>::fromFollyDynamic(
     const folly::dynamic& routes) {
   auto rib = std::make_shared<RouteTableRib<AddrT>>();
-  auto routesJson = routes[kRoutes];
-  for (const auto& routeJson : routesJson) {
-    auto route = Route<AddrT>::fromFollyDynamic(routeJson);
+  const auto& routesJson = routes[kRoutes];
+  for (const auto& route :
+       fromFollyDynamicArrayParallel<Route<AddrT>>(routesJson)) {
     rib->addRoute(route);
     rib->addRouteInRadixTree(route);
   }
@@ -81,17 +82,12 @@ RouteTableRib<AddrT>* RouteTableRib<AddrT>::modify(
       (*state)->getRouteTables()->getRouteTable(id);
   RouteTable* clonedRouteTable = routeTable->modify(state);
 
-  auto clonedRib = this->clone();
-  // Generate the radix tree from the cloned nodeMap_. Remember, we haven't
-  // clone every route yet. So we will still use the old route pointer.
   // Right now only revertNewRouteEntry() needs modify(). The expected result of
   // modify() is that we have a cloned RouteTableRib return if the current one
-  // is published. To make sure the cloned RouteTableRib works, we need to
-  // ensure radixTree_ and nodeMap_ in sync before we return a newly cloned rib.
-  for (const auto& node : nodeMap_->getAllNodes()) {
-    clonedRib->radixTree_.insert(
-        node.first.network, node.first.mask, node.second);
-  }
+  // is published, with radixTree_ and nodeMap_ in sync. clone() shares the
+  // radixTree_ of this rib, which is in sync since this rib is published, so
+  // there is no need to rebuild it.
+  auto clonedRib = this->clone();
   CHECK_EQ(clonedRib->size(), clonedRib->radixTree_.size());
 
   auto clonedRibPtr = clonedRib.get();
@@ -14,7 +14,7 @@
 #include "fboss/agent/state/NodeMap.h"
 #include "fboss/agent/state/RouteTypes.h"
 #include "fboss/agent/types.h"
-#include "fboss/lib/RadixTree.h"
+#include "fboss/lib/PersistentRadixTree.h"
 
 namespace facebook::fboss {
 
@@ -77,8 +77,8 @@ class RouteTableRib : public NodeBase {
 
   using Prefix = RoutePrefix<AddrT>;
   using RouteType = Route<AddrT>;
-  using RoutesRadixTree =
-      facebook::network::RadixTree<AddrT, std::shared_ptr<Route<AddrT>>>;
+  using RoutesRadixTree = facebook::network::
+      PersistentRadixTree<AddrT, std::shared_ptr<Route<AddrT>>>;
 
   bool empty() const {
     return nodeMap_->empty();
@@ -109,15 +109,16 @@ class RouteTableRib : public NodeBase {
     // In this clone(), we make sure the root RouteTableRib version increased by
     // 1. And then we use the default NodeMap clone() to clone the childNode
     // `nodeMap_`, so we don't have to clone every route in `nodeMap_`.
-    // Besides, we don't clone the RadixTree. So that, we can just add/update/
-    // remove routes on nodeMap_ and then call
-    // `cloneToRadixTreeWithForwardClear()` to build the whole radixTree_
-    // after all the changes.
+    // The RadixTree is persistent, so copying it is O(1) and shares all of
+    // its nodes with this rib. Callers changing routes on nodeMap_ apply the
+    // same change through *InRadixTree(), which only copies the nodes on the
+    // path to the route.
     auto routeTableRib =
         std::make_shared<RouteTableRib>(getNodeID(), getGeneration() + 1);
     // Note: this is the default NodeMap clone(), only the nodeMap pointer is
     // cloned, while all the routes are still the old route pointer.
     routeTableRib->nodeMap_ = nodeMap_->clone();
+    routeTableRib->radixTree_ = radixTree_;
     return routeTableRib;
   }
 
@@ -143,7 +144,8 @@ class RouteTableRib : public NodeBase {
    * The following functions modify the static state.
    * These should only be called on unpublished objects which are only visible
    * to a single thread.
-   * To add/update/remove a route, we only do it on nodeMap_
+   * To add/update/remove a route, we only do it on nodeMap_. Callers keep
+   * radixTree_ in sync through the *InRadixTree() functions below.
    */
   void addRoute(const std::shared_ptr<Route<AddrT>>& route);
   void updateRoute(const std::shared_ptr<Route<AddrT>>& route);
@@ -152,21 +154,6 @@ class RouteTableRib : public NodeBase {
     return nodeMap_->getRouteIf(prefix);
   }
 
-  void cloneToRadixTreeWithForwardClear() {
-    // We should expect this function is called only before we publish the rib
-    CHECK(!isPublished());
-    radixTree_.clear();
-    for (const auto& node : nodeMap_->getAllNodes()) {
-      auto route = node.second;
-      if (route->isPublished()) {
-        route = route->clone(RouteType::Fields::COPY_PREFIX_AND_NEXTHOPS);
-      }
-      route->clearForward();
-      radixTree_.insert(node.first.network, node.first.mask, route);
-    }
-    CHECK_EQ(size(), radixTree_.size());
-  }
-
   // STRONGLY RECOMMEND to use routes() which returns the NodeMap
   // routesRadixTree() should only be used in the unit test to check whether
   // noddeMap_ and radixTree_ in sync
@@ -183,10 +170,21 @@ class RouteTableRib : public NodeBase {
     return citr != radixTree_.end() ? citr->value() : nullptr;
   }
 
+  // Batch longestMatch, results are in the same order as addrs
+  std::vector<std::shared_ptr<Route<AddrT>>> longestMatch(
+      folly::Range<const AddrT*> addrs) const {
+    auto matches = radixTree_.longestMatch(addrs);
+    std::vector<std::shared_ptr<Route<AddrT>>> routes;
+    routes.reserve(matches.size());
+    for (auto match : matches) {
+      routes.push_back(match ? match->value() : nullptr);
+    }
+    return routes;
+  }
+
   void addRouteInRadixTree(const std::shared_ptr<Route<AddrT>>& route) {
     auto inserted =
-        radixTree_.insert(route->prefix().network, route->prefix().mask, route)
-            .second;
+        radixTree_.insert(route->prefix().network, route->prefix().mask, route);
     if (!inserted) {
       throw FbossError(
           "Add failed, prefix for: ",
@@ -195,15 +193,14 @@ class RouteTableRib : public NodeBase {
     }
   }
   void updateRouteInRadixTree(const std::shared_ptr<Route<AddrT>>& route) {
-    auto itr =
-        radixTree_.exactMatch(route->prefix().network, route->prefix().mask);
-    if (itr == radixTree_.end()) {
+    auto updated =
+        radixTree_.update(route->prefix().network, route->prefix().mask, route);
+    if (!updated) {
       throw FbossError(
           "Update failed, prefix for: ",
           route->str(),
           " not present in RadixTree");
     }
-    itr->value() = route;
   }
   void removeRouteInRadixTree(const std::shared_ptr<Route<AddrT>>& route) {
     auto erased =
@@ -124,6 +124,7 @@ void RouteUpdater::addRouteImpl(
       newRoute = old->clone(
           RouteFields<typename PrefixT::AddressT>::COPY_PREFIX_AND_NEXTHOPS);
       rib->updateRoute(newRoute);
+      rib->updateRouteInRadixTree(newRoute);
     } else {
       newRoute = old;
     }
@@ -132,6 +133,7 @@ void RouteUpdater::addRouteImpl(
   } else {
     auto newRoute = make_shared<RouteT>(prefix, clientId, std::move(entry));
     rib->addRoute(newRoute);
+    rib->addRouteInRadixTree(newRoute);
     XLOG(DBG3) << "Added route " << newRoute->str();
   }
 }
@@ -198,6 +200,7 @@ void RouteUpdater::delRouteImpl(
   if (old->isPublished()) {
     old = old->clone();
     rib->updateRoute(old);
+    rib->updateRouteInRadixTree(old);
   }
   old->delEntryForClient(clientId);
   // TODO Do I need to publish the change??
@@ -205,6 +208,8 @@ void RouteUpdater::delRouteImpl(
              << " from route " << prefix.str();
   if (old->hasNoEntry()) {
     rib->removeRoute(old);
+    rib->removeRouteInRadixTree(old);
+    ribCloned->removed.push_back(prefix);
     XLOG(DBG3) << "...and then deleted route " << prefix.str();
   }
 }
@@ -235,9 +240,13 @@ void RouteUpdater::removeAllRoutesForClientImpl(
   CHECK(ribCloned->cloned);
   for (auto& routeNode : rib->writableRoutes()->writableNodes()) {
     auto route = routeNode.second;
+    if (!route->getEntryForClient(clientId)) {
+      continue;
+    }
     if (route->isPublished()) {
       route = route->clone();
       routeNode.second = route;
+      rib->updateRouteInRadixTree(route);
     }
     route->delEntryForClient(clientId);
     if (route->hasNoEntry()) {
@@ -249,6 +258,8 @@ void RouteUpdater::removeAllRoutesForClientImpl(
   // Now, delete whatever routes went from 1 nexthoplist to 0.
   for (std::shared_ptr<Route<AddrT>>& route : routesToDelete) {
     rib->removeRoute(route);
+    rib->removeRouteInRadixTree(route);
+    ribCloned->removed.push_back(route->prefix());
   }
 }
 
@@ -604,41 +615,138 @@ void RouteUpdater::resolveOne(RouteT* route, ClonedRib* ribCloned) {
              << " route " << route->str();
 }
 
-void RouteUpdater::resolve() {
-  // First, we need to make sure every route of the changed rib is cloned
-  // and the RadixTree of this changed rib is also generated.
-  // The reason why we have to do the same for-loop separately is because the
-  // resolveOne needs radixTree_ to find nexthop, so we have to build the tree
-  // before resolveOne().
-  for (auto& ribCloned : clonedRibs_) {
-    if (ribCloned.second.v4.cloned) {
-      ribCloned.second.v4.rib->cloneToRadixTreeWithForwardClear();
+namespace {
+/*
+ * Prefixes of a vrf whose route was added, changed or removed, or whose
+ * forwarding info has to be resolved again.
+ */
+struct ChangedPrefixes {
+  void add(const RoutePrefixV4& prefix) {
+    v4.insert(prefix.network, prefix.mask, true);
+  }
+  void add(const RoutePrefixV6& prefix) {
+    v6.insert(prefix.network, prefix.mask, true);
+  }
+  bool covers(const folly::IPAddress& addr) const {
+    if (addr.isV4()) {
+      return v4.longestMatch(addr.asV4(), addr.bitCount()) != v4.end();
+    }
+    return v6.longestMatch(addr.asV6(), addr.bitCount()) != v6.end();
+  }
+
+  facebook::network::PersistentRadixTree<IPAddressV4, bool> v4;
+  facebook::network::PersistentRadixTree<IPAddressV6, bool> v6;
+};
+
+/*
+ * Whether resolving route looks up a next hop covered by a changed prefix
+ */
+template <typename RouteT>
+bool hasChangedNextHop(const RouteT& route, const ChangedPrefixes& changed) {
+  const auto bestEntry = route.getBestEntry().second;
+  const auto action = bestEntry->getAction();
+  if (action == RouteForwardAction::DROP ||
+      action == RouteForwardAction::TO_CPU) {
+    return false;
+  }
+  for (const auto& nh : bestEntry->getNextHopSet()) {
+    // Next hops with an interface are resolved without a lookup
+    if (!nh.intfID().has_value() && changed.covers(nh.addr())) {
+      return true;
     }
-    if (ribCloned.second.v6.cloned) {
-      ribCloned.second.v6.rib->cloneToRadixTreeWithForwardClear();
+  }
+  return false;
+}
+
+/*
+ * Clear the forwarding info of the routes added or changed in this rib, and
+ * record them as well as the removed ones in changed.
+ */
+template <typename RibT>
+void clearChangedRoutes(RibT* ribCloned, ChangedPrefixes* changed) {
+  for (const auto& prefix : ribCloned->removed) {
+    changed->add(prefix);
+  }
+  for (const auto& route : *ribCloned->rib->routes()) {
+    // Routes are only cloned when they are added or changed
+    if (!route->isPublished()) {
+      route->clearForward();
+      changed->add(route->prefix());
     }
   }
+}
 
-  // Ideally, just need to resolve the routes that is changed or impacted by
-  // the changed routes.
-  // However, Without copy-on-write RadixTree, it is O(n) to find out the
-  // routes that are changed. In this case, we just simply loop through all
-  // routes and resolve those that are not resolved yet.
-  // TODO(joseph5wu) T23364375 will try to improve it in the future.
+/*
+ * Clear the forwarding info of the routes with a next hop covered by a
+ * changed prefix, and add their prefixes to changed. Returns whether any
+ * route was cleared.
+ */
+template <typename AddrT, typename RibT>
+bool clearDependentRoutes(RibT* ribCloned, ChangedPrefixes* changed) {
+  auto rib = ribCloned->rib.get();
+  std::vector<std::shared_ptr<Route<AddrT>>> dependents;
+  for (const auto& route : *rib->routes()) {
+    if (!route->needResolve() && hasChangedNextHop(*route, *changed)) {
+      dependents.push_back(route);
+    }
+  }
+  for (auto& route : dependents) {
+    if (route->isPublished()) {
+      route = route->clone();
+      rib->updateRoute(route);
+      rib->updateRouteInRadixTree(route);
+    }
+    route->clearForward();
+    changed->add(route->prefix());
+  }
+  return !dependents.empty();
+}
+} // namespace
+
+void RouteUpdater::resolve() {
+  // The radix tree of a changed rib is kept in sync with its nodeMap_ by
+  // every change above, and shares all untouched nodes with the original
+  // rib. Only the routes whose forwarding info may have changed are resolved
+  // again: the ones added or changed by this update, and the ones with a
+  // next hop covered by one of those or by a removed route, recursively.
+  // Everything else keeps its forwarding info and stays shared as well.
   for (auto& ribCloned : clonedRibs_) {
-    if (ribCloned.second.v4.cloned) {
-      auto rib = ribCloned.second.v4.rib.get();
-      for (auto& routeNode : rib->writableRoutesRadixTree()) {
-        if (routeNode.value()->needResolve()) {
-          resolveOne(routeNode.value().get(), &ribCloned.second);
+    auto& rib = ribCloned.second;
+    if (!rib.v4.cloned && !rib.v6.cloned) {
+      continue;
+    }
+
+    ChangedPrefixes changed;
+    if (rib.v4.cloned) {
+      clearChangedRoutes(&rib.v4, &changed);
+    }
+    if (rib.v6.cloned) {
+      clearChangedRoutes(&rib.v6, &changed);
+    }
+    bool cleared = true;
+    while (cleared) {
+      cleared = false;
+      if (rib.v4.cloned) {
+        cleared |= clearDependentRoutes<IPAddressV4>(&rib.v4, &changed);
+      }
+      if (rib.v6.cloned) {
+        cleared |= clearDependentRoutes<IPAddressV6>(&rib.v6, &changed);
+      }
+    }
+
+    // resolveOne() looks next hops up in the radix trees, which hold the
+    // cleared routes by now
+    if (rib.v4.cloned) {
+      for (const auto& route : *rib.v4.rib->routes()) {
+        if (route->needResolve()) {
+          resolveOne(route.get(), &rib);
         }
       }
     }
-    if (ribCloned.second.v6.cloned) {
-      auto rib = ribCloned.second.v6.rib.get();
-      for (auto& routeNode : rib->writableRoutesRadixTree()) {
-        if (routeNode.value()->needResolve()) {
-          resolveOne(routeNode.value().get(), &ribCloned.second);
+    if (rib.v6.cloned) {
+      for (const auto& route : *rib.v6.rib->routes()) {
+        if (route->needResolve()) {
+          resolveOne(route.get(), &rib);
         }
       }
     }
@@ -736,11 +844,12 @@ bool RouteUpdater::dedupRoutes(const RibT* oldRib, RibT* newRib) {
       isSame = false;
       continue;
     }
-    auto& newRoute = newIter->value();
+    auto newRoute = newIter->value();
     if (oldRoute->isSame(newRoute.get())) {
       // both routes are completely same, instead of using the new route,
       // we re-use the old route. First update oldRoute to radixTree_
-      newIter->value() = oldRoute;
+      newRoutes.update(
+          oldRoute->prefix().network, oldRoute->prefix().mask, oldRoute);
       // we also need to update the nodeMap_
       newRib->updateRoute(oldRoute);
     } else {
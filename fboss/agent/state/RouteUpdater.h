@@ -103,10 +103,14 @@ class RouteUpdater {
     struct RibV4 {
       std::shared_ptr<RouteTableRibV4> rib;
       bool cloned{false};
+      // Prefixes removed from rib, routes resolved through them are
+      // resolved again
+      std::vector<PrefixV4> removed;
     } v4;
     struct RibV6 {
       std::shared_ptr<RouteTableRibV6> rib;
       bool cloned{false};
+      std::vector<PrefixV6> removed;
     } v6;
   };
   boost::container::flat_map<RouterID, ClonedRib> clonedRibs_;
@@ -130,7 +134,7 @@ class RouteUpdater {
   template <typename AddrT, typename RibT>
   void removeAllRoutesForClientImpl(RibT* ribCloned, ClientID clientId);
 
-  // resolve all routes that are not resolved yet
+  // resolve the routes of changed ribs that may resolve differently now
   void resolve();
   template <typename RouteT>
   void resolveOne(RouteT* route, ClonedRib* clonedRib);
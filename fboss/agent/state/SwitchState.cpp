@@ -18,6 +18,7 @@
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/InterfaceMap.h"
 #include "fboss/agent/state/LabelForwardingInformationBase.h"
+#include "fboss/agent/state/ParallelSerialization.h"
 #include "fboss/agent/state/Port.h"
 #include "fboss/agent/state/PortMap.h"
 #include "fboss/agent/state/QosPolicyMap.h"
@@ -30,6 +31,9 @@
 
 #include "fboss/agent/state/NodeBase-defs.h"
 
+#include <functional>
+#include <vector>
+
 using std::make_shared;
 using std::shared_ptr;
 using std::chrono::seconds;
@@ -84,79 +88,142 @@ SwitchStateFields::SwitchStateFields()
       switchSettings(make_shared<SwitchSettings>()) {}
 
 folly::dynamic SwitchStateFields::toFollyDynamic() const {
-  folly::dynamic switchState = folly::dynamic::object;
-  switchState[kInterfaces] = interfaces->toFollyDynamic();
-  switchState[kPorts] = ports->toFollyDynamic();
-  switchState[kVlans] = vlans->toFollyDynamic();
-  switchState[kRouteTables] = routeTables->toFollyDynamic();
-  switchState[kAcls] = acls->toFollyDynamic();
-  switchState[kSflowCollectors] = sFlowCollectors->toFollyDynamic();
-  switchState[kDefaultVlan] = static_cast<uint32_t>(defaultVlan);
-  switchState[kControlPlane] = controlPlane->toFollyDynamic();
-  switchState[kLoadBalancers] = loadBalancers->toFollyDynamic();
-  switchState[kMirrors] = mirrors->toFollyDynamic();
-  switchState[kAggregatePorts] = aggPorts->toFollyDynamic();
-  switchState[kLabelForwardingInformationBase] = labelFib->toFollyDynamic();
-  switchState[kSwitchSettings] = switchSettings->toFollyDynamic();
+  // Top level maps are independent, so they are serialized in parallel
+  std::vector<std::pair<const char*, std::function<folly::dynamic()>>> maps = {
+      {kInterfaces, [this] { return interfaces->toFollyDynamic(); }},
+      {kPorts, [this] { return ports->toFollyDynamic(); }},
+      {kVlans, [this] { return vlans->toFollyDynamic(); }},
+      {kRouteTables, [this] { return routeTables->toFollyDynamic(); }},
+      {kAcls, [this] { return acls->toFollyDynamic(); }},
+      {kSflowCollectors, [this] { return sFlowCollectors->toFollyDynamic(); }},
+      {kControlPlane, [this] { return controlPlane->toFollyDynamic(); }},
+      {kLoadBalancers, [this] { return loadBalancers->toFollyDynamic(); }},
+      {kMirrors, [this] { return mirrors->toFollyDynamic(); }},
+      {kAggregatePorts, [this] { return aggPorts->toFollyDynamic(); }},
+      {kLabelForwardingInformationBase,
+       [this] { return labelFib->toFollyDynamic(); }},
+      {kSwitchSettings, [this] { return switchSettings->toFollyDynamic(); }},
+      {kQosPolicies, [this] { return qosPolicies->toFollyDynamic(); }},
+  };
   if (qcmCfg) {
-    switchState[kQcmCfg] = qcmCfg->toFollyDynamic();
+    maps.emplace_back(kQcmCfg, [this] { return qcmCfg->toFollyDynamic(); });
   }
   if (bufferPoolCfgs) {
-    switchState[kBufferPoolCfgs] = bufferPoolCfgs->toFollyDynamic();
+    maps.emplace_back(
+        kBufferPoolCfgs, [this] { return bufferPoolCfgs->toFollyDynamic(); });
   }
   if (defaultDataPlaneQosPolicy) {
-    switchState[kDefaultDataplaneQosPolicy] =
-        defaultDataPlaneQosPolicy->toFollyDynamic();
+    maps.emplace_back(kDefaultDataplaneQosPolicy, [this] {
+      return defaultDataPlaneQosPolicy->toFollyDynamic();
+    });
+  }
+  std::vector<folly::dynamic> mapsJson(maps.size());
+  forEachChunkParallel(maps.size(), 1, [&](size_t begin, size_t end) {
+    for (auto i = begin; i < end; ++i) {
+      mapsJson[i] = maps[i].second();
+    }
+  });
+
+  folly::dynamic switchState = folly::dynamic::object;
+  for (size_t i = 0; i < maps.size(); ++i) {
+    switchState[maps[i].first] = std::move(mapsJson[i]);
   }
-  switchState[kQosPolicies] = qosPolicies->toFollyDynamic();
+  switchState[kDefaultVlan] = static_cast<uint32_t>(defaultVlan);
   return switchState;
 }
 
 SwitchStateFields SwitchStateFields::fromFollyDynamic(
     const folly::dynamic& swJson) {
   SwitchStateFields switchState;
-  switchState.interfaces = InterfaceMap::fromFollyDynamic(swJson[kInterfaces]);
-  switchState.ports = PortMap::fromFollyDynamic(swJson[kPorts]);
-  switchState.vlans = VlanMap::fromFollyDynamic(swJson[kVlans]);
-  switchState.routeTables =
-      RouteTableMap::fromFollyDynamic(swJson[kRouteTables]);
-  switchState.acls = AclMap::fromFollyDynamic(swJson[kAcls]);
+  auto has = [&swJson](const char* key) {
+    return swJson.find(key) != swJson.items().end();
+  };
+  // Each of these sets a different field, so they can run in parallel
+  std::vector<std::function<void()>> maps = {
+      [&] {
+        switchState.interfaces =
+            InterfaceMap::fromFollyDynamic(swJson[kInterfaces]);
+      },
+      [&] { switchState.ports = PortMap::fromFollyDynamic(swJson[kPorts]); },
+      [&] { switchState.vlans = VlanMap::fromFollyDynamic(swJson[kVlans]); },
+      [&] {
+        switchState.routeTables =
+            RouteTableMap::fromFollyDynamic(swJson[kRouteTables]);
+      },
+      [&] { switchState.acls = AclMap::fromFollyDynamic(swJson[kAcls]); },
+  };
   if (swJson.count(kSflowCollectors) > 0) {
-    switchState.sFlowCollectors =
-        SflowCollectorMap::fromFollyDynamic(swJson[kSflowCollectors]);
+    maps.emplace_back([&] {
+      switchState.sFlowCollectors =
+          SflowCollectorMap::fromFollyDynamic(swJson[kSflowCollectors]);
+    });
   }
-  switchState.defaultVlan = VlanID(swJson[kDefaultVlan].asInt());
-  if (swJson.find(kQosPolicies) != swJson.items().end()) {
-    switchState.qosPolicies =
-        QosPolicyMap::fromFollyDynamic(swJson[kQosPolicies]);
+  if (has(kQosPolicies)) {
+    maps.emplace_back([&] {
+      switchState.qosPolicies =
+          QosPolicyMap::fromFollyDynamic(swJson[kQosPolicies]);
+    });
   }
-  if (swJson.find(kControlPlane) != swJson.items().end()) {
-    switchState.controlPlane =
-        ControlPlane::fromFollyDynamic(swJson[kControlPlane]);
+  if (has(kControlPlane)) {
+    maps.emplace_back([&] {
+      switchState.controlPlane =
+          ControlPlane::fromFollyDynamic(swJson[kControlPlane]);
+    });
   }
-  if (swJson.find(kLoadBalancers) != swJson.items().end()) {
-    switchState.loadBalancers =
-        LoadBalancerMap::fromFollyDynamic(swJson[kLoadBalancers]);
+  if (has(kLoadBalancers)) {
+    maps.emplace_back([&] {
+      switchState.loadBalancers =
+          LoadBalancerMap::fromFollyDynamic(swJson[kLoadBalancers]);
+    });
   }
-  if (swJson.find(kMirrors) != swJson.items().end()) {
-    switchState.mirrors = MirrorMap::fromFollyDynamic(swJson[kMirrors]);
+  if (has(kMirrors)) {
+    maps.emplace_back([&] {
+      switchState.mirrors = MirrorMap::fromFollyDynamic(swJson[kMirrors]);
+    });
   }
-  if (swJson.find(kAggregatePorts) != swJson.items().end()) {
-    switchState.aggPorts =
-        AggregatePortMap::fromFollyDynamic(swJson[kAggregatePorts]);
+  if (has(kAggregatePorts)) {
+    maps.emplace_back([&] {
+      switchState.aggPorts =
+          AggregatePortMap::fromFollyDynamic(swJson[kAggregatePorts]);
+    });
   }
-  if (swJson.find(kLabelForwardingInformationBase) != swJson.items().end()) {
-    switchState.labelFib = LabelForwardingInformationBase::fromFollyDynamic(
-        swJson[kLabelForwardingInformationBase]);
+  if (has(kLabelForwardingInformationBase)) {
+    maps.emplace_back([&] {
+      switchState.labelFib = LabelForwardingInformationBase::fromFollyDynamic(
+          swJson[kLabelForwardingInformationBase]);
+    });
   }
-  if (swJson.find(kSwitchSettings) != swJson.items().end()) {
-    switchState.switchSettings =
-        SwitchSettings::fromFollyDynamic(swJson[kSwitchSettings]);
+  if (has(kSwitchSettings)) {
+    maps.emplace_back([&] {
+      switchState.switchSettings =
+          SwitchSettings::fromFollyDynamic(swJson[kSwitchSettings]);
+    });
   }
+  if (has(kDefaultDataplaneQosPolicy)) {
+    maps.emplace_back([&] {
+      switchState.defaultDataPlaneQosPolicy =
+          QosPolicy::fromFollyDynamic(swJson[kDefaultDataplaneQosPolicy]);
+    });
+  }
+  if (has(kQcmCfg)) {
+    maps.emplace_back([&] {
+      switchState.qcmCfg = QcmCfg::fromFollyDynamic(swJson[kQcmCfg]);
+    });
+  }
+  if (has(kBufferPoolCfgs)) {
+    maps.emplace_back([&] {
+      switchState.bufferPoolCfgs =
+          BufferPoolCfgMap::fromFollyDynamic(swJson[kBufferPoolCfgs]);
+    });
+  }
+  forEachChunkParallel(maps.size(), 1, [&](size_t begin, size_t end) {
+    for (auto i = begin; i < end; ++i) {
+      maps[i]();
+    }
+  });
+  switchState.defaultVlan = VlanID(swJson[kDefaultVlan].asInt());
 
-  if (swJson.find(kDefaultDataplaneQosPolicy) != swJson.items().end()) {
-    switchState.defaultDataPlaneQosPolicy =
-        QosPolicy::fromFollyDynamic(swJson[kDefaultDataplaneQosPolicy]);
+  if (switchState.defaultDataPlaneQosPolicy) {
     auto name = switchState.defaultDataPlaneQosPolicy->getName();
     /* for backward compatibility, this policy is also kept in qos policy map.
      * remove it, if it exists */
@@ -165,14 +232,6 @@ SwitchStateFields SwitchStateFields::fromFollyDynamic(
     switchState.qosPolicies->removeNodeIf(name);
   }
 
-  if (swJson.find(kQcmCfg) != swJson.items().end()) {
-    switchState.qcmCfg = QcmCfg::fromFollyDynamic(swJson[kQcmCfg]);
-  }
-  if (swJson.find(kBufferPoolCfgs) != swJson.items().end()) {
-    switchState.bufferPoolCfgs =
-        BufferPoolCfgMap::fromFollyDynamic(swJson[kBufferPoolCfgs]);
-  }
-
   // TODO verify that created state here is internally consistent t4155406
   return switchState;
 }
@@ -189,6 +189,38 @@ TEST_F(ForwardingInformationBaseV6Test, DecreasingLPMSequence) {
   }
 }
 
+TEST_F(ForwardingInformationBaseV4Test, BatchLPM) {
+  // Unsorted, with a repeated address and one without any match
+  std::vector<folly::IPAddressV4> addresses{
+      folly::IPAddressV4("161.16.8.1"),
+      folly::IPAddressV4("0.0.0.0"),
+      folly::IPAddressV4("192.0.0.0"),
+      folly::IPAddressV4("64.1.0.1"),
+      folly::IPAddressV4("0.0.0.0")};
+  auto routes = fib.longestMatch(folly::crange(addresses));
+  ASSERT_EQ(routes.size(), addresses.size());
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    EXPECT_EQ(routes[i], fib.longestMatch(addresses[i]));
+  }
+  EXPECT_EQ(nullptr, routes[2]);
+  std::vector<folly::IPAddressV4> none;
+  EXPECT_TRUE(fib.longestMatch(folly::crange(none)).empty());
+}
+
+TEST_F(ForwardingInformationBaseV6Test, BatchLPM) {
+  std::vector<folly::IPAddressV6> addresses{
+      folly::IPAddressV6("A110:801::"),
+      folly::IPAddressV6("C000::"),
+      folly::IPAddressV6("4001:1::"),
+      folly::IPAddressV6("::")};
+  auto routes = fib.longestMatch(folly::crange(addresses));
+  ASSERT_EQ(routes.size(), addresses.size());
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    EXPECT_EQ(routes[i], fib.longestMatch(addresses[i]));
+  }
+  EXPECT_EQ(nullptr, routes[1]);
+}
+
 TEST(ForwardingInformationBaseV4, IPv4DefaultPrefixComparesSmallest) {
   ForwardingInformationBaseV4 oldFib;
   ForwardingInformationBaseV4 newFib;
@@ -421,6 +421,74 @@ TEST(Route, resolve) {
   }
 }
 
+// Only routes resolved through a changed route are resolved again
+TEST(Route, resolveChangedRoutesOnly) {
+  auto stateV1 = applyInitConfig();
+  ASSERT_NE(nullptr, stateV1);
+  auto rid = RouterID(0);
+
+  RouteUpdater u1(stateV1->getRouteTables());
+  u1.addRoute(
+      rid,
+      IPAddress("10.0.0.0"),
+      24,
+      CLIENT_A,
+      RouteNextHopEntry(makeNextHops({"1.1.1.10"}), DISTANCE));
+  u1.addRoute(
+      rid,
+      IPAddress("20.0.0.0"),
+      24,
+      CLIENT_A,
+      RouteNextHopEntry(makeNextHops({"2.2.2.10"}), DISTANCE));
+  // resolved through 10.0.0.0/24
+  u1.addRoute(
+      rid,
+      IPAddress("30.0.0.0"),
+      24,
+      CLIENT_A,
+      RouteNextHopEntry(makeNextHops({"10.0.0.1"}), DISTANCE));
+  auto tables1 = u1.updateDone();
+  ASSERT_NE(nullptr, tables1);
+  tables1->publish();
+  auto r130 = GET_ROUTE_V4(tables1, rid, "30.0.0.0/24");
+  EXPECT_RESOLVED(r130);
+  EXPECT_FWD_INFO(r130, InterfaceID(1), "1.1.1.10");
+
+  // Move 10.0.0.0/24 to interface 2
+  RouteUpdater u2(tables1);
+  u2.addRoute(
+      rid,
+      IPAddress("10.0.0.0"),
+      24,
+      CLIENT_A,
+      RouteNextHopEntry(makeNextHops({"2.2.2.11"}), DISTANCE));
+  auto tables2 = u2.updateDone();
+  ASSERT_NE(nullptr, tables2);
+  EXPECT_NODEMAP_MATCH(tables2);
+  tables2->publish();
+  auto r230 = GET_ROUTE_V4(tables2, rid, "30.0.0.0/24");
+  EXPECT_RESOLVED(r230);
+  EXPECT_FWD_INFO(r230, InterfaceID(2), "2.2.2.11");
+  // Routes not resolved through the changed one are left alone
+  EXPECT_EQ(
+      GET_ROUTE_V4(tables1, rid, "20.0.0.0/24"),
+      GET_ROUTE_V4(tables2, rid, "20.0.0.0/24"));
+  // The published table still resolves through the old route
+  EXPECT_FWD_INFO(r130, InterfaceID(1), "1.1.1.10");
+  EXPECT_NODEMAP_MATCH(tables1);
+
+  // Removing 10.0.0.0/24 leaves 30.0.0.0/24 without a route to its next hop
+  RouteUpdater u3(tables2);
+  u3.delRoute(rid, IPAddress("10.0.0.0"), 24, CLIENT_A);
+  auto tables3 = u3.updateDone();
+  ASSERT_NE(nullptr, tables3);
+  EXPECT_NODEMAP_MATCH(tables3);
+  auto r330 = GET_ROUTE_V4(tables3, rid, "30.0.0.0/24");
+  ASSERT_NE(nullptr, r330);
+  EXPECT_FALSE(r330->isResolved());
+  EXPECT_TRUE(r330->isUnresolvable());
+}
+
 TEST(Route, resolveDropToCPUMix) {
   auto stateV1 = applyInitConfig();
   ASSERT_NE(nullptr, stateV1);
@@ -1389,6 +1457,13 @@ TEST(Route, PruneAddedRoutes) {
           prefix1.network);
   ASSERT_EQ(nullptr, remainingRouteEntry);
   EXPECT_NODEMAP_MATCH(state3->getRouteTables());
+  // The pruned rib started out sharing the radix tree of the published one,
+  // which must not see the removal
+  EXPECT_EQ(
+      newRouteEntry,
+      state2->getRouteTables()->getRouteTable(rid0)->getRibV4()->longestMatch(
+          prefix1.network));
+  EXPECT_NODEMAP_MATCH(state2->getRouteTables());
 }
 
 // Test that pruning of changed routes happens correctly.
@@ -10,6 +10,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 #include "fboss/agent/AlpmUtils.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteTable.h"
@@ -86,4 +88,24 @@ TEST(AlpmUtilsTests, minAlpmV6RouteCount) {
   EXPECT_EQ(1, numMinAlpmV6Routes());
 }
 
+TEST(AlpmUtilsTests, alpmAddOrder) {
+  using PrefixV6 = RoutePrefix<IPAddressV6>;
+  std::vector<PrefixV6> prefixes{
+      {IPAddressV6("2401:db00::"), 32},
+      {IPAddressV6("2401:db00:1::"), 64},
+      {IPAddressV6("::"), 0},
+      {IPAddressV6("2401:db00::"), 64},
+      {IPAddressV6("2401:db00::1"), 128},
+  };
+  std::sort(prefixes.begin(), prefixes.end(), alpmAddOrderLess<PrefixV6>);
+  std::vector<PrefixV6> expected{
+      {IPAddressV6("::"), 0},
+      {IPAddressV6("2401:db00::1"), 128},
+      {IPAddressV6("2401:db00::"), 64},
+      {IPAddressV6("2401:db00:1::"), 64},
+      {IPAddressV6("2401:db00::"), 32},
+  };
+  EXPECT_EQ(expected, prefixes);
+}
+
 } // namespace facebook::fboss
@@ -11,6 +11,9 @@
 
 #include <folly/Benchmark.h>
 #include <folly/Memory.h>
+#include <folly/futures/Future.h>
+#include "fboss/agent/ArpHandler.h"
+#include "fboss/agent/NeighborUpdater.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/TunManager.h"
 #include "fboss/agent/hw/mock/MockRxPacket.h"
@@ -21,6 +24,7 @@
 #include "fboss/agent/state/SwitchState.h"
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/state/VlanMap.h"
+#include "fboss/agent/test/TestUtils.h"
 
 using namespace facebook::fboss;
 using folly::IPAddress;
@@ -38,6 +42,9 @@ unique_ptr<SwSwitch> sw;
 unique_ptr<MockRxPacket> arpRequest_10_0_0_1;
 unique_ptr<MockRxPacket> arpRequest_10_0_0_5;
 
+// Number of new hosts resolved at once by the neighbor burst benchmarks
+constexpr auto kNeighborBurst = 5000;
+
 unique_ptr<SwSwitch> setupSwitch() {
   MacAddress localMac("02:00:01:00:00:01");
   auto sw = make_unique<SwSwitch>(make_unique<SimPlatform>(localMac, 10));
@@ -65,6 +72,8 @@ unique_ptr<SwSwitch> setupSwitch() {
     Interface::Addresses addrs1;
     addrs1.emplace(IPAddress("10.0.0.1"), 24);
     addrs1.emplace(IPAddress("192.168.0.1"), 24);
+    // Large enough for the neighbor burst benchmarks
+    addrs1.emplace(IPAddress("10.1.0.1"), 16);
     intf1->setAddresses(addrs1);
     state->addIntf(intf1);
 
@@ -136,6 +145,47 @@ void init() {
   arpRequest_10_0_0_5->setSrcVlan(VlanID(1));
 }
 
+IPAddressV4 burstHost(int idx) {
+  return IPAddressV4::fromLongHBO(IPAddressV4("10.1.0.2").toLongHBO() + idx);
+}
+
+/*
+ * A rack of new hosts coming up at once, e.g. after a rack reboot. Traffic
+ * towards every host is punted and a probe sent, which adds a pending entry,
+ * then all hosts reply.
+ */
+void neighborBurst(size_t numIters, int batchWindowMs) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_neighbor_batch_window_ms = batchWindowMs;
+  auto updater = sw->getNeighborUpdater();
+  auto port = PortDescriptor(PortID(1));
+
+  for (size_t n = 0; n < numIters; ++n) {
+    for (auto i = 0; i < kNeighborBurst; ++i) {
+      updater->sentArpRequest(VlanID(1), burstHost(i));
+    }
+    for (auto i = 0; i < kNeighborBurst; ++i) {
+      updater->receivedArpMine(
+          VlanID(1),
+          burstHost(i),
+          MacAddress::fromHBO(0x020000100000 + i),
+          port,
+          ARP_OP_REPLY);
+    }
+    updater->waitForPendingUpdates();
+    waitForStateUpdates(sw.get());
+
+    BENCHMARK_SUSPEND {
+      std::vector<folly::Future<uint32_t>> flushed;
+      for (auto i = 0; i < kNeighborBurst; ++i) {
+        flushed.push_back(updater->flushEntry(VlanID(1), burstHost(i)));
+      }
+      folly::collectAll(flushed).get();
+      waitForStateUpdates(sw.get());
+    }
+  }
+}
+
 } // unnamed namespace
 
 BENCHMARK(ArpRequest, numIters) {
@@ -176,6 +226,14 @@ BENCHMARK(ArpRequestNotMine, numIters) {
   }
 }
 
+BENCHMARK(NeighborBurst, numIters) {
+  neighborBurst(numIters, 0);
+}
+
+BENCHMARK_RELATIVE(NeighborBurstBatched, numIters) {
+  neighborBurst(numIters, 10);
+}
+
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
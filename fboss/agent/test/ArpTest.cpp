@@ -992,6 +992,69 @@ TEST(ArpTest, PendingArpCleanup) {
   }
 }
 
+TEST(ArpTest, BatchedNeighborUpdates) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_neighbor_batch_window_ms = 1000;
+  FLAGS_neighbor_batch_max_entries = 20;
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+  auto updater = sw->getNeighborUpdater();
+  VlanID vlanID(1);
+  auto host = [](int idx) {
+    return IPAddressV4::fromLongHBO(
+        IPAddressV4("10.0.0.10").toLongHBO() + idx);
+  };
+  auto hostMac = [](int idx) {
+    return MacAddress::fromHBO(0x020000000100 + idx);
+  };
+  constexpr auto kNumHosts = 50;
+
+  // Pending entries are applied 20 at a time, and every batch must be seen
+  // by the HwSwitch
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(3);
+  for (auto i = 0; i < kNumHosts; ++i) {
+    updater->sentArpRequest(vlanID, host(i));
+  }
+  updater->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+  for (auto i = 0; i < kNumHosts; ++i) {
+    auto entry = getArpEntry(sw, host(i), vlanID);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_TRUE(entry->isPending());
+  }
+
+  // Resolved entries may be coalesced with each other
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(testing::Between(1, 3));
+  for (auto i = 0; i < kNumHosts; ++i) {
+    updater->receivedArpMine(
+        vlanID, host(i), hostMac(i), PortDescriptor(PortID(1)), ARP_OP_REPLY);
+  }
+  updater->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+  for (auto i = 0; i < kNumHosts; ++i) {
+    auto entry = getArpEntry(sw, host(i), vlanID);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_FALSE(entry->isPending());
+    EXPECT_EQ(entry->getMac(), hostMac(i));
+  }
+
+  // A host resolving while its pending entry is still queued: the pending
+  // entry is applied on its own first
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(2);
+  updater->sentArpRequest(vlanID, host(kNumHosts));
+  updater->receivedArpMine(
+      vlanID,
+      host(kNumHosts),
+      hostMac(kNumHosts),
+      PortDescriptor(PortID(1)),
+      ARP_OP_REPLY);
+  updater->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+  auto entry = getArpEntry(sw, host(kNumHosts), vlanID);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_FALSE(entry->isPending());
+}
+
 TEST(ArpTest, ArpTableSerialization) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
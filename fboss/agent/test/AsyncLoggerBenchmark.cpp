@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/AsyncLogger.h"
+
+#include <folly/Benchmark.h>
+#include "common/init/Init.h"
+
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+
+constexpr auto kBenchmarkLog = "/tmp/async_logger_benchmark";
+constexpr auto kLogTimeout = 100;
+// Roughly the size of one traced SAI call
+constexpr auto kRecordSize = 128;
+
+/*
+ * One iteration is one appendLog() call, spread over numThreads producers
+ * logging concurrently.
+ */
+void appendLogBenchmark(uint32_t iters, int numThreads) {
+  folly::BenchmarkSuspender suspender;
+  AsyncLogger logger(kBenchmarkLog, kLogTimeout);
+  logger.startFlushThread();
+  std::string record(kRecordSize - 1, '.');
+  record.push_back('\n');
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads);
+  suspender.dismiss();
+
+  for (auto i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&logger, &record, iters, numThreads]() {
+      for (uint32_t j = 0; j < iters / numThreads; ++j) {
+        logger.appendLog(record.c_str(), record.size());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  suspender.rehire();
+  logger.stopFlushThread();
+  std::remove(kBenchmarkLog);
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(appendLogBenchmark, 1_thread, 1)
+BENCHMARK_NAMED_PARAM(appendLogBenchmark, 4_threads, 4)
+BENCHMARK_NAMED_PARAM(appendLogBenchmark, 16_threads, 16)
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -10,9 +10,16 @@
 
 #include "fboss/agent/AsyncLogger.h"
 
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/String.h>
 #include <gtest/gtest.h>
 #include <stdio.h>
 
+#include <thread>
+#include <vector>
+
 #define TEST_LOG "/tmp/sai_logger_test"
 
 // Test string size that's larger than half of the buffer,
@@ -122,3 +129,100 @@ TEST_F(AsyncLoggerTest, concurrentWaitTest) {
   // Therefore, the flush count should be equal or greater than two.
   EXPECT_GE(asyncLogger->flushCount_, 2);
 }
+
+TEST_F(AsyncLoggerTest, multiProducerOrderTest) {
+  auto constexpr kNumThreads = 4;
+  auto constexpr kRecordsPerThread = 1000;
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      for (auto j = 0; j < kRecordsPerThread; ++j) {
+        auto record = folly::sformat("{} {}\n", i, j);
+        asyncLogger->appendLog(record.c_str(), record.size());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  asyncLogger->forceFlush();
+  EXPECT_EQ(asyncLogger->droppedRecords(), 0);
+
+  // Every record is written whole and in order for each producer
+  std::string contents;
+  ASSERT_TRUE(folly::readFile(TEST_LOG, contents));
+  std::vector<folly::StringPiece> lines;
+  folly::split('\n', folly::rtrimWhitespace(contents), lines);
+  EXPECT_EQ(lines.size(), kNumThreads * kRecordsPerThread);
+  std::vector<int> nextRecord(kNumThreads, 0);
+  for (auto line : lines) {
+    auto thread = folly::to<int>(line.split_step(' '));
+    auto record = folly::to<int>(line);
+    EXPECT_EQ(record, nextRecord[thread]++);
+  }
+}
+
+TEST_F(AsyncLoggerTest, stagingBufferOverflowTest) {
+  // Records that do not fit in the staging buffer are dropped and counted,
+  // the caller is never blocked. The long timeout keeps the flush thread
+  // from draining the staging buffer in between.
+  asyncLogger->stopFlushThread();
+  asyncLogger = std::make_unique<AsyncLogger>(TEST_LOG, 100000, 1024);
+  asyncLogger->startFlushThread();
+
+  std::string record(200, '.');
+  for (auto i = 0; i < 5; ++i) {
+    asyncLogger->appendLog(record.c_str(), record.size());
+  }
+  EXPECT_EQ(asyncLogger->droppedRecords(), 1);
+
+  // Records larger than the whole staging buffer are written directly,
+  // after what is already staged
+  std::string large(2048, '#');
+  asyncLogger->appendLog(large.c_str(), large.size());
+  EXPECT_EQ(asyncLogger->droppedRecords(), 1);
+
+  std::string contents;
+  ASSERT_TRUE(folly::readFile(TEST_LOG, contents));
+  std::string expected;
+  for (auto i = 0; i < 4; ++i) {
+    expected += record;
+  }
+  expected += large;
+  EXPECT_EQ(contents, expected);
+}
+
+TEST_F(AsyncLoggerTest, stopDrainTest) {
+  // Staged records are written out by stopFlushThread(), without waiting
+  // for a timeout
+  asyncLogger->stopFlushThread();
+  asyncLogger = std::make_unique<AsyncLogger>(TEST_LOG, 100000);
+  asyncLogger->startFlushThread();
+
+  std::string str = "TestString";
+  asyncLogger->appendLog(str.c_str(), str.size());
+  asyncLogger->stopFlushThread();
+
+  std::string contents;
+  ASSERT_TRUE(folly::readFile(TEST_LOG, contents));
+  EXPECT_EQ(contents, str);
+}
+
+TEST_F(AsyncLoggerTest, terminateDrainTest) {
+  // Records still in the staging buffers are written by terminate handler
+  auto constexpr kTerminateLog = "/tmp/sai_logger_terminate_test";
+  std::string str = "TestString";
+  EXPECT_DEATH(
+      {
+        AsyncLogger logger(kTerminateLog, 100000);
+        logger.startFlushThread();
+        logger.appendLog(str.c_str(), str.size());
+        std::terminate();
+      },
+      "");
+
+  std::string contents;
+  ASSERT_TRUE(folly::readFile(kTerminateLog, contents));
+  EXPECT_EQ(contents, str);
+  std::remove(kTerminateLog);
+}
@@ -0,0 +1,210 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/CpuPacketScheduler.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/ParsedPacketMeta.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/InterfaceMap.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+
+ParsedPacketMeta makeMeta(ETHERTYPE etherType) {
+  ParsedPacketMeta meta;
+  meta.etherType = static_cast<uint16_t>(etherType);
+  return meta;
+}
+
+ParsedPacketMeta
+makeIpMeta(ETHERTYPE etherType, IP_PROTO proto, uint8_t ttl = 64) {
+  auto meta = makeMeta(etherType);
+  meta.ipProto = static_cast<uint8_t>(proto);
+  meta.ttl = ttl;
+  return meta;
+}
+
+// One interface with 10.0.0.1/24, 2401:db00::1/64 and fe80::1/64, on VLAN 1
+std::shared_ptr<InterfaceMap> makeInterfaces() {
+  auto intf = std::make_shared<Interface>(
+      InterfaceID(1),
+      RouterID(0),
+      VlanID(1),
+      "intf1",
+      folly::MacAddress("02:00:00:00:00:01"),
+      9000,
+      false /* isVirtual */,
+      false /* isStateSyncDisabled */);
+  Interface::Addresses addrs;
+  addrs.emplace(folly::IPAddress("10.0.0.1"), 24);
+  addrs.emplace(folly::IPAddress("2401:db00::1"), 64);
+  addrs.emplace(folly::IPAddress("fe80::1"), 64);
+  intf->setAddresses(addrs);
+  auto interfaces = std::make_shared<InterfaceMap>();
+  interfaces->addInterface(intf);
+  return interfaces;
+}
+
+cfg::CpuPacketSchedulerConfig makeConfig(
+    cfg::CpuPacketClass packetClass,
+    int32_t packetsPerSec,
+    int32_t burstSize) {
+  cfg::CpuPacketRateLimit rateLimit;
+  rateLimit.packetsPerSec_ref() = packetsPerSec;
+  rateLimit.burstSize_ref() = burstSize;
+  cfg::CpuPacketSchedulerConfig config;
+  config.rateLimits_ref()[packetClass] = rateLimit;
+  return config;
+}
+
+} // namespace
+
+TEST(CpuPacketSchedulerTest, Classify) {
+  auto interfacesPtr = makeInterfaces();
+  const auto& interfaces = *interfacesPtr;
+  EXPECT_EQ(
+      cfg::CpuPacketClass::HIGH,
+      CpuPacketScheduler::classify(
+          makeMeta(ETHERTYPE::ETHERTYPE_SLOW_PROTOCOLS), interfaces));
+  EXPECT_EQ(
+      cfg::CpuPacketClass::HIGH,
+      CpuPacketScheduler::classify(
+          makeMeta(ETHERTYPE::ETHERTYPE_LLDP), interfaces));
+  EXPECT_EQ(
+      cfg::CpuPacketClass::NEIGHBOR,
+      CpuPacketScheduler::classify(
+          makeMeta(ETHERTYPE::ETHERTYPE_ARP), interfaces));
+  EXPECT_EQ(
+      cfg::CpuPacketClass::DEFAULT,
+      CpuPacketScheduler::classify(
+          makeMeta(ETHERTYPE::ETHERTYPE_MPLS), interfaces));
+
+  // Single hop BGP is high priority despite its TTL of 1
+  auto bgp = makeIpMeta(ETHERTYPE::ETHERTYPE_IPV6, IP_PROTO::IP_PROTO_TCP, 1);
+  bgp.srcL4Port = 12345;
+  bgp.dstL4Port = 179;
+  EXPECT_EQ(
+      cfg::CpuPacketClass::HIGH, CpuPacketScheduler::classify(bgp, interfaces));
+
+  auto ndp = makeIpMeta(
+      ETHERTYPE::ETHERTYPE_IPV6, IP_PROTO::IP_PROTO_IPV6_ICMP, 255);
+  ndp.icmpType = static_cast<uint8_t>(
+      ICMPv6Type::ICMPV6_TYPE_NDP_NEIGHBOR_SOLICITATION);
+  EXPECT_EQ(
+      cfg::CpuPacketClass::NEIGHBOR,
+      CpuPacketScheduler::classify(ndp, interfaces));
+
+  auto ping = makeIpMeta(
+      ETHERTYPE::ETHERTYPE_IPV6, IP_PROTO::IP_PROTO_IPV6_ICMP, 64);
+  ping.icmpType = static_cast<uint8_t>(ICMPv6Type::ICMPV6_TYPE_ECHO_REQUEST);
+  EXPECT_EQ(
+      cfg::CpuPacketClass::DEFAULT,
+      CpuPacketScheduler::classify(ping, interfaces));
+
+  // Expiring packets we would have to route
+  auto udp = makeIpMeta(ETHERTYPE::ETHERTYPE_IPV4, IP_PROTO::IP_PROTO_UDP, 1);
+  udp.dstIp = folly::IPAddress("10.0.1.1");
+  EXPECT_EQ(
+      cfg::CpuPacketClass::TTL_EXPIRED,
+      CpuPacketScheduler::classify(udp, interfaces));
+  udp.ttl = 2;
+  EXPECT_EQ(
+      cfg::CpuPacketClass::DEFAULT,
+      CpuPacketScheduler::classify(udp, interfaces));
+}
+
+TEST(CpuPacketSchedulerTest, ClassifyLowTtlForUs) {
+  auto interfacesPtr = makeInterfaces();
+  const auto& interfaces = *interfacesPtr;
+
+  // Packets to our addresses are handled by the host whatever their TTL
+  auto udp = makeIpMeta(ETHERTYPE::ETHERTYPE_IPV4, IP_PROTO::IP_PROTO_UDP, 1);
+  udp.dstIp = folly::IPAddress("10.0.0.1");
+  EXPECT_EQ(
+      cfg::CpuPacketClass::DEFAULT,
+      CpuPacketScheduler::classify(udp, interfaces));
+  auto udp6 =
+      makeIpMeta(ETHERTYPE::ETHERTYPE_IPV6, IP_PROTO::IP_PROTO_UDP, 1);
+  udp6.dstIp = folly::IPAddress("2401:db00::1");
+  EXPECT_EQ(
+      cfg::CpuPacketClass::DEFAULT,
+      CpuPacketScheduler::classify(udp6, interfaces));
+
+  // So is multicast on a VLAN with an interface
+  udp.dstIp = folly::IPAddress("224.0.0.5");
+  udp.vlan = VlanID(1);
+  EXPECT_EQ(
+      cfg::CpuPacketClass::DEFAULT,
+      CpuPacketScheduler::classify(udp, interfaces));
+  udp.vlan = VlanID(2);
+  EXPECT_EQ(
+      cfg::CpuPacketClass::TTL_EXPIRED,
+      CpuPacketScheduler::classify(udp, interfaces));
+
+  // Link local addresses only count on their own VLAN
+  udp6.dstIp = folly::IPAddress("fe80::1");
+  udp6.vlan = VlanID(1);
+  EXPECT_EQ(
+      cfg::CpuPacketClass::DEFAULT,
+      CpuPacketScheduler::classify(udp6, interfaces));
+  udp6.vlan = VlanID(2);
+  EXPECT_EQ(
+      cfg::CpuPacketClass::TTL_EXPIRED,
+      CpuPacketScheduler::classify(udp6, interfaces));
+}
+
+TEST(CpuPacketSchedulerTest, DisabledByDefault) {
+  CpuPacketScheduler scheduler;
+  EXPECT_FALSE(scheduler.enabled());
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_TRUE(scheduler.admit(cfg::CpuPacketClass::DEFAULT, PortID(1)));
+  }
+}
+
+TEST(CpuPacketSchedulerTest, RateLimitPerPort) {
+  CpuPacketScheduler scheduler;
+  // Low enough a rate that no tokens are added during the test
+  scheduler.setConfig(makeConfig(cfg::CpuPacketClass::TTL_EXPIRED, 1, 2));
+  EXPECT_TRUE(scheduler.enabled());
+
+  EXPECT_TRUE(scheduler.admit(cfg::CpuPacketClass::TTL_EXPIRED, PortID(1)));
+  EXPECT_TRUE(scheduler.admit(cfg::CpuPacketClass::TTL_EXPIRED, PortID(1)));
+  EXPECT_FALSE(scheduler.admit(cfg::CpuPacketClass::TTL_EXPIRED, PortID(1)));
+
+  // Each port has its own bucket
+  EXPECT_TRUE(scheduler.admit(cfg::CpuPacketClass::TTL_EXPIRED, PortID(2)));
+
+  // Classes without a limit are not affected
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_TRUE(scheduler.admit(cfg::CpuPacketClass::HIGH, PortID(1)));
+  }
+
+  // Removing the limit admits everything again
+  scheduler.setConfig(cfg::CpuPacketSchedulerConfig());
+  EXPECT_FALSE(scheduler.enabled());
+  EXPECT_TRUE(scheduler.admit(cfg::CpuPacketClass::TTL_EXPIRED, PortID(1)));
+}
+
+TEST(CpuPacketSchedulerTest, InvalidConfig) {
+  CpuPacketScheduler scheduler;
+  EXPECT_THROW(
+      scheduler.setConfig(makeConfig(cfg::CpuPacketClass::DEFAULT, 0, 10)),
+      FbossError);
+  EXPECT_THROW(
+      scheduler.setConfig(makeConfig(cfg::CpuPacketClass::DEFAULT, 10, -1)),
+      FbossError);
+  EXPECT_FALSE(scheduler.enabled());
+}
@@ -9,6 +9,7 @@
  */
 
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/IcmpErrorRateLimiter.h"
 #include "fboss/agent/IPv6Handler.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
@@ -464,6 +465,79 @@ TEST(ICMPTest, TTLExceededV4IPExtraOptions) {
   handle->rxPacket(std::make_unique<folly::IOBuf>(pkt), portID, vlanID);
 }
 
+TEST(ICMPTest, TTLExceededV4RateLimited) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_icmp_error_rate_limit = 1;
+  FLAGS_icmp_error_burst_size = 2;
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+
+  PortID portID(1);
+  VlanID vlanID(1);
+
+  const std::string ipHdr =
+      // Version(4), IHL(5), DSCP(7), ECN(1), Total Length(20+8+8=36)
+      "45 1d 00 24"
+      // Identification(0x3456), Flags(0x1), Fragment offset(0x1345)
+      "34 56 53 45"
+      // TTL(1), Protocol(11), Checksum (0x1234, fake)
+      "01 11 12 34"
+      // Source IP (1.2.3.4)
+      "01 02 03 04"
+      // Destination IP (10.1.0.10)
+      "0a 01 00 0a";
+
+  const std::string udpHdr =
+      // UDP
+      // Source port (69), destination port (70)
+      "00 45 00 46"
+      // Length (16), checksum (0x1234, faked)
+      "00 10 12 34";
+
+  const std::string payload = "01 02 03 04 05 06 07 08";
+
+  auto pkt = PktUtil::parseHexData(
+      // dst mac, src mac
+      "00 02 00 00 00 01  02 00 02 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00 00 01"
+      // IPv4
+      "08 00" +
+      ipHdr + udpHdr + payload);
+
+  auto icmpPayload = PktUtil::parseHexData(
+      // icmp padding for unused field
+      "00 00 00 00" + ipHdr + udpHdr + payload);
+
+  CounterCache counters(sw);
+
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(0);
+  EXPECT_PLATFORM_CALL(sw, getLocalMac()).WillRepeatedly(Return(kPlatformMac));
+
+  // Only the first burst of errors to 1.2.3.4 is sent
+  EXPECT_SWITCHED_PKT(
+      sw,
+      "ICMP TTL Exceeded",
+      checkICMPv4TTLExceeded(
+          kPlatformMac,
+          IPAddressV4("10.0.0.1"),
+          kPlatformMac,
+          IPAddressV4("1.2.3.4"),
+          VlanID(1),
+          icmpPayload.data(),
+          32))
+      .Times(2);
+
+  for (auto i = 0; i < 3; ++i) {
+    handle->rxPacket(std::make_unique<folly::IOBuf>(pkt), portID, vlanID);
+  }
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "ipv4.ttl_exceeded.sum", 3);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "icmp.error.suppressed.sum", 1);
+}
+
 TEST(ICMPTest, ExtraFrameCheckSequenceAtEnd) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
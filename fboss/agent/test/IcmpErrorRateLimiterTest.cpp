@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/IcmpErrorRateLimiter.h"
+
+#include "fboss/agent/packet/ICMPHdr.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+
+namespace {
+
+const auto kTimeExceeded =
+    static_cast<uint8_t>(ICMPv4Type::ICMPV4_TYPE_TIME_EXCEEDED);
+const auto kUnreachable =
+    static_cast<uint8_t>(ICMPv4Type::ICMPV4_TYPE_DESTINATION_UNREACHABLE);
+
+} // namespace
+
+TEST(IcmpErrorRateLimiterTest, Unlimited) {
+  IcmpErrorRateLimiter limiter(0, 1);
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_TRUE(limiter.admit(IPAddress("10.0.0.1"), kTimeExceeded));
+  }
+}
+
+TEST(IcmpErrorRateLimiterTest, Burst) {
+  // Low enough a rate that no tokens are added during the test
+  IcmpErrorRateLimiter limiter(1, 3);
+  IPAddress dst("2401:db00::1");
+  for (auto i = 0; i < 3; ++i) {
+    EXPECT_TRUE(limiter.admit(dst, kTimeExceeded));
+  }
+  EXPECT_FALSE(limiter.admit(dst, kTimeExceeded));
+
+  // Other types and destinations have their own buckets
+  EXPECT_TRUE(limiter.admit(dst, kUnreachable));
+  EXPECT_TRUE(limiter.admit(IPAddress("2401:db00::2"), kTimeExceeded));
+}
+
+TEST(IcmpErrorRateLimiterTest, ZeroBurst) {
+  // A burst of 0 still lets one error through
+  IcmpErrorRateLimiter limiter(1, 0);
+  EXPECT_TRUE(limiter.admit(IPAddress("10.0.0.1"), kTimeExceeded));
+  EXPECT_FALSE(limiter.admit(IPAddress("10.0.0.1"), kTimeExceeded));
+}
@@ -213,8 +213,13 @@ class LookupClassRouteUpdaterTest : public ::testing::Test {
   }
 
   void removeNeighbor(const AddrT& ip) {
+    removeNeighbors({ip});
+  }
+
+  // Removes all the neighbors in a single state update
+  void removeNeighbors(const std::vector<AddrT>& ips) {
     this->updateState(
-        "Add new route", [=](const std::shared_ptr<SwitchState>& state) {
+        "Remove neighbors", [=](const std::shared_ptr<SwitchState>& state) {
           auto newState = state->clone();
 
           VlanID vlanId = newState->getInterfaces()
@@ -224,7 +229,9 @@ class LookupClassRouteUpdaterTest : public ::testing::Test {
           auto* neighborTable =
               vlan->template getNeighborEntryTable<AddrT>().get()->modify(
                   &vlan, &newState);
-          neighborTable->removeEntry(ip);
+          for (const auto& ip : ips) {
+            neighborTable->removeEntry(ip);
+          }
           return newState;
         });
     waitForStateUpdates(this->sw_);
@@ -447,6 +454,26 @@ TYPED_TEST(LookupClassRouteUpdaterTest, VerifyNeighborAddAndRemove) {
   this->verifyClassIDHelper(this->kroutePrefix2(), std::nullopt);
 }
 
+TYPED_TEST(LookupClassRouteUpdaterTest, RemoveNeighborsInSingleDelta) {
+  this->addRoute(
+      this->kroutePrefix1(), {this->kIpAddressA(), this->kIpAddressB()});
+  this->addRoute(
+      this->kroutePrefix2(), {this->kIpAddressB(), this->kIpAddressC()});
+  this->resolveNeighbor(this->kIpAddressA(), this->kMacAddressA());
+  this->resolveNeighbor(this->kIpAddressB(), this->kMacAddressB());
+  this->verifyClassIDHelper(
+      this->kroutePrefix1(), cfg::AclLookupClass::CLASS_QUEUE_PER_HOST_QUEUE_0);
+  this->verifyClassIDHelper(
+      this->kroutePrefix2(), cfg::AclLookupClass::CLASS_QUEUE_PER_HOST_QUEUE_1);
+
+  // Both removals are processed as part of the same delta, so classID
+  // updates for r1 and r2 are coalesced into one state update. Neither route
+  // is left with a resolved nexthop.
+  this->removeNeighbors({this->kIpAddressA(), this->kIpAddressB()});
+  this->verifyClassIDHelper(this->kroutePrefix1(), std::nullopt);
+  this->verifyClassIDHelper(this->kroutePrefix2(), std::nullopt);
+}
+
 // Test cases verifying Port changes
 
 TYPED_TEST(LookupClassRouteUpdaterTest, PortLookupClassesToNoLookupClasses) {
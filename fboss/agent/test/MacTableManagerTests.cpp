@@ -18,6 +18,13 @@
 #include "fboss/agent/test/TestUtils.h"
 
 #include <folly/MacAddress.h>
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <thread>
+
+DECLARE_bool(l2_learning_batching);
+DECLARE_int32(l2_learning_batch_window_ms);
 
 namespace facebook::fboss {
 
@@ -65,7 +72,24 @@ class MacTableManagerTest : public ::testing::Test {
         facebook::fboss::L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE);
   }
 
-  void verifyMacIsAdded() {
+  /*
+   * Send a learn or age event without waiting for it to be applied
+   */
+  void sendMacCb(PortID port, L2EntryUpdateType l2EntryUpdateType) {
+    auto l2Entry = L2Entry(
+        kMacAddress(),
+        kVlan(),
+        PortDescriptor(port),
+        L2Entry::L2EntryType::L2_ENTRY_TYPE_PENDING);
+    sw_->l2LearningUpdateReceived(l2Entry, l2EntryUpdateType);
+  }
+
+  void waitForMacCbs() {
+    waitForBackgroundThread(sw_);
+    waitForStateUpdates(sw_);
+  }
+
+  void verifyMacIsAdded(PortID port) {
     verifyStateUpdate([=]() {
       auto vlan = sw_->getState()->getVlans()->getVlan(kVlan());
       auto* macTable = vlan->getMacTable().get();
@@ -73,10 +97,14 @@ class MacTableManagerTest : public ::testing::Test {
 
       EXPECT_NE(nullptr, node);
       EXPECT_EQ(kMacAddress(), node->getMac());
-      EXPECT_EQ(kPortID(), node->getPort().phyPortID());
+      EXPECT_EQ(port, node->getPort().phyPortID());
     });
   }
 
+  void verifyMacIsAdded() {
+    verifyMacIsAdded(kPortID());
+  }
+
   void verifyMacIsDeleted() {
     verifyStateUpdate([=]() {
       auto vlan = sw_->getState()->getVlans()->getVlan(kVlan());
@@ -142,4 +170,47 @@ TEST_F(MacTableManagerTest, SameMacAgedCbTwice) {
   verifyMacIsDeleted();
 }
 
+TEST_F(MacTableManagerTest, BatchedMacMoves) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_l2_learning_batching = true;
+  FLAGS_l2_learning_batch_window_ms = 0;
+
+  // Learned, moved twice and learned again on the last port, applied as
+  // one update
+  sendMacCb(PortID(1), L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  sendMacCb(PortID(2), L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  sendMacCb(PortID(3), L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  sendMacCb(PortID(3), L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  waitForMacCbs();
+
+  verifyMacIsAdded(PortID(3));
+}
+
+TEST_F(MacTableManagerTest, BatchedMacMovedAndAged) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_l2_learning_batching = true;
+  FLAGS_l2_learning_batch_window_ms = 0;
+
+  triggerMacLearnedCb();
+  // The move must still be applied for the age event to remove the entry
+  sendMacCb(PortID(2), L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  sendMacCb(PortID(2), L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE);
+  waitForMacCbs();
+
+  verifyMacIsDeleted();
+}
+
+TEST_F(MacTableManagerTest, BatchedMacLearnedAfterWindow) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_l2_learning_batching = true;
+  FLAGS_l2_learning_batch_window_ms = 10;
+
+  sendMacCb(kPortID(), L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+  // Let the batching window expire before waiting for the update
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  waitForMacCbs();
+
+  verifyMacIsAdded();
+}
+
 } // namespace facebook::fboss
@@ -1,11 +1,13 @@
 #include "fboss/agent/MirrorManager.h"
 #include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/MirrorMap.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteUpdater.h"
 #include "fboss/agent/state/SwitchState.h"
 #include "fboss/agent/test/HwTestHandle.h"
 #include "fboss/agent/test/TestUtils.h"
 
+#include <folly/Conv.h>
 #include <folly/IPAddress.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
@@ -23,6 +25,8 @@ namespace facebook::fboss {
 
 namespace {
 constexpr auto kMirrorName = "mirror";
+constexpr auto kNumScaleMirrors = 500;
+constexpr auto kNumScaleNeighbors = 20'000;
 constexpr AdminDistance DISTANCE = AdminDistance::STATIC_ROUTE;
 const PortID kMirrorEgressPort{5};
 
@@ -92,6 +96,15 @@ MirrorManagerTestParams<folly::IPAddressV6>::getParams() {
       {IPAddressV6("2401:db00:2110:10::1000"), 127},
       {IPAddressV6("2401:db00:2110:10::0000"), 64});
 }
+
+// Address with the lowest 16 bits of base replaced by offset
+template <typename AddrT>
+AddrT addressAt(const AddrT& base, uint16_t offset) {
+  auto bytes = base.toByteArray();
+  bytes[bytes.size() - 2] = offset >> 8;
+  bytes[bytes.size() - 1] = offset & 0xff;
+  return AddrT::fromBinary(folly::ByteRange(bytes.data(), bytes.size()));
+}
 } // namespace
 
 template <typename AddrT>
@@ -1312,4 +1325,124 @@ TYPED_TEST(MirrorManagerTest, UpdateRoute) {
     EXPECT_EQ(egressPort, params.neighborPorts[0]);
   });
 }
+
+TYPED_TEST(MirrorManagerTest, ScaleIncrementalResolution) {
+  const auto params = MirrorManagerTestParams<TypeParam>::getParams();
+  auto mirrorName = [](int i) { return folly::to<std::string>("mirror", i); };
+  // Mirror destinations sit in the shorter prefix, neighbors are unrelated
+  // to any mirror
+  auto mirrorDestination = [&](int i) {
+    return addressAt(params.shorterPrefix.network, 0x2000 + i);
+  };
+  auto neighborIp = [&](int i) {
+    return addressAt(params.neighborIPs[0], 0x8000 + i);
+  };
+
+  this->updateState(
+      "add mirrors", [=](const std::shared_ptr<SwitchState>& state) {
+        auto updatedState = this->addNeighbor(
+            state,
+            params.interfaces[0],
+            params.neighborIPs[0],
+            params.neighborMACs[0],
+            params.neighborPorts[0]);
+        updatedState = this->addNeighbor(
+            updatedState,
+            params.interfaces[1],
+            params.neighborIPs[1],
+            params.neighborMACs[1],
+            params.neighborPorts[1]);
+        RouteNextHopSet nextHops = {params.nextHop(0), params.nextHop(1)};
+        updatedState =
+            this->addRoute(updatedState, params.shorterPrefix, nextHops);
+        for (auto i = 0; i < kNumScaleMirrors; ++i) {
+          updatedState = this->addErspanMirror(
+              updatedState, mirrorName(i), mirrorDestination(i));
+        }
+        return updatedState;
+      });
+
+  uint64_t numResolved = 0;
+  std::shared_ptr<MirrorMap> mirrors;
+  this->verifyStateUpdate([&]() {
+    auto state = this->sw_->getState();
+    for (auto i = 0; i < kNumScaleMirrors; ++i) {
+      auto mirror = state->getMirrors()->getMirrorIf(mirrorName(i));
+      ASSERT_NE(mirror, nullptr);
+      EXPECT_TRUE(mirror->isResolved());
+    }
+    numResolved = this->sw_->getMirrorManager()->getNumMirrorsResolved();
+    mirrors = state->getMirrors();
+  });
+
+  // Neighbor churn no mirror depends on resolves nothing and must not
+  // produce a new mirror map
+  auto start = std::chrono::steady_clock::now();
+  this->updateState(
+      "add neighbors", [=](const std::shared_ptr<SwitchState>& state) {
+        auto updatedState = state;
+        for (auto i = 0; i < kNumScaleNeighbors; ++i) {
+          updatedState = this->addNeighbor(
+              updatedState,
+              params.interfaces[0],
+              neighborIp(i),
+              params.neighborMACs[0],
+              params.neighborPorts[0]);
+        }
+        return updatedState;
+      });
+  this->verifyStateUpdate([&]() {
+    auto state = this->sw_->getState();
+    EXPECT_EQ(
+        numResolved, this->sw_->getMirrorManager()->getNumMirrorsResolved());
+    EXPECT_EQ(mirrors, state->getMirrors());
+  });
+  XLOG(INFO) << "Applied " << kNumScaleNeighbors << " neighbors with "
+             << kNumScaleMirrors << " mirrors in "
+             << std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count()
+             << " ms";
+
+  // A more specific route for one mirror re-resolves that mirror only:
+  // once for the route change, once when applying the update and once for
+  // the resulting mirror change
+  this->updateState(
+      "add mirror route", [=](const std::shared_ptr<SwitchState>& state) {
+        RouteNextHopSet nextHops = {params.nextHop(1)};
+        return this->addRoute(
+            state,
+            RoutePrefix<TypeParam>{mirrorDestination(0), TypeParam::bitCount()},
+            nextHops);
+      });
+  this->verifyStateUpdate([&]() {
+    auto state = this->sw_->getState();
+    EXPECT_EQ(
+        numResolved + 3,
+        this->sw_->getMirrorManager()->getNumMirrorsResolved());
+    auto mirror = state->getMirrors()->getMirrorIf(mirrorName(0));
+    ASSERT_TRUE(mirror->getEgressPort().has_value());
+    EXPECT_EQ(mirror->getEgressPort().value(), params.neighborPorts[1]);
+    numResolved = this->sw_->getMirrorManager()->getNumMirrorsResolved();
+  });
+
+  // Removing the shared nexthop neighbor moves all other mirrors over
+  this->updateState(
+      "remove nexthop neighbor",
+      [=](const std::shared_ptr<SwitchState>& state) {
+        return this->delNeighbor(
+            state, params.interfaces[0], params.neighborIPs[0]);
+      });
+  this->verifyStateUpdate([&]() {
+    auto state = this->sw_->getState();
+    for (auto i = 0; i < kNumScaleMirrors; ++i) {
+      auto mirror = state->getMirrors()->getMirrorIf(mirrorName(i));
+      ASSERT_TRUE(mirror->getEgressPort().has_value());
+      EXPECT_EQ(mirror->getEgressPort().value(), params.neighborPorts[1]);
+    }
+    EXPECT_EQ(
+        numResolved + 3 * (kNumScaleMirrors - 1),
+        this->sw_->getMirrorManager()->getNumMirrorsResolved());
+  });
+}
 } // namespace facebook::fboss
@@ -0,0 +1,140 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/NetlinkBatch.h"
+#include "fboss/agent/NlError.h"
+
+extern "C" {
+#include <netlink/route/rule.h>
+}
+
+#include <folly/Conv.h>
+#include <folly/IPAddress.h>
+#include <folly/ScopeGuard.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+
+// Table reserved by TunManager for virtual interfaces, not used by the host
+constexpr auto kTableId = 250;
+
+/*
+ * Build a request deleting a source routing rule which does not exist. The
+ * kernel rejects it whether or not the test runs with CAP_NET_ADMIN, without
+ * changing the host.
+ */
+nl_msg* deleteMissingRule(int idx) {
+  auto addr = folly::IPAddress(folly::to<std::string>("2001:db8::", idx + 1));
+  auto rule = rtnl_rule_alloc();
+  SCOPE_EXIT {
+    rtnl_rule_put(rule);
+  };
+  rtnl_rule_set_family(rule, AF_INET6);
+  rtnl_rule_set_table(rule, kTableId);
+  rtnl_rule_set_action(rule, FR_ACT_TO_TBL);
+  auto src = nl_addr_build(
+      AF_INET6, const_cast<unsigned char*>(addr.bytes()), addr.byteCount());
+  SCOPE_EXIT {
+    nl_addr_put(src);
+  };
+  nl_addr_set_prefixlen(src, addr.bitCount());
+  rtnl_rule_set_src(rule, src);
+
+  nl_msg* msg{nullptr};
+  nlCheckError(rtnl_rule_build_delete_request(rule, 0, &msg), "build");
+  return msg;
+}
+
+class NetlinkBatchTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    sock_ = nl_socket_alloc();
+    ASSERT_NE(sock_, nullptr);
+    ASSERT_EQ(nl_connect(sock_, NETLINK_ROUTE), 0);
+  }
+  void TearDown() override {
+    nl_close(sock_);
+    nl_socket_free(sock_);
+  }
+
+ protected:
+  nl_sock* sock_{nullptr};
+};
+
+} // namespace
+
+TEST_F(NetlinkBatchTest, AllRequestsAcked) {
+  // Small chunks so that the requests span several sendmsg calls
+  NetlinkBatch batch(sock_, 256);
+  constexpr auto kNumRequests = 100;
+  for (auto i = 0; i < kNumRequests; ++i) {
+    batch.add(
+        deleteMissingRule(i),
+        folly::to<std::string>("remove missing rule ", i),
+        true /* ignoreError */);
+  }
+  EXPECT_EQ(batch.size(), kNumRequests);
+  // Every request gets a failed ACK, which must not be mistaken for the ACK
+  // of another request or left unread
+  EXPECT_NO_THROW(batch.flush());
+  EXPECT_TRUE(batch.empty());
+
+  // The socket is still usable once the batch is flushed
+  batch.add(deleteMissingRule(0), "remove missing rule", true);
+  EXPECT_NO_THROW(batch.flush());
+}
+
+TEST_F(NetlinkBatchTest, FailureThrownAfterBatch) {
+  NetlinkBatch batch(sock_);
+  batch.add(deleteMissingRule(0), "remove missing rule 0", true);
+  batch.add(deleteMissingRule(1), "remove missing rule 1");
+  batch.add(deleteMissingRule(2), "remove missing rule 2");
+  try {
+    batch.flush();
+    FAIL() << "flush did not throw";
+  } catch (const NlError& ex) {
+    EXPECT_NE(
+        std::string(ex.what()).find("remove missing rule 1"),
+        std::string::npos);
+  }
+  EXPECT_TRUE(batch.empty());
+}
+
+TEST_F(NetlinkBatchTest, ClearDropsRequests) {
+  NetlinkBatch batch(sock_);
+  batch.add(deleteMissingRule(0), "remove missing rule");
+  batch.clear();
+  EXPECT_TRUE(batch.empty());
+  EXPECT_NO_THROW(batch.flush());
+}
+
+TEST_F(NetlinkBatchTest, UndoFailedRequests) {
+  NetlinkBatch batch(sock_);
+  batch.add(deleteMissingRule(0), "remove missing rule 0");
+  // The undo fails as well, which is only logged
+  batch.setUndo(deleteMissingRule(1), "undo remove missing rule 0");
+  batch.add(deleteMissingRule(2), "remove missing rule 2", true);
+  batch.setUndo(deleteMissingRule(3), "undo remove missing rule 2");
+  try {
+    batch.flush();
+    FAIL() << "flush did not throw";
+  } catch (const NlError& ex) {
+    EXPECT_NE(
+        std::string(ex.what()).find("remove missing rule 0"),
+        std::string::npos);
+    EXPECT_EQ(std::string(ex.what()).find("undo"), std::string::npos);
+  }
+  EXPECT_TRUE(batch.empty());
+
+  // The ACKs of the undo requests were consumed as well
+  batch.add(deleteMissingRule(0), "remove missing rule", true);
+  EXPECT_NO_THROW(batch.flush());
+}
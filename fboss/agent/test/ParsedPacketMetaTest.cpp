@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/ParsedPacketMeta.h"
+
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPProto.h"
+
+#include <folly/MacAddress.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::MacAddress;
+
+namespace {
+
+std::unique_ptr<MockRxPacket> makePacket(folly::StringPiece hex) {
+  auto pkt = MockRxPacket::fromHex(hex);
+  pkt->padToLength(68);
+  pkt->setSrcPort(PortID(3));
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+
+} // unnamed namespace
+
+TEST(ParsedPacketMetaTest, TaggedIPv4Udp) {
+  auto pkt = makePacket(
+      // dst mac, src mac
+      "ff ff ff ff ff ff  00 02 00 01 02 03"
+      // 802.1q, VLAN 5
+      "81 00  00 05"
+      // IPv4, Version(4), IHL(5), DSCP, ECN, Total Length(28)
+      "08 00  45 00 00 1c"
+      // Id, Flags, frag offset, TTL, Protocol(UDP), checksum
+      "00 00 00 00  ff 11 00 00"
+      // Source IP (0.0.0.0), Destination IP (255.255.255.255)
+      "00 00 00 00  ff ff ff ff"
+      // UDP 68 -> 67, Length, checksum
+      "00 44  00 43  00 08  00 00");
+  auto meta = ParsedPacketMeta::parse(pkt.get(), nullptr);
+
+  EXPECT_EQ(MacAddress("ff:ff:ff:ff:ff:ff"), meta.dstMac);
+  EXPECT_EQ(MacAddress("00:02:00:01:02:03"), meta.srcMac);
+  EXPECT_EQ(static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV4), meta.etherType);
+  EXPECT_EQ(5, meta.vlanTag.value());
+  EXPECT_EQ(PortID(3), meta.port);
+  EXPECT_EQ(VlanID(1), meta.vlan);
+  EXPECT_EQ(18, meta.l3Offset);
+  ASSERT_TRUE(meta.hasL4());
+  EXPECT_EQ(38, meta.l4Offset);
+  EXPECT_EQ(static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP), meta.ipProto);
+  EXPECT_EQ(255, meta.ttl);
+  EXPECT_EQ(folly::IPAddress("255.255.255.255"), meta.dstIp);
+  EXPECT_EQ(68, meta.srcL4Port);
+  EXPECT_EQ(67, meta.dstL4Port);
+}
+
+TEST(ParsedPacketMetaTest, UntaggedIPv6Tcp) {
+  auto pkt = makePacket(
+      // dst mac, src mac
+      "02 00 01 00 00 01  00 02 00 01 02 03"
+      // IPv6, Version 6, traffic class, flow label
+      "86 dd  60 00 00 00"
+      // Payload length: 20, Next Header: 6 (TCP), Hop Limit (255)
+      "00 14  06 ff"
+      // src addr (2401:db00:2110:3001::f)
+      "24 01 db 00 21 10 30 01 00 00 00 00 00 00 00 0f"
+      // dst addr (2401:db00:2110:3001::1)
+      "24 01 db 00 21 10 30 01 00 00 00 00 00 00 00 01"
+      // TCP 54321 -> 179 (BGP)
+      "d4 31  00 b3");
+  auto meta = ParsedPacketMeta::parse(pkt.get(), nullptr);
+
+  EXPECT_EQ(static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV6), meta.etherType);
+  EXPECT_FALSE(meta.vlanTag.has_value());
+  EXPECT_EQ(14, meta.l3Offset);
+  ASSERT_TRUE(meta.hasL4());
+  EXPECT_EQ(54, meta.l4Offset);
+  EXPECT_EQ(static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP), meta.ipProto);
+  EXPECT_EQ(255, meta.ttl);
+  EXPECT_EQ(folly::IPAddress("2401:db00:2110:3001::1"), meta.dstIp);
+  EXPECT_EQ(54321, meta.srcL4Port);
+  EXPECT_EQ(179, meta.dstL4Port);
+}
+
+TEST(ParsedPacketMetaTest, Arp) {
+  auto pkt = makePacket(
+      // dst mac, src mac
+      "ff ff ff ff ff ff  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // ARP, htype: ethernet, ptype: IPv4, hlen: 6, plen: 4
+      "08 06  00 01  08 00  06  04");
+  auto meta = ParsedPacketMeta::parse(pkt.get(), nullptr);
+
+  EXPECT_EQ(static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_ARP), meta.etherType);
+  EXPECT_EQ(1, meta.vlanTag.value());
+  EXPECT_FALSE(meta.hasL4());
+  auto cursor = meta.l3Cursor(pkt.get());
+  EXPECT_EQ(1, cursor.readBE<uint16_t>());
+  EXPECT_EQ(0x0800, cursor.readBE<uint16_t>());
+}
+
+TEST(ParsedPacketMetaTest, IPv4HeaderPastEnd) {
+  auto pkt = MockRxPacket::fromHex(
+      // dst mac, src mac
+      "02 00 01 00 00 01  00 02 00 01 02 03"
+      // IPv4, Version(4), IHL(15), DSCP, ECN, Total Length(60)
+      "08 00  4f 00 00 3c"
+      // Id, Flags, frag offset, TTL, Protocol(TCP), checksum
+      "00 00 00 00  ff 06 00 00"
+      // Source IP, Destination IP, options cut short
+      "0a 00 00 0f  0a 00 00 01");
+  auto meta = ParsedPacketMeta::parse(pkt.get(), nullptr);
+
+  EXPECT_EQ(static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP), meta.ipProto);
+  EXPECT_EQ(folly::IPAddress("10.0.0.1"), meta.dstIp);
+  EXPECT_FALSE(meta.hasL4());
+  EXPECT_EQ(0, meta.srcL4Port);
+  EXPECT_EQ(0, meta.dstL4Port);
+}
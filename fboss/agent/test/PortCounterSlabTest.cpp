@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/PortCounterSlab.h"
+#include "fboss/agent/SwitchStats.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <thread>
+
+using namespace facebook::fboss;
+
+namespace {
+uint64_t counterValue(
+    const PortCounterRegistry& registry,
+    PortID port,
+    PortCounter counter) {
+  return registry.getCounters(port)[size_t(counter)];
+}
+
+std::map<std::string, uint64_t> exportedDeltas(PortCounterRegistry& registry) {
+  std::map<std::string, uint64_t> deltas;
+  registry.forEachCounterDelta(
+      [&deltas](const std::string& key, uint64_t delta) {
+        deltas[key] = delta;
+      });
+  return deltas;
+}
+} // namespace
+
+TEST(PortCounterSlabTest, MergeThreads) {
+  PortCounterRegistry registry;
+  registry.setPorts({{PortID(1), "eth1/1/1"}, {PortID(5), "eth1/2/1"}});
+
+  constexpr auto kThreads = 4;
+  constexpr auto kIncrements = 1000;
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&registry]() {
+      SwitchStats stats(&registry);
+      for (auto j = 0; j < kIncrements; ++j) {
+        stats.portCounter(PortID(1), PortCounter::TRAPPED_PKTS);
+        stats.portCounter(PortID(5), PortCounter::HOST_RX_BYTES, 10);
+      }
+      // Not in the index, ignored
+      stats.portCounter(PortID(2), PortCounter::TRAPPED_PKTS);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Counters of exited threads are kept
+  EXPECT_EQ(
+      counterValue(registry, PortID(1), PortCounter::TRAPPED_PKTS),
+      kThreads * kIncrements);
+  EXPECT_EQ(
+      counterValue(registry, PortID(5), PortCounter::HOST_RX_BYTES),
+      kThreads * kIncrements * 10);
+  EXPECT_EQ(counterValue(registry, PortID(2), PortCounter::TRAPPED_PKTS), 0);
+
+  // Only counters which went up are exported
+  auto deltas = exportedDeltas(registry);
+  EXPECT_EQ(deltas.size(), 2);
+  EXPECT_EQ(deltas["eth1/1/1.trapped.pkts"], kThreads * kIncrements);
+  EXPECT_EQ(deltas["eth1/2/1.host.rx.bytes"], kThreads * kIncrements * 10);
+
+  // Nothing new since the previous export
+  EXPECT_TRUE(exportedDeltas(registry).empty());
+}
+
+TEST(PortCounterSlabTest, PortsAddedAndRemoved) {
+  PortCounterRegistry registry;
+  registry.setPorts({{PortID(1), "eth1/1/1"}, {PortID(2), "eth1/1/2"}});
+  SwitchStats stats(&registry);
+  stats.portCounter(PortID(1), PortCounter::TRAPPED_DROPS, 3);
+  stats.portCounter(PortID(2), PortCounter::TRAPPED_DROPS, 4);
+
+  // Counters of ports still present carry over to the new slab
+  registry.setPorts({{PortID(1), "eth1/1/1"}, {PortID(3), "eth1/1/3"}});
+  stats.portCounter(PortID(1), PortCounter::TRAPPED_DROPS);
+  stats.portCounter(PortID(3), PortCounter::TRAPPED_DROPS);
+  EXPECT_EQ(counterValue(registry, PortID(1), PortCounter::TRAPPED_DROPS), 4);
+  EXPECT_EQ(counterValue(registry, PortID(2), PortCounter::TRAPPED_DROPS), 0);
+  EXPECT_EQ(counterValue(registry, PortID(3), PortCounter::TRAPPED_DROPS), 1);
+}
+
+TEST(PortCounterSlabTest, PortRenamed) {
+  PortCounterRegistry registry;
+  registry.setPorts({{PortID(1), "eth1/1/1"}, {PortID(2), ""}});
+  {
+    SwitchStats stats(&registry);
+    stats.portCounter(PortID(1), PortCounter::LINK_STATE_FLAPS, 2);
+    stats.portCounter(PortID(2), PortCounter::LINK_STATE_FLAPS);
+  }
+
+  // Ports without a name are not exported
+  auto deltas = exportedDeltas(registry);
+  EXPECT_EQ(deltas.size(), 1);
+  EXPECT_EQ(deltas["eth1/1/1.link_state.flap"], 2);
+
+  // Counts, including those of exited threads, follow the port. What was
+  // already exported under the old name is not exported again.
+  registry.setPorts({{PortID(1), "eth2/1/1"}, {PortID(2), "eth2/1/2"}});
+  {
+    SwitchStats stats(&registry);
+    stats.portCounter(PortID(1), PortCounter::LINK_STATE_FLAPS);
+  }
+  EXPECT_EQ(
+      counterValue(registry, PortID(1), PortCounter::LINK_STATE_FLAPS), 3);
+  deltas = exportedDeltas(registry);
+  EXPECT_EQ(deltas.size(), 1);
+  EXPECT_EQ(deltas["eth2/1/1.link_state.flap"], 1);
+}
@@ -589,6 +589,42 @@ TEST_F(RoutingFixture, HostToSwitchUnicast) {
   }
 }
 
+/**
+ * Verify that a burst of L3 packets from host is sent like single packets.
+ */
+TEST_F(RoutingFixture, HostToSwitchUnicastBurst) {
+  // Cache the current stats
+  CounterCache counters(sw);
+
+  constexpr auto kBurstSize = 3;
+  std::vector<std::unique_ptr<TxPacket>> pkts;
+  for (auto i = 0; i < kBurstSize; ++i) {
+    pkts.push_back(createTxPacket(
+        sw,
+        createV4UnicastPacket(
+            kIPv4IntfAddr1, kIPv4NbhAddr1, kEmptyMac, kEmptyMac)));
+  }
+  auto bufCopy = IOBuf::copyBuffer(
+      pkts[0]->buf()->data(),
+      pkts[0]->buf()->length(),
+      pkts[0]->buf()->headroom(),
+      0);
+  EXPECT_SWITCHED_PKT(
+      sw,
+      "V4 UcastPkt",
+      matchTxPacket(
+          kPlatformMac,
+          kPlatformMac,
+          VlanID(1),
+          IPv4Handler::ETHERTYPE_IPV4,
+          std::move(bufCopy)))
+      .Times(kBurstSize);
+  sw->sendL3Packets(std::move(pkts), InterfaceID(1));
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "host.tx.sum", kBurstSize);
+}
+
 /**
  * Verify flow of link local packets from host to switch for both v4 and v6.
  * All outgoing L2 packets must have their MAC resolved in software.
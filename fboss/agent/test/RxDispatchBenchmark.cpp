@@ -0,0 +1,247 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/packet/NDP.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV6.h>
+#include <folly/MacAddress.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+
+using namespace facebook::fboss;
+using folly::IOBuf;
+using folly::IPAddressV6;
+using folly::MacAddress;
+using std::make_unique;
+using std::string;
+using std::unique_ptr;
+
+/*
+ * Time for SwSwitch to classify a trapped packet and run its handler, for
+ * the control plane protocols seen most on the CPU queue. The MockHwSwitch
+ * drops whatever the handlers send, so folly reports ns/packet for the RX
+ * path alone.
+ */
+
+namespace {
+
+// Global state used by the benchmarks
+unique_ptr<HwTestHandle> handle;
+unique_ptr<MockRxPacket> arpRequest;
+unique_ptr<MockRxPacket> ndpSolicitation;
+unique_ptr<MockRxPacket> lacpdu;
+unique_ptr<MockRxPacket> lldpdu;
+unique_ptr<MockRxPacket> dhcpDiscover;
+unique_ptr<MockRxPacket> bgpSyn;
+
+// Hex for numBytes zero bytes
+string zeros(size_t numBytes) {
+  string hex;
+  for (size_t i = 0; i < numBytes; ++i) {
+    hex += "00 ";
+  }
+  return hex;
+}
+
+unique_ptr<MockRxPacket> rxPacket(unique_ptr<MockRxPacket> pkt) {
+  pkt->padToLength(68);
+  pkt->setSrcPort(PortID(1));
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+
+// Neighbor solicitation for 2401:db00:2110:3001::1, owned by interface 1
+unique_ptr<MockRxPacket> makeNdpSolicitation() {
+  MacAddress srcMac("00:02:00:01:02:03");
+  IPAddressV6 srcIP("2401:db00:2110:3001::f");
+  IPAddressV6 targetIP("2401:db00:2110:3001::1");
+  // Reserved, target address and source link layer address option
+  size_t plen = 4 + IPAddressV6::byteCount() + 8;
+
+  IPv6Hdr ipv6(srcIP, targetIP.getSolicitedNodeAddress());
+  ipv6.payloadLength = ICMPHdr::SIZE + plen;
+  ipv6.nextHeader = static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP);
+  ipv6.hopLimit = 255;
+
+  size_t totalLen = EthHdr::SIZE + IPv6Hdr::SIZE + ipv6.payloadLength;
+  auto buf = IOBuf::create(totalLen);
+  buf->append(totalLen);
+  folly::io::RWPrivateCursor cursor(buf.get());
+
+  auto bodyFn = [&](folly::io::RWPrivateCursor* c) {
+    c->writeBE<uint32_t>(0);
+    c->push(targetIP.bytes(), IPAddressV6::byteCount());
+    c->writeBE<uint8_t>(NDPOptionType::SRC_LL_ADDRESS);
+    c->writeBE<uint8_t>(NDPOptionLength::SRC_LL_ADDRESS_IEEE802);
+    c->push(srcMac.bytes(), MacAddress::SIZE);
+  };
+
+  ICMPHdr icmp6(
+      static_cast<uint8_t>(ICMPv6Type::ICMPV6_TYPE_NDP_NEIGHBOR_SOLICITATION),
+      0,
+      0);
+  icmp6.serializeFullPacket(
+      &cursor,
+      MacAddress::createMulticast(ipv6.dstAddr),
+      srcMac,
+      VlanID(1),
+      ipv6,
+      plen,
+      bodyFn);
+  return rxPacket(make_unique<MockRxPacket>(std::move(buf)));
+}
+
+void init() {
+  // Setting up the switch is expensive, do it once for all benchmarks
+  handle = createTestHandle(
+      testStateA(), std::nullopt /* default mac */, SwitchFlags::ENABLE_LLDP);
+
+  arpRequest = rxPacket(MockRxPacket::fromHex(
+      // dst mac, src mac
+      "ff ff ff ff ff ff  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // ARP, htype: ethernet, ptype: IPv4, hlen: 6, plen: 4
+      "08 06  00 01  08 00  06  04"
+      // ARP Request
+      "00 01"
+      // Sender MAC
+      "00 02 00 01 02 03"
+      // Sender IP: 10.0.0.15
+      "0a 00 00 0f"
+      // Target MAC
+      "00 00 00 00 00 00"
+      // Target IP: 10.0.0.1
+      "0a 00 00 01"));
+
+  ndpSolicitation = makeNdpSolicitation();
+
+  // LACP isn't enabled on the switch, so this only measures classification
+  lacpdu = rxPacket(MockRxPacket::fromHex(
+      // dst mac (slow protocols multicast), src mac
+      "01 80 c2 00 00 02  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // Slow protocols, subtype: LACP, version 1
+      "88 09  01  01" +
+      zeros(106)));
+
+  // Random parseable LLDP packet found using the fuzzer, see LldpManagerTest
+  lldpdu = rxPacket(MockRxPacket::fromHex(
+      "02 00 01 00 00 01 02 00 02 01 02 03"
+      "81 00 00 01 88 cc 02 0d 00 14 34 56"
+      "53 0c 1f 06 12 34 01 02 03 04 0a 32"
+      "00 73 21 21 21 4a 21 02 02 06 02 02"
+      "00 00 00 00 f2 00 00 0d 0d 0d 0d 0d"
+      "00 00 00 00 00 94 94 94 94 00 00 3b"
+      "3b de 00 00"));
+
+  // No DHCP relay is configured on VLAN 1, so the discover is dropped
+  dhcpDiscover = rxPacket(MockRxPacket::fromHex(
+      // dst mac, src mac
+      "ff ff ff ff ff ff  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // IPv4
+      "08 00"
+      // Version(4), IHL(5), DSCP, ECN, Total Length(272)
+      "45  00  01 10"
+      // Id, Flags, frag offset
+      "00 00  00 00"
+      // TTL(255), Protocol(UDP), checksum (fake)
+      "ff  11  00 00"
+      // Source IP (0.0.0.0), Destination IP (255.255.255.255)
+      "00 00 00 00  ff ff ff ff"
+      // UDP 68 -> 67, Length (252), checksum
+      "00 44  00 43  00 fc  00 00"
+      // op: BOOTREQUEST, htype, hlen, hops
+      "01  01  06  00"
+      // xid, secs, flags
+      "0a 0a 0a 01  00 00  80 00" +
+      // ciaddr, yiaddr, siaddr, giaddr
+      zeros(16) +
+      // chaddr
+      "00 02 00 01 02 03" + zeros(10) +
+      // sname, file
+      zeros(64 + 128) +
+      // magic cookie, DHCP message type: discover, end
+      "63 82 53 63  35 01 01  ff"));
+
+  bgpSyn = rxPacket(MockRxPacket::fromHex(
+      // dst mac (interface 1), src mac
+      "00 02 00 00 00 01  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // IPv4
+      "08 00"
+      // Version(4), IHL(5), DSCP(48), ECN, Total Length(40)
+      "45  c0  00 28"
+      // Id, Flags (DF), frag offset
+      "00 01  40 00"
+      // TTL(1), Protocol(TCP), checksum (fake)
+      "01  06  00 00"
+      // Source IP (10.0.0.15), Destination IP (10.0.0.1)
+      "0a 00 00 0f  0a 00 00 01"
+      // TCP 54321 -> 179 (BGP), seq, ack
+      "d4 31  00 b3  00 00 00 01  00 00 00 00"
+      // Data offset(5), flags: SYN, window, checksum, urgent pointer
+      "50  02  ff ff  00 00  00 00"));
+}
+
+void dispatch(size_t numIters, const MockRxPacket& pkt) {
+  auto sw = handle->getSw();
+  for (size_t n = 0; n < numIters; ++n) {
+    sw->packetReceived(pkt.clone());
+  }
+}
+
+} // unnamed namespace
+
+BENCHMARK(RxArpRequest, numIters) {
+  dispatch(numIters, *arpRequest);
+}
+
+BENCHMARK(RxNdpSolicitation, numIters) {
+  dispatch(numIters, *ndpSolicitation);
+}
+
+BENCHMARK(RxLacp, numIters) {
+  dispatch(numIters, *lacpdu);
+}
+
+BENCHMARK(RxLldp, numIters) {
+  dispatch(numIters, *lldpdu);
+}
+
+BENCHMARK(RxDhcpDiscover, numIters) {
+  dispatch(numIters, *dhcpDiscover);
+}
+
+BENCHMARK(RxBgpSyn, numIters) {
+  dispatch(numIters, *bgpSyn);
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  init();
+  folly::runBenchmarks();
+  handle.reset();
+  return 0;
+}
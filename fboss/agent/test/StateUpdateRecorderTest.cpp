@@ -0,0 +1,154 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StateUpdateRecorder.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortDescriptor.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/experimental/TestUtil.h>
+#include <folly/json.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using std::chrono::microseconds;
+
+namespace {
+
+std::shared_ptr<SwitchState> disablePort(
+    const std::shared_ptr<SwitchState>& in,
+    PortID portId) {
+  auto newState = in->clone();
+  auto newPort = newState->getPorts()->getPort(portId)->clone();
+  newPort->setAdminState(cfg::PortState::DISABLED);
+  newState->getPorts()->modify(&newState)->updatePort(newPort);
+  newState->publish();
+  return newState;
+}
+
+std::shared_ptr<SwitchState> addArpEntry(
+    const std::shared_ptr<SwitchState>& in,
+    folly::IPAddressV4 ip) {
+  auto newState = in->clone();
+  auto arpTable =
+      newState->getVlans()->getVlan(VlanID(1))->getArpTable()->modify(
+          VlanID(1), &newState);
+  arpTable->addEntry(
+      ip,
+      folly::MacAddress("02:00:00:00:00:01"),
+      PortDescriptor(PortID(1)),
+      InterfaceID(1));
+  newState->publish();
+  return newState;
+}
+
+std::vector<folly::dynamic> readRecords(const std::string& path) {
+  std::string contents;
+  EXPECT_TRUE(folly::readFile(path.c_str(), contents));
+  std::vector<folly::StringPiece> lines;
+  folly::split('\n', contents, lines, true /* ignoreEmpty */);
+  std::vector<folly::dynamic> records;
+  for (const auto& line : lines) {
+    records.push_back(folly::parseJson(line));
+  }
+  return records;
+}
+
+} // namespace
+
+TEST(StateUpdateRecorderTest, RecordAndReadBack) {
+  folly::test::TemporaryFile logFile;
+  auto stateA = testStateA();
+  stateA->publish();
+  auto stateB = disablePort(stateA, PortID(1));
+  {
+    StateUpdateRecorder recorder(logFile.path().string(), 10);
+    recorder.recordUpdate(stateA, microseconds(0));
+    recorder.recordUpdate(stateB, microseconds(10));
+  }
+
+  auto updates = StateUpdateRecorder::readLog(logFile.path().string());
+  ASSERT_EQ(updates.size(), 2);
+  EXPECT_EQ(updates[1].hwDuration, microseconds(10));
+  EXPECT_EQ(updates[0].state->toFollyDynamic(), stateA->toFollyDynamic());
+  EXPECT_EQ(updates[1].state->toFollyDynamic(), stateB->toFollyDynamic());
+
+  // Unchanged sections and nodes are shared between the replayed states, so
+  // the replayed delta only has the port that changed
+  const auto& oldState = updates[0].state;
+  const auto& newState = updates[1].state;
+  EXPECT_EQ(oldState->getVlans(), newState->getVlans());
+  EXPECT_EQ(oldState->getInterfaces(), newState->getInterfaces());
+  EXPECT_EQ(oldState->getPort(PortID(2)), newState->getPort(PortID(2)));
+  int changedPorts = 0;
+  DeltaFunctions::forEachChanged(
+      StateDelta(oldState, newState).getPortsDelta(),
+      [&](const std::shared_ptr<Port>& oldPort,
+          const std::shared_ptr<Port>& newPort) {
+        EXPECT_EQ(oldPort->getID(), PortID(1));
+        EXPECT_EQ(newPort->getAdminState(), cfg::PortState::DISABLED);
+        ++changedPorts;
+      });
+  EXPECT_EQ(changedPorts, 1);
+}
+
+  // Only the changed port is in the log
+  auto records = readRecords(logFile.path().string());
+  ASSERT_EQ(records.size(), 2);
+  const auto& changes = records[1]["changes"];
+  ASSERT_EQ(changes.size(), 1);
+  EXPECT_EQ(changes["ports"]["changed"].size(), 1);
+  EXPECT_EQ(changes["ports"]["added"].size(), 0);
+  EXPECT_EQ(changes["ports"]["removed"].size(), 0);
+}
+
+TEST(StateUpdateRecorderTest, RecordNeighborEntries) {
+  folly::test::TemporaryFile logFile;
+  auto stateA = testStateA();
+  stateA->publish();
+  auto stateB = addArpEntry(stateA, folly::IPAddressV4("10.0.0.10"));
+  auto stateC = addArpEntry(stateB, folly::IPAddressV4("10.0.0.11"));
+  {
+    StateUpdateRecorder recorder(logFile.path().string(), 10);
+    recorder.recordUpdate(stateA, microseconds(0));
+    recorder.recordUpdate(stateB, microseconds(0));
+    recorder.recordUpdate(stateC, microseconds(0));
+    EXPECT_EQ(recorder.droppedUpdates(), 0);
+  }
+
+  // The vlan is recorded without its ARP table, plus the added entry
+  auto records = readRecords(logFile.path().string());
+  ASSERT_EQ(records.size(), 3);
+  const auto& vlans = records[2]["changes"]["vlans"];
+  ASSERT_EQ(vlans["changed"].size(), 1);
+  const auto& vlan = vlans["changed"][0];
+  EXPECT_EQ(vlan["arpTable"]["added"].size(), 1);
+  EXPECT_EQ(vlan.count("ndpTable"), 0);
+
+  auto updates = StateUpdateRecorder::readLog(logFile.path().string());
+  ASSERT_EQ(updates.size(), 3);
+  EXPECT_EQ(updates[2].state->toFollyDynamic(), stateC->toFollyDynamic());
+  auto oldArpTable =
+      updates[1].state->getVlans()->getVlan(VlanID(1))->getArpTable();
+  auto newArpTable =
+      updates[2].state->getVlans()->getVlan(VlanID(1))->getArpTable();
+  EXPECT_EQ(
+      oldArpTable->getEntry(folly::IPAddressV4("10.0.0.10")),
+      newArpTable->getEntry(folly::IPAddressV4("10.0.0.10")));
+  EXPECT_EQ(updates[1].state->getPorts(), updates[2].state->getPorts());
+}
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/ParallelSerialization.h"
+#include "fboss/agent/state/RouteNextHopEntry.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/RouteUpdater.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/MacAddress.h>
+#include <gflags/gflags.h>
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+using folly::MacAddress;
+
+namespace {
+
+// 200k routes and 50k neighbors in total
+constexpr auto kNumV4Routes = 150000;
+constexpr auto kNumV6Routes = 50000;
+constexpr auto kNumArpEntries = 25000;
+constexpr auto kNumNdpEntries = 25000;
+
+std::shared_ptr<SwitchState> state;
+
+std::shared_ptr<SwitchState> makeState() {
+  auto newState = std::make_shared<SwitchState>();
+  const RouterID rid(0);
+  newState->addRouteTable(std::make_shared<RouteTable>(rid));
+
+  RouteUpdater updater(newState->getRouteTables());
+  RouteNextHopEntry::NextHopSet nhops{
+      UnresolvedNextHop(IPAddressV6("2401:db00::1"), UCMP_DEFAULT_WEIGHT),
+      UnresolvedNextHop(IPAddressV6("2401:db00::2"), UCMP_DEFAULT_WEIGHT)};
+  RouteNextHopEntry nhopEntry(nhops, AdminDistance::EBGP);
+  for (auto i = 0; i < kNumV4Routes; ++i) {
+    auto network = IPAddressV4::fromLongHBO(0x0a000000 + (i << 8));
+    updater.addRoute(rid, network, 24, ClientID::BGPD, nhopEntry);
+  }
+  for (auto i = 0; i < kNumV6Routes; ++i) {
+    auto bytes = IPAddressV6("2401:db00::").toByteArray();
+    bytes[4] = i >> 8;
+    bytes[5] = i & 0xff;
+    updater.addRoute(rid, IPAddressV6(bytes), 48, ClientID::BGPD, nhopEntry);
+  }
+  newState->resetRouteTables(updater.updateDone());
+
+  auto vlan = std::make_shared<Vlan>(VlanID(1), "Vlan1");
+  auto arpTable = std::make_shared<ArpTable>();
+  for (auto i = 0; i < kNumArpEntries; ++i) {
+    arpTable->addEntry(
+        IPAddressV4::fromLongHBO(0x0b000000 + i),
+        MacAddress::fromHBO(0x020000000000 + i),
+        PortDescriptor(PortID(1 + i % 32)),
+        InterfaceID(1));
+  }
+  vlan->setArpTable(arpTable);
+  auto ndpTable = std::make_shared<NdpTable>();
+  for (auto i = 0; i < kNumNdpEntries; ++i) {
+    auto bytes = IPAddressV6("2401:db00:ffff::").toByteArray();
+    bytes[14] = i >> 8;
+    bytes[15] = i & 0xff;
+    ndpTable->addEntry(
+        IPAddressV6(bytes),
+        MacAddress::fromHBO(0x020000100000 + i),
+        PortDescriptor(PortID(1 + i % 32)),
+        InterfaceID(1));
+  }
+  vlan->setNdpTable(ndpTable);
+  newState->addVlan(vlan);
+  newState->publish();
+  return newState;
+}
+
+// Serialize the state to folly::dynamic and back, as done on warm boot
+void roundTrip(size_t numIters, uint32_t numThreads) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_state_serialization_threads = numThreads;
+  for (size_t n = 0; n < numIters; ++n) {
+    auto json = state->toFollyDynamic();
+    auto restored = SwitchState::fromFollyDynamic(json);
+    folly::doNotOptimizeAway(restored);
+  }
+}
+
+} // unnamed namespace
+
+BENCHMARK(SwitchStateRoundTrip, numIters) {
+  roundTrip(numIters, 1);
+}
+
+BENCHMARK_RELATIVE(SwitchStateRoundTrip4Threads, numIters) {
+  roundTrip(numIters, 4);
+}
+
+BENCHMARK_RELATIVE(SwitchStateRoundTrip8Threads, numIters) {
+  roundTrip(numIters, 8);
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  // Building the state takes much longer than a round trip, do it once
+  state = makeState();
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/TxPacketBufferPool.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+TEST(TxPacketBufferPoolTest, ReuseBuffer) {
+  TxPacketBufferPool pool(4);
+  auto buf = pool.allocate(64);
+  EXPECT_EQ(64, buf->length());
+  EXPECT_GE(buf->capacity(), TxPacketBufferPool::kSizeClasses[0]);
+  auto data = buf->data();
+
+  pool.release(std::move(buf));
+  EXPECT_EQ(1, pool.freeBuffers());
+
+  // Same class, so the buffer is reused
+  buf = pool.allocate(100);
+  EXPECT_EQ(0, pool.freeBuffers());
+  EXPECT_EQ(data, buf->data());
+  EXPECT_EQ(100, buf->length());
+  EXPECT_EQ(0, buf->headroom());
+}
+
+TEST(TxPacketBufferPoolTest, SizeClasses) {
+  TxPacketBufferPool pool(4);
+  pool.release(pool.allocate(64));
+  EXPECT_EQ(1, pool.freeBuffers());
+
+  // Larger class, the small buffer stays in the pool
+  auto buf = pool.allocate(1500);
+  EXPECT_EQ(1500, buf->length());
+  EXPECT_EQ(1, pool.freeBuffers());
+  pool.release(std::move(buf));
+  EXPECT_EQ(2, pool.freeBuffers());
+}
+
+TEST(TxPacketBufferPoolTest, MaxBuffersPerClass) {
+  TxPacketBufferPool pool(2);
+  std::vector<std::unique_ptr<folly::IOBuf>> bufs;
+  for (auto i = 0; i < 3; ++i) {
+    bufs.push_back(pool.allocate(64));
+  }
+  for (auto& buf : bufs) {
+    pool.release(std::move(buf));
+  }
+  EXPECT_EQ(2, pool.freeBuffers());
+}
+
+TEST(TxPacketBufferPoolTest, NotPooled) {
+  TxPacketBufferPool pool(4);
+  // Jumbo packets are allocated as usual and not kept
+  auto buf = pool.allocate(9000);
+  EXPECT_EQ(9000, buf->length());
+  pool.release(std::move(buf));
+  EXPECT_EQ(0, pool.freeBuffers());
+
+  // Nor are buffers still referenced elsewhere
+  buf = pool.allocate(64);
+  auto clone = buf->clone();
+  pool.release(std::move(buf));
+  EXPECT_EQ(0, pool.freeBuffers());
+
+  // Nor chains
+  buf = pool.allocate(64);
+  buf->prependChain(pool.allocate(64));
+  pool.release(std::move(buf));
+  EXPECT_EQ(0, pool.freeBuffers());
+}
@@ -0,0 +1,255 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#ifndef COMPACT_RADIX_TREE_H
+#error "This should only be included by CompactRadixTree.h"
+#endif
+
+namespace facebook::network {
+
+template <typename IPADDRTYPE, typename T>
+CompactRadixTreeIterator<IPADDRTYPE, T>::CompactRadixTreeIterator(
+    const Tree* tree,
+    uint32_t index)
+    : tree_(index == Tree::kNoNode ? nullptr : tree), view_(tree, index) {
+  if (tree_ && !tree_->nodes_[index].hasValue) {
+    ++(*this);
+  }
+}
+
+template <typename IPADDRTYPE, typename T>
+CompactRadixTreeIterator<IPADDRTYPE, T>&
+CompactRadixTreeIterator<IPADDRTYPE, T>::operator++() {
+  CHECK(!atEnd());
+  // Same walk as RadixTreeIteratorImpl::radixTreeItrIncrement, over indices
+  const auto& nodes = tree_->nodes_;
+  auto cursor = view_.index();
+  auto previous = Tree::kNoNode;
+  auto done = false;
+  while (!done && cursor != Tree::kNoNode) {
+    const auto& node = nodes[cursor];
+    if (previous == Tree::kNoNode || node.parent == previous) {
+      // Going down the tree
+      previous = cursor;
+      if (node.left != Tree::kNoNode) {
+        cursor = node.left;
+      } else if (node.right != Tree::kNoNode) {
+        cursor = node.right;
+      } else {
+        cursor = node.parent;
+        continue;
+      }
+    } else if (node.left == previous) {
+      // Coming up the tree from left.
+      previous = cursor;
+      if (node.right != Tree::kNoNode) {
+        cursor = node.right;
+      } else {
+        cursor = node.parent;
+        continue;
+      }
+    } else {
+      // Coming up the tree from right
+      previous = cursor;
+      cursor = node.parent;
+      continue;
+    }
+    done = cursor == Tree::kNoNode || nodes[cursor].hasValue;
+  }
+  if (cursor == Tree::kNoNode) {
+    tree_ = nullptr;
+    view_ = NodeView();
+  } else {
+    view_ = NodeView(tree_, cursor);
+  }
+  return *this;
+}
+
+template <typename IPADDRTYPE, typename T>
+uint32_t CompactRadixTree<IPADDRTYPE, T>::longestMatchImpl(
+    const Bits& bits,
+    uint8_t masklen,
+    bool& foundExact,
+    bool includeNonValueNodes) const {
+  // Can't trust the clients to have 0s in all bits after mask length
+  const auto toMatch = PrefixTraits::mask(bits, masklen);
+
+  auto parent = kNoNode;
+  auto lastValueNodeSeen = kNoNode;
+  auto cur = root_;
+  while (cur != kNoNode) {
+    const auto& node = nodes_[cur];
+    auto direction = searchDirection(node, toMatch, masklen);
+    if (direction == TreeDirection::PARENT) {
+      // We took one extra step in the hope of getting a better
+      // match but this didn't succeed. So back up one step
+      cur = parent;
+      break;
+    }
+    lastValueNodeSeen = node.hasValue ? cur : lastValueNodeSeen;
+    if (direction == TreeDirection::THIS_NODE) {
+      foundExact = node.hasValue || includeNonValueNodes;
+      break;
+    }
+    auto next = direction == TreeDirection::LEFT ? node.left : node.right;
+    if (next == kNoNode) {
+      break;
+    }
+    parent = cur;
+    cur = next;
+  }
+  return includeNonValueNodes ? cur : lastValueNodeSeen;
+}
+
+template <typename IPADDRTYPE, typename T>
+uint32_t CompactRadixTree<IPADDRTYPE, T>::allocNode(
+    const Bits& bits,
+    uint8_t masklen) {
+  uint32_t index;
+  if (!freeNodes_.empty()) {
+    index = freeNodes_.back();
+    freeNodes_.pop_back();
+    nodes_[index] = Node();
+  } else {
+    CHECK_LT(nodes_.size(), kNoNode);
+    index = nodes_.size();
+    nodes_.emplace_back();
+    values_.emplace_back();
+  }
+  nodes_[index].bits = bits;
+  nodes_[index].masklen = masklen;
+  return index;
+}
+
+template <typename IPADDRTYPE, typename T>
+void CompactRadixTree<IPADDRTYPE, T>::freeNode(uint32_t index) {
+  values_[index].reset();
+  nodes_[index].hasValue = false;
+  freeNodes_.push_back(index);
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename VALUE>
+std::pair<
+    typename CompactRadixTree<IPADDRTYPE, T>::ConstIterator,
+    bool>
+CompactRadixTree<IPADDRTYPE, T>::insert(
+    const IPADDRTYPE& ipaddr,
+    uint8_t mask,
+    VALUE&& value) {
+  auto foundExact = false;
+  // Can't trust the clients to have 0s in all bits after mask length
+  auto toAdd = PrefixTraits::mask(PrefixTraits::fromAddress(ipaddr), mask);
+  auto bestMatch = longestMatchImpl(
+      toAdd, mask, foundExact, true /*include non value nodes*/);
+  if (foundExact) {
+    if (nodes_[bestMatch].hasValue) {
+      // Prefix already exists in the tree
+      return std::make_pair(ConstIterator(this, bestMatch), false);
+    }
+    nodes_[bestMatch].hasValue = true;
+    values_[bestMatch] = std::forward<VALUE>(value);
+    ++size_;
+    return std::make_pair(ConstIterator(this, bestMatch), true);
+  }
+
+  // Note that allocating nodes may move the arena, so nodes are only
+  // referred to by index from here on
+  auto newNode = allocNode(toAdd, mask);
+  nodes_[newNode].hasValue = true;
+  values_[newNode] = std::forward<VALUE>(value);
+
+  // The node the new prefix gets joined with, and the link pointing to it
+  uint32_t sibling;
+  if (bestMatch == kNoNode) {
+    sibling = root_;
+  } else {
+    auto direction = searchDirection(nodes_[bestMatch], toAdd, mask);
+    CHECK(
+        direction == TreeDirection::LEFT || direction == TreeDirection::RIGHT);
+    sibling = childLink(bestMatch, direction);
+    if (sibling == kNoNode) {
+      setChild(bestMatch, direction, newNode);
+      ++size_;
+      return std::make_pair(ConstIterator(this, newNode), true);
+    }
+  }
+  if (sibling == kNoNode) {
+    // Empty tree, make this the root
+    root_ = newNode;
+    ++size_;
+    return std::make_pair(ConstIterator(this, newNode), true);
+  }
+
+  // Join the new node and sibling under their longest common prefix, which
+  // is either the new node itself or a new non value node
+  auto prefixLen = std::min<uint8_t>(
+      std::min<uint8_t>(
+          PrefixTraits::commonPrefixLen(nodes_[sibling].bits, toAdd), mask),
+      nodes_[sibling].masklen);
+  auto prefixBits = PrefixTraits::mask(toAdd, prefixLen);
+  uint32_t joint;
+  if (prefixLen == mask) {
+    joint = newNode;
+  } else {
+    joint = allocNode(prefixBits, prefixLen);
+  }
+  replaceInParent(sibling, joint);
+  auto siblingDirection = searchDirection(
+      nodes_[joint], nodes_[sibling].bits, nodes_[sibling].masklen);
+  CHECK(
+      siblingDirection == TreeDirection::LEFT ||
+      siblingDirection == TreeDirection::RIGHT);
+  setChild(joint, siblingDirection, sibling);
+  if (joint != newNode) {
+    setChild(
+        joint,
+        siblingDirection == TreeDirection::LEFT ? TreeDirection::RIGHT
+                                                : TreeDirection::LEFT,
+        newNode);
+  }
+  ++size_;
+  return std::make_pair(ConstIterator(this, newNode), true);
+}
+
+/*
+ * Same cases as RadixTree::erase, which explains why all non value nodes
+ * keep 2 children.
+ */
+template <typename IPADDRTYPE, typename T>
+bool CompactRadixTree<IPADDRTYPE, T>::erase(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen) {
+  auto foundExact = false;
+  auto toDelete = longestMatchImpl(
+      PrefixTraits::fromAddress(ipaddr), masklen, foundExact);
+  if (!foundExact) {
+    return false;
+  }
+  auto& node = nodes_[toDelete];
+  auto parent = node.parent;
+  if (node.left != kNoNode && node.right != kNoNode) {
+    // Keep the node as the non value parent of both children
+    node.hasValue = false;
+    values_[toDelete].reset();
+  } else if (node.left != kNoNode || node.right != kNoNode) {
+    // Let the only child take the place of toDelete
+    replaceInParent(toDelete, node.left != kNoNode ? node.left : node.right);
+    freeNode(toDelete);
+  } else {
+    replaceInParent(toDelete, kNoNode);
+    freeNode(toDelete);
+    if (parent != kNoNode && !nodes_[parent].hasValue) {
+      // A non value parent left with one child goes away as well, its
+      // other child takes its place
+      const auto& parentNode = nodes_[parent];
+      auto sibling =
+          parentNode.left != kNoNode ? parentNode.left : parentNode.right;
+      CHECK_NE(sibling, kNoNode);
+      replaceInParent(parent, sibling);
+      freeNode(parent);
+    }
+  }
+  --size_;
+  return true;
+}
+
+} // namespace facebook::network
@@ -0,0 +1,396 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#ifndef COMPACT_RADIX_TREE_H
+#define COMPACT_RADIX_TREE_H
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+
+#include "fboss/lib/RadixTree.h"
+
+namespace facebook::network {
+
+/*
+ * Packed, fixed size representation of the prefix bits of an address, most
+ * significant bit first. Only IPAddressV4 and IPAddressV6 are supported.
+ */
+template <typename IPADDRTYPE>
+struct CompactPrefixTraits;
+
+template <>
+struct CompactPrefixTraits<folly::IPAddressV4> {
+  typedef uint32_t Bits;
+  static constexpr uint8_t kBitCount = 32;
+
+  static Bits fromAddress(const folly::IPAddressV4& addr) {
+    return addr.toLongHBO();
+  }
+  static folly::IPAddressV4 toAddress(Bits bits) {
+    return folly::IPAddressV4::fromLongHBO(bits);
+  }
+  static Bits mask(Bits bits, uint8_t masklen) {
+    return masklen == 0 ? 0 : bits & (~Bits(0) << (kBitCount - masklen));
+  }
+  static bool nthMSBit(Bits bits, uint8_t n) {
+    return (bits >> (kBitCount - 1 - n)) & 1;
+  }
+  // Number of leading bits a and b have in common
+  static uint8_t commonPrefixLen(Bits a, Bits b) {
+    auto diff = a ^ b;
+    return diff ? __builtin_clz(diff) : kBitCount;
+  }
+};
+
+template <>
+struct CompactPrefixTraits<folly::IPAddressV6> {
+  // Most significant half first
+  typedef std::array<uint64_t, 2> Bits;
+  static constexpr uint8_t kBitCount = 128;
+
+  static Bits fromAddress(const folly::IPAddressV6& addr) {
+    Bits bits{0, 0};
+    auto bytes = addr.bytes();
+    for (auto i = 0; i < 8; ++i) {
+      bits[0] = (bits[0] << 8) | bytes[i];
+      bits[1] = (bits[1] << 8) | bytes[i + 8];
+    }
+    return bits;
+  }
+  static folly::IPAddressV6 toAddress(const Bits& bits) {
+    folly::ByteArray16 bytes;
+    for (auto i = 0; i < 8; ++i) {
+      bytes[7 - i] = (bits[0] >> (8 * i)) & 0xff;
+      bytes[15 - i] = (bits[1] >> (8 * i)) & 0xff;
+    }
+    return folly::IPAddressV6(bytes);
+  }
+  static Bits mask(const Bits& bits, uint8_t masklen) {
+    if (masklen <= 64) {
+      return {masklen == 0 ? 0 : bits[0] & (~uint64_t(0) << (64 - masklen)),
+              0};
+    }
+    return {bits[0], bits[1] & (~uint64_t(0) << (128 - masklen))};
+  }
+  static bool nthMSBit(const Bits& bits, uint8_t n) {
+    return n < 64 ? (bits[0] >> (63 - n)) & 1 : (bits[1] >> (127 - n)) & 1;
+  }
+  static uint8_t commonPrefixLen(const Bits& a, const Bits& b) {
+    if (auto diff = a[0] ^ b[0]) {
+      return __builtin_clzll(diff);
+    }
+    auto diff = a[1] ^ b[1];
+    return diff ? 64 + __builtin_clzll(diff) : kBitCount;
+  }
+};
+
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTree;
+
+/*
+ * Read only view of a node in a CompactRadixTree, with the same accessors
+ * as RadixTreeNode. Views are handed out by CompactRadixTree iterators.
+ */
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTreeNodeView {
+ public:
+  typedef CompactRadixTree<IPADDRTYPE, T> Tree;
+
+  CompactRadixTreeNodeView() {}
+  CompactRadixTreeNodeView(const Tree* tree, uint32_t index)
+      : tree_(tree), index_(index) {}
+
+  IPADDRTYPE ipAddress() const {
+    return CompactPrefixTraits<IPADDRTYPE>::toAddress(node().bits);
+  }
+  uint32_t masklen() const {
+    return node().masklen;
+  }
+  bool isValueNode() const {
+    return node().hasValue;
+  }
+  bool isNonValueNode() const {
+    return !isValueNode();
+  }
+  const T& value() const {
+    return tree_->values_[index_].value();
+  }
+  std::string str(bool printValue = true) const {
+    auto nodeStr = folly::to<std::string>(ipAddress().str(), "/", masklen());
+    if (printValue) {
+      nodeStr += isNonValueNode()
+          ? "(*)"
+          : folly::to<std::string>("(", this->value(), ")");
+    }
+    return nodeStr;
+  }
+
+  uint32_t index() const {
+    return index_;
+  }
+
+ private:
+  const typename Tree::Node& node() const {
+    return tree_->nodes_[index_];
+  }
+
+  const Tree* tree_{nullptr};
+  uint32_t index_{0};
+};
+
+/*
+ * Forward iterator over the value nodes of a CompactRadixTree, in
+ * DFS/preorder fashion like RadixTreeIterator. Iterators hold node indices,
+ * so they stay valid while other prefixes are inserted.
+ */
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTreeIterator
+    : public std::iterator<
+          std::forward_iterator_tag,
+          const CompactRadixTreeNodeView<IPADDRTYPE, T>> {
+ public:
+  typedef CompactRadixTree<IPADDRTYPE, T> Tree;
+  typedef CompactRadixTreeNodeView<IPADDRTYPE, T> NodeView;
+
+  CompactRadixTreeIterator() {}
+  CompactRadixTreeIterator(const Tree* tree, uint32_t index);
+
+  CompactRadixTreeIterator& operator++();
+
+  CompactRadixTreeIterator operator++(int) {
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  bool operator==(const CompactRadixTreeIterator& r) const {
+    return atEnd() ? r.atEnd() : !r.atEnd() && view_.index() == r.view_.index();
+  }
+  bool operator!=(const CompactRadixTreeIterator& r) const {
+    return !(*this == r);
+  }
+
+  const NodeView& operator*() const {
+    CHECK(!atEnd());
+    return view_;
+  }
+  const NodeView* operator->() const {
+    CHECK(!atEnd());
+    return &view_;
+  }
+
+  bool atEnd() const {
+    return tree_ == nullptr;
+  }
+
+ private:
+  const Tree* tree_{nullptr};
+  NodeView view_;
+};
+
+/*
+ * Radix tree with the same semantics and insert/erase/lookup/iterator API
+ * as RadixTree (non value nodes join two subtrees, so paths are already
+ * compressed), laid out for cache efficiency:
+ *
+ * - Nodes live in one contiguous arena and link to each other with 32 bit
+ *   indices instead of pointers. Erased nodes are recycled through a free
+ *   list, so a tree does one allocation per doubling rather than one per
+ *   node.
+ * - Prefix bits are stored packed in native integers (4 bytes for v4, 16
+ *   for v6), so matching a node is a mask and compare on registers.
+ * - Values are kept in a parallel array, lookups only touch the nodes.
+ *
+ * Values can't be modified through iterators, use update() instead.
+ */
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTree {
+ public:
+  typedef CompactPrefixTraits<IPADDRTYPE> PrefixTraits;
+  typedef typename PrefixTraits::Bits Bits;
+  typedef CompactRadixTreeIterator<IPADDRTYPE, T> ConstIterator;
+  typedef ConstIterator Iterator;
+  typedef typename RadixTreeNode<IPADDRTYPE, T>::TreeDirection TreeDirection;
+
+  static constexpr uint32_t kNoNode = std::numeric_limits<uint32_t>::max();
+
+  CompactRadixTree() {}
+
+  ConstIterator begin() const {
+    return ConstIterator(this, root_);
+  }
+  ConstIterator end() const {
+    return ConstIterator();
+  }
+
+  // Free all nodes and clear the tree.
+  void clear() {
+    nodes_.clear();
+    values_.clear();
+    freeNodes_.clear();
+    root_ = kNoNode;
+    size_ = 0;
+  }
+
+  // Pre-allocate the arena for numPrefixes prefixes
+  void reserve(size_t numPrefixes) {
+    // At most one non value node per value node
+    nodes_.reserve(2 * numPrefixes);
+    values_.reserve(2 * numPrefixes);
+  }
+
+  /*
+   * Insert a IP, mask, value in tree. Returns inserted node, true
+   * if a node was inserted. If a node for IP, mask already existed
+   * in the tree we return that node, false.
+   */
+  template <typename VALUE>
+  std::pair<ConstIterator, bool>
+  insert(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value);
+
+  /*
+   * Replace the value of an existing IP, mask. Returns false if the prefix
+   * is not in the tree.
+   */
+  template <typename VALUE>
+  bool update(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value) {
+    auto foundExact = false;
+    auto index = longestMatchImpl(
+        PrefixTraits::fromAddress(ipaddr), masklen, foundExact);
+    if (!foundExact) {
+      return false;
+    }
+    values_[index] = std::forward<VALUE>(value);
+    return true;
+  }
+
+  // Erase a IP, mask
+  bool erase(const IPADDRTYPE& ipaddr, uint8_t masklen);
+
+  // Given a IP, mask return the node with longest match for it
+  // NOTE: masklen is unsigned and must be <= ipaddr.bitCount()
+  ConstIterator longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    auto foundExact = false;
+    return ConstIterator(
+        this,
+        longestMatchImpl(
+            PrefixTraits::fromAddress(ipaddr), masklen, foundExact));
+  }
+
+  /*
+   * Given a IP, mask return node whose IP, mask which matches this prefix
+   * exactly
+   */
+  ConstIterator exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    auto foundExact = false;
+    auto index = longestMatchImpl(
+        PrefixTraits::fromAddress(ipaddr), masklen, foundExact);
+    return ConstIterator(this, foundExact ? index : kNoNode);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Number of value and non value nodes in the tree
+  size_t numNodes() const {
+    return nodes_.size() - freeNodes_.size();
+  }
+
+  // Bytes allocated by the tree, excluding anything owned by the values
+  size_t bytesUsed() const {
+    return sizeof(*this) + nodes_.capacity() * sizeof(Node) +
+        values_.capacity() * sizeof(std::optional<T>) +
+        freeNodes_.capacity() * sizeof(uint32_t);
+  }
+
+ private:
+  friend class CompactRadixTreeNodeView<IPADDRTYPE, T>;
+  friend class CompactRadixTreeIterator<IPADDRTYPE, T>;
+
+  struct Node {
+    Bits bits;
+    uint32_t left{kNoNode};
+    uint32_t right{kNoNode};
+    uint32_t parent{kNoNode};
+    uint8_t masklen{0};
+    bool hasValue{false};
+  };
+
+  TreeDirection
+  searchDirection(const Node& node, const Bits& toSearch, uint8_t masklen)
+      const {
+    // Same as RadixTreeNode::searchDirection
+    if (node.masklen < masklen) {
+      if (PrefixTraits::mask(toSearch, node.masklen) == node.bits) {
+        return PrefixTraits::nthMSBit(toSearch, node.masklen)
+            ? TreeDirection::RIGHT
+            : TreeDirection::LEFT;
+      }
+      return TreeDirection::PARENT;
+    }
+    if (node.masklen == masklen && node.bits == toSearch) {
+      return TreeDirection::THIS_NODE;
+    }
+    return TreeDirection::PARENT;
+  }
+
+  uint32_t longestMatchImpl(
+      const Bits& bits,
+      uint8_t masklen,
+      bool& foundExact,
+      bool includeNonValueNodes = false) const;
+
+  uint32_t allocNode(const Bits& bits, uint8_t masklen);
+  void freeNode(uint32_t index);
+
+  uint32_t& childLink(uint32_t parent, TreeDirection direction) {
+    return direction == TreeDirection::LEFT ? nodes_[parent].left
+                                            : nodes_[parent].right;
+  }
+  // Link of the parent (or root_) pointing to index
+  uint32_t& linkTo(uint32_t index) {
+    auto parent = nodes_[index].parent;
+    if (parent == kNoNode) {
+      return root_;
+    }
+    return nodes_[parent].left == index ? nodes_[parent].left
+                                        : nodes_[parent].right;
+  }
+  void setChild(uint32_t parent, TreeDirection direction, uint32_t child) {
+    childLink(parent, direction) = child;
+    if (child != kNoNode) {
+      nodes_[child].parent = parent;
+    }
+  }
+  void replaceInParent(uint32_t index, uint32_t replacement) {
+    auto parent = nodes_[index].parent;
+    linkTo(index) = replacement;
+    if (replacement != kNoNode) {
+      nodes_[replacement].parent = parent;
+    }
+  }
+
+  std::vector<Node> nodes_;
+  std::vector<std::optional<T>> values_;
+  std::vector<uint32_t> freeNodes_;
+  uint32_t root_{kNoNode};
+  size_t size_{0};
+};
+
+} // namespace facebook::network
+
+#include "CompactRadixTree-inl.h"
+
+#endif // COMPACT_RADIX_TREE_H
@@ -0,0 +1,314 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#ifndef PERSISTENT_RADIX_TREE_H
+#error "This should only be included by PersistentRadixTree.h"
+#endif
+
+namespace facebook::network {
+
+template <typename IPADDRTYPE, typename T>
+typename PersistentRadixTreeNode<IPADDRTYPE, T>::TreeDirection
+PersistentRadixTreeNode<IPADDRTYPE, T>::searchDirection(
+    const IPADDRTYPE& toSearch,
+    uint8_t toSearchMasklen) const {
+  // Same as RadixTreeNode::searchDirection
+  if (masklen_ < toSearchMasklen) {
+    if (toSearch.mask(masklen_) == ipAddress_) {
+      return toSearch.getNthMSBit(masklen_) == 1 ? TreeDirection::RIGHT
+                                                 : TreeDirection::LEFT;
+    }
+    return TreeDirection::PARENT;
+  }
+  if (masklen_ == toSearchMasklen && ipAddress_ == toSearch) {
+    return TreeDirection::THIS_NODE;
+  }
+  return TreeDirection::PARENT;
+}
+
+template <typename IPADDRTYPE, typename T>
+PersistentRadixTreeIterator<IPADDRTYPE, T>&
+PersistentRadixTreeIterator<IPADDRTYPE, T>::operator++() {
+  CHECK(!atEnd());
+  do {
+    // Preorder: left subtree is visited before the right one
+    if (cursor_->right()) {
+      toVisit_.push_back(cursor_->right());
+    }
+    if (cursor_->left()) {
+      toVisit_.push_back(cursor_->left());
+    }
+    if (toVisit_.empty()) {
+      cursor_ = nullptr;
+    } else {
+      cursor_ = toVisit_.back();
+      toVisit_.pop_back();
+    }
+  } while (cursor_ && cursor_->isNonValueNode());
+  return *this;
+}
+
+template <typename IPADDRTYPE, typename T>
+const typename PersistentRadixTree<IPADDRTYPE, T>::TreeNode*
+PersistentRadixTree<IPADDRTYPE, T>::longestMatchImpl(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    bool& foundExact,
+    bool includeNonValueNodes) const {
+  // Can't trust the clients to have 0s in all bits after mask length
+  const auto toMatch = ipaddr.mask(masklen);
+
+  const TreeNode* parent = nullptr;
+  const TreeNode* lastValueNodeSeen = nullptr;
+  const TreeNode* curNode = root_.get();
+  while (curNode) {
+    auto searchDirection = curNode->searchDirection(toMatch, masklen);
+    if (searchDirection == TreeDirection::PARENT) {
+      // We took one extra step in the hope of getting a better
+      // match but this didn't succeed. So back up one step
+      curNode = parent;
+      break;
+    }
+    lastValueNodeSeen = curNode->isValueNode() ? curNode : lastValueNodeSeen;
+    if (searchDirection == TreeDirection::THIS_NODE) {
+      foundExact = curNode->isValueNode() || includeNonValueNodes;
+      break;
+    }
+    auto next = searchDirection == TreeDirection::LEFT ? curNode->left()
+                                                       : curNode->right();
+    if (!next) {
+      break;
+    }
+    parent = curNode;
+    curNode = next;
+  }
+  return includeNonValueNodes ? curNode : lastValueNodeSeen;
+}
+
+template <typename IPADDRTYPE, typename T>
+std::vector<const typename PersistentRadixTree<IPADDRTYPE, T>::TreeNode*>
+PersistentRadixTree<IPADDRTYPE, T>::longestMatch(
+    folly::Range<const IPADDRTYPE*> addrs) const {
+  std::vector<const TreeNode*> matches(addrs.size(), nullptr);
+  CHECK_LT(addrs.size(), std::numeric_limits<uint32_t>::max());
+  BatchOrder order(addrs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&addrs](uint32_t a, uint32_t b) {
+    return addrs[a] < addrs[b];
+  });
+  if (root_) {
+    batchLongestMatch(
+        root_.get(), addrs, order.begin(), order.end(), nullptr, matches);
+  }
+  return matches;
+}
+
+/*
+ * Addresses under a prefix are contiguous once sorted. So the addresses
+ * under node, and then under each of its children, are narrowed down with
+ * binary searches; the ones falling outside get the best match seen so far.
+ */
+template <typename IPADDRTYPE, typename T>
+void PersistentRadixTree<IPADDRTYPE, T>::batchLongestMatch(
+    const TreeNode* node,
+    folly::Range<const IPADDRTYPE*> addrs,
+    typename BatchOrder::const_iterator begin,
+    typename BatchOrder::const_iterator end,
+    const TreeNode* bestMatch,
+    std::vector<const TreeNode*>& matches) {
+  auto assign = [&matches](auto from, auto to, const TreeNode* match) {
+    for (; from != to; ++from) {
+      matches[*from] = match;
+    }
+  };
+  const auto masklen = node->masklen();
+  const auto& network = node->ipAddress();
+  auto first = std::partition_point(begin, end, [&](uint32_t i) {
+    return addrs[i].mask(masklen) < network;
+  });
+  auto last = std::partition_point(first, end, [&](uint32_t i) {
+    return addrs[i].mask(masklen) == network;
+  });
+  assign(begin, first, bestMatch);
+  assign(last, end, bestMatch);
+  if (first == last) {
+    return;
+  }
+  bestMatch = node->isValueNode() ? node : bestMatch;
+  if (node->isLeaf()) {
+    assign(first, last, bestMatch);
+    return;
+  }
+  // Nodes with children are shorter than bitCount, so there is a next bit
+  auto mid = std::partition_point(first, last, [&](uint32_t i) {
+    return addrs[i].getNthMSBit(masklen) == 0;
+  });
+  if (node->left()) {
+    batchLongestMatch(node->left(), addrs, first, mid, bestMatch, matches);
+  } else {
+    assign(first, mid, bestMatch);
+  }
+  if (node->right()) {
+    batchLongestMatch(node->right(), addrs, mid, last, bestMatch, matches);
+  } else {
+    assign(mid, last, bestMatch);
+  }
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename VALUE>
+bool PersistentRadixTree<IPADDRTYPE, T>::insert(
+    const IPADDRTYPE& ipaddr,
+    uint8_t mask,
+    VALUE&& value) {
+  // Check first, so that a failed insert copies no nodes
+  if (exactMatch(ipaddr, mask) != end()) {
+    return false;
+  }
+  // Can't trust the clients to have 0s in all bits after mask length
+  auto toAdd = ipaddr.mask(mask);
+  auto link = &root_;
+  while (*link) {
+    auto direction = (*link)->searchDirection(toAdd, mask);
+    if (direction == TreeDirection::THIS_NODE) {
+      // Non value node for this prefix, just give it a value
+      writable(*link)->value_ = std::forward<VALUE>(value);
+      ++size_;
+      return true;
+    }
+    if (direction == TreeDirection::PARENT) {
+      break;
+    }
+    link = &child(writable(*link), direction);
+  }
+
+  auto newNode = std::make_shared<TreeNode>(
+      toAdd, mask, std::forward<VALUE>(value));
+  if (!*link) {
+    *link = std::move(newNode);
+    ++size_;
+    return true;
+  }
+  // The new prefix does not fall under the node at link. Join both under
+  // their longest common prefix, which is either the new node itself or a
+  // new non value node. Nothing below link changes, so the node at link
+  // stays shared.
+  auto prefix = IPADDRTYPE::longestCommonPrefix(
+      {(*link)->ipAddress(), (*link)->masklen()}, {toAdd, mask});
+  NodePtr newParent;
+  if (prefix.first == toAdd && prefix.second == mask) {
+    newParent = std::move(newNode);
+  } else {
+    newParent = std::make_shared<TreeNode>(prefix.first, prefix.second);
+  }
+  auto oldDirection = newParent->searchDirection(link->get());
+  CHECK(
+      oldDirection == TreeDirection::LEFT ||
+      oldDirection == TreeDirection::RIGHT);
+  child(newParent.get(), oldDirection) = std::move(*link);
+  if (newNode) {
+    auto newDirection = newParent->searchDirection(newNode.get());
+    CHECK(
+        newDirection != oldDirection &&
+        (newDirection == TreeDirection::LEFT ||
+         newDirection == TreeDirection::RIGHT));
+    child(newParent.get(), newDirection) = std::move(newNode);
+  }
+  *link = std::move(newParent);
+  ++size_;
+  return true;
+}
+
+template <typename IPADDRTYPE, typename T>
+typename PersistentRadixTree<IPADDRTYPE, T>::NodePtr*
+PersistentRadixTree<IPADDRTYPE, T>::writablePath(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    NodePtr** parentLink) {
+  const auto toFind = ipaddr.mask(masklen);
+  NodePtr* parent = nullptr;
+  auto link = &root_;
+  while (true) {
+    CHECK(*link);
+    auto direction = (*link)->searchDirection(toFind, masklen);
+    CHECK(direction != TreeDirection::PARENT);
+    auto node = writable(*link);
+    if (direction == TreeDirection::THIS_NODE) {
+      break;
+    }
+    parent = link;
+    link = &child(node, direction);
+  }
+  if (parentLink) {
+    *parentLink = parent;
+  }
+  return link;
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename VALUE>
+bool PersistentRadixTree<IPADDRTYPE, T>::update(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    VALUE&& value) {
+  if (exactMatch(ipaddr, masklen) == end()) {
+    return false;
+  }
+  auto link = writablePath(ipaddr, masklen, nullptr);
+  (*link)->value_ = std::forward<VALUE>(value);
+  return true;
+}
+
+/*
+ * Same cases as RadixTree::erase, which explains why all non value nodes
+ * keep 2 children. The only difference is that every node whose links
+ * change is made writable first.
+ */
+template <typename IPADDRTYPE, typename T>
+bool PersistentRadixTree<IPADDRTYPE, T>::erase(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen) {
+  if (exactMatch(ipaddr, masklen) == end()) {
+    return false;
+  }
+  NodePtr* parentLink = nullptr;
+  auto link = writablePath(ipaddr, masklen, &parentLink);
+  auto toDelete = link->get();
+  if (toDelete->left_ && toDelete->right_) {
+    // Keep the node as the non value parent of both children
+    toDelete->value_.reset();
+  } else if (toDelete->left_ || toDelete->right_) {
+    // Let the only child take the place of toDelete
+    auto onlyChild = toDelete->left_ ? std::move(toDelete->left_)
+                                     : std::move(toDelete->right_);
+    *link = std::move(onlyChild);
+  } else {
+    link->reset();
+    auto parent = parentLink ? parentLink->get() : nullptr;
+    if (parent && parent->isNonValueNode()) {
+      // A non value parent left with one child goes away as well, its
+      // other child takes its place
+      auto sibling =
+          parent->left_ ? std::move(parent->left_) : std::move(parent->right_);
+      CHECK(sibling);
+      *parentLink = std::move(sibling);
+    }
+  }
+  --size_;
+  return true;
+}
+
+template <typename IPADDRTYPE, typename T>
+bool PersistentRadixTree<IPADDRTYPE, T>::radixSubTreesEqual(
+    const TreeNode* nodeA,
+    const TreeNode* nodeB) {
+  if (nodeA == nodeB) {
+    return true;
+  }
+  if (nodeA && nodeB) {
+    return nodeA->equalSansLinks(*nodeB) &&
+        radixSubTreesEqual(nodeA->left(), nodeB->left()) &&
+        radixSubTreesEqual(nodeA->right(), nodeB->right());
+  }
+  return false;
+}
+
+} // namespace facebook::network
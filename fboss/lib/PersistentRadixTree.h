@@ -0,0 +1,345 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#ifndef PERSISTENT_RADIX_TREE_H
+#define PERSISTENT_RADIX_TREE_H
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Range.h>
+
+#include "fboss/lib/RadixTree.h"
+
+namespace facebook::network {
+
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTree;
+
+/*
+ * Node in PersistentRadixTree. Same layout rules as RadixTreeNode: nodes
+ * created by inserts hold a value, nodes created by the tree to join two
+ * subtrees hold none and always have 2 children.
+ *
+ * Nodes are reference counted and may be shared by several trees, so they
+ * have no parent pointer. A node is only ever modified through a tree
+ * which holds the single reference to it, shared nodes are copied first.
+ */
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTreeNode {
+ public:
+  typedef std::shared_ptr<PersistentRadixTreeNode> NodePtr;
+  typedef typename RadixTreeNode<IPADDRTYPE, T>::TreeDirection TreeDirection;
+
+  PersistentRadixTreeNode(const IPADDRTYPE& ipAddr, uint8_t mlen)
+      : ipAddress_(ipAddr), masklen_(mlen) {}
+
+  template <typename VALUE>
+  PersistentRadixTreeNode(const IPADDRTYPE& ipAddr, uint8_t mlen, VALUE&& val)
+      : ipAddress_(ipAddr),
+        masklen_(mlen),
+        value_(std::forward<VALUE>(val)) {}
+
+  // Copy of the node sharing both subtrees
+  PersistentRadixTreeNode(const PersistentRadixTreeNode& r) = default;
+  PersistentRadixTreeNode& operator=(const PersistentRadixTreeNode& r) =
+      delete;
+
+  const IPADDRTYPE& ipAddress() const {
+    return ipAddress_;
+  }
+  uint32_t masklen() const {
+    return masklen_;
+  }
+  bool isValueNode() const {
+    return value_.has_value();
+  }
+  bool isNonValueNode() const {
+    return !isValueNode();
+  }
+  bool isLeaf() const {
+    return left_ == nullptr && right_ == nullptr;
+  }
+  const PersistentRadixTreeNode* left() const {
+    return left_.get();
+  }
+  const PersistentRadixTreeNode* right() const {
+    return right_.get();
+  }
+  const T& value() const {
+    return value_.value();
+  }
+  std::string str(bool printValue = true) const {
+    auto nodeStr = folly::to<std::string>(ipAddress_.str(), "/", masklen_);
+    if (printValue) {
+      nodeStr += isNonValueNode()
+          ? "(*)"
+          : folly::to<std::string>("(", this->value(), ")");
+    }
+    return nodeStr;
+  }
+
+  // Given a IP, mask pair determine where that might lie w.r.t. this node
+  TreeDirection searchDirection(const IPADDRTYPE& toSearch, uint8_t masklen)
+      const;
+
+  TreeDirection searchDirection(const PersistentRadixTreeNode* node) const {
+    return searchDirection(node->ipAddress_, node->masklen_);
+  }
+
+  // Comparison with links (left, right) ignored
+  bool equalSansLinks(const PersistentRadixTreeNode& r) const {
+    return ipAddress_ == r.ipAddress_ && masklen_ == r.masklen_ &&
+        isValueNode() == r.isValueNode() &&
+        (!isValueNode() || this->value() == r.value());
+  }
+
+ private:
+  friend class PersistentRadixTree<IPADDRTYPE, T>;
+
+  IPADDRTYPE ipAddress_;
+  uint32_t masklen_{0}; // Number of bits to match.
+  std::optional<T> value_;
+  NodePtr left_{nullptr};
+  NodePtr right_{nullptr};
+};
+
+/*
+ * Forward iterator over the value nodes of a PersistentRadixTree, in
+ * DFS/preorder fashion like RadixTreeIterator. Without parent pointers the
+ * iterator keeps the subtrees still to be visited on a stack.
+ *
+ * Iterators returned by lookups (exactMatch, longestMatch) are positioned on
+ * the matched node with an empty stack, so incrementing them only walks the
+ * subtree of the match.
+ */
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTreeIterator
+    : public std::iterator<
+          std::forward_iterator_tag,
+          const PersistentRadixTreeNode<IPADDRTYPE, T>> {
+ public:
+  typedef PersistentRadixTreeNode<IPADDRTYPE, T> TreeNode;
+
+  PersistentRadixTreeIterator() {}
+  explicit PersistentRadixTreeIterator(const TreeNode* node) : cursor_(node) {
+    if (cursor_ && cursor_->isNonValueNode()) {
+      ++(*this);
+    }
+  }
+
+  PersistentRadixTreeIterator& operator++();
+
+  PersistentRadixTreeIterator operator++(int) {
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  bool operator==(const PersistentRadixTreeIterator& r) const {
+    return cursor_ == r.cursor_;
+  }
+  bool operator!=(const PersistentRadixTreeIterator& r) const {
+    return cursor_ != r.cursor_;
+  }
+
+  const TreeNode& operator*() const {
+    CHECK(!atEnd());
+    return *cursor_;
+  }
+  const TreeNode* operator->() const {
+    CHECK(!atEnd());
+    return cursor_;
+  }
+
+  bool atEnd() const {
+    return cursor_ == nullptr;
+  }
+
+ private:
+  const TreeNode* cursor_{nullptr};
+  std::vector<const TreeNode*> toVisit_;
+};
+
+/*
+ * Radix tree with the same lookup semantics as RadixTree, but persistent:
+ * copying a tree is O(1) and shares all nodes with the original. insert,
+ * update and erase copy only the nodes on the path from the root to the
+ * modified prefix which are still shared with another tree (path copying),
+ * so modifying a copy touches at most O(prefix length) nodes and never
+ * changes what the original tree sees.
+ *
+ * Nodes are immutable once shared, so trees sharing nodes can be read and
+ * modified from different threads. A single tree object is not thread safe.
+ *
+ * Only IPAddressV4 and IPAddressV6 trees are supported. Since values can't
+ * be modified through iterators, use update() to change the value of a
+ * prefix.
+ */
+template <typename IPADDRTYPE, typename T>
+class PersistentRadixTree {
+ public:
+  typedef PersistentRadixTreeNode<IPADDRTYPE, T> TreeNode;
+  typedef typename TreeNode::NodePtr NodePtr;
+  typedef typename TreeNode::TreeDirection TreeDirection;
+  typedef PersistentRadixTreeIterator<IPADDRTYPE, T> ConstIterator;
+  typedef ConstIterator Iterator;
+
+  PersistentRadixTree() {}
+
+  // Copies share all nodes, see clone()
+  PersistentRadixTree(const PersistentRadixTree& r) = default;
+  PersistentRadixTree& operator=(const PersistentRadixTree& r) = default;
+  PersistentRadixTree(PersistentRadixTree&& r) noexcept
+      : root_(std::move(r.root_)), size_(r.size_) {
+    r.size_ = 0;
+  }
+  PersistentRadixTree& operator=(PersistentRadixTree&& r) noexcept {
+    root_ = std::move(r.root_);
+    size_ = r.size_;
+    r.size_ = 0;
+    return *this;
+  }
+
+  // O(1) copy of this tree, all nodes are shared until modified
+  PersistentRadixTree clone() const {
+    return *this;
+  }
+
+  ConstIterator begin() const {
+    return ConstIterator(root_.get());
+  }
+  ConstIterator end() const {
+    return ConstIterator();
+  }
+
+  // Release all nodes of this tree. Nodes shared with other trees survive.
+  void clear() {
+    root_.reset();
+    size_ = 0;
+  }
+
+  /*
+   * Insert a IP, mask, value in tree. Returns false and leaves the tree
+   * unchanged if a value for IP, mask already exists.
+   */
+  template <typename VALUE>
+  bool insert(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value);
+
+  /*
+   * Replace the value of an existing IP, mask. Returns false if the prefix
+   * is not in the tree.
+   */
+  template <typename VALUE>
+  bool update(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value);
+
+  // Erase a IP, mask
+  bool erase(const IPADDRTYPE& ipaddr, uint8_t masklen);
+
+  // Given a IP, mask return the node with longest match for it
+  // NOTE: masklen is unsigned and must be <= ipaddr.bitCount()
+  ConstIterator longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    auto foundExact = false;
+    return ConstIterator(longestMatchImpl(ipaddr, masklen, foundExact));
+  }
+
+  /*
+   * Batch longest match of host addresses (masklen == bitCount). Returns,
+   * for each address in order, the value node with the longest match or
+   * nullptr. The addresses are sorted first, so that each node is visited
+   * at most once for the whole batch rather than once per address.
+   */
+  std::vector<const TreeNode*> longestMatch(
+      folly::Range<const IPADDRTYPE*> addrs) const;
+
+  /*
+   * Given a IP, mask return node whose IP, mask which matches this prefix
+   * exactly
+   */
+  ConstIterator exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    auto foundExact = false;
+    auto match = longestMatchImpl(ipaddr, masklen, foundExact);
+    return ConstIterator(foundExact ? match : nullptr);
+  }
+
+  // Compare 2 radix (sub) trees. Shared subtrees compare equal right away.
+  static bool radixSubTreesEqual(const TreeNode* nodeA, const TreeNode* nodeB);
+
+  bool operator==(const PersistentRadixTree& r) const {
+    return size_ == r.size_ && radixSubTreesEqual(root(), r.root());
+  }
+  bool operator!=(const PersistentRadixTree& r) const {
+    return !(*this == r);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+  const TreeNode* root() const {
+    return root_.get();
+  }
+
+ private:
+  const TreeNode* longestMatchImpl(
+      const IPADDRTYPE& ipaddr,
+      uint8_t masklen,
+      bool& foundExact,
+      bool includeNonValueNodes = false) const;
+
+  using BatchOrder = std::vector<uint32_t>;
+  static void batchLongestMatch(
+      const TreeNode* node,
+      folly::Range<const IPADDRTYPE*> addrs,
+      typename BatchOrder::const_iterator begin,
+      typename BatchOrder::const_iterator end,
+      const TreeNode* bestMatch,
+      std::vector<const TreeNode*>& matches);
+
+  /*
+   * Make the node held by link safe to modify, copying it if it's shared
+   * with another tree. The link itself must belong to this tree, i.e. be
+   * root_ or a child of a node already made writable.
+   */
+  static TreeNode* writable(NodePtr& link) {
+    if (link.use_count() > 1) {
+      link = std::make_shared<TreeNode>(*link);
+    }
+    return link.get();
+  }
+
+  static NodePtr& child(TreeNode* node, TreeDirection direction) {
+    DCHECK(
+        direction == TreeDirection::LEFT || direction == TreeDirection::RIGHT);
+    return direction == TreeDirection::LEFT ? node->left_ : node->right_;
+  }
+
+  /*
+   * Walk from the root to the node for IP, mask, making every node on the
+   * way writable. The prefix must be in the tree. Returns the link holding
+   * the node and, through parentLink, the link holding its parent.
+   */
+  NodePtr* writablePath(
+      const IPADDRTYPE& ipaddr,
+      uint8_t masklen,
+      NodePtr** parentLink);
+
+  NodePtr root_{nullptr};
+  size_t size_{0};
+};
+
+} // namespace facebook::network
+
+#include "PersistentRadixTree-inl.h"
+
+#endif // PERSISTENT_RADIX_TREE_H
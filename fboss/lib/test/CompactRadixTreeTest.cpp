@@ -0,0 +1,138 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <gtest/gtest.h>
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Random.h>
+
+#include "fboss/lib/CompactRadixTree.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace facebook::network;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+
+namespace {
+
+IPAddressV4 randomIp(IPAddressV4 /*unused*/) {
+  return IPAddressV4::fromLongHBO(folly::Random::rand32());
+}
+
+IPAddressV6 randomIp(IPAddressV6 /*unused*/) {
+  folly::ByteArray16 ba;
+  *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+  *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+  return IPAddressV6(ba);
+}
+
+// Both trees hold the same prefixes, in the same preorder
+template <typename IPAddrType>
+void expectSameTrees(
+    const RadixTree<IPAddrType, int>& tree,
+    const CompactRadixTree<IPAddrType, int>& compact) {
+  EXPECT_EQ(tree.size(), compact.size());
+  auto itr = tree.begin();
+  auto citr = compact.begin();
+  for (; itr != tree.end() && citr != compact.end(); ++itr, ++citr) {
+    EXPECT_EQ(itr->ipAddress(), citr->ipAddress());
+    EXPECT_EQ(itr->masklen(), citr->masklen());
+    EXPECT_EQ(itr->value(), citr->value());
+  }
+  EXPECT_TRUE(itr == tree.end());
+  EXPECT_TRUE(citr == compact.end());
+}
+
+template <typename IPAddrType>
+void compareWithRadixTree() {
+  const auto kBitCount = IPAddrType::bitCount();
+  RadixTree<IPAddrType, int> tree;
+  CompactRadixTree<IPAddrType, int> compact;
+  std::vector<std::pair<IPAddrType, uint8_t>> prefixes;
+  for (auto i = 0; i < 5000; ++i) {
+    auto mask = folly::Random::rand32(kBitCount + 1);
+    auto ip = randomIp(IPAddrType()).mask(mask);
+    auto inserted = compact.insert(ip, mask, i);
+    EXPECT_EQ(tree.insert(ip, mask, i).second, inserted.second);
+    EXPECT_EQ(inserted.first->ipAddress(), ip);
+    prefixes.emplace_back(ip, mask);
+  }
+  expectSameTrees(tree, compact);
+  // Lookups of prefixes not in the tree too
+  for (auto i = 0; i < 5000; ++i) {
+    auto ip = randomIp(IPAddrType());
+    auto mask = folly::Random::rand32(kBitCount + 1);
+    auto itr = tree.longestMatch(ip, mask);
+    auto citr = compact.longestMatch(ip, mask);
+    ASSERT_EQ(itr == tree.end(), citr == compact.end());
+    if (itr != tree.end()) {
+      EXPECT_EQ(itr->value(), citr->value());
+    }
+    const auto& pfx = prefixes[folly::Random::rand32(prefixes.size())];
+    EXPECT_EQ(
+        tree.exactMatch(pfx.first, pfx.second) == tree.end(),
+        compact.exactMatch(pfx.first, pfx.second) == compact.end());
+  }
+
+  // Erased nodes are recycled by later inserts
+  for (auto i = 0; i < 2500; ++i) {
+    const auto& pfx = prefixes[folly::Random::rand32(prefixes.size())];
+    EXPECT_EQ(
+        tree.erase(pfx.first, pfx.second),
+        compact.erase(pfx.first, pfx.second));
+  }
+  expectSameTrees(tree, compact);
+  auto bytesUsed = compact.bytesUsed();
+  for (auto i = 0; i < 500; ++i) {
+    auto mask = folly::Random::rand32(kBitCount + 1);
+    auto ip = randomIp(IPAddrType()).mask(mask);
+    EXPECT_EQ(
+        tree.insert(ip, mask, -i).second, compact.insert(ip, mask, -i).second);
+  }
+  expectSameTrees(tree, compact);
+  EXPECT_EQ(compact.bytesUsed(), bytesUsed);
+  EXPECT_LE(compact.numNodes(), 2 * compact.size());
+}
+
+} // namespace
+
+TEST(CompactRadixTree, CompareWithRadixTree4) {
+  compareWithRadixTree<IPAddressV4>();
+}
+
+TEST(CompactRadixTree, CompareWithRadixTree6) {
+  compareWithRadixTree<IPAddressV6>();
+}
+
+TEST(CompactRadixTree, UpdateAndErase) {
+  CompactRadixTree<IPAddressV6, int> tree;
+  EXPECT_EQ(tree.begin(), tree.end());
+  EXPECT_TRUE(tree.insert(IPAddressV6("2401:db00::"), 32, 1).second);
+  EXPECT_TRUE(tree.insert(IPAddressV6("2401:db00:1::"), 48, 2).second);
+  EXPECT_TRUE(tree.insert(IPAddressV6("2401:db00:2::"), 48, 3).second);
+  EXPECT_FALSE(tree.insert(IPAddressV6("2401:db00:2::"), 48, 4).second);
+  EXPECT_EQ(tree.numNodes(), 4);
+
+  EXPECT_TRUE(tree.update(IPAddressV6("2401:db00:2::"), 48, 5));
+  EXPECT_FALSE(tree.update(IPAddressV6("2401:db00:3::"), 48, 6));
+  auto match = tree.longestMatch(IPAddressV6("2401:db00:2::1"), 128);
+  ASSERT_NE(match, tree.end());
+  EXPECT_EQ(match->value(), 5);
+  EXPECT_EQ(match->masklen(), 48);
+  // Bits past the mask length are ignored
+  match = tree.exactMatch(IPAddressV6("2401:db00:1::1"), 48);
+  ASSERT_NE(match, tree.end());
+  EXPECT_EQ(match->value(), 2);
+
+  // Takes the non value node joining the two /48s with it
+  EXPECT_TRUE(tree.erase(IPAddressV6("2401:db00:1::"), 48));
+  EXPECT_FALSE(tree.erase(IPAddressV6("2401:db00:1::"), 48));
+  EXPECT_EQ(tree.numNodes(), 2);
+  match = tree.longestMatch(IPAddressV6("2401:db00:1::1"), 128);
+  ASSERT_NE(match, tree.end());
+  EXPECT_EQ(match->value(), 1);
+
+  tree.clear();
+  EXPECT_EQ(tree.size(), 0);
+  EXPECT_EQ(tree.begin(), tree.end());
+}
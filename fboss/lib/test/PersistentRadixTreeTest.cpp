@@ -0,0 +1,265 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <gtest/gtest.h>
+#include <map>
+#include <unordered_set>
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Random.h>
+
+#include "fboss/lib/PersistentRadixTree.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace facebook::network;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+
+namespace {
+
+// Structural comparison with a RadixTree built from the same operations
+template <typename IPAddrType>
+bool sameShape(
+    const RadixTreeNode<IPAddrType, int>* node,
+    const PersistentRadixTreeNode<IPAddrType, int>* pnode) {
+  if (!node || !pnode) {
+    return !node && !pnode;
+  }
+  if (node->ipAddress() != pnode->ipAddress() ||
+      node->masklen() != pnode->masklen() ||
+      node->isValueNode() != pnode->isValueNode() ||
+      (node->isValueNode() && node->value() != pnode->value())) {
+    return false;
+  }
+  return sameShape(node->left(), pnode->left()) &&
+      sameShape(node->right(), pnode->right());
+}
+
+template <typename IPAddrType>
+void collectNodes(
+    const PersistentRadixTreeNode<IPAddrType, int>* node,
+    std::unordered_set<const void*>& nodes) {
+  if (node) {
+    nodes.insert(node);
+    collectNodes(node->left(), nodes);
+    collectNodes(node->right(), nodes);
+  }
+}
+
+// Number of nodes of tree which are not shared with other
+template <typename IPAddrType>
+size_t numUnsharedNodes(
+    const PersistentRadixTree<IPAddrType, int>& tree,
+    const PersistentRadixTree<IPAddrType, int>& other) {
+  std::unordered_set<const void*> treeNodes;
+  std::unordered_set<const void*> otherNodes;
+  collectNodes(tree.root(), treeNodes);
+  collectNodes(other.root(), otherNodes);
+  size_t unshared = 0;
+  for (auto node : treeNodes) {
+    unshared += otherNodes.count(node) ? 0 : 1;
+  }
+  return unshared;
+}
+
+IPAddressV4 randomIp4() {
+  return IPAddressV4::fromLongHBO(folly::Random::rand32());
+}
+
+IPAddressV6 randomIp6() {
+  folly::ByteArray16 ba;
+  *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+  *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+  return IPAddressV6(ba);
+}
+
+template <typename IPAddrType>
+using Prefixes = std::map<std::pair<IPAddrType, uint8_t>, int>;
+
+template <typename IPAddrType>
+void expectContents(
+    const PersistentRadixTree<IPAddrType, int>& tree,
+    const Prefixes<IPAddrType>& prefixes) {
+  EXPECT_EQ(tree.size(), prefixes.size());
+  size_t count = 0;
+  for (const auto& node : tree) {
+    auto it = prefixes.find({node.ipAddress(), node.masklen()});
+    ASSERT_NE(it, prefixes.end()) << node.str();
+    EXPECT_EQ(it->second, node.value());
+    ++count;
+  }
+  EXPECT_EQ(count, prefixes.size());
+}
+
+} // namespace
+
+TEST(PersistentRadixTree, InsertErase4) {
+  PersistentRadixTree<IPAddressV4, int> tree;
+  EXPECT_TRUE(tree.insert(IPAddressV4("10.0.0.0"), 8, 1));
+  EXPECT_TRUE(tree.insert(IPAddressV4("10.1.0.0"), 16, 2));
+  // Joined under a non value 10.0.0.0/15 node
+  EXPECT_TRUE(tree.insert(IPAddressV4("10.0.0.0"), 16, 3));
+  EXPECT_FALSE(tree.insert(IPAddressV4("10.0.0.0"), 16, 4));
+  EXPECT_EQ(tree.size(), 3);
+
+  auto match = tree.longestMatch(IPAddressV4("10.1.2.3"), 32);
+  ASSERT_NE(match, tree.end());
+  EXPECT_EQ(match->value(), 2);
+  match = tree.longestMatch(IPAddressV4("10.2.0.0"), 32);
+  ASSERT_NE(match, tree.end());
+  EXPECT_EQ(match->value(), 1);
+  EXPECT_EQ(tree.longestMatch(IPAddressV4("11.0.0.0"), 32), tree.end());
+  EXPECT_EQ(tree.exactMatch(IPAddressV4("10.0.0.0"), 15), tree.end());
+
+  EXPECT_TRUE(tree.update(IPAddressV4("10.0.0.0"), 16, 5));
+  EXPECT_FALSE(tree.update(IPAddressV4("10.0.0.0"), 15, 6));
+  EXPECT_EQ(tree.exactMatch(IPAddressV4("10.0.0.0"), 16)->value(), 5);
+
+  // Erasing 10.0.0.0/16 takes the non value node with it
+  EXPECT_TRUE(tree.erase(IPAddressV4("10.0.0.0"), 16));
+  EXPECT_FALSE(tree.erase(IPAddressV4("10.0.0.0"), 16));
+  EXPECT_EQ(tree.size(), 2);
+  ASSERT_NE(tree.root(), nullptr);
+  ASSERT_NE(tree.root()->left(), nullptr);
+  EXPECT_EQ(tree.root()->left()->masklen(), 16);
+  EXPECT_TRUE(tree.root()->left()->isValueNode());
+
+  EXPECT_TRUE(tree.erase(IPAddressV4("10.0.0.0"), 8));
+  EXPECT_TRUE(tree.erase(IPAddressV4("10.1.0.0"), 16));
+  EXPECT_EQ(tree.size(), 0);
+  EXPECT_EQ(tree.root(), nullptr);
+  EXPECT_EQ(tree.begin(), tree.end());
+}
+
+TEST(PersistentRadixTree, SameShapeAsRadixTree) {
+  RadixTree<IPAddressV4, int> tree4;
+  PersistentRadixTree<IPAddressV4, int> ptree4;
+  RadixTree<IPAddressV6, int> tree6;
+  PersistentRadixTree<IPAddressV6, int> ptree6;
+  std::vector<std::pair<IPAddressV4, uint8_t>> prefixes4;
+  std::vector<std::pair<IPAddressV6, uint8_t>> prefixes6;
+  for (auto i = 0; i < 2000; ++i) {
+    auto mask4 = folly::Random::rand32(33);
+    auto ip4 = randomIp4().mask(mask4);
+    EXPECT_EQ(
+        tree4.insert(ip4, mask4, i).second, ptree4.insert(ip4, mask4, i));
+    prefixes4.emplace_back(ip4, mask4);
+    auto mask6 = folly::Random::rand32(129);
+    auto ip6 = randomIp6().mask(mask6);
+    EXPECT_EQ(
+        tree6.insert(ip6, mask6, i).second, ptree6.insert(ip6, mask6, i));
+    prefixes6.emplace_back(ip6, mask6);
+  }
+  EXPECT_TRUE(sameShape(tree4.root(), ptree4.root()));
+  EXPECT_TRUE(sameShape(tree6.root(), ptree6.root()));
+
+  for (auto i = 0; i < 1000; ++i) {
+    const auto& pfx4 = prefixes4[folly::Random::rand32(prefixes4.size())];
+    EXPECT_EQ(
+        tree4.erase(pfx4.first, pfx4.second),
+        ptree4.erase(pfx4.first, pfx4.second));
+    const auto& pfx6 = prefixes6[folly::Random::rand32(prefixes6.size())];
+    EXPECT_EQ(
+        tree6.erase(pfx6.first, pfx6.second),
+        ptree6.erase(pfx6.first, pfx6.second));
+  }
+  EXPECT_EQ(tree4.size(), ptree4.size());
+  EXPECT_EQ(tree6.size(), ptree6.size());
+  EXPECT_TRUE(sameShape(tree4.root(), ptree4.root()));
+  EXPECT_TRUE(sameShape(tree6.root(), ptree6.root()));
+}
+
+TEST(PersistentRadixTree, CloneIsIsolated) {
+  using Tree = PersistentRadixTree<IPAddressV4, int>;
+  Tree tree;
+  Prefixes<IPAddressV4> prefixes;
+  for (auto i = 0; i < 1000; ++i) {
+    auto mask = folly::Random::rand32(33);
+    auto ip = randomIp4().mask(mask);
+    if (tree.insert(ip, mask, i)) {
+      prefixes[{ip, mask}] = i;
+    }
+  }
+
+  // Every version keeps its contents while later versions are modified
+  std::vector<std::pair<Tree, Prefixes<IPAddressV4>>> versions;
+  for (auto round = 0; round < 20; ++round) {
+    versions.emplace_back(tree.clone(), prefixes);
+    EXPECT_TRUE(tree == versions.back().first);
+    for (auto i = 0; i < 50; ++i) {
+      auto it = prefixes.begin();
+      std::advance(it, folly::Random::rand32(prefixes.size()));
+      if (i % 2) {
+        EXPECT_TRUE(tree.erase(it->first.first, it->first.second));
+        prefixes.erase(it);
+      } else {
+        EXPECT_TRUE(tree.update(it->first.first, it->first.second, -i));
+        it->second = -i;
+      }
+      auto mask = folly::Random::rand32(33);
+      auto ip = randomIp4().mask(mask);
+      if (tree.insert(ip, mask, i)) {
+        prefixes[{ip, mask}] = i;
+      }
+    }
+    expectContents(tree, prefixes);
+  }
+  for (const auto& version : versions) {
+    expectContents(version.first, version.second);
+  }
+}
+
+TEST(PersistentRadixTree, PathCopying) {
+  PersistentRadixTree<IPAddressV6, int> tree;
+  for (auto i = 0; i < 10000; ++i) {
+    auto mask = folly::Random::rand32(129);
+    tree.insert(randomIp6().mask(mask), mask, i);
+  }
+
+  // Each modification of a clone copies at most the nodes on the path to
+  // the prefix, plus the new value and non value nodes of an insert
+  auto copy = tree.clone();
+  EXPECT_EQ(numUnsharedNodes(copy, tree), 0);
+  auto ip = randomIp6();
+  copy.insert(ip, 128, -1);
+  EXPECT_LE(numUnsharedNodes(copy, tree), 128 + 2);
+  EXPECT_EQ(tree.exactMatch(ip, 128), tree.end());
+
+  auto copy2 = copy.clone();
+  EXPECT_TRUE(copy2.update(ip, 128, -2));
+  EXPECT_LE(numUnsharedNodes(copy2, copy), 128 + 1);
+  EXPECT_EQ(copy.exactMatch(ip, 128)->value(), -1);
+  EXPECT_EQ(copy2.exactMatch(ip, 128)->value(), -2);
+
+  EXPECT_TRUE(copy2.erase(ip, 128));
+  EXPECT_NE(copy.exactMatch(ip, 128), copy.end());
+  EXPECT_TRUE(copy2 == tree);
+
+  // Nodes no longer shared are modified in place
+  auto unshared = numUnsharedNodes(copy2, tree);
+  EXPECT_TRUE(copy2.insert(ip, 128, -3));
+  EXPECT_TRUE(copy2.erase(ip, 128));
+  EXPECT_EQ(numUnsharedNodes(copy2, tree), unshared);
+}
+
+TEST(PersistentRadixTree, BatchLongestMatch) {
+  PersistentRadixTree<IPAddressV6, int> tree;
+  EXPECT_EQ(tree.longestMatch(folly::Range<const IPAddressV6*>()).size(), 0);
+  for (auto i = 0; i < 5000; ++i) {
+    auto mask = folly::Random::rand32(129);
+    tree.insert(randomIp6().mask(mask), mask, i);
+  }
+  // Addresses under prefixes of the tree, plus random ones and duplicates
+  std::vector<IPAddressV6> addrs;
+  for (const auto& node : tree) {
+    addrs.push_back(node.ipAddress());
+    addrs.push_back(randomIp6());
+  }
+  addrs.push_back(addrs.front());
+  auto matches = tree.longestMatch(folly::crange(addrs));
+  ASSERT_EQ(matches.size(), addrs.size());
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    auto match = tree.longestMatch(addrs[i], 128);
+    EXPECT_EQ(matches[i], match == tree.end() ? nullptr : &*match);
+  }
+}
@@ -8,6 +8,8 @@
 #include "PyRadixWrapper.h"
 #include "common/base/Random.h"
 #include "common/init/Init.h"
+#include "fboss/lib/CompactRadixTree.h"
+#include "fboss/lib/PersistentRadixTree.h"
 #include "fboss/lib/RadixTree.h"
 
 using namespace std;
@@ -27,6 +29,14 @@ DEFINE_int32(
     lookup_count,
     5000,
     "The number of elements to look up on each lookup iteration");
+DEFINE_int32(
+    clone_modify_count,
+    10,
+    "The number of elements to erase and re-add on each clone iteration");
+DEFINE_int32(
+    scale_count,
+    100000,
+    "The number of prefixes in the trees of the lookup rate benchmarks");
 namespace {
 set<Prefix4> insertSet4;
 set<Prefix4> eraseSet4;
@@ -36,6 +46,16 @@ set<Prefix6> insertSet6;
 set<Prefix6> eraseSet6;
 set<Prefix6> exactMatchSet6;
 set<Prefix6> longestMatchSet6;
+vector<Prefix4> cloneModifySet4;
+vector<Prefix6> cloneModifySet6;
+
+// Trees of FLAGS_scale_count prefixes, and addresses to look up in them
+RadixTree<IPAddressV4, int> scaleTree4;
+CompactRadixTree<IPAddressV4, int> scaleCompactTree4;
+vector<IPAddressV4> scaleLookups4;
+RadixTree<IPAddressV6, int> scaleTree6;
+CompactRadixTree<IPAddressV6, int> scaleCompactTree6;
+vector<IPAddressV6> scaleLookups6;
 vector<int> valueSet;
 
 // V4 Benchmarks
@@ -117,6 +137,56 @@ BENCHMARK_RELATIVE(RadixTreeLongestMatch4) {
   }
 }
 
+/*
+ * Clone the tree, then change a few prefixes of the copy. This is what every
+ * route update does to the radix tree of a published RouteTableRib.
+ */
+template <typename TREE, typename PREFIXES>
+void cloneAndModify(const TREE& tree, const PREFIXES& prefixes) {
+  auto copy = tree.clone();
+  auto count = 0;
+  for (const auto& pfx : prefixes) {
+    copy.erase(pfx.ip, pfx.mask);
+    copy.insert(pfx.ip, pfx.mask, count++);
+  }
+  folly::doNotOptimizeAway(copy.size());
+}
+
+BENCHMARK(RadixTreeCloneModify4, iters) {
+  RadixTree<IPAddressV4, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree4(rtree);
+  }
+  while (iters--) {
+    cloneAndModify(rtree, cloneModifySet4);
+  }
+}
+
+BENCHMARK_RELATIVE(PersistentRadixTreeCloneModify4, iters) {
+  PersistentRadixTree<IPAddressV4, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree4(rtree);
+  }
+  while (iters--) {
+    cloneAndModify(rtree, cloneModifySet4);
+  }
+}
+
+BENCHMARK(PersistentRadixTreeInsert4) {
+  PersistentRadixTree<IPAddressV4, int> rtree;
+  setupTree4(rtree);
+}
+
+BENCHMARK_RELATIVE(PersistentRadixTreeLongestMatch4) {
+  PersistentRadixTree<IPAddressV4, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree4(rtree);
+  }
+  for (auto pfx : longestMatchSet4) {
+    rtree.longestMatch(pfx.ip, pfx.mask);
+  }
+}
+
 // V6 benchmarks
 
 template <typename TREE>
@@ -197,6 +267,109 @@ BENCHMARK_RELATIVE(RadixTreeLongestMatch6) {
   }
 }
 
+BENCHMARK(RadixTreeCloneModify6, iters) {
+  RadixTree<IPAddressV6, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree6(rtree);
+  }
+  while (iters--) {
+    cloneAndModify(rtree, cloneModifySet6);
+  }
+}
+
+BENCHMARK_RELATIVE(PersistentRadixTreeCloneModify6, iters) {
+  PersistentRadixTree<IPAddressV6, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree6(rtree);
+  }
+  while (iters--) {
+    cloneAndModify(rtree, cloneModifySet6);
+  }
+}
+
+/*
+ * One longest match of a host address per iteration, so the benchmark
+ * reports lookups per second.
+ */
+template <typename TREE, typename ADDRS>
+void lookups(const TREE& tree, const ADDRS& addrs, unsigned iters) {
+  size_t i = 0;
+  while (iters--) {
+    const auto& addr = addrs[i++ % addrs.size()];
+    folly::doNotOptimizeAway(tree.longestMatch(addr, addr.bitCount()));
+  }
+}
+
+BENCHMARK(RadixTreeLookupRate4, iters) {
+  lookups(scaleTree4, scaleLookups4, iters);
+}
+
+BENCHMARK_RELATIVE(CompactRadixTreeLookupRate4, iters) {
+  lookups(scaleCompactTree4, scaleLookups4, iters);
+}
+
+BENCHMARK(RadixTreeLookupRate6, iters) {
+  lookups(scaleTree6, scaleLookups6, iters);
+}
+
+BENCHMARK_RELATIVE(CompactRadixTreeLookupRate6, iters) {
+  lookups(scaleCompactTree6, scaleLookups6, iters);
+}
+
+BENCHMARK(RadixTreeInsertScale6) {
+  RadixTree<IPAddressV6, int> rtree;
+  for (const auto& node : scaleCompactTree6) {
+    rtree.insert(node.ipAddress(), node.masklen(), node.value());
+  }
+}
+
+BENCHMARK_RELATIVE(CompactRadixTreeInsertScale6) {
+  CompactRadixTree<IPAddressV6, int> rtree;
+  for (const auto& node : scaleCompactTree6) {
+    rtree.insert(node.ipAddress(), node.masklen(), node.value());
+  }
+}
+
+// Bytes of RadixTree nodes per prefix, not counting allocator overhead
+template <typename IPADDRTYPE>
+double bytesPerRoute(const RadixTree<IPADDRTYPE, int>& tree) {
+  size_t numNodes = 0;
+  for (RadixTreeConstIterator<IPADDRTYPE, int> itr(
+           tree.root(), true /* includeNonValueNodes */);
+       !itr.atEnd();
+       ++itr) {
+    ++numNodes;
+  }
+  return double(numNodes * sizeof(RadixTreeNode<IPADDRTYPE, int>)) /
+      tree.size();
+}
+
+template <typename IPADDRTYPE>
+double bytesPerRoute(const CompactRadixTree<IPADDRTYPE, int>& tree) {
+  return double(tree.bytesUsed()) / tree.size();
+}
+
+template <typename IPADDRTYPE>
+void setupScaleTrees(
+    RadixTree<IPADDRTYPE, int>& tree,
+    CompactRadixTree<IPADDRTYPE, int>& compactTree,
+    vector<IPADDRTYPE>& lookupAddrs,
+    const std::function<IPADDRTYPE()>& randomAddr) {
+  while (tree.size() < FLAGS_scale_count) {
+    auto addr = randomAddr();
+    auto mask = folly::Random::rand32(addr.bitCount() + 1);
+    auto value = folly::Random::rand32();
+    tree.insert(addr.mask(mask), mask, value);
+    compactTree.insert(addr.mask(mask), mask, value);
+    // Covered by at least the prefix just inserted
+    lookupAddrs.push_back(addr);
+  }
+  LOG(INFO) << "IPv" << (IPADDRTYPE::bitCount() == 32 ? 4 : 6) << ": "
+            << tree.size() << " prefixes, RadixTree " << bytesPerRoute(tree)
+            << " bytes/route, CompactRadixTree " << bytesPerRoute(compactTree)
+            << " bytes/route";
+}
+
 } // namespace
 
 int main(int /*argc*/, char* /*argv*/[]) {
@@ -224,6 +397,12 @@ int main(int /*argc*/, char* /*argv*/[]) {
     auto newIp = pfx.ip.mask(newMask);
     longestMatchSet4.insert(Prefix4(newIp, newMask));
   }
+  for (auto pfx : eraseSet4) {
+    if (cloneModifySet4.size() == FLAGS_clone_modify_count) {
+      break;
+    }
+    cloneModifySet4.push_back(pfx);
+  }
 
   // Generate random V6 prefixes
   vector<Prefix6> inserted6;
@@ -252,5 +431,22 @@ int main(int /*argc*/, char* /*argv*/[]) {
     auto newIp = pfx.ip.mask(newMask);
     longestMatchSet6.insert(Prefix6(newIp, newMask));
   }
+  for (auto pfx : eraseSet6) {
+    if (cloneModifySet6.size() == FLAGS_clone_modify_count) {
+      break;
+    }
+    cloneModifySet6.push_back(pfx);
+  }
+  setupScaleTrees<IPAddressV4>(
+      scaleTree4, scaleCompactTree4, scaleLookups4, []() {
+        return IPAddressV4::fromLongHBO(folly::Random::rand32());
+      });
+  setupScaleTrees<IPAddressV6>(
+      scaleTree6, scaleCompactTree6, scaleLookups6, []() {
+        ByteArray16 ba;
+        *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+        *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+        return IPAddressV6(ba);
+      });
   runBenchmarks();
 }
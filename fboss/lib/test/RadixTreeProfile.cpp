@@ -3,11 +3,13 @@
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 #include <array>
+#include <chrono>
 #include <set>
 #include <vector>
 #include "Utils.h"
 #include "common/base/Random.h"
 #include "common/init/Init.h"
+#include "fboss/lib/CompactRadixTree.h"
 #include "fboss/lib/RadixTree.h"
 
 using namespace std;
@@ -23,10 +25,20 @@ DEFINE_bool(v6Inserts, false, "Do inserts into v6 trees");
 DEFINE_bool(v6Deletes, false, "Perform deletes on v6 trees");
 DEFINE_bool(v6Exact, false, "Perform exact match on v6 trees");
 DEFINE_bool(v6Longest, false, "Perform longest match on v6 trees");
+DEFINE_bool(
+    v4Scale,
+    false,
+    "Compare RadixTree and CompactRadixTree with 100k v4 prefixes");
+DEFINE_bool(
+    v6Scale,
+    false,
+    "Compare RadixTree and CompactRadixTree with 100k v6 prefixes");
 
 constexpr auto kTreeCount = 1000;
 constexpr auto kInsertCount = 10000;
 constexpr auto kMatchCount = 5000;
+constexpr auto kScaleCount = 100000;
+constexpr auto kScaleLookups = 10000000;
 
 vector<Prefix4> insertVec4;
 vector<Prefix4> matchVec4;
@@ -143,6 +155,61 @@ void radixTreeLongestMatch6() {
   }
 }
 
+// Scale
+template <typename IPADDRTYPE>
+size_t numTreeNodes(const RadixTree<IPADDRTYPE, int>& tree) {
+  size_t numNodes = 0;
+  for (RadixTreeConstIterator<IPADDRTYPE, int> itr(
+           tree.root(), true /* includeNonValueNodes */);
+       !itr.atEnd();
+       ++itr) {
+    ++numNodes;
+  }
+  return numNodes;
+}
+
+template <typename TREE, typename IPADDRTYPE>
+double lookupsPerSec(const TREE& tree, const vector<IPADDRTYPE>& addrs) {
+  auto start = std::chrono::steady_clock::now();
+  size_t found = 0;
+  for (auto i = 0; i < kScaleLookups; ++i) {
+    const auto& addr = addrs[i % addrs.size()];
+    found += tree.longestMatch(addr, addr.bitCount()) != tree.end();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  CHECK_EQ(found, size_t(kScaleLookups));
+  return kScaleLookups / elapsed.count();
+}
+
+/*
+ * Log lookups per second and bytes per route of RadixTree and
+ * CompactRadixTree holding the same kScaleCount prefixes. RadixTree bytes
+ * only count the nodes, not allocator overhead.
+ */
+template <typename IPADDRTYPE, typename RANDOMADDR>
+void radixTreeScale(RANDOMADDR randomAddr) {
+  RadixTree<IPADDRTYPE, int> tree;
+  CompactRadixTree<IPADDRTYPE, int> compactTree;
+  vector<IPADDRTYPE> addrs;
+  while (tree.size() < kScaleCount) {
+    auto addr = randomAddr();
+    auto mask = folly::Random::rand32(IPADDRTYPE::bitCount() + 1);
+    tree.insert(addr.mask(mask), mask, mask);
+    compactTree.insert(addr.mask(mask), mask, mask);
+    addrs.push_back(addr);
+  }
+  auto treeBytes =
+      numTreeNodes(tree) * sizeof(RadixTreeNode<IPADDRTYPE, int>);
+  LOG(INFO) << "RadixTree: " << lookupsPerSec(tree, addrs)
+            << " lookups/s, " << double(treeBytes) / tree.size()
+            << " bytes/route";
+  LOG(INFO) << "CompactRadixTree: " << lookupsPerSec(compactTree, addrs)
+            << " lookups/s, "
+            << double(compactTree.bytesUsed()) / compactTree.size()
+            << " bytes/route";
+}
+
 void fillV4MatchVec() {
   if (matchVec4.size()) {
     return;
@@ -230,5 +297,18 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  if (FLAGS_v4Scale) {
+    radixTreeScale<IPAddressV4>(
+        []() { return IPAddressV4::fromLongHBO(folly::Random::rand32()); });
+  }
+  if (FLAGS_v6Scale) {
+    radixTreeScale<IPAddressV6>([]() {
+      ByteArray16 ba;
+      *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+      *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+      return IPAddressV6(ba);
+    });
+  }
+
   return 0;
 }